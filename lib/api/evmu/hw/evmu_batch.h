@@ -0,0 +1,116 @@
+/*! \file
+ *  \brief EvmuBatch: lockstep CPU execution across many devices
+ *  \ingroup peripherals
+ *
+ *  EvmuBatch steps the CPU cores of a large number of
+ *  devices running the same program, keeping their hot
+ *  state in struct-of-arrays layout so that one decoded
+ *  instruction can be applied across every device (lane)
+ *  sitting at the same program counter.
+ *
+ *  \todo
+ *      - service interrupts and timers between batched instructions
+ *      - vectorize LDF/LDC by batching flash/ROM reads
+ *
+ *  \copyright 2023 Falco Girgis
+ */
+#ifndef EVMU_BATCH_H
+#define EVMU_BATCH_H
+
+#include "evmu_cpu.h"
+
+#define GBL_SELF_TYPE EvmuBatch
+
+GBL_DECLS_BEGIN
+
+GBL_FORWARD_DECLARE_STRUCT(EvmuBatch);
+GBL_FORWARD_DECLARE_STRUCT(EvmuDevice);
+
+//! Counters accumulated by an EvmuBatch while running
+GBL_DECLARE_STRUCT(EvmuBatchStats) {
+    uint64_t groups;        //!< Number of decoded instructions (one per group of lanes sharing a PC)
+    uint64_t vectorLanes;   //!< Lane instructions executed across the whole group at once
+    uint64_t scalarLanes;   //!< Lane instructions which fell back to per-device execution
+    uint64_t validated;     //!< Lane instructions cross-checked against per-device execution
+};
+
+/*! \struct  EvmuBatch
+ *  \brief   Struct-of-arrays executor for a set of devices
+ *
+ *  An EvmuBatch mirrors the PC, ACC, PSW, B, C, SP and both
+ *  general-purpose RAM banks of each of its devices (lanes),
+ *  with each register or RAM byte stored contiguously across
+ *  lanes. Each step, lanes are grouped by PC and program
+ *  memory, the instruction is fetched and decoded once per
+ *  group, and its ALU, load/store, branch, and stack
+ *  operations are applied across every lane of the group in
+ *  straight-line loops the compiler can vectorize.
+ *
+ *  Instructions touching anything outside of the mirrored
+ *  state (peripheral SFRs, XRAM, flash, the BIOS) run through
+ *  the regular EvmuCpu path on that lane's device instead, so
+ *  divergent lanes and I/O remain exact.
+ *
+ *  Only the CPU's instruction stream is advanced: interrupts,
+ *  timers, and the rest of the device are not updated while
+ *  batched, and halted lanes sit idle. Devices must not be
+ *  accessed directly until EvmuBatch_sync() has written the
+ *  mirrored state back to them.
+ *
+ *  With validation enabled, every batched lane instruction is
+ *  also executed by EvmuCpu on the lane's device and the two
+ *  results are compared, failing on the first mismatch.
+ *
+ *  \sa EvmuBatchStats
+ */
+
+/*! \name Lifetime Management
+ *  \brief Methods for creating and destroying a batch
+ *  \relatesalso EvmuBatch
+ *  @{
+ */
+//! Creates a batch whose lanes mirror the \p count devices in \p ppDevices, which must outlive it
+EVMU_EXPORT EvmuBatch* EvmuBatch_create  (EvmuDevice** ppDevices, size_t count) GBL_NOEXCEPT;
+//! Writes the mirrored state back to every device, then destroys the batch
+EVMU_EXPORT void       EvmuBatch_destroy (GBL_SELF)                             GBL_NOEXCEPT;
+//! @}
+
+/*! \name Lanes
+ *  \brief Methods for querying lanes
+ *  \relatesalso EvmuBatch
+ *  @{
+ */
+//! Returns the number of devices (lanes) in the batch
+EVMU_EXPORT size_t      EvmuBatch_laneCount (GBL_CSELF)              GBL_NOEXCEPT;
+//! Returns the device mirrored by the lane at \p lane
+EVMU_EXPORT EvmuDevice* EvmuBatch_device    (GBL_CSELF, size_t lane) GBL_NOEXCEPT;
+//! Returns the program counter of the lane at \p lane
+EVMU_EXPORT EvmuPc      EvmuBatch_pc        (GBL_CSELF, size_t lane) GBL_NOEXCEPT;
+//! Returns the number of distinct program counters across all running lanes
+EVMU_EXPORT size_t      EvmuBatch_divergence(GBL_CSELF)              GBL_NOEXCEPT;
+//! @}
+
+/*! \name Execution
+ *  \brief Methods for running and synchronizing lanes
+ *  \relatesalso EvmuBatch
+ *  @{
+ */
+//! Executes \p instructions instructions on every lane which isn't halted
+EVMU_EXPORT EVMU_RESULT EvmuBatch_run           (GBL_SELF, size_t instructions) GBL_NOEXCEPT;
+//! Writes the mirrored state of every lane back to its device
+EVMU_EXPORT EVMU_RESULT EvmuBatch_sync          (GBL_SELF)                      GBL_NOEXCEPT;
+//! Reloads the mirrored state of every lane after its device was modified externally
+EVMU_EXPORT EVMU_RESULT EvmuBatch_reload        (GBL_SELF)                      GBL_NOEXCEPT;
+//! Enables or disables cross-checking batched instructions against EvmuCpu execution
+EVMU_EXPORT void        EvmuBatch_setValidating (GBL_SELF, GblBool enabled)     GBL_NOEXCEPT;
+//! Returns whether batched instructions are being cross-checked against EvmuCpu execution
+EVMU_EXPORT GblBool     EvmuBatch_validating    (GBL_CSELF)                     GBL_NOEXCEPT;
+//! Copies the counters accumulated by the batch into \p pStats
+EVMU_EXPORT void        EvmuBatch_stats         (GBL_CSELF, EvmuBatchStats* pStats) GBL_NOEXCEPT;
+//! @}
+
+GBL_DECLS_END
+
+#undef GBL_SELF_TYPE
+
+#endif // EVMU_BATCH_H
@@ -46,6 +46,10 @@
 #define EVMU_BUZZER_NAME                "buzzer"    //!< EvmuBuzzer GblObject name
 #define EVMU_BUZZER_PCM_BUFFER_SIZE     256         //!< Size of internal PCM buffer (bytes)
 
+#define EVMU_BUZZER_STREAM_DEFAULT_FREQUENCY 48000  //!< Default host sample rate of the PCM stream (Hz)
+#define EVMU_BUZZER_STREAM_DEFAULT_CAPACITY  8192   //!< Default capacity of the PCM stream's ring buffer (samples)
+#define EVMU_BUZZER_STREAM_SILENCE           0x7f   //!< Sample value generated while the buzzer is idle
+
 #define GBL_SELF_TYPE EvmuBuzzer
 
 GBL_DECLS_BEGIN
@@ -159,6 +163,81 @@ EVMU_EXPORT size_t      EvmuBuzzer_pcmFrequency (GBL_CSELF) GBL_NOEXCEPT;
 EVMU_EXPORT float       EvmuBuzzer_pcmGain      (GBL_CSELF) GBL_NOEXCEPT;
 //! @}
 
+/*! \name  PCM Stream
+ *  \brief Methods for pulling sample-accurate PCM from an audio thread
+ *  \relatesalso EvmuBuzzer
+ *
+ *  While streaming, the emulation thread generates unsigned 8-bit
+ *  samples at the given host frequency directly from the Timer1 and
+ *  P1 state on every emulated cycle, pushing them into a lock-free
+ *  single-producer, single-consumer ring buffer. An audio thread then
+ *  drains the ring with EvmuBuzzer_pullPcm() (or the
+ *  EvmuBuzzer_pcmStreamCallback() trampoline) without ever locking
+ *  or stalling emulation. When the ring is full, new samples are
+ *  dropped and counted rather than blocking.
+ *
+ *  \note
+ *  Starting and stopping the stream must not race with the audio
+ *  thread's pulls; pause the audio device around those calls.
+ *  @{
+ */
+//! Allocates the ring buffer and begins generating samples at \p frequency Hz
+EVMU_EXPORT EVMU_RESULT EvmuBuzzer_startPcmStream    (GBL_SELF,
+                                                      size_t frequency,
+                                                      size_t capacity)  GBL_NOEXCEPT;
+//! Stops generating samples and releases the ring buffer
+EVMU_EXPORT void        EvmuBuzzer_stopPcmStream     (GBL_SELF)         GBL_NOEXCEPT;
+//! Returns whether samples are currently being streamed
+EVMU_EXPORT GblBool     EvmuBuzzer_pcmStreaming      (GBL_CSELF)        GBL_NOEXCEPT;
+//! Returns the host sample rate of the PCM stream
+EVMU_EXPORT size_t      EvmuBuzzer_pcmStreamFrequency(GBL_CSELF)        GBL_NOEXCEPT;
+//! Returns the number of samples ready to be pulled (audio thread)
+EVMU_EXPORT size_t      EvmuBuzzer_pcmStreamAvailable(GBL_CSELF)        GBL_NOEXCEPT;
+//! Returns the number of samples dropped due to a full ring buffer
+EVMU_EXPORT size_t      EvmuBuzzer_pcmStreamDropped  (GBL_CSELF)        GBL_NOEXCEPT;
+//! Copies up to \p samples samples into \p pBuffer, padding any underrun with silence (audio thread)
+EVMU_EXPORT size_t      EvmuBuzzer_pullPcm           (GBL_SELF,
+                                                      void*  pBuffer,
+                                                      size_t samples)   GBL_NOEXCEPT;
+//! Pull-style audio callback trampoline, with an EvmuBuzzer as \p pUserdata
+EVMU_EXPORT void        EvmuBuzzer_pcmStreamCallback (void*    pUserdata,
+                                                      uint8_t* pStream,
+                                                      int      bytes)   GBL_NOEXCEPT;
+//! @}
+
+/*! \name  Offline Rendering
+ *  \brief Methods for rendering PCM without an audio device
+ *  \relatesalso EvmuBuzzer
+ *
+ *  Renders the same sample-accurate output as the PCM stream, with
+ *  the per-tone frequency response baked into the amplitude when
+ *  EvmuBuzzer::enableFreqResp is set, either into a preallocated
+ *  caller buffer or into an unsigned 8-bit mono WAV file. Samples
+ *  are timed by integer sample clocks against emulated cycles and
+ *  nothing is allocated per sample, so rendering runs as fast as
+ *  the device can be stepped with EvmuBuzzer_renderFor().
+ *  @{
+ */
+//! Begins rendering into \p pBuffer, which holds up to \p samples samples
+EVMU_EXPORT EVMU_RESULT EvmuBuzzer_renderPcm      (GBL_SELF,
+                                                   size_t frequency,
+                                                   void*  pBuffer,
+                                                   size_t samples)   GBL_NOEXCEPT;
+//! Begins rendering into a WAV file at \p pPath
+EVMU_EXPORT EVMU_RESULT EvmuBuzzer_renderWav      (GBL_SELF,
+                                                   size_t      frequency,
+                                                   const char* pPath) GBL_NOEXCEPT;
+//! Runs the owning device unthrottled for exactly \p ticks of emulated time, ignoring its speed, while rendering
+EVMU_EXPORT EVMU_RESULT EvmuBuzzer_renderFor      (GBL_SELF,
+                                                   EvmuTicks ticks)   GBL_NOEXCEPT;
+//! Ends rendering, finalizing and closing any WAV file
+EVMU_EXPORT EVMU_RESULT EvmuBuzzer_finishRender   (GBL_SELF)          GBL_NOEXCEPT;
+//! Returns whether an offline render is in progress
+EVMU_EXPORT GblBool     EvmuBuzzer_rendering      (GBL_CSELF)         GBL_NOEXCEPT;
+//! Returns the number of samples produced by the current or last render
+EVMU_EXPORT size_t      EvmuBuzzer_renderedSamples(GBL_CSELF)         GBL_NOEXCEPT;
+//! @}
+
 GBL_DECLS_END
 
 #undef GBL_SELF_TYPE
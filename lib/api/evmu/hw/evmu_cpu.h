@@ -128,13 +128,15 @@ EVMU_EXPORT void   EvmuCpu_setPc (GBL_SELF, EvmuPc address) GBL_NOEXCEPT;
  *  @{
  */
 //! Returns the number of seconds per instruction for the currently executing instruction
-EVMU_EXPORT double   EvmuCpu_secs    (GBL_CSELF)             GBL_NOEXCEPT;
+EVMU_EXPORT double   EvmuCpu_secs         (GBL_CSELF)             GBL_NOEXCEPT;
 //! Returns the number of cycles per instruction for the currently executing instruction
-EVMU_EXPORT size_t   EvmuCpu_cycles  (GBL_CSELF)             GBL_NOEXCEPT;
+EVMU_EXPORT size_t   EvmuCpu_cycles       (GBL_CSELF)             GBL_NOEXCEPT;
 //! Returns the opcode of the currently executing instruction
-EVMU_EXPORT EvmuWord EvmuCpu_opcode  (GBL_CSELF)             GBL_NOEXCEPT;
+EVMU_EXPORT EvmuWord EvmuCpu_opcode       (GBL_CSELF)             GBL_NOEXCEPT;
 //! Returns the operand of the currently executing instruction at index \p idx
-EVMU_EXPORT int32_t  EvmuCpu_operand (GBL_CSELF, size_t idx) GBL_NOEXCEPT;
+EVMU_EXPORT int32_t  EvmuCpu_operand      (GBL_CSELF, size_t idx) GBL_NOEXCEPT;
+//! Returns the total number of instructions fetched and executed by the CPU
+EVMU_EXPORT uint64_t EvmuCpu_instructions (GBL_CSELF)             GBL_NOEXCEPT;
 //! @}
 
 /*! \name Instruction Execution
@@ -24,6 +24,7 @@
 #include "../hw/evmu_buzzer.h"
 #include "../hw/evmu_gamepad.h"
 #include "../hw/evmu_timers.h"
+#include "../hw/evmu_sio.h"
 #include "../fs/evmu_fat.h"
 #include "../fs/evmu_file_manager.h"
 
@@ -41,6 +42,32 @@
 
 GBL_DECLS_BEGIN
 
+/*! \enum  EVMU_DEVICE_INIT_FLAGS
+ *  \brief Flags controlling which construction work is deferred
+ *
+ *  By default a device formats its flash, logs the resulting
+ *  filesystem, and resets every peripheral (including BIOS
+ *  date/time setup) while being constructed. These flags let
+ *  short-lived or bulk-created devices skip that work, which is
+ *  then performed on first use instead.
+ *
+ *  \sa EvmuDevice_createWithFlags()
+ */
+GBL_DECLARE_FLAGS(EVMU_DEVICE_INIT_FLAGS) {
+    EVMU_DEVICE_INIT_DEFAULT      = 0x0, //!< Format, log, and reset during construction
+    EVMU_DEVICE_INIT_DEFER_FORMAT = 0x1, //!< Format flash on first use, only if unformatted
+    EVMU_DEVICE_INIT_QUIET        = 0x2, //!< Don't log the filesystem after formatting
+    EVMU_DEVICE_INIT_DEFER_RESET  = 0x4, //!< Reset peripherals and BIOS state on first update
+    EVMU_DEVICE_INIT_LIGHTWEIGHT  = 0x7, //!< Defer everything and stay quiet
+    EVMU_DEVICE_INIT_ARENA        = 0x8  //!< Back ROM, flash, and WRAM with one cache-line-aligned block
+};
+
+//! 128-bit fingerprint of a device's state, as computed by EvmuDevice_stateHash()
+typedef struct EvmuStateHash {
+    uint64_t lo;    //!< Low 64 bits, usable on its own as a shorter hash
+    uint64_t hi;    //!< High 64 bits
+} EvmuStateHash;
+
 /*! \struct     EvmuDeviceClass
  *  \extends    GblObjectClass
  *  \implements EvmuIBehaviorClass
@@ -75,6 +102,7 @@ GBL_INSTANCE_DERIVE(EvmuDevice, GblObject)
     EvmuBattery* pBattery;  //!< EvmuBattery Peripheral
     EvmuGamepad* pGamepad;  //!< EvmuGamepad Peripheral
     EvmuTimers*  pTimers;   //!< EvmuTimers Peripheral
+    EvmuSio*     pSio;      //!< EvmuSio Peripheral
     union {
         EvmuFlash*       pFlash;   //!< EvmuFlash Peripheral
         EvmuFat*         pFat;     //!< EvmuFat Peripheral
@@ -96,7 +124,9 @@ GBL_PROPERTIES(EvmuDevice,
     (battery, GBL_GENERIC, (READ), EVMU_BATTERY_TYPE),
     (gamepad, GBL_GENERIC, (READ), EVMU_GAMEPAD_TYPE),
     (timers,  GBL_GENERIC, (READ), EVMU_TIMERS_TYPE),
-    (fat,     GBL_GENERIC, (READ), EVMU_FAT_TYPE)
+    (sio,     GBL_GENERIC, (READ), EVMU_SIO_TYPE),
+    (fat,       GBL_GENERIC, (READ),        EVMU_FAT_TYPE),
+    (initFlags, GBL_GENERIC, (READ, WRITE), GBL_FLAGS_TYPE)
 )
 //! \endcond
 
@@ -104,6 +134,11 @@ GBL_PROPERTIES(EvmuDevice,
 EVMU_EXPORT GblType     EvmuDevice_type   (void)      GBL_NOEXCEPT;
 //! Creates an EvmuDevice instance and returns a pointer to it
 EVMU_EXPORT EvmuDevice* EvmuDevice_create (void)      GBL_NOEXCEPT;
+//! Creates an EvmuDevice instance, deferring the construction work selected by \p flags
+EVMU_EXPORT EvmuDevice* EvmuDevice_createWithFlags
+                                          (EVMU_DEVICE_INIT_FLAGS flags) GBL_NOEXCEPT;
+//! Creates a copy of the given device's emulation state, sharing its flash and ROM copy-on-write, or returns NULL on failure
+EVMU_EXPORT EvmuDevice* EvmuDevice_clone  (GBL_CSELF) GBL_NOEXCEPT;
 //! Increments the reference counter for the given device, returning a pointer to it
 EVMU_EXPORT EvmuDevice* EvmuDevice_ref    (GBL_CSELF) GBL_NOEXCEPT;
 //! Decrements and returns the reference count of the given EvmuDevice, destructing it at 0
@@ -112,16 +147,176 @@ EVMU_EXPORT GblRefCount EvmuDevice_unref  (GBL_SELF)  GBL_NOEXCEPT;
 /*! \name Peripherals
  *  \brief Methods for managing peripheral components
  *  \relatesalso EvmuDevice
+ *
+ *  Peripherals are tracked in a registry indexed by position,
+ *  name, and type, so lookups take constant time. It is kept
+ *  up-to-date by EvmuDevice_addPeripheral() and
+ *  EvmuDevice_removePeripheral(), and captures each
+ *  peripheral's name when it is added.
  *  @{
  */
+//! Attaches \p pPeripheral to the given device as a GblObject child, registering it for lookups
+EVMU_EXPORT EVMU_RESULT     EvmuDevice_addPeripheral   (GBL_SELF, EvmuPeripheral* pPeripheral) GBL_NOEXCEPT;
+//! Detaches \p pPeripheral from the given device, removing it from the registry
+EVMU_EXPORT EVMU_RESULT     EvmuDevice_removePeripheral(GBL_SELF, EvmuPeripheral* pPeripheral) GBL_NOEXCEPT;
 //! Returns the number of EvmuPeripheral GblObject children attached to the given device instance
 EVMU_EXPORT size_t          EvmuDevice_peripheralCount (GBL_CSELF)                    GBL_NOEXCEPT;
 //! Finds a child EvmuPeripheral child attached to the given device, returning a pointer to it or NULL if not found
 EVMU_EXPORT EvmuPeripheral* EvmuDevice_findPeripheral  (GBL_CSELF, const char* pName) GBL_NOEXCEPT;
+//! Finds the first child EvmuPeripheral which is or derives from \p type, returning a pointer to it or NULL if not found
+EVMU_EXPORT EvmuPeripheral* EvmuDevice_findPeripheralByType
+                                                       (GBL_CSELF, GblType type)      GBL_NOEXCEPT;
 //! Returns the child EvmuPeripheral attached to the given device at the provided \p index
 EVMU_EXPORT EvmuPeripheral* EvmuDevice_peripheral      (GBL_CSELF, size_t index)      GBL_NOEXCEPT;
 //! @}
 
+/*! \name Initialization
+ *  \brief Methods for managing deferred construction work
+ *  \relatesalso EvmuDevice
+ *  @{
+ */
+//! Returns the flags the given device was constructed with
+EVMU_EXPORT EVMU_DEVICE_INIT_FLAGS EvmuDevice_initFlags   (GBL_CSELF) GBL_NOEXCEPT;
+//! Returns the deferred work (DEFER_FORMAT and/or DEFER_RESET) which has yet to be performed
+EVMU_EXPORT EVMU_DEVICE_INIT_FLAGS EvmuDevice_pendingInit (GBL_CSELF) GBL_NOEXCEPT;
+//! Performs any pending deferred work immediately, rather than waiting for first use
+EVMU_EXPORT EVMU_RESULT            EvmuDevice_finishInit  (GBL_SELF)  GBL_NOEXCEPT;
+//! @}
+
+/*! \name Speed
+ *  \brief Methods for controlling emulation speed
+ *  \relatesalso EvmuDevice
+ *
+ *  Updating a device runs it for the given host time multiplied
+ *  by its speed ratio, which is further scaled 10x or 0.1x while
+ *  the fast-forward or slow-motion buttons are held. Fractions
+ *  of a tick and the partial instruction at the end of each
+ *  update are carried into the next, so the emulated time stays
+ *  exact no matter how the host divides it up.
+ *
+ *  EvmuDevice_runTurbo() ignores the speed ratio and runs the
+ *  device as fast as the host allows for a wall-clock budget.
+ *  @{
+ */
+//! Returns the ratio of emulated time to host time used by EvmuIBehavior_update()
+EVMU_EXPORT double      EvmuDevice_speed        (GBL_CSELF)                                  GBL_NOEXCEPT;
+//! Sets the ratio of emulated time to host time used by EvmuIBehavior_update(), which must be positive
+EVMU_EXPORT EVMU_RESULT EvmuDevice_setSpeed     (GBL_SELF, double ratio)                     GBL_NOEXCEPT;
+//! Returns the total emulated time the given device has been run for
+EVMU_EXPORT EvmuTicks   EvmuDevice_emulatedTicks(GBL_CSELF)                                  GBL_NOEXCEPT;
+//! Runs unthrottled for \p budget ticks of wall-clock time, writing the speed ratio achieved to \p pRatio
+EVMU_EXPORT EVMU_RESULT EvmuDevice_runTurbo     (GBL_SELF, EvmuTicks budget, double* pRatio) GBL_NOEXCEPT;
+//! Returns the speed ratio achieved by the last call to EvmuDevice_runTurbo()
+EVMU_EXPORT double      EvmuDevice_turboRatio   (GBL_CSELF)                                  GBL_NOEXCEPT;
+//! @}
+
+/*! \name Rewind
+ *  \brief Methods for stepping a device back in emulated time
+ *  \relatesalso EvmuDevice
+ *
+ *  While recording, a device takes a snapshot of its state every
+ *  interval of emulated time, storing each as the difference from
+ *  the next, along with the buttons held during every update in
+ *  between. Rewinding restores the nearest earlier snapshot, then
+ *  replays the recorded input up to the requested time, so any
+ *  point within the history can be reached exactly.
+ *
+ *  History lives within a single allocation of the given budget,
+ *  with the oldest snapshots dropped to make room for new ones.
+ *  It's discarded when the device is reset or a state is loaded,
+ *  and a device can't be rewound while linked to another.
+ *  @{
+ */
+//! Records rewind history within \p budget bytes, snapshotting every \p interval ticks, or stops recording when 0
+EVMU_EXPORT EVMU_RESULT EvmuDevice_setRewind    (GBL_SELF, size_t budget, EvmuTicks interval) GBL_NOEXCEPT;
+//! Returns the byte budget of the rewind history, or 0 if it isn't being recorded
+EVMU_EXPORT size_t      EvmuDevice_rewindBudget (GBL_CSELF)                                   GBL_NOEXCEPT;
+//! Returns the earliest emulated time the given device can be rewound to
+EVMU_EXPORT EvmuTicks   EvmuDevice_rewindLimit  (GBL_CSELF)                                   GBL_NOEXCEPT;
+//! Restores the given device to how it was after running for \p ticks, discarding history beyond it
+EVMU_EXPORT EVMU_RESULT EvmuDevice_rewind       (GBL_SELF, EvmuTicks ticks)                   GBL_NOEXCEPT;
+//! @}
+
+/*! \name Movies
+ *  \brief Methods for recording and replaying input
+ *  \relatesalso EvmuDevice
+ *
+ *  A movie holds the state a device was in when recording began,
+ *  followed by a compact stream of the emulated time of every
+ *  update and each change to the buttons it was polled with.
+ *  Playing one back loads its state, then makes the same updates
+ *  with the same buttons as fast as the host allows, ignoring
+ *  the frontend, so the device ends up exactly as it was when
+ *  the movie was saved.
+ *
+ *  Resetting the device or loading a state, including by
+ *  rewinding, ends the recording, which can still be saved.
+ *  @{
+ */
+//! Begins recording a movie from the current state of the given device, discarding any previous one
+EVMU_EXPORT EVMU_RESULT EvmuDevice_recordMovie   (GBL_SELF)                     GBL_NOEXCEPT;
+//! Returns GBL_TRUE if the given device is still recording its movie
+EVMU_EXPORT GblBool     EvmuDevice_movieRecording(GBL_CSELF)                    GBL_NOEXCEPT;
+//! Stops recording and discards the movie
+EVMU_EXPORT void        EvmuDevice_stopMovie     (GBL_SELF)                     GBL_NOEXCEPT;
+//! Returns the number of bytes needed to save the movie recorded so far, or 0 if there isn't one
+EVMU_EXPORT size_t      EvmuDevice_movieSize     (GBL_CSELF)                    GBL_NOEXCEPT;
+//! Saves the movie recorded so far into \p pData, writing the number of bytes used to \p pSize
+EVMU_EXPORT EVMU_RESULT EvmuDevice_saveMovie     (GBL_CSELF,
+                                                  void*   pData,
+                                                  size_t  capacity,
+                                                  size_t* pSize)                GBL_NOEXCEPT;
+//! Replays a movie previously saved by EvmuDevice_saveMovie() to completion
+EVMU_EXPORT EVMU_RESULT EvmuDevice_playMovie     (GBL_SELF,
+                                                  const void* pData,
+                                                  size_t      size)             GBL_NOEXCEPT;
+//! @}
+
+/*! \name State Images
+ *  \brief Methods for saving and resuming from memory-mapped files
+ *  \relatesalso EvmuDevice
+ *
+ *  A state image lays out a save state at fixed, page-aligned
+ *  offsets within a file, with the contents of ROM, flash, and
+ *  WRAM kept raw in regions of their own. Loading one maps those
+ *  regions privately into memory instead of reading them, so
+ *  resuming takes the same time regardless of their size, with
+ *  each page only read in once the emulator first touches it.
+ *  Writes never reach the file, which can be loaded any number
+ *  of times by any number of devices.
+ *
+ *  Images are only portable between hosts sharing the same byte
+ *  order and state version. Saving works anywhere, but loading
+ *  is unsupported on hosts without POSIX file APIs. An image
+ *  which fails to load leaves the device as it was.
+ *  @{
+ */
+//! Writes the full state of the given device out to the image file at \p pPath
+EVMU_EXPORT EVMU_RESULT EvmuDevice_saveImage(GBL_CSELF, const char* pPath) GBL_NOEXCEPT;
+//! Resumes the given device from the image file at \p pPath, saved by EvmuDevice_saveImage()
+EVMU_EXPORT EVMU_RESULT EvmuDevice_loadImage(GBL_SELF, const char* pPath)  GBL_NOEXCEPT;
+//! @}
+
+/*! \name State Hashing
+ *  \brief Methods for fingerprinting the state of a device
+ *  \relatesalso EvmuDevice
+ *
+ *  A state hash covers everything a save state would, so two
+ *  devices hash the same when loading one's state into the other
+ *  would change nothing. Hashes of flash are cached block by
+ *  block, with only the blocks written since the previous call
+ *  being rehashed, so hashing the same device repeatedly costs
+ *  little more than hashing its few kilobytes of RAM and
+ *  peripheral state.
+ *
+ *  The hash isn't cryptographic, and isn't guaranteed to stay
+ *  the same between versions of the library.
+ *  @{
+ */
+//! Writes a 128-bit hash of the full state of the given device to \p pHash
+EVMU_EXPORT EVMU_RESULT EvmuDevice_stateHash(GBL_CSELF, EvmuStateHash* pHash) GBL_NOEXCEPT;
+//! @}
+
 GBL_DECLS_END
 
 #undef GBL_SELF_TYPE
@@ -49,6 +49,8 @@
 #define EVMU_FLASH_BANK_SIZE    65536                                       //!< Size of a single flash bank
 #define EVMU_FLASH_BANKS        2                                           //!< Number of flash banks
 #define EVMU_FLASH_SIZE         (EVMU_FLASH_BANK_SIZE * EVMU_FLASH_BANKS)   //!< Total flash size in bytes
+#define EVMU_FLASH_BLOCK_SIZE   512                                         //!< Granularity at which modifications are tracked
+#define EVMU_FLASH_BLOCKS       (EVMU_FLASH_SIZE / EVMU_FLASH_BLOCK_SIZE)   //!< Number of tracked blocks
 //! @}
 
 /*! \name Programming Sequence
@@ -105,6 +107,11 @@ GBL_CLASS_DERIVE_EMPTY(EvmuFlash, EvmuPeripheral, EvmuIMemory)
  *  the VMU's flash storage. Unless you know what you're
  *  doing, it's advised to work with a higher level API.
  *
+ *  Every write to flash, whether from the CPU, the BIOS, or
+ *  the filesystem, flags the 512-byte blocks it touched as
+ *  dirty until flash is next marked clean. Delta save states
+ *  only contain these blocks.
+ *
  * \sa EvmuFat, EvmuFileManager
  */
 GBL_INSTANCE_DERIVE(EvmuFlash, EvmuPeripheral)
@@ -176,6 +183,84 @@ EVMU_EXPORT EVMU_RESULT EvmuFlash_writeBytes (GBL_SELF,
                                               EvmuAddress base,
                                               const void* pData,
                                               size_t*     pBytes)  GBL_NOEXCEPT;
+//! Copies exactly \p bytes from flash into the buffer, without notifying anyone of the access
+EVMU_EXPORT EVMU_RESULT EvmuFlash_readRaw    (GBL_CSELF,
+                                              EvmuAddress base,
+                                              void*       pData,
+                                              size_t      bytes)   GBL_NOEXCEPT;
+//! Copies exactly \p bytes from the buffer into flash, without setting dataChanged or emitting dataChange
+EVMU_EXPORT EVMU_RESULT EvmuFlash_writeRaw   (GBL_SELF,
+                                              EvmuAddress base,
+                                              const void* pData,
+                                              size_t      bytes)   GBL_NOEXCEPT;
+//! @}
+
+/*! \name Change Tracking
+ *  \brief Methods for tracking which blocks have been modified
+ *  \relatesalso EvmuFlash
+ *  @{
+ */
+//! Returns whether the given block has been modified since flash was last marked clean
+EVMU_EXPORT GblBool     EvmuFlash_blockDirty  (GBL_CSELF, size_t block) GBL_NOEXCEPT;
+//! Returns the number of blocks which have been modified since flash was last marked clean
+EVMU_EXPORT size_t      EvmuFlash_dirtyBlocks (GBL_CSELF)               GBL_NOEXCEPT;
+//! Flags every block as unmodified, establishing the base for subsequent delta save states
+EVMU_EXPORT void        EvmuFlash_markClean   (GBL_SELF)                GBL_NOEXCEPT;
+//! @}
+
+/*! \name Journaling
+ *  \brief Methods for crash-consistent persistence to an image file
+ *  \relatesalso EvmuFlash
+ *
+ *  While journaling, each sync appends only the blocks modified
+ *  since the previous one to a write-ahead journal beside the
+ *  image, as a checksummed batch which only counts once it has
+ *  been committed in full. Once the journal grows large enough,
+ *  it's retired and folded back into the image on a background
+ *  thread. Opening the image replays any journals left behind,
+ *  discarding a batch torn by a crash, so the image can never
+ *  be left in a state that was never synced. Journaling needs
+ *  POSIX file APIs, and is unsupported on hosts without them.
+ *  @{
+ */
+//! Persists flash to the image at \p pPath, loading and recovering it if it exists or creating it from flash if not
+EVMU_EXPORT EVMU_RESULT EvmuFlash_openJournal       (GBL_SELF, const char* pPath) GBL_NOEXCEPT;
+//! Appends every block modified since the last sync to the journal, returning once it's durable
+EVMU_EXPORT EVMU_RESULT EvmuFlash_syncJournal       (GBL_SELF)                    GBL_NOEXCEPT;
+//! Retires the journal and starts folding it into the image in the background, waiting on any previous checkpoint
+EVMU_EXPORT EVMU_RESULT EvmuFlash_checkpointJournal (GBL_SELF)                    GBL_NOEXCEPT;
+//! Syncs one last time, waits on any checkpoint, and stops journaling
+EVMU_EXPORT EVMU_RESULT EvmuFlash_closeJournal      (GBL_SELF)                    GBL_NOEXCEPT;
+//! Returns whether flash is currently being persisted through a journal
+EVMU_EXPORT GblBool     EvmuFlash_journaling        (GBL_CSELF)                   GBL_NOEXCEPT;
+//! Returns the number of bytes synced to the active journal since it was last retired
+EVMU_EXPORT size_t      EvmuFlash_journalSize       (GBL_CSELF)                   GBL_NOEXCEPT;
+//! @}
+
+/*! \name Image Mapping
+ *  \brief Methods for backing flash directly with an image file
+ *  \relatesalso EvmuFlash
+ *
+ *  Rather than being read in up-front, a mapped .bin or .vmu
+ *  image is paged in lazily as its blocks are touched, sharing
+ *  pages with the OS's file cache instead of keeping a copy per
+ *  device. With write-back, modifications land in the image as
+ *  the OS sees fit, and are only guaranteed to have reached it
+ *  after a sync, so the caller decides how often that is. Without
+ *  it, they stay private to the device. A clone gets its own copy
+ *  of a write-back image rather than sharing it, and an image
+ *  can't be mapped while journaling, nor journaled while mapped.
+ *  Mapping is unsupported on hosts without POSIX file APIs.
+ *  @{
+ */
+//! Backs flash with the raw image at \p pPath, writing modifications back to it if \p writeBack or keeping them private if not
+EVMU_EXPORT EVMU_RESULT EvmuFlash_mapImage   (GBL_SELF, const char* pPath, GblBool writeBack) GBL_NOEXCEPT;
+//! Flushes every block modified since the last sync out to a write-back image, returning once it's durable if \p wait
+EVMU_EXPORT EVMU_RESULT EvmuFlash_syncImage  (GBL_SELF, GblBool wait)                         GBL_NOEXCEPT;
+//! Syncs one last time, then moves flash back into memory of its own, detached from the image
+EVMU_EXPORT EVMU_RESULT EvmuFlash_unmapImage (GBL_SELF)                                       GBL_NOEXCEPT;
+//! Returns whether flash is currently backed by a mapped image
+EVMU_EXPORT GblBool     EvmuFlash_mapped     (GBL_CSELF)                                      GBL_NOEXCEPT;
 //! @}
 
 GBL_DECLS_END
@@ -10,6 +10,9 @@
  *  - enabling and disabling screen refresh
  *  - changing screen refresh rate
  *  - synchronous event-driven callbacks for back-end drawing
+ *  - compressed in-memory recording of refreshed frames
+ *  - playback of .LCD animation files
+ *  - incremental hashing of the display contents for regression testing
  *
  *  \todo
  *      - Pixel ghosting still needs some work
@@ -44,6 +47,7 @@
 #define EVMU_LCD_PIXEL_WIDTH    48  //!< Screen resolution (width/rows)
 #define EVMU_LCD_PIXEL_HEIGHT   32  //!< Screen resolution (height/columns)
 #define EVMU_LCD_ICON_COUNT     4   //!< Number of icons
+#define EVMU_LCD_FRAME_SIZE     192 //!< Bytes per raw 1bpp frame (6 bytes per row, MSB is leftmost pixel)
 //! @}
 
 /*! \name  Emulator Settings
@@ -54,6 +58,15 @@
 #define EVMU_LCD_SCREEN_REFRESH_DIVISOR 199 //!< Number of physical refreshes to skip before redrawing
 //! @}
 
+/*! \name  Frame Recorder
+ *  \brief Constants used to configure frame recording
+ *  @{
+ */
+#define EVMU_LCD_RECORDER_KEYFRAME_INTERVAL 64          //!< Number of delta frames per self-contained keyframe
+#define EVMU_LCD_RECORDER_MIN_CAPACITY      (32 * 1024) //!< Smallest recording buffer size, in bytes
+#define EVMU_LCD_RECORDER_DEFAULT_CAPACITY  (4 * 1024 * 1024) //!< Recording buffer size used when none is given
+//! @}
+
 #define GBL_SELF_TYPE EvmuLcd
 
 GBL_DECLS_BEGIN
@@ -83,6 +96,14 @@ GBL_DECLARE_FLAGS(EVMU_LCD_ICONS) {
     EVMU_LCD_ICONS_ALL   = 0xf  //!< All Icons
 };
 
+//! Playback state of an .LCD animation
+GBL_DECLARE_ENUM(EVMU_LCD_ANIMATION_STATE) {
+    EVMU_LCD_ANIMATION_STATE_NONE,      //!< No animation is loaded
+    EVMU_LCD_ANIMATION_STATE_STOPPED,   //!< Animation is loaded but paused
+    EVMU_LCD_ANIMATION_STATE_PLAYING,   //!< Animation is currently advancing
+    EVMU_LCD_ANIMATION_STATE_COMPLETE   //!< Animation has finished its last repetition
+};
+
 /*! \struct  EvmuLcdClass
  *  \extends EvmuPeripheralClass
  *  \brief   GblClass for EvmuLcd
@@ -192,6 +213,100 @@ EVMU_EXPORT uint8_t EvmuLcd_decoratedPixel (GBL_CSELF, size_t row, size_t col) G
 EVMU_EXPORT void EvmuLcd_setIcons (GBL_SELF, EVMU_LCD_ICONS icons)                    GBL_NOEXCEPT;
 //! Sets the raw pixel value for the given screen coordinate, with \p enabled signifying a black pixel
 EVMU_EXPORT void EvmuLcd_setPixel (GBL_SELF, size_t row, size_t col, GblBool enabled) GBL_NOEXCEPT;
+//! Copies an entire raw 1bpp frame of EVMU_LCD_FRAME_SIZE bytes from \p pFrame into the display
+EVMU_EXPORT void EvmuLcd_setFrame (GBL_SELF, const uint8_t* pFrame)                   GBL_NOEXCEPT;
+//! @}
+
+/*! \name Frame Hashing
+ *  \brief Methods for fingerprinting the display contents
+ *
+ *  The frame hash is a 64-bit XOR of per-byte hashes over the displayed XRAM
+ *  bytes plus the icon bits. It is kept up-to-date incrementally as XRAM is
+ *  written, so querying it never touches the framebuffer. It reflects the raw
+ *  XRAM contents, not the decorated pixels with ghosting or filtering applied.
+ *
+ *  \relatesalso EvmuLcd
+ *  @{
+ */
+//! Returns the current hash of the display contents, which is kept up-to-date with every XRAM write
+EVMU_EXPORT uint64_t EvmuLcd_frameHash    (GBL_CSELF)                              GBL_NOEXCEPT;
+//! Computes the hash a display would have when showing the raw 1bpp \p pFrame along with \p icons
+EVMU_EXPORT uint64_t EvmuLcd_hashFrame    (const uint8_t* pFrame,
+                                           EVMU_LCD_ICONS icons)                   GBL_NOEXCEPT;
+//! Updates the owning device until the frame hash matches \p hash or \p timeout device ticks elapse, returning GBL_TRUE upon a match
+EVMU_EXPORT GblBool  EvmuLcd_runUntilHash (GBL_SELF,
+                                           uint64_t   hash,
+                                           EvmuTicks  timeout,
+                                           EvmuTicks* pElapsed)                    GBL_NOEXCEPT;
+//! @}
+
+/*! \name Frame Recording
+ *  \brief Methods for capturing refreshed frames into a compressed ring buffer
+ *
+ *  Each refreshed frame which differs from the previous one is XOR'd against it,
+ *  run-length encoded, and appended to a fixed-size ring buffer along with its
+ *  timestamp (in the same ticks passed to EvmuIBehavior_update()). Every
+ *  EVMU_LCD_RECORDER_KEYFRAME_INTERVAL frames is stored as a keyframe, so seeking
+ *  never decodes more than that many frames. Once the buffer is full, the oldest
+ *  keyframe group is discarded to make room.
+ *
+ *  \relatesalso EvmuLcd
+ *  @{
+ */
+//! Copies the raw 1bpp contents of the display into \p pFrame, which must hold EVMU_LCD_FRAME_SIZE bytes
+EVMU_EXPORT void        EvmuLcd_frame           (GBL_CSELF, uint8_t* pFrame)       GBL_NOEXCEPT;
+//! Begins recording into a newly allocated buffer of \p capacity bytes (0 for the default), discarding any previous recording
+EVMU_EXPORT EVMU_RESULT EvmuLcd_startRecording  (GBL_SELF, size_t capacity)        GBL_NOEXCEPT;
+//! Stops capturing frames, keeping what has already been recorded around for seeking and exporting
+EVMU_EXPORT void        EvmuLcd_stopRecording   (GBL_SELF)                         GBL_NOEXCEPT;
+//! Stops recording and releases the recording buffer
+EVMU_EXPORT void        EvmuLcd_clearRecording  (GBL_SELF)                         GBL_NOEXCEPT;
+//! Returns GBL_TRUE if frames are currently being captured, GBL_FALSE otherwise
+EVMU_EXPORT GblBool     EvmuLcd_recording       (GBL_CSELF)                        GBL_NOEXCEPT;
+//! Returns the number of frames currently held within the recording buffer
+EVMU_EXPORT size_t      EvmuLcd_recordedFrames  (GBL_CSELF)                        GBL_NOEXCEPT;
+//! Returns the number of compressed bytes currently used within the recording buffer
+EVMU_EXPORT size_t      EvmuLcd_recordedBytes   (GBL_CSELF)                        GBL_NOEXCEPT;
+//! Decodes the recorded frame at \p index (0 being the oldest retained) into \p pFrame, optionally returning its timestamp
+EVMU_EXPORT EVMU_RESULT EvmuLcd_recordedFrame   (GBL_CSELF,
+                                                 size_t     index,
+                                                 uint8_t*   pFrame,
+                                                 EvmuTicks* pTimestamp)            GBL_NOEXCEPT;
+//! Exports the recording to \p pPath as a legacy .LCD animation, quantizing frame delays to 1/12th of a second
+EVMU_EXPORT EVMU_RESULT EvmuLcd_exportRecording (GBL_CSELF, const char* pPath)     GBL_NOEXCEPT;
+//! @}
+
+/*! \name Animation Playback
+ *  \brief Methods for playing back .LCD animation files
+ *
+ *  An animation is decoded once into a single reference-counted buffer of raw
+ *  1bpp frames, which can be shared between any number of displays. Frames are
+ *  copied straight into XRAM as they are reached, using integer tick timing.
+ *  While an animation is playing, EvmuDevice drives the display directly rather
+ *  than running the CPU, which picks back up once playback is paused or completes.
+ *
+ *  \relatesalso EvmuLcd
+ *  @{
+ */
+//! Loads and decodes the .LCD animation file at \p pPath, replacing any previously loaded animation
+EVMU_EXPORT EVMU_RESULT EvmuLcd_loadAnimation   (GBL_SELF, const char* pPath)       GBL_NOEXCEPT;
+//! Shares the animation already loaded by \p pSource, without copying or decoding its frames again
+EVMU_EXPORT EVMU_RESULT EvmuLcd_shareAnimation  (GBL_SELF, const EvmuLcd* pSource)  GBL_NOEXCEPT;
+//! Releases the currently loaded animation, returning control of the display to the CPU
+EVMU_EXPORT void        EvmuLcd_unloadAnimation (GBL_SELF)                          GBL_NOEXCEPT;
+//! Starts or resumes playback, restarting from the first frame if the animation had completed
+EVMU_EXPORT EVMU_RESULT EvmuLcd_playAnimation   (GBL_SELF)                          GBL_NOEXCEPT;
+//! Pauses playback on the current frame
+EVMU_EXPORT void        EvmuLcd_pauseAnimation  (GBL_SELF)                          GBL_NOEXCEPT;
+//! Jumps to the given \p frame of the animation, displaying it immediately
+EVMU_EXPORT EVMU_RESULT EvmuLcd_seekAnimation   (GBL_SELF, size_t frame)            GBL_NOEXCEPT;
+//! Returns the current playback state of the animation
+EVMU_EXPORT EVMU_LCD_ANIMATION_STATE
+                        EvmuLcd_animationState  (GBL_CSELF)                         GBL_NOEXCEPT;
+//! Returns the total number of frames within the loaded animation, or 0 if there isn't one
+EVMU_EXPORT size_t      EvmuLcd_animationFrames (GBL_CSELF)                         GBL_NOEXCEPT;
+//! Returns the index of the animation frame currently being displayed
+EVMU_EXPORT size_t      EvmuLcd_animationFrame  (GBL_CSELF)                         GBL_NOEXCEPT;
 //! @}
 
 GBL_DECLS_END
@@ -40,6 +40,14 @@ typedef enum EVMU_PROGRAM_SRC {
     EVMU_PROGRAM_SRC_FLASH_BANK_1 = EVMU_SFR_EXT_FLASH_BANK_1   //!< Flash (Bank 1)
 } EVMU_PROGRAM_SRC;
 
+//! Contiguous block of internal memory, including banks not currently mapped into data memory
+typedef enum EVMU_RAM_REGION {
+    EVMU_RAM_REGION_RAM,    //!< Every general-purpose RAM bank, back-to-back
+    EVMU_RAM_REGION_SFR,    //!< Special function registers
+    EVMU_RAM_REGION_XRAM,   //!< Every XRAM bank, back-to-back
+    EVMU_RAM_REGION_COUNT   //!< Number of regions
+} EVMU_RAM_REGION;
+
 /*! \struct  EvmuRamClass
  *  \extends EvmuPeripheralclass
  *  \implements EvmuIMemoryClass
@@ -122,6 +130,48 @@ EVMU_EXPORT EVMU_RESULT EvmuRam_writeData      (GBL_SELF, EvmuAddress addr, Evmu
 EVMU_EXPORT EVMU_RESULT EvmuRam_writeDataLatch (GBL_SELF, EvmuAddress addr, EvmuWord val) GBL_NOEXCEPT;
 //! @}
 
+/*! \name Bulk Transfers
+ *  \brief Methods for copying whole regions of internal memory
+ *  \relatesalso EvmuRam
+ *
+ *  Rather than going through data memory a byte at a time, these
+ *  copy straight to and from the backing banks of a region. The
+ *  regular variants behave as the equivalent sequence of single
+ *  data accesses would, running each register's side-effects for
+ *  the SFR region and flagging LCD updates for XRAM. The raw
+ *  variants do nothing but copy, so writing SFRs raw won't remap
+ *  banks or reload timers, which makes them suited to tooling
+ *  and serialization rather than emulation.
+ *  @{
+ */
+//! Returns the size of the given region, in bytes
+EVMU_EXPORT size_t      EvmuRam_regionSize     (EVMU_RAM_REGION region)                   GBL_NOEXCEPT;
+//! Reads \p bytes from \p region starting at \p offset into \p pData, triggering read side-effects
+EVMU_EXPORT EVMU_RESULT EvmuRam_readRegion     (GBL_CSELF,
+                                                EVMU_RAM_REGION region,
+                                                size_t          offset,
+                                                void*           pData,
+                                                size_t          bytes)                    GBL_NOEXCEPT;
+//! Writes \p bytes from \p pData to \p region starting at \p offset, triggering write side-effects
+EVMU_EXPORT EVMU_RESULT EvmuRam_writeRegion    (GBL_SELF,
+                                                EVMU_RAM_REGION region,
+                                                size_t          offset,
+                                                const void*     pData,
+                                                size_t          bytes)                    GBL_NOEXCEPT;
+//! Copies \p bytes from \p region starting at \p offset into \p pData, with no side-effects
+EVMU_EXPORT EVMU_RESULT EvmuRam_readRegionRaw  (GBL_CSELF,
+                                                EVMU_RAM_REGION region,
+                                                size_t          offset,
+                                                void*           pData,
+                                                size_t          bytes)                    GBL_NOEXCEPT;
+//! Copies \p bytes from \p pData to \p region starting at \p offset, with no side-effects
+EVMU_EXPORT EVMU_RESULT EvmuRam_writeRegionRaw (GBL_SELF,
+                                                EVMU_RAM_REGION region,
+                                                size_t          offset,
+                                                const void*     pData,
+                                                size_t          bytes)                    GBL_NOEXCEPT;
+//! @}
+
 /*! \name Program Memory
  *  \brief Methods for managing the program address space
  *  \relatesalso EvmuRam
@@ -137,6 +137,8 @@ EVMU_EXPORT GblType EvmuRom_type (void) GBL_NOEXCEPT;
 EVMU_EXPORT GblBool        EvmuRom_biosActive (GBL_CSELF) GBL_NOEXCEPT;
 //! Returns the type of BIOS currently loaded into ROM
 EVMU_EXPORT EVMU_BIOS_TYPE EvmuRom_biosType   (GBL_CSELF) GBL_NOEXCEPT;
+//! Returns the CRC of the BIOS image currently loaded into ROM, or 0 if it's emulated
+EVMU_EXPORT GblHash        EvmuRom_biosCrc    (GBL_CSELF) GBL_NOEXCEPT;
 //! Returns the mode the BIOS is in (file manager, game, clock, etc)
 EVMU_EXPORT EVMU_BIOS_MODE EvmuRom_biosMode   (GBL_CSELF) GBL_NOEXCEPT;
 //! @}
@@ -0,0 +1,89 @@
+/*! \file
+ *  \brief EvmuSio: SIO0/SIO1 serial interface peripheral
+ *  \ingroup peripherals
+ *
+ *  This header provides an API and implementation for the
+ *  VMU's two synchronous serial ports, which are used to link
+ *  two units together through their external connectors:
+ *  * SIO0, which shifts SBUF0 out of the unit
+ *  * SIO1, which shifts a byte into SBUF1 from the other unit
+ *
+ *  Transfers are modelled a whole byte at a time: a byte sent
+ *  by one unit arrives in the other's SBUF1 once its transfer
+ *  time has elapsed, with no bit-level shifting in between.
+ *  Units always shift on their own internal clock, as the
+ *  external transfer clock and SO0 polarity control are not
+ *  emulated.
+ *
+ *  \author    2023 Falco Girgis
+ *  \copyright MIT License
+ */
+
+#ifndef EVMU_SIO_H
+#define EVMU_SIO_H
+
+#include "../types/evmu_peripheral.h"
+
+/*! \name Type System
+ *  \brief Type UUID and cast operators
+ *  @{
+ */
+#define EVMU_SIO_TYPE               (GBL_TYPEID(EvmuSio))            //!< Type UUID for EvmuSio
+#define EVMU_SIO(self)              (GBL_CAST(EvmuSio, self))        //!< Function-style cast for GblInstance
+#define EVMU_SIO_CLASS(klass)       (GBL_CLASS_CAST(EvmuSio, klass)) //!< Function-style cast for GblClass
+#define EVMU_SIO_GET_CLASS(self)    (GBL_CLASSOF(EvmuSio, self))     //!< Get EvmuSioClass from GblInstance
+//! @}
+
+#define EVMU_SIO_NAME               "sio"   //!< EvmuSio GblObject name
+#define EVMU_SIO_BITS               8       //!< Number of bits shifted per transfer
+
+#define GBL_SELF_TYPE EvmuSio
+
+GBL_DECLS_BEGIN
+
+/*! \struct  EvmuSioClass
+ *  \extends EvmuPeripheralClass
+ *  \brief   GblClass structure for EvmuSio
+ *
+ *  No public members.
+ *
+ *  \sa EvmuSio
+ */
+GBL_CLASS_DERIVE_EMPTY(EvmuSio, EvmuPeripheral)
+
+/*! \struct  EvmuSio
+ *  \extends EvmuPeripheral
+ *  \ingroup peripherals
+ *  \brief   GblInstance structure for EvmuSio
+ *
+ *  Setting the transfer control bit of SCON0 shifts SBUF0 out
+ *  over the number of cycles given by the SBR baud rate
+ *  register, after which the transfer end flag is set and the
+ *  SIO0 interrupt is raised. When linked to another device, the
+ *  byte is then received by the other device's SIO1, provided
+ *  its own transfer control bit is set, raising the SIO1
+ *  interrupt there.
+ *
+ *  Devices are linked with EvmuEmulator_linkDevices(). Unlinked
+ *  devices still time their transfers, but nothing is received.
+ *
+ *  \sa EvmuSioClass, EvmuEmulator_linkDevices()
+ */
+GBL_INSTANCE_DERIVE_EMPTY(EvmuSio, EvmuPeripheral)
+
+EVMU_EXPORT GblType    EvmuSio_type          (void)      GBL_NOEXCEPT;
+
+//! Returns the number of cycles taken to shift a byte at the current SBR baud rate
+EVMU_EXPORT EvmuCycles EvmuSio_transferCycles(GBL_CSELF) GBL_NOEXCEPT;
+//! Returns GBL_TRUE if SIO0 is currently shifting a byte out
+EVMU_EXPORT GblBool    EvmuSio_transmitting  (GBL_CSELF) GBL_NOEXCEPT;
+//! Returns GBL_TRUE if the device is linked to another through EvmuEmulator
+EVMU_EXPORT GblBool    EvmuSio_linked        (GBL_CSELF) GBL_NOEXCEPT;
+//! Advances transfers by the cycles of the last instruction, delivering any bytes which have arrived
+EVMU_EXPORT void       EvmuSio_update        (GBL_SELF)  GBL_NOEXCEPT;
+
+GBL_DECLS_END
+
+#undef GBL_SELF_TYPE
+
+#endif // EVMU_SIO_H
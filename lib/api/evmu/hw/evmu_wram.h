@@ -111,6 +111,16 @@ EVMU_EXPORT EVMU_RESULT EvmuWram_writeBytes (GBL_SELF,
                                              EvmuAddress address,
                                              const void* pData,
                                              size_t*     pSize)   GBL_NOEXCEPT;
+//! Copies exactly \p size bytes from WRAM into \p pData, starting at \p address, without notifying anyone of the access
+EVMU_EXPORT EVMU_RESULT EvmuWram_readRaw    (GBL_CSELF,
+                                             EvmuAddress address,
+                                             void*       pData,
+                                             size_t      size)    GBL_NOEXCEPT;
+//! Copies exactly \p size bytes from \p pData into WRAM, starting at \p address, without setting dataChanged or emitting dataChange
+EVMU_EXPORT EVMU_RESULT EvmuWram_writeRaw   (GBL_SELF,
+                                             EvmuAddress address,
+                                             const void* pData,
+                                             size_t      size)    GBL_NOEXCEPT;
 //! @}
 
 GBL_DECLS_END
@@ -33,6 +33,12 @@
 #define EVMU_EMULATOR_GET_CLASS(self)   (GBL_CLASSOF(EvmuEmulator, self))     //!< Get EvmuEmulatorClass from GblInstance
 //! @}
 
+#define EVMU_EMULATOR_WORKERS_MAX           256     //!< Maximum number of threads in the device scheduler's pool
+#define EVMU_EMULATOR_SLICE_INSTRUCTIONS    4096    //!< Target instructions per work-stealing time slice
+#define EVMU_EMULATOR_SLICE_MIN_TICKS       1000000 //!< Minimum work-stealing time slice (1ms emulated)
+#define EVMU_EMULATOR_LINK_QUANTUM          100000  //!< Default emulated time between linked devices synchronizing (100us)
+#define EVMU_EMULATOR_LOCKSTEP_SYNC         1024    //!< Default lockstep steps between comparisons of RAM, SFR, XRAM, and WRAM
+
 #define GBL_SELF_TYPE   EvmuEmulator
 
 GBL_DECLS_BEGIN
@@ -46,6 +52,51 @@ GBL_FORWARD_DECLARE_STRUCT(EvmuDevice);
  */
 typedef GblBool (*EvmuEmulatorIterFn)(GBL_CSELF, EvmuDevice* pDevice, void* pClosure);
 
+//! Policies used by the device scheduler to distribute devices across its workers
+GBL_DECLARE_ENUM(EVMU_EMULATOR_SCHEDULE) {
+    EVMU_EMULATOR_SCHEDULE_STATIC,          //!< Devices are evenly partitioned across workers for each frame
+    EVMU_EMULATOR_SCHEDULE_WORK_STEALING    //!< Devices run as adaptive time slices which idle workers steal
+};
+
+//! Per-worker counters accumulated by the device scheduler
+GBL_DECLARE_STRUCT(EvmuEmulatorWorkerStats) {
+    uint64_t busyNsecs;     //!< Host time spent running device updates
+    uint64_t totalNsecs;    //!< Host time spent in frames, including idling and barriers
+    uint64_t slices;        //!< Number of device updates (or time slices) run
+    uint64_t steals;        //!< Number of time slices stolen from other workers
+    uint64_t instructions;  //!< Number of instructions executed by the worker's devices
+};
+
+//! Regions of device state compared when running devices in lockstep
+GBL_DECLARE_ENUM(EVMU_EMULATOR_REGION) {
+    EVMU_EMULATOR_REGION_NONE,  //!< No region
+    EVMU_EMULATOR_REGION_CPU,   //!< Program counter and program memory selection
+    EVMU_EMULATOR_REGION_RAM,   //!< General-purpose RAM banks
+    EVMU_EMULATOR_REGION_SFR,   //!< Special function registers
+    EVMU_EMULATOR_REGION_XRAM,  //!< XRAM (LCD) banks
+    EVMU_EMULATOR_REGION_FLASH, //!< Flash banks
+    EVMU_EMULATOR_REGION_WRAM   //!< Work RAM banks
+};
+
+/*! Progress of devices running in lockstep, along with the first divergence between them
+ *
+ *  \note
+ *  For EVMU_EMULATOR_REGION_CPU, \p expected and \p actual hold the
+ *  program counters, with bit 16 set when executing from flash.
+ */
+GBL_DECLARE_STRUCT(EvmuEmulatorLockstep) {
+    uint64_t             steps;    //!< Steps run by every device, up to and including a divergence
+    EvmuTicks            ticks;    //!< Emulated time elapsed over those steps
+    uint64_t             hash;     //!< Rolling hash of the first device's state after every step, as far as it was compared
+    GblBool              diverged; //!< Whether a device's state no longer matches the first device's
+    size_t               device;   //!< Index of the first diverging device
+    EVMU_EMULATOR_REGION region;   //!< Region holding the first differing byte
+    size_t               bank;     //!< Bank within the region holding the first differing byte
+    EvmuAddress          address;  //!< Address of the first differing byte within its bank
+    uint32_t             expected; //!< Value on the first device
+    uint32_t             actual;   //!< Value on the diverging device
+};
+
 /*! \struct     EvmuEmulatorClass
  *  \extends    GblModuleClass
  *  \implements EvmuIBehaviorClass
@@ -65,6 +116,50 @@ GBL_CLASS_DERIVE_EMPTY(EvmuEmulator, GblModule, EvmuIBehavior)
  *  EvmuEmulator is a top-level module object for the
  *  emulation core.
  *
+ *  Updating an EvmuEmulator advances all of its devices through
+ *  its built-in scheduler, which partitions them across a pool of
+ *  worker threads and runs them in parallel, synchronizing only at
+ *  frame boundaries. Devices never share mutable state while
+ *  running, so they must not be touched by other threads until
+ *  EvmuEmulator_runDevices() returns.
+ *
+ *  With EVMU_EMULATOR_SCHEDULE_WORK_STEALING, each device's frame
+ *  is instead split into time slices sized from its measured
+ *  instruction rate, which are queued on per-worker Chase-Lev
+ *  deques so that idle workers can steal from busy ones.
+ *
+ *  EvmuEmulator_runLockstep() instead advances devices serially
+ *  in identical steps, one system cycle each by default, comparing
+ *  a hash of every device's state against the first device's. This
+ *  is meant to catch the first point at which builds or
+ *  configurations under test diverge from a reference. The program
+ *  counter and flash are compared after every step, with only the
+ *  flash blocks written since the previous step rehashed. RAM, SFR,
+ *  XRAM, and WRAM are only compared at sync points, every
+ *  EvmuEmulator_lockstepSync() steps and after the last step of
+ *  each run, so a divergence confined to them is reported at the
+ *  next sync point, though still at the first differing byte.
+ *
+ *  Devices connected with EvmuEmulator_linkDevices() exchange bytes
+ *  over their EvmuSio serial ports. Each linked pair is scheduled as
+ *  a single device, with the second device running on a thread of
+ *  its own. The two synchronize after every fixed quantum of
+ *  emulated time, and a byte sent during one quantum is received
+ *  exactly one quantum later. Linked devices always run at normal
+ *  speed, ignoring EvmuDevice speed and the gamepad's fast-forward
+ *  and slow-motion buttons, so link play is deterministic, and the
+ *  rest of the emulator keeps running in parallel.
+ *
+ *  EvmuEmulator_bootDevice() runs a device with a BIOS image loaded
+ *  until the BIOS idles in its main loop, then caches the resulting
+ *  state, minus ROM, flash, and WRAM contents, under the CRCs of the
+ *  image and of the card. Devices later booted with the same image
+ *  and an identical card load that state instead, with the clock set
+ *  to the current time, so that they start instantly rather than
+ *  after emulating the BIOS startup. Their own card is never
+ *  replaced, and boots during which the BIOS writes to the card
+ *  aren't cached at all.
+ *
  *  \sa EvmuEmulatorClass
  */
 GBL_INSTANCE_DERIVE_EMPTY(EvmuEmulator, GblModule)
@@ -87,6 +182,10 @@ EVMU_EXPORT GblRefCount   EvmuEmulator_unref  (GBL_SELF) GBL_NOEXCEPT;
 /*! \name Device Management
  *  \brief Methods for managing devices
  *  \relatesalso EvmuEmulator
+ *
+ *  Devices are the emulator's EvmuDevice children, whether
+ *  they were added with EvmuEmulator_addDevice() or parented
+ *  to it any other way, in the order they became children.
  *  @{
  */
 //! Adds the device given by \p pDevice to the top-level EvmuEmulator instance, taking ownership of it
@@ -95,7 +194,7 @@ EVMU_EXPORT EVMU_RESULT EvmuEmulator_addDevice     (GBL_SELF, EvmuDevice* pDevic
 EVMU_EXPORT EVMU_RESULT EvmuEmulator_removeDevice  (GBL_SELF, EvmuDevice* pDevice) GBL_NOEXCEPT;
 //! Returns the total number of devices owned and managed by the EvmuEmulator instance
 EVMU_EXPORT size_t      EvmuEmulator_deviceCount   (GBL_CSELF)                     GBL_NOEXCEPT;
-//! Returns the device managed by the given EvmuEmulator instance at the given \p index
+//! Returns the device managed by the given EvmuEmulator instance at the given \p index, in the order they became children
 EVMU_EXPORT EvmuDevice* EvmuEmulator_device        (GBL_CSELF, size_t index)       GBL_NOEXCEPT;
 //! Iterates over each managed EvmuDevice, passing it to \p pFnIt, along with \p pClosure
 EVMU_EXPORT GblBool     EvmuEmulator_foreachDevice (GBL_CSELF,
@@ -103,6 +202,85 @@ EVMU_EXPORT GblBool     EvmuEmulator_foreachDevice (GBL_CSELF,
                                                     void*              pClosure)   GBL_NOEXCEPT;
 //! @}
 
+/*! \name Scheduling
+ *  \brief Methods for running devices in parallel
+ *  \relatesalso EvmuEmulator
+ *  @{
+ */
+//! Resizes the worker pool to \p count threads, including the calling thread (1 runs serially, the only option without C11 threads)
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_setWorkerCount (GBL_SELF, size_t count)        GBL_NOEXCEPT;
+//! Returns the number of threads, including the calling thread, used to run devices
+EVMU_EXPORT size_t      EvmuEmulator_workerCount    (GBL_CSELF)                     GBL_NOEXCEPT;
+//! Selects the policy used to distribute devices across workers
+EVMU_EXPORT void        EvmuEmulator_setSchedule    (GBL_SELF,
+                                                     EVMU_EMULATOR_SCHEDULE schedule) GBL_NOEXCEPT;
+//! Returns the policy used to distribute devices across workers
+EVMU_EXPORT EVMU_EMULATOR_SCHEDULE
+                        EvmuEmulator_schedule       (GBL_CSELF)                     GBL_NOEXCEPT;
+//! Advances every device by \p frameTicks, \p frames times, with a barrier after each frame
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_runDevices     (GBL_SELF,
+                                                     EvmuTicks frameTicks,
+                                                     size_t    frames)              GBL_NOEXCEPT;
+//! Copies the counters for the worker at \p index into \p pStats
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_workerStats    (GBL_CSELF,
+                                                     size_t                   index,
+                                                     EvmuEmulatorWorkerStats* pStats) GBL_NOEXCEPT;
+//! Returns the fraction of frame time the worker at \p index spent running devices
+EVMU_EXPORT float       EvmuEmulator_workerUtilization
+                                                    (GBL_CSELF, size_t index)       GBL_NOEXCEPT;
+//! Clears the counters of every worker
+EVMU_EXPORT void        EvmuEmulator_resetWorkerStats
+                                                    (GBL_SELF)                      GBL_NOEXCEPT;
+//! @}
+
+/*! \name Lockstep
+ *  \brief Methods for comparing devices as they run
+ *  \relatesalso EvmuEmulator
+ *  @{
+ */
+//! Advances every device by \p stepTicks (one system cycle if 0), \p steps times, stopping at the first divergence
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_runLockstep    (GBL_SELF,
+                                                     EvmuTicks             stepTicks,
+                                                     size_t                steps,
+                                                     EvmuEmulatorLockstep* pLockstep) GBL_NOEXCEPT;
+//! Clears the step counter, rolling hash, and divergence, so that lockstep starts over from the current state
+EVMU_EXPORT void        EvmuEmulator_resetLockstep  (GBL_SELF)                      GBL_NOEXCEPT;
+//! Sets the number of steps between comparisons of RAM, SFR, XRAM, and WRAM (EVMU_EMULATOR_LOCKSTEP_SYNC if 0)
+EVMU_EXPORT void        EvmuEmulator_setLockstepSync(GBL_SELF, size_t steps)        GBL_NOEXCEPT;
+//! Returns the number of steps between comparisons of RAM, SFR, XRAM, and WRAM
+EVMU_EXPORT size_t      EvmuEmulator_lockstepSync   (GBL_CSELF)                     GBL_NOEXCEPT;
+//! @}
+
+/*! \name Serial Links
+ *  \brief Methods for connecting devices through their serial ports
+ *  \relatesalso EvmuEmulator
+ *  @{
+ */
+//! Links the serial ports of two managed devices, synchronizing them every \p quantum (EVMU_EMULATOR_LINK_QUANTUM if 0)
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_linkDevices    (GBL_SELF,
+                                                     EvmuDevice* pDevice1,
+                                                     EvmuDevice* pDevice2,
+                                                     EvmuTicks   quantum)          GBL_NOEXCEPT;
+//! Disconnects \p pDevice from the device it is linked to, discarding any bytes in flight
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_unlinkDevice   (GBL_SELF, EvmuDevice* pDevice) GBL_NOEXCEPT;
+//! Returns the device \p pDevice is linked to, or NULL if it isn't linked
+EVMU_EXPORT EvmuDevice* EvmuEmulator_linkedDevice   (GBL_CSELF,
+                                                     const EvmuDevice* pDevice)     GBL_NOEXCEPT;
+//! @}
+
+/*! \name Boot Cache
+ *  \brief Methods for starting devices from a cached BIOS boot
+ *  \relatesalso EvmuEmulator
+ *  @{
+ */
+//! Brings \p pDevice, which must have a BIOS loaded, into the BIOS main loop, booting and caching it if needed
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_bootDevice     (GBL_SELF, EvmuDevice* pDevice) GBL_NOEXCEPT;
+//! Returns the number of cached boot states, one for each pairing of BIOS image and card contents booted
+EVMU_EXPORT size_t      EvmuEmulator_bootCacheCount (GBL_CSELF)                     GBL_NOEXCEPT;
+//! Frees every cached boot state, so that the next device booted with each image runs through startup again
+EVMU_EXPORT void        EvmuEmulator_clearBootCache (GBL_SELF)                      GBL_NOEXCEPT;
+//! @}
+
 GBL_DECLS_END
 
 #undef GBL_SELF_TYPE
@@ -3,6 +3,7 @@
  *
  *  \todo
  *      - static typeinfo
+ *      - portable byte order for save states
  *
  *  \author     2023 Falco Girgis
  *  \copyright  MIT License
@@ -23,12 +24,34 @@
 #define EVMU_IBEHAVIOR_GET_CLASS(self)   (GBL_CLASSOF(EvmuIBehavior, self))     //!< Gets an EvmuIBehaviorClass from a GblInstance
 //! @}
 
+#define EVMU_IBEHAVIOR_STATE_VERSION     1  //!< Version of the binary save state format
+
 #define GBL_SELF_TYPE EvmuIBehavior
 
 GBL_DECLS_BEGIN
 
 GBL_FORWARD_DECLARE_STRUCT(EvmuEmulator);
 
+/*! \brief Cursor over a caller-provided save state buffer
+ *
+ *  Passed down through each entity while saving or loading a
+ *  state, with every entity transferring its fields at the
+ *  current offset. A buffer with no data only measures the
+ *  size a state would take.
+ *
+ *  \sa EvmuIBehavior_saveState(), EvmuIBehavior_loadState()
+ */
+typedef struct EvmuStateBuffer {
+    uint8_t*    pData;      //!< Caller-provided memory, or NULL when measuring
+    size_t      capacity;   //!< Size of pData in bytes
+    size_t      offset;     //!< Bytes transferred so far
+    GblBool     loading;    //!< Fields are copied out of pData rather than into it
+    GblBool     delta;      //!< Content unmodified since the last snapshot is left out when saving
+    GblBool     external;   //!< ROM, flash, and WRAM contents are left out, to be transferred separately
+    GblBool     restoring;  //!< Rolling back a rejected load, so the loaded state doesn't become a new snapshot
+    EVMU_RESULT result;     //!< First error encountered, after which nothing more is transferred
+} EvmuStateBuffer;
+
 /*! \struct  EvmuIBehaviorClass
  *  \extends GblInterface
  *  \brief   GblInterface/VTable for all EvmuBehaviors
@@ -44,9 +67,9 @@ GBL_INTERFACE_DERIVE(EvmuIBehavior)
     //! Called when the update event is fired
     EVMU_RESULT (*pFnUpdate)    (GBL_SELF, EvmuTicks ticks);
     //! Called to save the state of the associated entity
-    EVMU_RESULT (*pFnSaveState) (GBL_CSELF, FILE* pFile);
+    EVMU_RESULT (*pFnSaveState) (GBL_CSELF, EvmuStateBuffer* pBuffer);
     //! Called to load the state of the associated entity
-    EVMU_RESULT (*pFnLoadState) (GBL_SELF, FILE* pFile);
+    EVMU_RESULT (*pFnLoadState) (GBL_SELF, EvmuStateBuffer* pBuffer);
 GBL_INTERFACE_END
 
 /*! \struct EvmuIBehavior
@@ -57,6 +80,20 @@ GBL_INTERFACE_END
  *  emulated Entities within ElysianVMU, providing basic event-driven
  *  logic for each hardware block.
  *
+ *  Save states are a compact binary snapshot written straight
+ *  into a caller-provided buffer, without allocating. Each
+ *  entity contributes a tagged and versioned section of its own,
+ *  followed by those of its children. States use the byte order
+ *  of the host which saved them.
+ *
+ *  Delta states leave out flash blocks which haven't changed
+ *  since EvmuFlash_markClean() was last called, or since a
+ *  state was last loaded, and can only be loaded on top of
+ *  the flash contents they were saved against.
+ *
+ *  A state rejected partway through loading is rolled back,
+ *  leaving the entity as it was beforehand.
+ *
  *  \sa EvmuIBehaviorClass
  */
 
@@ -67,8 +104,22 @@ EVMU_EXPORT EvmuEmulator* EvmuIBehavior_emulator   (GBL_CSELF)
 
 EVMU_EXPORT EVMU_RESULT   EvmuIBehavior_reset      (GBL_SELF)                                 GBL_NOEXCEPT;
 EVMU_EXPORT EVMU_RESULT   EvmuIBehavior_update     (GBL_SELF, EvmuTicks ticks)                GBL_NOEXCEPT;
-EVMU_EXPORT EVMU_RESULT   EvmuIBehavior_saveState  (GBL_SELF, GblStringBuffer* pString)       GBL_NOEXCEPT;
-EVMU_EXPORT EVMU_RESULT   EvmuIBehavior_loadState  (GBL_SELF, const GblStringBuffer* pString) GBL_NOEXCEPT;
+//! Returns the number of bytes needed to save the state of the given entity
+EVMU_EXPORT size_t        EvmuIBehavior_stateSize  (GBL_CSELF)                                GBL_NOEXCEPT;
+//! Saves the state of the given entity into \p pData, writing the number of bytes used to \p pSize
+EVMU_EXPORT EVMU_RESULT   EvmuIBehavior_saveState  (GBL_CSELF,
+                                                    void*   pData,
+                                                    size_t  capacity,
+                                                    size_t* pSize)                            GBL_NOEXCEPT;
+//! Returns the number of bytes needed to save a delta state of the given entity
+EVMU_EXPORT size_t        EvmuIBehavior_deltaSize  (GBL_CSELF)                                GBL_NOEXCEPT;
+//! Saves a state of the given entity holding only the flash blocks modified since the last snapshot
+EVMU_EXPORT EVMU_RESULT   EvmuIBehavior_saveDelta  (GBL_CSELF,
+                                                    void*   pData,
+                                                    size_t  capacity,
+                                                    size_t* pSize)                            GBL_NOEXCEPT;
+//! Restores the state of the given entity from a buffer previously filled by EvmuIBehavior_saveState() or EvmuIBehavior_saveDelta()
+EVMU_EXPORT EVMU_RESULT   EvmuIBehavior_loadState  (GBL_SELF, const void* pData, size_t size) GBL_NOEXCEPT;
 
 GBL_DECLS_END
 
@@ -57,6 +57,8 @@ EVMU_EXPORT EVMU_RESULT EvmuFat_format(const EvmuFat* pSelf, const EvmuRootBlock
 
     if(!pRoot) pRoot = &defaultRoot;
 
+    GBL_CTX_VERIFY_CALL(EvmuFlash__detach_(pRam_->pFlash, 0, EVMU_FLASH_SIZE));
+
     EVMU_LOG_DEBUG("Zeroing flash");
     memset(pRam_->pFlash->pStorage->pData, 0, pRoot->totalSize * EvmuFat_blockSize(pSelf));
 
@@ -359,7 +361,12 @@ EVMU_EXPORT EVMU_RESULT EvmuFat_blockLink(const EvmuFat* pSelf, EvmuBlock block,
                    block, next);
 
     const EvmuBlock tableBlock = EvmuFat_blockTable(pSelf);
-    EvmuBlock*      pFatTable  = EvmuFat_blockData(pSelf, tableBlock);
+
+    GBL_CTX_VERIFY_CALL(EvmuFlash__detach_(EVMU_FLASH_(pSelf),
+                                           tableBlock * EvmuFat_blockSize(pSelf) + block * sizeof(EvmuBlock),
+                                           sizeof(EvmuBlock)));
+
+    EvmuBlock* pFatTable = EvmuFat_blockData(pSelf, tableBlock);
 
     GBL_CTX_VERIFY(pFatTable,
                    EVMU_RESULT_ERROR_INVALID_BLOCK,
@@ -381,6 +388,10 @@ EVMU_EXPORT EvmuBlock EvmuFat_blockAlloc(const EvmuFat* pSelf, EvmuBlock prev, E
     EvmuBlock block = EVMU_FAT_BLOCK_FAT_UNALLOCATED;
     GBL_CTX_BEGIN(NULL);
 
+    GBL_CTX_VERIFY_CALL(EvmuFlash__detach_(EVMU_FLASH_(pSelf),
+                                           EvmuFat_blockTable(pSelf) * EvmuFat_blockSize(pSelf),
+                                           EvmuFat_root(pSelf)->fatSize * EvmuFat_blockSize(pSelf)));
+
     EvmuBlock* pFatTable = (EvmuBlock*)EvmuFat_blockData(pSelf, EvmuFat_blockTable(pSelf));
 
     int firstBlock;
@@ -412,6 +423,7 @@ EVMU_EXPORT EvmuBlock EvmuFat_blockAlloc(const EvmuFat* pSelf, EvmuBlock prev, E
              */
             pFatTable[i] = EVMU_FAT_BLOCK_FAT_LAST_IN_FILE;
             //Zero out contents of block
+            EvmuFlash__touch_(EVMU_FLASH_(pSelf), block * EvmuFat_blockSize(pSelf), EvmuFat_blockSize(pSelf));
             memset((void*)EvmuFat_blockData(pSelf, block), 0, EvmuFat_blockSize(pSelf));
             //Update fat entry if not first block in series
             if(prev != EVMU_FAT_BLOCK_FAT_UNALLOCATED &&
@@ -441,10 +453,17 @@ EVMU_EXPORT EvmuDirEntry* EvmuFat_dirEntry(const EvmuFat* pSelf, size_t index) {
 }
 
 EVMU_EXPORT EvmuDirEntry* EvmuFat_dirEntryAlloc(const EvmuFat* pSelf, EVMU_FILE_TYPE fileType) {
+    EvmuFlash_* pFlash_ = EVMU_FLASH_(pSelf);
+
+    if(!GBL_RESULT_SUCCESS(EvmuFlash__detach_(pFlash_, 0, 0)))
+        return NULL;
+
     for(int e = EvmuFat_dirEntryCount(pSelf) - 1; e >= 0; --e) {
         EvmuDirEntry* pEntry = EvmuFat_dirEntry(pSelf, e);
 
         if(pEntry && pEntry->fileType == EVMU_FILE_TYPE_NONE) {
+            // The caller goes on to fill in the rest of the entry
+            EvmuFlash__touch_(pFlash_, (uint8_t*)pEntry - pFlash_->pStorage->pData, sizeof(EvmuDirEntry));
             memset(pEntry, 0, sizeof(EvmuDirEntry));
             pEntry->fileType = fileType;
             return pEntry;
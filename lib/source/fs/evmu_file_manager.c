@@ -8,6 +8,7 @@
 #include "gyro_vmu_vms.h"
 #include "evmu_fat_.h"
 #include "../hw/evmu_flash_.h"
+#include "../hw/evmu_device_.h"
 #include "gyro_vmu_flash.h"
 
 static EVMU_RESULT EvmuFileManager_loadFlash_(EvmuFileManager* pSelf, const char* pPath);
@@ -63,6 +64,16 @@ EVMU_EXPORT size_t EvmuFileManager_free(EvmuFileManager* pSelf, EvmuDirEntry* pE
     EVMU_LOG_PUSH();
     GBL_CTX_BEGIN(NULL);
 
+    {   // Stop sharing storage with clones, then follow pEntry into our own copy
+        EvmuFlash_*    pFlash_ = EVMU_FLASH_(pSelf);
+        const uint8_t* pPrev   = pFlash_->pStorage->pData;
+
+        GBL_CTX_VERIFY_CALL(EvmuFlash__detach_(pFlash_,
+                                               (const uint8_t*)pEntry - pPrev,
+                                               sizeof(EvmuDirEntry)));
+        pEntry = (EvmuDirEntry*)(pFlash_->pStorage->pData + ((const uint8_t*)pEntry - pPrev));
+    }
+
     EvmuBlock    block      = pEntry->firstBlock;
     const size_t blockCount = pEntry->fileSize;
     EvmuFat*     pFat       = EVMU_FAT(pSelf);
@@ -232,6 +243,8 @@ EVMU_EXPORT EVMU_RESULT EvmuFileManager_defrag(EvmuFileManager* pSelf) {
     GBL_CTX_VERIFY(EvmuFat_isFormatted(EVMU_FAT(pSelf)),
                    EVMU_RESULT_ERROR_UNFORMATTED,
                    "Cannot defrag and unformatted card!");
+
+    GBL_CTX_VERIFY_CALL(EvmuFlash__detach_(EVMU_FLASH_(pSelf), 0, EVMU_FLASH_SIZE));
     {
         EvmuFat*       pFat         = EVMU_FAT(pSelf);
         EvmuFat_*      pFat_        = EVMU_FAT_(pFat);
@@ -245,12 +258,13 @@ EVMU_EXPORT EVMU_RESULT EvmuFileManager_defrag(EvmuFileManager* pSelf) {
         if(fileCount) {
             // Create temporary device
             pTempDevice = GBL_NEW(EvmuDevice,
-                                  "name", "tempDefragDevice");
+                                  "name",      "tempDefragDevice",
+                                  "initFlags", EVMU_DEVICE_INIT_LIGHTWEIGHT);
 
             pTempFlash  = EVMU_FLASH_(pTempDevice->pFlash);
 
             // Create temporary back-up of flash to restore at any point if we fail
-            GblByteArray_copy(pTempFlash->pStorage, pFlash_->pStorage);
+            EvmuStorage__copy_(pTempFlash->pStorage, pFlash_->pStorage);
 
             EVMU_LOG_VERBOSE("Uninstalling all files.");
             EVMU_LOG_PUSH();
@@ -433,6 +447,12 @@ EVMU_EXPORT EvmuDirEntry* EvmuFileManager_alloc(EvmuFileManager* pSelf,
     GblStringBuffer_construct(&str.buff, "", 0, sizeof(str));
     memset(blocks, -1, sizeof(int) * EvmuFat_userBlocks(pFat));
 
+    // A lightweight device formats its flash on first allocation
+    GBL_CTX_VERIFY_CALL(EvmuDevice__finishInit_(EVMU_DEVICE_(EvmuPeripheral_device(EVMU_PERIPHERAL(pSelf))),
+                                                EVMU_DEVICE_INIT_DEFER_FORMAT));
+    // Each step below flags the blocks it modifies
+    GBL_CTX_VERIFY_CALL(EvmuFlash__detach_(EVMU_FLASH_(pSelf), 0, 0));
+
     EVMU_LOG_VERBOSE("VMU Flash - Creating file [%s].", EvmuNewFileInfo_name(pInfo, &str.buff));
     EVMU_LOG_PUSH();
 
@@ -661,6 +681,9 @@ EVMU_EXPORT EVMU_RESULT EvmuFileManager_load(EvmuFileManager* pSelf, const char*
 
     GblStringBuffer_construct(&str.buff, "", 0, sizeof(str));
 
+    // Legacy loaders write straight into flash wherever they please
+    GBL_CTX_VERIFY_CALL(EvmuFlash__detach_(EVMU_FLASH_(pSelf), 0, EVMU_FLASH_SIZE));
+
     pStrList = GblStringList_createSplit(pPath, "/\\");
 
     if(!gblStrCaseCmp(GblStringList_back(pStrList),
@@ -0,0 +1,952 @@
+#include <evmu/hw/evmu_batch.h>
+#include <evmu/hw/evmu_device.h>
+#include <evmu/hw/evmu_sfr.h>
+#include <evmu/hw/evmu_rom.h>
+#include "evmu_device_.h"
+#include "evmu_cpu_.h"
+#include "evmu_ram_.h"
+#include "../types/evmu_alloc_.h"
+#include <gimbal/algorithms/gimbal_numeric.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EVMU_BATCH_ALIGNMENT_   64  // cache line, wide enough for any SIMD register
+
+struct EvmuBatch {
+    EvmuDevice**     ppDevices;
+    size_t           laneCount;
+    // Mirrored CPU state, each stored contiguously across lanes
+    EvmuPc*          pPc;
+    EvmuWord*        pAcc;
+    EvmuWord*        pPsw;
+    EvmuWord*        pB;
+    EvmuWord*        pC;
+    EvmuWord*        pSp;
+    EvmuWord*        pRam;          // [bank][address][lane]
+    const EvmuWord** ppExt;         // program memory, lanes only group when it's shared
+    uint64_t*        pInstructions; // batched instructions not yet credited to the device's EvmuCpu
+    // Per-lane status
+    uint8_t*         pHalted;
+    uint8_t*         pBios;
+    uint8_t*         pDirty;        // mirror is newer than the device
+    uint8_t*         pActive;       // member of the group being executed
+    uint8_t*         pStepped;      // already executed during the current step
+    EvmuWord*        pOperand;      // per-lane source operand of the group's instruction
+    uint8_t*         pBlock;
+    GblBool          validating;
+    EvmuBatchStats   stats;
+};
+
+// Where an ALU instruction's source operand comes from
+typedef enum EVMU_BATCH_SRC_ {
+    EVMU_BATCH_SRC_IMMEDIATE_,
+    EVMU_BATCH_SRC_DIRECT_,
+    EVMU_BATCH_SRC_INDIRECT_
+} EVMU_BATCH_SRC_;
+
+// Accumulator-only operations which never touch flags other than parity
+typedef enum EVMU_BATCH_LOGIC_ {
+    EVMU_BATCH_LOGIC_LOAD_,
+    EVMU_BATCH_LOGIC_AND_,
+    EVMU_BATCH_LOGIC_OR_,
+    EVMU_BATCH_LOGIC_XOR_
+} EVMU_BATCH_LOGIC_;
+
+GBL_INLINE size_t EvmuBatch_align_(size_t size) {
+    return (size + EVMU_BATCH_ALIGNMENT_ - 1) & ~(size_t)(EVMU_BATCH_ALIGNMENT_ - 1);
+}
+
+// Assigns every array from pBlock (when given), returning the size of the block
+static size_t EvmuBatch_layout_(EvmuBatch* pSelf, uint8_t* pBlock, size_t count) {
+    size_t offset = 0;
+
+#define EVMU_BATCH_CARVE_(field, size)                          \
+    GBL_STMT_START {                                            \
+        if(pBlock) pSelf->field = (void*)(pBlock + offset);     \
+        offset += EvmuBatch_align_(size);                       \
+    } GBL_STMT_END
+
+    EVMU_BATCH_CARVE_(ppDevices,     sizeof(EvmuDevice*)     * count);
+    EVMU_BATCH_CARVE_(pPc,           sizeof(EvmuPc)          * count);
+    EVMU_BATCH_CARVE_(pAcc,          sizeof(EvmuWord)        * count);
+    EVMU_BATCH_CARVE_(pPsw,          sizeof(EvmuWord)        * count);
+    EVMU_BATCH_CARVE_(pB,            sizeof(EvmuWord)        * count);
+    EVMU_BATCH_CARVE_(pC,            sizeof(EvmuWord)        * count);
+    EVMU_BATCH_CARVE_(pSp,           sizeof(EvmuWord)        * count);
+    EVMU_BATCH_CARVE_(pRam,          sizeof(EvmuWord)        * count *
+                                     EVMU_ADDRESS_SEGMENT_RAM_BANKS *
+                                     EVMU_ADDRESS_SEGMENT_RAM_SIZE);
+    EVMU_BATCH_CARVE_(ppExt,         sizeof(const EvmuWord*) * count);
+    EVMU_BATCH_CARVE_(pInstructions, sizeof(uint64_t)        * count);
+    EVMU_BATCH_CARVE_(pHalted,       sizeof(uint8_t)         * count);
+    EVMU_BATCH_CARVE_(pBios,         sizeof(uint8_t)         * count);
+    EVMU_BATCH_CARVE_(pDirty,        sizeof(uint8_t)         * count);
+    EVMU_BATCH_CARVE_(pActive,       sizeof(uint8_t)         * count);
+    EVMU_BATCH_CARVE_(pStepped,      sizeof(uint8_t)         * count);
+    EVMU_BATCH_CARVE_(pOperand,      sizeof(EvmuWord)        * count);
+
+#undef EVMU_BATCH_CARVE_
+
+    return offset;
+}
+
+// Row of a general-purpose RAM byte across lanes
+GBL_INLINE EvmuWord* EvmuBatch_ram_(const EvmuBatch* pSelf, size_t bank, EvmuAddress address) {
+    return &pSelf->pRam[(bank * EVMU_ADDRESS_SEGMENT_RAM_SIZE + address) * pSelf->laneCount];
+}
+
+// Row of a mirrored SFR across lanes, or NULL if it isn't mirrored
+GBL_INLINE EvmuWord* EvmuBatch_row_(const EvmuBatch* pSelf, EvmuAddress address) {
+    switch(address) {
+    case EVMU_ADDRESS_SFR_ACC: return pSelf->pAcc;
+    case EVMU_ADDRESS_SFR_PSW: return pSelf->pPsw;
+    case EVMU_ADDRESS_SFR_B:   return pSelf->pB;
+    case EVMU_ADDRESS_SFR_C:   return pSelf->pC;
+    case EVMU_ADDRESS_SFR_SP:  return pSelf->pSp;
+    default:                   return NULL;
+    }
+}
+
+// Whether an address is mirrored by the batch and free of side-effects
+GBL_INLINE GblBool EvmuBatch_mirrored_(const EvmuBatch* pSelf, EvmuAddress address) {
+    return address < EVMU_ADDRESS_SEGMENT_RAM_SIZE || EvmuBatch_row_(pSelf, address);
+}
+
+GBL_INLINE size_t EvmuBatch_bank_(const EvmuBatch* pSelf, size_t lane) {
+    return (pSelf->pPsw[lane] & EVMU_SFR_PSW_RAMBK0_MASK) >> EVMU_SFR_PSW_RAMBK0_POS;
+}
+
+// Lane's copy of a mirrored address, resolving general-purpose RAM to the lane's current bank
+GBL_INLINE EvmuWord* EvmuBatch_reg_(const EvmuBatch* pSelf, size_t lane, EvmuAddress address) {
+    if(address < EVMU_ADDRESS_SEGMENT_RAM_SIZE)
+        return &EvmuBatch_ram_(pSelf, EvmuBatch_bank_(pSelf, lane), address)[lane];
+    else
+        return &EvmuBatch_row_(pSelf, address)[lane];
+}
+
+// Mirrors EvmuRam_writeData(), whose only side-effect on mirrored addresses is ACC parity
+GBL_INLINE void EvmuBatch_write_(EvmuBatch* pSelf, size_t lane, EvmuAddress address, EvmuWord value) {
+    if(address == EVMU_ADDRESS_SFR_ACC && pSelf->pAcc[lane] != value)
+        pSelf->pPsw[lane] = (pSelf->pPsw[lane] & 0xfe) | gblParity(value);
+
+    *EvmuBatch_reg_(pSelf, lane, address) = value;
+}
+
+// Mirrors EvmuRam_indirectAddress(), only valid for modes 0 and 1 which address general-purpose RAM
+GBL_INLINE EvmuAddress EvmuBatch_indirect_(const EvmuBatch* pSelf, size_t lane, size_t mode) {
+    return *EvmuBatch_reg_(pSelf, lane,
+                           mode | ((pSelf->pPsw[lane] &
+                                   (EVMU_SFR_PSW_IRBK0_MASK|EVMU_SFR_PSW_IRBK1_MASK)) >> 0x1u))
+           | (mode&0x2)<<0x7u;
+}
+
+GBL_INLINE void EvmuBatch_push_(EvmuBatch* pSelf, size_t lane, EvmuWord value) {
+    EvmuBatch_ram_(pSelf, 0, ++pSelf->pSp[lane])[lane] = value;
+}
+
+GBL_INLINE EvmuWord EvmuBatch_pop_(EvmuBatch* pSelf, size_t lane) {
+    return EvmuBatch_ram_(pSelf, 0, pSelf->pSp[lane]--)[lane];
+}
+
+// Whether popping at the given SP passes EvmuRam_popStack()'s underflow check
+GBL_INLINE GblBool EvmuBatch_popSafe_(EvmuWord sp) {
+    return (EvmuWord)(sp - 1) + 1 >= EVMU_ADDRESS_SYSTEM_STACK_BASE;
+}
+
+// Copies a lane's mirrored state back to its device, if the device is stale
+static void EvmuBatch_scatter_(EvmuBatch* pSelf, size_t lane) {
+    if(!pSelf->pDirty[lane]) return;
+
+    EvmuDevice_* pDevice_ = EVMU_DEVICE_(pSelf->ppDevices[lane]);
+    EvmuCpu_*    pCpu_    = pDevice_->pCpu;
+    EvmuRam_*    pRam_    = pDevice_->pRam;
+
+    pCpu_->pc                  = pSelf->pPc[lane];
+    pCpu_->instructions       += pSelf->pInstructions[lane];
+    pSelf->pInstructions[lane] = 0;
+
+    pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_ACC)] = pSelf->pAcc[lane];
+    pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_PSW)] = pSelf->pPsw[lane];
+    pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_B)]   = pSelf->pB[lane];
+    pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_C)]   = pSelf->pC[lane];
+    pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_SP)]  = pSelf->pSp[lane];
+
+    for(size_t b = 0; b < EVMU_ADDRESS_SEGMENT_RAM_BANKS; ++b)
+        for(size_t a = 0; a < EVMU_ADDRESS_SEGMENT_RAM_SIZE; ++a)
+            pRam_->ram[b][a] = EvmuBatch_ram_(pSelf, b, a)[lane];
+
+    // PSW may have switched banks while batched
+    const size_t bank = EvmuBatch_bank_(pSelf, lane);
+    pRam_->pIntMap[EVMU_RAM__INT_SEGMENT_GP1_] = pRam_->ram[bank];
+    pRam_->pIntMap[EVMU_RAM__INT_SEGMENT_GP2_] = &pRam_->ram[bank][EVMU_RAM__INT_SEGMENT_SIZE_];
+
+    pSelf->pDirty[lane] = 0;
+}
+
+// Reloads a lane's mirrored state from its device
+static void EvmuBatch_gather_(EvmuBatch* pSelf, size_t lane) {
+    EvmuDevice*  pDevice  = pSelf->ppDevices[lane];
+    EvmuDevice_* pDevice_ = EVMU_DEVICE_(pDevice);
+    EvmuRam_*    pRam_    = pDevice_->pRam;
+
+    pSelf->pPc[lane]  = pDevice_->pCpu->pc;
+    pSelf->pAcc[lane] = pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_ACC)];
+    pSelf->pPsw[lane] = pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_PSW)];
+    pSelf->pB[lane]   = pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_B)];
+    pSelf->pC[lane]   = pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_C)];
+    pSelf->pSp[lane]  = pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_SP)];
+
+    for(size_t b = 0; b < EVMU_ADDRESS_SEGMENT_RAM_BANKS; ++b)
+        for(size_t a = 0; a < EVMU_ADDRESS_SEGMENT_RAM_SIZE; ++a)
+            EvmuBatch_ram_(pSelf, b, a)[lane] = pRam_->ram[b][a];
+
+    pSelf->ppExt[lane]   = pRam_->pExt;
+    pSelf->pHalted[lane] = !!(pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_PCON)] & EVMU_SFR_PCON_HALT_MASK);
+    pSelf->pBios[lane]   = EvmuRom_biosActive(pDevice->pRom);
+    pSelf->pDirty[lane]  = 0;
+}
+
+// Whether a lane's mirrored state matches that of its device
+static GblBool EvmuBatch_matches_(const EvmuBatch* pSelf, size_t lane) {
+    EvmuDevice_* pDevice_ = EVMU_DEVICE_(pSelf->ppDevices[lane]);
+    EvmuRam_*    pRam_    = pDevice_->pRam;
+
+    if(pSelf->pPc[lane]  != pDevice_->pCpu->pc                              ||
+       pSelf->pAcc[lane] != pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_ACC)] ||
+       pSelf->pPsw[lane] != pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_PSW)] ||
+       pSelf->pB[lane]   != pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_B)]   ||
+       pSelf->pC[lane]   != pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_C)]   ||
+       pSelf->pSp[lane]  != pRam_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_SP)])
+        return GBL_FALSE;
+
+    for(size_t b = 0; b < EVMU_ADDRESS_SEGMENT_RAM_BANKS; ++b)
+        for(size_t a = 0; a < EVMU_ADDRESS_SEGMENT_RAM_SIZE; ++a)
+            if(EvmuBatch_ram_(pSelf, b, a)[lane] != pRam_->ram[b][a])
+                return GBL_FALSE;
+
+    return GBL_TRUE;
+}
+
+// Runs a lane's next instruction through its device's EvmuCpu
+static void EvmuBatch_runScalar_(EvmuBatch* pSelf, size_t lane) {
+    EvmuBatch_scatter_(pSelf, lane);
+    // Errors are logged but don't stop the CPU, same as EvmuCpu's update
+    EvmuCpu_runNext(pSelf->ppDevices[lane]->pCpu);
+    EvmuBatch_gather_(pSelf, lane);
+    ++pSelf->stats.scalarLanes;
+}
+
+// Whether every lane of the group can execute the instruction without leaving the mirrored state
+static GblBool EvmuBatch_vectorizable_(const EvmuBatch* pSelf, const EvmuDecodedInstruction* pInstr) {
+    const EvmuOperands* pOperands = &pInstr->operands;
+
+    switch(pInstr->opcode) {
+    case EVMU_OPCODE_NOP:
+    case EVMU_OPCODE_BR:
+    case EVMU_OPCODE_BRF:
+    case EVMU_OPCODE_JMP:
+    case EVMU_OPCODE_JMPF:
+    case EVMU_OPCODE_CALL:
+    case EVMU_OPCODE_CALLF:
+    case EVMU_OPCODE_CALLR:
+    case EVMU_OPCODE_MUL:
+    case EVMU_OPCODE_DIV:
+    case EVMU_OPCODE_BEI:
+    case EVMU_OPCODE_BNEI:
+    case EVMU_OPCODE_BZ:
+    case EVMU_OPCODE_BNZ:
+    case EVMU_OPCODE_ADDI:
+    case EVMU_OPCODE_ADDCI:
+    case EVMU_OPCODE_SUBI:
+    case EVMU_OPCODE_SUBCI:
+    case EVMU_OPCODE_ANDI:
+    case EVMU_OPCODE_ORI:
+    case EVMU_OPCODE_XORI:
+    case EVMU_OPCODE_ROR:
+    case EVMU_OPCODE_RORC:
+    case EVMU_OPCODE_ROL:
+    case EVMU_OPCODE_ROLC:
+        return GBL_TRUE;
+    case EVMU_OPCODE_LD:
+    case EVMU_OPCODE_ST:
+    case EVMU_OPCODE_MOV:
+    case EVMU_OPCODE_BE:
+    case EVMU_OPCODE_BNE:
+    case EVMU_OPCODE_BPC:
+    case EVMU_OPCODE_DBNZ:
+    case EVMU_OPCODE_PUSH:
+    case EVMU_OPCODE_INC:
+    case EVMU_OPCODE_DEC:
+    case EVMU_OPCODE_BP:
+    case EVMU_OPCODE_BN:
+    case EVMU_OPCODE_ADD:
+    case EVMU_OPCODE_ADDC:
+    case EVMU_OPCODE_SUB:
+    case EVMU_OPCODE_SUBC:
+    case EVMU_OPCODE_NOT1:
+    case EVMU_OPCODE_CLR1:
+    case EVMU_OPCODE_SET1:
+    case EVMU_OPCODE_XCH:
+    case EVMU_OPCODE_OR:
+    case EVMU_OPCODE_AND:
+    case EVMU_OPCODE_XOR:
+        return EvmuBatch_mirrored_(pSelf, pOperands->direct);
+    case EVMU_OPCODE_LD_IND:
+    case EVMU_OPCODE_ST_IND:
+    case EVMU_OPCODE_MOV_IND:
+    case EVMU_OPCODE_BE_IND:
+    case EVMU_OPCODE_BNE_IND:
+    case EVMU_OPCODE_DBNZ_IND:
+    case EVMU_OPCODE_INC_IND:
+    case EVMU_OPCODE_DEC_IND:
+    case EVMU_OPCODE_ADD_IND:
+    case EVMU_OPCODE_ADDC_IND:
+    case EVMU_OPCODE_SUB_IND:
+    case EVMU_OPCODE_SUBC_IND:
+    case EVMU_OPCODE_XCH_IND:
+    case EVMU_OPCODE_OR_IND:
+    case EVMU_OPCODE_AND_IND:
+    case EVMU_OPCODE_XOR_IND:
+        // Modes 2 and 3 point into SFRs
+        return !(pOperands->indirect & 0x2);
+    case EVMU_OPCODE_POP:
+        if(!EvmuBatch_mirrored_(pSelf, pOperands->direct))
+            return GBL_FALSE;
+        for(size_t l = 0; l < pSelf->laneCount; ++l)
+            if(pSelf->pActive[l] && !EvmuBatch_popSafe_(pSelf->pSp[l]))
+                return GBL_FALSE;
+        return GBL_TRUE;
+    case EVMU_OPCODE_RET:
+        for(size_t l = 0; l < pSelf->laneCount; ++l)
+            if(pSelf->pActive[l] && (!EvmuBatch_popSafe_(pSelf->pSp[l]) ||
+                                     !EvmuBatch_popSafe_(pSelf->pSp[l] - 1)))
+                return GBL_FALSE;
+        return GBL_TRUE;
+    // Flash, ROM, and interrupt controller access
+    default:
+        return GBL_FALSE;
+    }
+}
+
+// Fills the per-lane operand row with an instruction's source value
+static void EvmuBatch_loadOperand_(EvmuBatch* pSelf, EVMU_BATCH_SRC_ src, const EvmuOperands* pOperands) {
+    EvmuWord* pOperand = pSelf->pOperand;
+
+    switch(src) {
+    case EVMU_BATCH_SRC_IMMEDIATE_:
+        memset(pOperand, pOperands->immediate, pSelf->laneCount);
+        break;
+    case EVMU_BATCH_SRC_DIRECT_:
+        if(pOperands->direct < EVMU_ADDRESS_SEGMENT_RAM_SIZE) {
+            const EvmuWord* pBank0 = EvmuBatch_ram_(pSelf, 0, pOperands->direct);
+            const EvmuWord* pBank1 = EvmuBatch_ram_(pSelf, 1, pOperands->direct);
+            const EvmuWord* pPsw   = pSelf->pPsw;
+
+            for(size_t l = 0; l < pSelf->laneCount; ++l)
+                pOperand[l] = (pPsw[l] & EVMU_SFR_PSW_RAMBK0_MASK)? pBank1[l] : pBank0[l];
+        } else
+            memcpy(pOperand, EvmuBatch_row_(pSelf, pOperands->direct), pSelf->laneCount);
+        break;
+    case EVMU_BATCH_SRC_INDIRECT_:
+        // Gather, since each lane's pointer may differ
+        for(size_t l = 0; l < pSelf->laneCount; ++l)
+            if(pSelf->pActive[l])
+                pOperand[l] = *EvmuBatch_reg_(pSelf, l,
+                                              EvmuBatch_indirect_(pSelf, l, pOperands->indirect));
+        break;
+    }
+}
+
+// ADD, ADDC, SUB, and SUBC of the operand row into ACC, matching EvmuCpu's OP_ARITH
+static void EvmuBatch_arith_(EvmuBatch* pSelf, GblBool subtract, GblBool carry) {
+    EvmuWord*       pAcc     = pSelf->pAcc;
+    EvmuWord*       pPsw     = pSelf->pPsw;
+    const EvmuWord* pOperand = pSelf->pOperand;
+    const uint8_t*  pActive  = pSelf->pActive;
+
+    for(size_t l = 0; l < pSelf->laneCount; ++l) {
+        const int a = pAcc[l];
+        const int b = pOperand[l];
+        const int c = carry? (pPsw[l] & EVMU_SFR_PSW_CY_MASK) >> EVMU_SFR_PSW_CY_POS : 0;
+        int cy, ac, ov;
+
+        if(!subtract) {
+            cy = a+b+c > 255;
+            ac = (a&0xf)+((b+c)&0xf) > 0xf;
+            ov = 0x80&(~a^(b+c))&((b+c)^(a+(b+c)));
+        } else {
+            cy = a-b-c < 0;
+            ac = (a&0xf)-(b&0xf)-c < 0;
+            ov = (int8_t)(a^(b+c)) < 0 && (int8_t)((b+c)^(a-(b+c))) >= 0;
+        }
+
+        // PSW is written after ACC, so ACC's parity update is overwritten
+        const EvmuWord r = subtract? a - b - c : a + b + c;
+        const EvmuWord p = (pPsw[l] & ~(EVMU_SFR_PSW_CY_MASK |
+                                        EVMU_SFR_PSW_AC_MASK |
+                                        EVMU_SFR_PSW_OV_MASK))
+                            | (cy? EVMU_SFR_PSW_CY_MASK : 0)
+                            | (ac? EVMU_SFR_PSW_AC_MASK : 0)
+                            | (ov? EVMU_SFR_PSW_OV_MASK : 0);
+
+        pAcc[l] = pActive[l]? r : pAcc[l];
+        pPsw[l] = pActive[l]? p : pPsw[l];
+    }
+}
+
+// LD, AND, OR, and XOR of the operand row into ACC, updating parity when ACC changes
+static void EvmuBatch_logic_(EvmuBatch* pSelf, EVMU_BATCH_LOGIC_ op) {
+    EvmuWord*       pAcc     = pSelf->pAcc;
+    EvmuWord*       pPsw     = pSelf->pPsw;
+    const EvmuWord* pOperand = pSelf->pOperand;
+    const uint8_t*  pActive  = pSelf->pActive;
+
+    for(size_t l = 0; l < pSelf->laneCount; ++l) {
+        EvmuWord r;
+
+        switch(op) {
+        default:
+        case EVMU_BATCH_LOGIC_LOAD_: r = pOperand[l];           break;
+        case EVMU_BATCH_LOGIC_AND_:  r = pAcc[l] & pOperand[l]; break;
+        case EVMU_BATCH_LOGIC_OR_:   r = pAcc[l] | pOperand[l]; break;
+        case EVMU_BATCH_LOGIC_XOR_:  r = pAcc[l] ^ pOperand[l]; break;
+        }
+
+        const GblBool  write = pActive[l] && pAcc[l] != r;
+        const EvmuWord p     = (pPsw[l] & 0xfe) | gblParity(r);
+
+        pPsw[l] = write? p : pPsw[l];
+        pAcc[l] = pActive[l]? r : pAcc[l];
+    }
+}
+
+// Executes an instruction across every active lane, mirroring EvmuCpu_execute_()
+static void EvmuBatch_execute_(EvmuBatch* pSelf, const EvmuDecodedInstruction* pInstr, size_t bytes) {
+#define LANES(LANE)             for(size_t LANE = 0; LANE < pSelf->laneCount; ++LANE) if(pSelf->pActive[LANE])
+#define PC                      pSelf->pPc[lane]
+#define OP(NAME)                pOperands->NAME
+#define SFR(NAME)               EVMU_ADDRESS_SFR_##NAME
+#define SFR_MSK(NAME, FIELD)    EVMU_SFR_##NAME##_##FIELD##_MASK
+#define SFR_POS(NAME, FIELD)    EVMU_SFR_##NAME##_##FIELD##_POS
+#define INDIRECT()              EvmuBatch_indirect_(pSelf, lane, OP(indirect))
+#define READ(ADDR)              (*EvmuBatch_reg_(pSelf, lane, ADDR))
+#define WRITE(ADDR, VAL)        EvmuBatch_write_(pSelf, lane, ADDR, VAL)
+#define PUSH(VALUE)             EvmuBatch_push_(pSelf, lane, VALUE)
+#define POP()                   EvmuBatch_pop_(pSelf, lane)
+#define PUSH_PC()               GBL_STMT_START { PUSH(PC & 0xff); PUSH((PC & 0xff00) >> 8u); } GBL_STMT_END
+#define POP_PC()                GBL_STMT_START { PC = POP() << 8u; PC |= POP(); } GBL_STMT_END
+#define PSW(FLAG, EXPR)         WRITE(SFR(PSW), (READ(SFR(PSW)) & ~SFR_MSK(PSW, FLAG)) | ((EXPR)? SFR_MSK(PSW, FLAG) : 0))
+#define BR(EXPR, OFFSET)        if((EXPR)) PC += OFFSET
+#define ARITH(SRC, SUB, CARRY)  GBL_STMT_START { EvmuBatch_loadOperand_(pSelf, SRC, pOperands); \
+                                                 EvmuBatch_arith_(pSelf, SUB, CARRY); } GBL_STMT_END
+#define LOGIC(SRC, OP)          GBL_STMT_START { EvmuBatch_loadOperand_(pSelf, SRC, pOperands); \
+                                                 EvmuBatch_logic_(pSelf, OP); } GBL_STMT_END
+
+#define BR_DEC(ADDR)                                    \
+    GBL_STMT_START {                                    \
+        const EvmuAddress addr  = (ADDR);               \
+        const EvmuWord    value = READ(addr) - 1;       \
+        WRITE(addr, value);                             \
+        BR(value != 0, OP(relative8));                  \
+    } GBL_STMT_END
+
+#define BR_CMP(VALUE1, OPERATOR, VALUE2, OFFSET) \
+    GBL_STMT_START {                             \
+        const EvmuWord v1 = VALUE1;              \
+        const EvmuWord v2 = VALUE2;              \
+        PSW(CY, v1 < v2);                        \
+        BR(v1 OPERATOR v2, OFFSET);              \
+    } GBL_STMT_END
+
+#define XCH(ADDR)                                \
+    GBL_STMT_START {                             \
+        const EvmuAddress address = (ADDR);      \
+        const EvmuWord    acc     = READ(SFR(ACC)); \
+        const EvmuWord    mem     = READ(address);  \
+        WRITE(SFR(ACC), mem);                    \
+        WRITE(address, acc);                     \
+    } GBL_STMT_END
+
+    const EvmuOperands* pOperands = &pInstr->operands;
+
+    //Advance program counters
+    LANES(lane) PC += bytes;
+
+    switch(pInstr->opcode) {
+    default:
+    case EVMU_OPCODE_NOP:
+        break;
+    case EVMU_OPCODE_BR:
+        LANES(lane) PC += OP(relative8);
+        break;
+    case EVMU_OPCODE_LD:
+        LOGIC(EVMU_BATCH_SRC_DIRECT_, EVMU_BATCH_LOGIC_LOAD_);
+        break;
+    case EVMU_OPCODE_LD_IND:
+        LOGIC(EVMU_BATCH_SRC_INDIRECT_, EVMU_BATCH_LOGIC_LOAD_);
+        break;
+    case EVMU_OPCODE_CALL:
+        LANES(lane) {
+            PUSH_PC();
+            PC &= ~0xfff;
+            PC |= (OP(absolute) & 0xfff);
+        }
+        break;
+    case EVMU_OPCODE_CALLR:
+        LANES(lane) {
+            PUSH_PC();
+            PC += (OP(relative16) % 65536) - 1;
+        }
+        break;
+    case EVMU_OPCODE_BRF:
+        LANES(lane) PC += (OP(relative16) % 65536) - 1;
+        break;
+    case EVMU_OPCODE_ST:
+        LANES(lane) WRITE(OP(direct), READ(SFR(ACC)));
+        break;
+    case EVMU_OPCODE_ST_IND:
+        LANES(lane) WRITE(INDIRECT(), READ(SFR(ACC)));
+        break;
+    case EVMU_OPCODE_CALLF:
+        LANES(lane) {
+            PUSH_PC();
+            PC = OP(absolute);
+        }
+        break;
+    case EVMU_OPCODE_JMPF:
+        LANES(lane) PC = OP(absolute);
+        break;
+    case EVMU_OPCODE_MOV:
+        LANES(lane) WRITE(OP(direct), OP(immediate));
+        break;
+    case EVMU_OPCODE_MOV_IND:
+        LANES(lane) WRITE(INDIRECT(), OP(immediate));
+        break;
+    case EVMU_OPCODE_JMP:
+        LANES(lane) {
+            PC &= ~0xfff;
+            PC |= (OP(absolute) & 0xfff);
+        }
+        break;
+    case EVMU_OPCODE_MUL:
+        LANES(lane) {
+            const int temp = (READ(SFR(C)) | (READ(SFR(ACC)) << 8)) * READ(SFR(B));
+            WRITE(SFR(C),    (temp & 0xff));
+            WRITE(SFR(ACC), ((temp & 0xff00)   >> 8));
+            WRITE(SFR(B),   ((temp & 0xff0000) >> 16));
+            PSW(CY, 0);
+            PSW(OV, temp > 65535);
+        }
+        break;
+    case EVMU_OPCODE_BEI:
+        LANES(lane) BR_CMP(READ(SFR(ACC)), ==, OP(immediate), OP(relative8));
+        break;
+    case EVMU_OPCODE_BE:
+        LANES(lane) BR_CMP(READ(SFR(ACC)), ==, READ(OP(direct)), OP(relative8));
+        break;
+    case EVMU_OPCODE_BE_IND:
+        LANES(lane) BR_CMP(READ(INDIRECT()), ==, OP(immediate), OP(relative8));
+        break;
+    case EVMU_OPCODE_DIV:
+        LANES(lane) {
+            int r  =  READ(SFR(B)), s;
+            if(r) {
+                const int v = READ(SFR(C)) | (READ(SFR(ACC)) << 8);
+                s = v % r;
+                r = v / r;
+            } else {
+                r = 0xff00 | READ(SFR(C));
+                s = 0;
+            }
+            WRITE(SFR(B),    s);
+            WRITE(SFR(C),    r & 0xff);
+            WRITE(SFR(ACC), (r & 0xff00) >> 8);
+            PSW(CY, 0);
+            PSW(OV, !s);
+        }
+        break;
+    case EVMU_OPCODE_BNEI:
+        LANES(lane) BR_CMP(READ(SFR(ACC)), !=, OP(immediate), OP(relative8));
+        break;
+    case EVMU_OPCODE_BNE:
+        LANES(lane) BR_CMP(READ(SFR(ACC)), !=, READ(OP(direct)), OP(relative8));
+        break;
+    case EVMU_OPCODE_BNE_IND:
+        LANES(lane) BR_CMP(READ(INDIRECT()), !=, OP(immediate), OP(relative8));
+        break;
+    case EVMU_OPCODE_BPC:
+        LANES(lane) {
+            const EvmuWord value = READ(OP(direct));
+            const EvmuWord mask = (1u << OP(bit));
+            if(value & mask) {
+                WRITE(OP(direct), value & (~mask));
+                PC += OP(relative8);
+            }
+        }
+        break;
+    case EVMU_OPCODE_DBNZ:
+        LANES(lane) BR_DEC(OP(direct));
+        break;
+    case EVMU_OPCODE_DBNZ_IND:
+        LANES(lane) BR_DEC(INDIRECT());
+        break;
+    case EVMU_OPCODE_PUSH:
+        LANES(lane) PUSH(READ(OP(direct)));
+        break;
+    case EVMU_OPCODE_INC:
+        LANES(lane) WRITE(OP(direct), READ(OP(direct)) + 1);
+        break;
+    case EVMU_OPCODE_INC_IND:
+        LANES(lane) {
+            const EvmuAddress addr = INDIRECT();
+            WRITE(addr, READ(addr) + 1);
+        }
+        break;
+    case EVMU_OPCODE_BP:
+        LANES(lane) BR(READ(OP(direct)) & (0x1 << OP(bit)), OP(relative8));
+        break;
+    case EVMU_OPCODE_POP:
+        LANES(lane) {
+            const EvmuWord value = POP();
+            WRITE(OP(direct), value);
+        }
+        break;
+    case EVMU_OPCODE_DEC:
+        LANES(lane) WRITE(OP(direct), READ(OP(direct)) - 1);
+        break;
+    case EVMU_OPCODE_DEC_IND:
+        LANES(lane) {
+            const EvmuAddress addr = INDIRECT();
+            WRITE(addr, READ(addr) - 1);
+        }
+        break;
+    case EVMU_OPCODE_BZ:
+        LANES(lane) BR(!READ(SFR(ACC)), OP(relative8));
+        break;
+    case EVMU_OPCODE_ADDI:
+        ARITH(EVMU_BATCH_SRC_IMMEDIATE_, GBL_FALSE, GBL_FALSE);
+        break;
+    case EVMU_OPCODE_ADD:
+        ARITH(EVMU_BATCH_SRC_DIRECT_, GBL_FALSE, GBL_FALSE);
+        break;
+    case EVMU_OPCODE_ADD_IND:
+        ARITH(EVMU_BATCH_SRC_INDIRECT_, GBL_FALSE, GBL_FALSE);
+        break;
+    case EVMU_OPCODE_BN:
+        LANES(lane) BR(!(READ(OP(direct)) & (0x1 << OP(bit))), OP(relative8));
+        break;
+    case EVMU_OPCODE_BNZ:
+        LANES(lane) BR(READ(SFR(ACC)), OP(relative8));
+        break;
+    case EVMU_OPCODE_ADDCI:
+        ARITH(EVMU_BATCH_SRC_IMMEDIATE_, GBL_FALSE, GBL_TRUE);
+        break;
+    case EVMU_OPCODE_ADDC:
+        ARITH(EVMU_BATCH_SRC_DIRECT_, GBL_FALSE, GBL_TRUE);
+        break;
+    case EVMU_OPCODE_ADDC_IND:
+        ARITH(EVMU_BATCH_SRC_INDIRECT_, GBL_FALSE, GBL_TRUE);
+        break;
+    case EVMU_OPCODE_RET:
+        LANES(lane) POP_PC();
+        break;
+    case EVMU_OPCODE_SUBI:
+        ARITH(EVMU_BATCH_SRC_IMMEDIATE_, GBL_TRUE, GBL_FALSE);
+        break;
+    case EVMU_OPCODE_SUB:
+        ARITH(EVMU_BATCH_SRC_DIRECT_, GBL_TRUE, GBL_FALSE);
+        break;
+    case EVMU_OPCODE_SUB_IND:
+        ARITH(EVMU_BATCH_SRC_INDIRECT_, GBL_TRUE, GBL_FALSE);
+        break;
+    case EVMU_OPCODE_NOT1:
+        LANES(lane) WRITE(OP(direct), READ(OP(direct)) ^ (0x1u << OP(bit)));
+        break;
+    case EVMU_OPCODE_SUBCI:
+        ARITH(EVMU_BATCH_SRC_IMMEDIATE_, GBL_TRUE, GBL_TRUE);
+        break;
+    case EVMU_OPCODE_SUBC:
+        ARITH(EVMU_BATCH_SRC_DIRECT_, GBL_TRUE, GBL_TRUE);
+        break;
+    case EVMU_OPCODE_SUBC_IND:
+        ARITH(EVMU_BATCH_SRC_INDIRECT_, GBL_TRUE, GBL_TRUE);
+        break;
+    case EVMU_OPCODE_ROR:
+        LANES(lane) {
+            const EvmuWord value = READ(SFR(ACC));
+            WRITE(SFR(ACC), ((value & 0x1) << 7u) | (value >> 1u));
+        }
+        break;
+    case EVMU_OPCODE_XCH:
+        LANES(lane) XCH(OP(direct));
+        break;
+    case EVMU_OPCODE_XCH_IND:
+        LANES(lane) XCH(INDIRECT());
+        break;
+    case EVMU_OPCODE_CLR1:
+        LANES(lane) WRITE(OP(direct), READ(OP(direct)) & ~(1u << OP(bit)));
+        break;
+    case EVMU_OPCODE_RORC:
+        LANES(lane) {
+            const unsigned v = READ(SFR(ACC));
+            const EvmuWord psw = READ(SFR(PSW));
+            WRITE(SFR(PSW), (psw & ~(SFR_MSK(PSW, CY))) | ((v & 0x1) << SFR_POS(PSW, CY)));
+            WRITE(SFR(ACC), (v >> 1) | (psw & SFR_MSK(PSW, CY)));
+        }
+        break;
+    case EVMU_OPCODE_ORI:
+        LOGIC(EVMU_BATCH_SRC_IMMEDIATE_, EVMU_BATCH_LOGIC_OR_);
+        break;
+    case EVMU_OPCODE_OR:
+        LOGIC(EVMU_BATCH_SRC_DIRECT_, EVMU_BATCH_LOGIC_OR_);
+        break;
+    case EVMU_OPCODE_OR_IND:
+        LOGIC(EVMU_BATCH_SRC_INDIRECT_, EVMU_BATCH_LOGIC_OR_);
+        break;
+    case EVMU_OPCODE_ROL:
+        LANES(lane) {
+            const EvmuWord value = READ(SFR(ACC));
+            WRITE(SFR(ACC), (value << 1u) | ((value & 0x80) >> 7u));
+        }
+        break;
+    case EVMU_OPCODE_ANDI:
+        LOGIC(EVMU_BATCH_SRC_IMMEDIATE_, EVMU_BATCH_LOGIC_AND_);
+        break;
+    case EVMU_OPCODE_AND:
+        LOGIC(EVMU_BATCH_SRC_DIRECT_, EVMU_BATCH_LOGIC_AND_);
+        break;
+    case EVMU_OPCODE_AND_IND:
+        LOGIC(EVMU_BATCH_SRC_INDIRECT_, EVMU_BATCH_LOGIC_AND_);
+        break;
+    case EVMU_OPCODE_SET1:
+        LANES(lane) WRITE(OP(direct), READ(OP(direct)) | (1u << OP(bit)));
+        break;
+    case EVMU_OPCODE_ROLC:
+        LANES(lane) {
+            const unsigned v = READ(SFR(ACC));
+            const EvmuWord psw = READ(SFR(PSW));
+            WRITE(SFR(PSW), (psw & ~(SFR_MSK(PSW, CY))) | (v & 0x80));
+            WRITE(SFR(ACC), (v << 1) | ((psw & SFR_MSK(PSW, CY)) >> SFR_POS(PSW, CY)));
+        }
+        break;
+    case EVMU_OPCODE_XORI:
+        LOGIC(EVMU_BATCH_SRC_IMMEDIATE_, EVMU_BATCH_LOGIC_XOR_);
+        break;
+    case EVMU_OPCODE_XOR:
+        LOGIC(EVMU_BATCH_SRC_DIRECT_, EVMU_BATCH_LOGIC_XOR_);
+        break;
+    case EVMU_OPCODE_XOR_IND:
+        LOGIC(EVMU_BATCH_SRC_INDIRECT_, EVMU_BATCH_LOGIC_XOR_);
+        break;
+    }
+
+    // Credited to each device's EvmuCpu once written back
+    for(size_t l = 0; l < pSelf->laneCount; ++l) {
+        pSelf->pInstructions[l] += pSelf->pActive[l];
+        pSelf->pDirty[l]        |= pSelf->pActive[l];
+    }
+}
+
+// Runs the group of lanes sharing the PC and program memory of the lane at lead
+static EVMU_RESULT EvmuBatch_step_(EvmuBatch* pSelf, size_t lead) {
+    GBL_CTX_BEGIN(NULL);
+
+    const EvmuPc    pc     = pSelf->pPc[lead];
+    const EvmuWord* pExt   = pSelf->ppExt[lead];
+    size_t          active = 0;
+
+    for(size_t l = 0; l < pSelf->laneCount; ++l) {
+        pSelf->pActive[l]   = !pSelf->pStepped[l] && !pSelf->pHalted[l] &&
+                              pSelf->pPc[l] == pc && pSelf->ppExt[l] == pExt;
+        pSelf->pStepped[l] |= pSelf->pActive[l];
+        active             += pSelf->pActive[l];
+    }
+
+    EvmuInstruction        encoded;
+    EvmuDecodedInstruction decoded;
+    size_t                 sourceSize = 4;
+    GblBool                vector     = GBL_FALSE;
+
+    // The emulated BIOS is entered and exited by EvmuCpu_runNext() itself
+    if(!pSelf->pBios[lead]) {
+        GBL_CTX_VERIFY_CALL(EvmuIsa_fetch(&encoded, &pExt[pc], &sourceSize));
+        GBL_CTX_VERIFY_CALL(EvmuIsa_decode(&encoded, &decoded));
+        vector = EvmuBatch_vectorizable_(pSelf, &decoded);
+    }
+
+    ++pSelf->stats.groups;
+
+    if(!vector) {
+        for(size_t l = 0; l < pSelf->laneCount; ++l)
+            if(pSelf->pActive[l])
+                EvmuBatch_runScalar_(pSelf, l);
+        GBL_CTX_DONE();
+    }
+
+    // Bring each device to the state the group is starting from
+    if(pSelf->validating)
+        for(size_t l = 0; l < pSelf->laneCount; ++l)
+            if(pSelf->pActive[l])
+                EvmuBatch_scatter_(pSelf, l);
+
+    EvmuBatch_execute_(pSelf, &decoded, EvmuIsa_format(encoded.bytes[EVMU_INSTRUCTION_BYTE_OPCODE])->bytes);
+    pSelf->stats.vectorLanes += active;
+
+    if(pSelf->validating) {
+        for(size_t l = 0; l < pSelf->laneCount; ++l) {
+            if(!pSelf->pActive[l]) continue;
+
+            EvmuCpu_runNext(pSelf->ppDevices[l]->pCpu);
+            ++pSelf->stats.validated;
+
+            GBL_CTX_VERIFY(EvmuBatch_matches_(pSelf, l),
+                           GBL_RESULT_ERROR_INTERNAL,
+                           "[EVMU_BATCH]: Lane %zu diverged from EvmuCpu executing opcode %x at PC %x!",
+                           l, decoded.opcode, pc);
+
+            // Already counted by the device's EvmuCpu
+            pSelf->pInstructions[l] = 0;
+            pSelf->pDirty[l]        = 0;
+        }
+    }
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EvmuBatch* EvmuBatch_create(EvmuDevice** ppDevices, size_t count) {
+    EvmuBatch* pSelf = NULL;
+
+    GBL_CTX_BEGIN(NULL);
+    GBL_CTX_VERIFY_POINTER(ppDevices);
+    GBL_CTX_VERIFY_ARG(count);
+
+    for(size_t l = 0; l < count; ++l) {
+        GBL_CTX_VERIFY_POINTER(ppDevices[l]);
+    }
+
+    pSelf = calloc(1, sizeof(EvmuBatch));
+
+    GBL_CTX_VERIFY(pSelf,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate batch!");
+
+    const size_t size = EvmuBatch_layout_(pSelf, NULL, count);
+
+    pSelf->pBlock = EvmuAlloc__aligned_(EVMU_BATCH_ALIGNMENT_, size);
+
+    GBL_CTX_VERIFY(pSelf->pBlock,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate %zu bytes for %zu batched lanes!",
+                   size, count);
+
+    memset(pSelf->pBlock, 0, size);
+    EvmuBatch_layout_(pSelf, pSelf->pBlock, count);
+    memcpy(pSelf->ppDevices, ppDevices, sizeof(EvmuDevice*) * count);
+    pSelf->laneCount = count;
+
+    for(size_t l = 0; l < count; ++l)
+        EvmuBatch_gather_(pSelf, l);
+
+    GBL_CTX_END_BLOCK();
+
+    if(GBL_RESULT_ERROR(GBL_CTX_RESULT()) && pSelf) {
+        EvmuAlloc__alignedFree_(pSelf->pBlock);
+        free(pSelf);
+        pSelf = NULL;
+    }
+
+    return pSelf;
+}
+
+EVMU_EXPORT void EvmuBatch_destroy(EvmuBatch* pSelf) {
+    if(!pSelf) return;
+
+    EvmuBatch_sync(pSelf);
+    EvmuAlloc__alignedFree_(pSelf->pBlock);
+    free(pSelf);
+}
+
+EVMU_EXPORT size_t EvmuBatch_laneCount(const EvmuBatch* pSelf) {
+    return pSelf? pSelf->laneCount : 0;
+}
+
+EVMU_EXPORT EvmuDevice* EvmuBatch_device(const EvmuBatch* pSelf, size_t lane) {
+    return lane < EvmuBatch_laneCount(pSelf)? pSelf->ppDevices[lane] : NULL;
+}
+
+EVMU_EXPORT EvmuPc EvmuBatch_pc(const EvmuBatch* pSelf, size_t lane) {
+    return lane < EvmuBatch_laneCount(pSelf)? pSelf->pPc[lane] : 0;
+}
+
+EVMU_EXPORT size_t EvmuBatch_divergence(const EvmuBatch* pSelf) {
+    uint64_t seen[(UINT16_MAX + 1) / 64] = { 0 };
+    size_t   count = 0;
+
+    for(size_t l = 0; l < EvmuBatch_laneCount(pSelf); ++l) {
+        const EvmuPc pc = pSelf->pPc[l];
+
+        if(pSelf->pHalted[l] || (seen[pc / 64] & (1ull << (pc % 64))))
+            continue;
+
+        seen[pc / 64] |= 1ull << (pc % 64);
+        ++count;
+    }
+
+    return count;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuBatch_run(EvmuBatch* pSelf, size_t instructions) {
+    GBL_CTX_BEGIN(NULL);
+    GBL_CTX_VERIFY_POINTER(pSelf);
+
+    for(size_t i = 0; i < instructions; ++i) {
+        memset(pSelf->pStepped, 0, pSelf->laneCount);
+
+        for(size_t l = 0; l < pSelf->laneCount; ++l) {
+            if(!pSelf->pStepped[l] && !pSelf->pHalted[l]) {
+                GBL_CTX_VERIFY_CALL(EvmuBatch_step_(pSelf, l));
+            }
+        }
+    }
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuBatch_sync(EvmuBatch* pSelf) {
+    GBL_CTX_BEGIN(NULL);
+    GBL_CTX_VERIFY_POINTER(pSelf);
+
+    for(size_t l = 0; l < pSelf->laneCount; ++l) {
+        if(!pSelf->pDirty[l]) continue;
+        // Notifies pcChange listeners once for everything that ran batched
+        EvmuCpu_setPc(pSelf->ppDevices[l]->pCpu, pSelf->pPc[l]);
+        EvmuBatch_scatter_(pSelf, l);
+    }
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuBatch_reload(EvmuBatch* pSelf) {
+    GBL_CTX_BEGIN(NULL);
+    GBL_CTX_VERIFY_POINTER(pSelf);
+
+    for(size_t l = 0; l < pSelf->laneCount; ++l) {
+        EVMU_DEVICE_(pSelf->ppDevices[l])->pCpu->instructions += pSelf->pInstructions[l];
+        pSelf->pInstructions[l] = 0;
+        EvmuBatch_gather_(pSelf, l);
+    }
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT void EvmuBatch_setValidating(EvmuBatch* pSelf, GblBool enabled) {
+    pSelf->validating = enabled;
+}
+
+EVMU_EXPORT GblBool EvmuBatch_validating(const EvmuBatch* pSelf) {
+    return pSelf->validating;
+}
+
+EVMU_EXPORT void EvmuBatch_stats(const EvmuBatch* pSelf, EvmuBatchStats* pStats) {
+    memcpy(pStats, &pSelf->stats, sizeof(EvmuBatchStats));
+}
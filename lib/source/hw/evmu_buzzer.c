@@ -3,15 +3,26 @@
 #include "evmu_device_.h"
 #include "evmu_buzzer_.h"
 #include "evmu_ram_.h"
+#include "evmu_clock_.h"
 
 #include <string.h>
 
 #include "../types/evmu_marshal_.h"
+#include "../types/evmu_ibehavior_.h"
 
 #define EVMU_BUZZER_FREQ_RESP_BASE_OFFSET_   0xe0
 #define EVMU_BUZZER_FREQ_RESP_DEFAULT_VALUE_ 30
 #define EVMU_BUZZER_FREQ_RESP_MAX_VALUE_     72
 
+#define EVMU_BUZZER_PCM_LOW_                 0x7f
+#define EVMU_BUZZER_PCM_HIGH_                0xff
+#define EVMU_BUZZER_STREAM_MIN_CAPACITY_     256
+#define EVMU_BUZZER_STREAM_MAX_CAPACITY_     (1 << 24)
+#define EVMU_BUZZER_RENDER_STAGING_SIZE_     4096
+#define EVMU_BUZZER_WAV_HEADER_SIZE_         44
+// EvmuClock_systemTicksPerCycle() reports nanoseconds
+#define EVMU_BUZZER_PCM_TICKS_PER_SEC_       1000000000ull
+
 static uint8_t freqResponse_[0x1f] = {
     [0x00] = 62,
     [0x01] = 62,
@@ -92,6 +103,140 @@ void EvmuBuzzer__memorySink_(EvmuBuzzer_* pSelf_, EvmuAddress address, EvmuWord
     }
 }
 
+static uint8_t EvmuBuzzer_freqResponse_(uint16_t tonePeriod) {
+    if(tonePeriod < EVMU_BUZZER_FREQ_RESP_BASE_OFFSET_ ||
+       tonePeriod >= EVMU_BUZZER_FREQ_RESP_BASE_OFFSET_ + GBL_COUNT_OF(freqResponse_))
+        return EVMU_BUZZER_FREQ_RESP_DEFAULT_VALUE_;
+    else
+        return freqResponse_[tonePeriod - EVMU_BUZZER_FREQ_RESP_BASE_OFFSET_];
+}
+
+// Samples the buzzer output's square wave from the Timer1 and P1 state
+static void EvmuBuzzer_wave_(EvmuBuzzer_* pSelf_, int t1l, EvmuBuzzerWave_* pWave) {
+    const uint8_t* pSfr = pSelf_->pRam->sfr;
+    const int      t1lr = pSfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_T1LR)];
+
+    pWave->playing  = pSelf_->enabled &&
+                      EvmuBuzzer_isConfigured(EVMU_BUZZER_PUBLIC_(pSelf_)) &&
+                      (pSfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_T1CNT)] & EVMU_SFR_T1CNT_T1LRUN_MASK);
+
+    // Same square wave as EvmuBuzzer_setTone(), but phase-locked to T1L
+    pWave->period   = 256 - t1lr;
+    pWave->invPulse = (uint8_t)(pSfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_T1LC)] - t1lr);
+    pWave->phase    = (t1l - t1lr) % pWave->period;
+
+    if(pWave->invPulse > pWave->period) pWave->invPulse = pWave->period;
+    if(pWave->phase < 0)                pWave->phase   += pWave->period;
+}
+
+GBL_INLINE uint8_t EvmuBuzzer_waveLevel_(const EvmuBuzzerWave_* pWave, int phase, uint8_t high) {
+    return !pWave->playing?           EVMU_BUZZER_STREAM_SILENCE :
+           (phase < pWave->invPulse)? EVMU_BUZZER_PCM_LOW_ : high;
+}
+
+static void EvmuBuzzer_streamAdvance_(EvmuBuzzerStream_*     pStream,
+                                      const EvmuBuzzerWave_* pWave,
+                                      EvmuTicks              ticksPerCycle,
+                                      int                    cycles)
+{
+    uint8_t*       pRing   = pStream->pRing->pData;
+    const uint64_t step    = ticksPerCycle * pStream->frequency;
+    size_t         head    = atomic_load_explicit(&pStream->head, memory_order_relaxed);
+    const size_t   tail    = atomic_load_explicit(&pStream->tail, memory_order_acquire);
+    size_t         dropped = 0;
+    int            phase   = pWave->phase;
+
+    for(int c = 0; c < cycles; ++c) {
+        const uint8_t level = EvmuBuzzer_waveLevel_(pWave, phase, EVMU_BUZZER_PCM_HIGH_);
+
+        // Integer sample clock: one sample per second's worth of (ticks * Hz)
+        pStream->clock += step;
+
+        while(pStream->clock >= EVMU_BUZZER_PCM_TICKS_PER_SEC_) {
+            pStream->clock -= EVMU_BUZZER_PCM_TICKS_PER_SEC_;
+
+            if(head - tail <= pStream->mask)
+                pRing[head++ & pStream->mask] = level;
+            else
+                ++dropped;
+        }
+
+        if(++phase >= pWave->period) phase = 0;
+    }
+
+    atomic_store_explicit(&pStream->head, head, memory_order_release);
+
+    if(dropped)
+        atomic_fetch_add_explicit(&pStream->dropped, dropped, memory_order_relaxed);
+}
+
+static void EvmuBuzzer_renderFlush_(EvmuBuzzerRender_* pRender) {
+    if(pRender->used && fwrite(pRender->pBuffer, 1, pRender->used, pRender->pFile) != pRender->used)
+        pRender->failed = GBL_TRUE;
+
+    pRender->used = 0;
+}
+
+static void EvmuBuzzer_renderAdvance_(EvmuBuzzerRender_*     pRender,
+                                      const EvmuBuzzerWave_* pWave,
+                                      EvmuTicks              ticksPerCycle,
+                                      int                    cycles,
+                                      uint8_t                high)
+{
+    const uint64_t step  = ticksPerCycle * pRender->frequency;
+    int            phase = pWave->phase;
+
+    for(int c = 0; c < cycles; ++c) {
+        const uint8_t level = EvmuBuzzer_waveLevel_(pWave, phase, high);
+
+        pRender->clock += step;
+
+        while(pRender->clock >= EVMU_BUZZER_PCM_TICKS_PER_SEC_) {
+            pRender->clock -= EVMU_BUZZER_PCM_TICKS_PER_SEC_;
+
+            if(pRender->used == pRender->capacity) {
+                if(pRender->pFile) {
+                    EvmuBuzzer_renderFlush_(pRender);
+                } else {
+                    pRender->truncated = GBL_TRUE;
+                    continue;
+                }
+            }
+
+            pRender->pBuffer[pRender->used++] = level;
+            ++pRender->samples;
+        }
+
+        if(++phase >= pWave->period) phase = 0;
+    }
+}
+
+void EvmuBuzzer__pcmAdvance_(EvmuBuzzer_* pSelf_, int t1l, int cycles) {
+    if(!pSelf_->stream.pRing && !pSelf_->render.frequency) return;
+
+    EvmuBuzzerWave_ wave;
+    EvmuBuzzer_wave_(pSelf_, t1l, &wave);
+
+    const EvmuTicks ticksPerCycle =
+            EvmuClock_systemTicksPerCycle(EVMU_CLOCK_PUBLIC_(pSelf_->pClock));
+
+    if(pSelf_->stream.pRing)
+        EvmuBuzzer_streamAdvance_(&pSelf_->stream, &wave, ticksPerCycle, cycles);
+
+    if(pSelf_->render.frequency) {
+        uint8_t high = EVMU_BUZZER_PCM_HIGH_;
+
+        // Bake the per-tone gain into the rendered amplitude
+        if(EVMU_BUZZER_PUBLIC_(pSelf_)->enableFreqResp)
+            high = EVMU_BUZZER_PCM_LOW_ +
+                   ((EVMU_BUZZER_PCM_HIGH_ - EVMU_BUZZER_PCM_LOW_) *
+                    EvmuBuzzer_freqResponse_(wave.period)) /
+                   EVMU_BUZZER_FREQ_RESP_MAX_VALUE_;
+
+        EvmuBuzzer_renderAdvance_(&pSelf_->render, &wave, ticksPerCycle, cycles, high);
+    }
+}
+
 EVMU_EXPORT GblBool EvmuBuzzer_isConfigured(const EvmuBuzzer* pSelf) {
     EvmuBuzzer_* pSelf_ = EVMU_BUZZER_(pSelf);
 
@@ -232,21 +377,283 @@ EVMU_EXPORT float EvmuBuzzer_pcmGain(const EvmuBuzzer* pSelf) {
     } else
 */
     if(pSelf->enableFreqResp) {
-        if(pSelf_->tonePeriod < EVMU_BUZZER_FREQ_RESP_BASE_OFFSET_ ||
-           pSelf_->tonePeriod > EVMU_BUZZER_FREQ_RESP_BASE_OFFSET_ +
-                                GBL_COUNT_OF(freqResponse_))
-        {
-            return (float)EVMU_BUZZER_FREQ_RESP_DEFAULT_VALUE_ / (float)EVMU_BUZZER_FREQ_RESP_MAX_VALUE_;
-        } else {
-            return (float)freqResponse_[pSelf_->tonePeriod -
-                                        EVMU_BUZZER_FREQ_RESP_BASE_OFFSET_] /
-                   (float)EVMU_BUZZER_FREQ_RESP_MAX_VALUE_;
-        }
+        return (float)EvmuBuzzer_freqResponse_(pSelf_->tonePeriod) /
+               (float)EVMU_BUZZER_FREQ_RESP_MAX_VALUE_;
     } else {
         return 1.0f;
     }
 }
 
+EVMU_EXPORT EVMU_RESULT EvmuBuzzer_startPcmStream(EvmuBuzzer* pSelf,
+                                                  size_t      frequency,
+                                                  size_t      capacity) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuBuzzerStream_* pStream = &EVMU_BUZZER_(pSelf)->stream;
+    size_t             size    = EVMU_BUZZER_STREAM_MIN_CAPACITY_;
+
+    GBL_CTX_VERIFY(frequency,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Cannot stream PCM at 0Hz!");
+
+    GBL_CTX_VERIFY(capacity <= EVMU_BUZZER_STREAM_MAX_CAPACITY_,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "PCM stream capacity is too large: [%zu samples]",
+                   capacity);
+
+    // Indices are masked, so round the ring up to a power of two
+    while(size < capacity) size <<= 1;
+
+    EvmuBuzzer_stopPcmStream(pSelf);
+
+    GBL_CTX_VERIFY(pStream->pRing = GblByteArray_create(size),
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate PCM stream: [%zu samples]",
+                   size);
+
+    pStream->mask      = size - 1;
+    pStream->frequency = frequency;
+    pStream->clock     = 0;
+    atomic_store_explicit(&pStream->head,    0, memory_order_relaxed);
+    atomic_store_explicit(&pStream->tail,    0, memory_order_relaxed);
+    atomic_store_explicit(&pStream->dropped, 0, memory_order_relaxed);
+
+    EVMU_LOG_VERBOSE("Started PCM stream: [%zuHz, %zu samples]", frequency, size);
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT void EvmuBuzzer_stopPcmStream(EvmuBuzzer* pSelf) {
+    EvmuBuzzerStream_* pStream = &EVMU_BUZZER_(pSelf)->stream;
+
+    if(pStream->pRing) {
+        GblByteArray_unref(pStream->pRing);
+        pStream->pRing = NULL;
+    }
+}
+
+EVMU_EXPORT GblBool EvmuBuzzer_pcmStreaming(const EvmuBuzzer* pSelf) {
+    return EVMU_BUZZER_(pSelf)->stream.pRing != NULL;
+}
+
+EVMU_EXPORT size_t EvmuBuzzer_pcmStreamFrequency(const EvmuBuzzer* pSelf) {
+    return EVMU_BUZZER_(pSelf)->stream.frequency;
+}
+
+EVMU_EXPORT size_t EvmuBuzzer_pcmStreamAvailable(const EvmuBuzzer* pSelf) {
+    EvmuBuzzerStream_* pStream = &EVMU_BUZZER_(pSelf)->stream;
+
+    if(!pStream->pRing) return 0;
+
+    return atomic_load_explicit(&pStream->head, memory_order_acquire) -
+           atomic_load_explicit(&pStream->tail, memory_order_relaxed);
+}
+
+EVMU_EXPORT size_t EvmuBuzzer_pcmStreamDropped(const EvmuBuzzer* pSelf) {
+    return atomic_load_explicit(&EVMU_BUZZER_(pSelf)->stream.dropped, memory_order_relaxed);
+}
+
+EVMU_EXPORT size_t EvmuBuzzer_pullPcm(EvmuBuzzer* pSelf, void* pBuffer, size_t samples) {
+    EvmuBuzzerStream_* pStream = &EVMU_BUZZER_(pSelf)->stream;
+    uint8_t*           pOut    = pBuffer;
+    size_t             count   = 0;
+
+    if(pStream->pRing) {
+        const uint8_t* pRing = pStream->pRing->pData;
+        const size_t   tail  = atomic_load_explicit(&pStream->tail, memory_order_relaxed);
+        const size_t   head  = atomic_load_explicit(&pStream->head, memory_order_acquire);
+        const size_t   start = tail & pStream->mask;
+
+        count = head - tail;
+        if(count > samples) count = samples;
+
+        // Copy out in at most two spans around the wrap point
+        const size_t span  = pStream->mask + 1 - start;
+        const size_t first = (count < span)? count : span;
+        memcpy(pOut, &pRing[start], first);
+        memcpy(&pOut[first], pRing, count - first);
+
+        atomic_store_explicit(&pStream->tail, tail + count, memory_order_release);
+    }
+
+    // Pad an underrun with silence rather than stalling the audio thread
+    memset(&pOut[count], EVMU_BUZZER_STREAM_SILENCE, samples - count);
+
+    return count;
+}
+
+EVMU_EXPORT void EvmuBuzzer_pcmStreamCallback(void* pUserdata, uint8_t* pStream, int bytes) {
+    // Unchecked cast: type checking has no business on the audio thread
+    EvmuBuzzer_pullPcm((EvmuBuzzer*)pUserdata, pStream, bytes > 0? (size_t)bytes : 0);
+}
+
+static GblBool EvmuBuzzer_writeWavHeader_(FILE* pFile, size_t frequency, size_t samples) {
+    uint8_t header[EVMU_BUZZER_WAV_HEADER_SIZE_];
+    size_t  pos = 0;
+
+#define WAV_BYTES_(str) (memcpy(&header[pos], str, 4), pos += 4)
+#define WAV_U16_(value) (header[pos++] = (uint8_t)(value),          \
+                         header[pos++] = (uint8_t)((value) >> 8))
+#define WAV_U32_(value) (WAV_U16_((uint32_t)(value) & 0xffff),      \
+                         WAV_U16_((uint32_t)(value) >> 16))
+
+    WAV_BYTES_("RIFF");
+    WAV_U32_(EVMU_BUZZER_WAV_HEADER_SIZE_ - 8 + samples);
+    WAV_BYTES_("WAVE");
+    WAV_BYTES_("fmt ");
+    WAV_U32_(16);           // fmt chunk size
+    WAV_U16_(1);            // PCM
+    WAV_U16_(1);            // mono
+    WAV_U32_(frequency);    // sample rate
+    WAV_U32_(frequency);    // byte rate
+    WAV_U16_(1);            // block align
+    WAV_U16_(8);            // bits per sample
+    WAV_BYTES_("data");
+    WAV_U32_(samples);
+
+#undef WAV_U32_
+#undef WAV_U16_
+#undef WAV_BYTES_
+
+    GBL_ASSERT(pos == sizeof(header));
+
+    return fwrite(header, sizeof(header), 1, pFile) == 1;
+}
+
+static void EvmuBuzzer_beginRender_(EvmuBuzzerRender_* pRender, size_t frequency) {
+    pRender->used      = 0;
+    pRender->samples   = 0;
+    pRender->clock     = 0;
+    pRender->truncated = GBL_FALSE;
+    pRender->failed    = GBL_FALSE;
+    pRender->frequency = frequency;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuBuzzer_renderPcm(EvmuBuzzer* pSelf,
+                                             size_t      frequency,
+                                             void*       pBuffer,
+                                             size_t      samples) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuBuzzerRender_* pRender = &EVMU_BUZZER_(pSelf)->render;
+
+    GBL_CTX_VERIFY_POINTER(pBuffer);
+    GBL_CTX_VERIFY(frequency,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Cannot render PCM at 0Hz!");
+    GBL_CTX_VERIFY(!pRender->frequency,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "A PCM render is already in progress!");
+
+    pRender->pBuffer  = pBuffer;
+    pRender->capacity = samples;
+    EvmuBuzzer_beginRender_(pRender, frequency);
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuBuzzer_renderWav(EvmuBuzzer* pSelf,
+                                             size_t      frequency,
+                                             const char* pPath) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuBuzzerRender_* pRender = &EVMU_BUZZER_(pSelf)->render;
+
+    GBL_CTX_VERIFY_POINTER(pPath);
+    GBL_CTX_VERIFY(frequency && frequency <= UINT32_MAX,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Invalid WAV sample rate: [%zuHz]",
+                   frequency);
+    GBL_CTX_VERIFY(!pRender->frequency,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "A PCM render is already in progress!");
+
+    if(!pRender->pStaging)
+        pRender->pStaging = GblByteArray_create(EVMU_BUZZER_RENDER_STAGING_SIZE_);
+
+    GBL_CTX_VERIFY(pRender->pStaging,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate WAV staging buffer: [%d bytes]",
+                   EVMU_BUZZER_RENDER_STAGING_SIZE_);
+
+    EVMU_LOG_INFO("Rendering buzzer to WAV: [%s, %zuHz]", pPath, frequency);
+
+    GBL_CTX_VERIFY((pRender->pFile = fopen(pPath, "wb")),
+                   GBL_RESULT_ERROR_FILE_OPEN);
+
+    // Sizes are patched in by EvmuBuzzer_finishRender()
+    if(!EvmuBuzzer_writeWavHeader_(pRender->pFile, frequency, 0)) {
+        fclose(pRender->pFile);
+        pRender->pFile = NULL;
+        GBL_CTX_RECORD_SET(GBL_RESULT_ERROR_FILE_WRITE);
+        GBL_CTX_DONE();
+    }
+
+    pRender->pBuffer  = pRender->pStaging->pData;
+    pRender->capacity = pRender->pStaging->size;
+    EvmuBuzzer_beginRender_(pRender, frequency);
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuBuzzer_renderFor(EvmuBuzzer* pSelf, EvmuTicks ticks) {
+    GBL_CTX_BEGIN(pSelf);
+
+    GBL_CTX_VERIFY(EvmuBuzzer_rendering(pSelf),
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "No PCM render is in progress!");
+
+    // Exactly the emulated time requested, regardless of the device's speed or fast-forward/slow-motion
+    GBL_CTX_VERIFY_CALL(EvmuDevice__advance_(EvmuPeripheral_device(EVMU_PERIPHERAL(pSelf)), ticks));
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuBuzzer_finishRender(EvmuBuzzer* pSelf) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuBuzzerRender_* pRender = &EVMU_BUZZER_(pSelf)->render;
+
+    if(!pRender->frequency) GBL_CTX_DONE();
+
+    if(pRender->pFile) {
+        EvmuBuzzer_renderFlush_(pRender);
+
+        if(fseek(pRender->pFile, 0, SEEK_SET) ||
+           !EvmuBuzzer_writeWavHeader_(pRender->pFile, pRender->frequency, pRender->samples))
+            pRender->failed = GBL_TRUE;
+
+        if(fclose(pRender->pFile))
+            pRender->failed = GBL_TRUE;
+
+        pRender->pFile = NULL;
+    }
+
+    if(pRender->truncated)
+        EVMU_LOG_WARN("PCM render buffer overflowed: [%zu samples]", pRender->capacity);
+
+    EVMU_LOG_VERBOSE("Rendered %zu PCM samples.", pRender->samples);
+
+    pRender->frequency = 0;
+    pRender->pBuffer   = NULL;
+    pRender->capacity  = 0;
+    pRender->used      = 0;
+
+    GBL_CTX_VERIFY(!pRender->failed,
+                   GBL_RESULT_ERROR_FILE_WRITE,
+                   "Failed to write rendered WAV file!");
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT GblBool EvmuBuzzer_rendering(const EvmuBuzzer* pSelf) {
+    return EVMU_BUZZER_(pSelf)->render.frequency != 0;
+}
+
+EVMU_EXPORT size_t EvmuBuzzer_renderedSamples(const EvmuBuzzer* pSelf) {
+    return EVMU_BUZZER_(pSelf)->render.samples;
+}
+
 static EVMU_RESULT EvmuBuzzer_playPcm_(EvmuBuzzer* pSelf) {
     GBL_CTX_BEGIN(NULL);
     GBL_CTX_VERIFY_CALL(GblSignal_emit(GBL_INSTANCE(pSelf), "toneStart"));
@@ -292,6 +699,22 @@ static GBL_RESULT EvmuBuzzer_IBehavior_reset_(EvmuIBehavior* pIBehavior) {
     GBL_CTX_END();
 }
 
+static GBL_RESULT EvmuBuzzer_GblBox_destructor_(GblBox* pBox) {
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuBuzzer_* pSelf_ = EVMU_BUZZER_(pBox);
+
+    EvmuBuzzer_stopPcmStream(EVMU_BUZZER(pBox));
+    EvmuBuzzer_finishRender(EVMU_BUZZER(pBox));
+
+    if(pSelf_->render.pStaging)
+        GblByteArray_unref(pSelf_->render.pStaging);
+
+    GBL_VCALL_DEFAULT(EvmuPeripheral, base.base.pFnDestructor, pBox);
+
+    GBL_CTX_END();
+}
+
 static GBL_RESULT EvmuBuzzer_GblObject_constructed_(GblObject* pObject) {
     GBL_CTX_BEGIN(NULL);
 
@@ -308,6 +731,32 @@ static GBL_RESULT EvmuBuzzer_GblObject_constructed_(GblObject* pObject) {
     GBL_CTX_END();
 }
 
+// Streaming and offline rendering belong to the host, so only the tone and PCM buffer are saved
+static EVMU_RESULT EvmuBuzzer_state_(EvmuBuzzer* pSelf, EvmuStateBuffer* pBuffer) {
+    EvmuBuzzer_* pSelf_ = EVMU_BUZZER_(pSelf);
+    const size_t start  = EvmuIBehavior__beginSection_(pBuffer, EVMU_BUZZER__STATE_TAG_, EVMU_BUZZER__STATE_VERSION_);
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->pcmBuffer);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->enabled);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->active);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->tonePeriod);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->toneInvPulseLength);
+    EvmuIBehavior__size_(pBuffer, &pSelf_->pcmSamples);
+    EvmuIBehavior__size_(pBuffer, &pSelf_->pcmFrequency);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf->pcmChanged);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf->enableFreqResp);
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+static EVMU_RESULT EvmuBuzzer_IBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuBuzzer_state_(EVMU_BUZZER(pSelf), pBuffer);
+}
+
+static EVMU_RESULT EvmuBuzzer_IBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuBuzzer_state_(EVMU_BUZZER(pSelf), pBuffer);
+}
+
 static GBL_RESULT EvmuBuzzerClass_init_(GblClass* pClass, const void* pUd) {
     GBL_UNUSED(pUd);
     GBL_CTX_BEGIN(NULL);
@@ -333,8 +782,11 @@ static GBL_RESULT EvmuBuzzerClass_init_(GblClass* pClass, const void* pUd) {
                           GBL_UINT8_TYPE);
     }
 
+    GBL_BOX_CLASS(pClass)       ->pFnDestructor  = EvmuBuzzer_GblBox_destructor_;
     GBL_OBJECT_CLASS(pClass)    ->pFnConstructed = EvmuBuzzer_GblObject_constructed_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnReset       = EvmuBuzzer_IBehavior_reset_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState   = EvmuBuzzer_IBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState   = EvmuBuzzer_IBehavior_loadState_;
     EVMU_BUZZER_CLASS(pClass)   ->pFnPlayPcm     = EvmuBuzzer_playPcm_;
     EVMU_BUZZER_CLASS(pClass)   ->pFnStopPcm     = EvmuBuzzer_stopPcm_;
     EVMU_BUZZER_CLASS(pClass)   ->pFnBufferPcm   = EvmuBuzzer_bufferPcm_;
@@ -2,27 +2,71 @@
 #define EVMU_BUZZER__H
 
 #include <evmu/hw/evmu_buzzer.h>
+#include <gimbal/utils/gimbal_byte_array.h>
+#include <stdatomic.h>
+#include <stdio.h>
 
 #define EVMU_BUZZER_(instance)      (GBL_PRIVATE(EvmuBuzzer, instance))
 #define EVMU_BUZZER_PUBLIC_(priv)   (GBL_PUBLIC(EvmuBuzzer, priv))
 
+#define EVMU_BUZZER__STATE_TAG_     EVMU_IBEHAVIOR__STATE_TAG_('B', 'U', 'Z', 'Z')
+#define EVMU_BUZZER__STATE_VERSION_ 1
+
 GBL_DECLS_BEGIN
 
 GBL_FORWARD_DECLARE_STRUCT(EvmuRam_);
+GBL_FORWARD_DECLARE_STRUCT(EvmuClock_);
+
+// Single-producer (emulation), single-consumer (audio) PCM ring
+GBL_DECLARE_STRUCT(EvmuBuzzerStream_) {
+    GblByteArray* pRing;
+    size_t        mask;
+    atomic_size_t head;      // written only by the emulation thread
+    atomic_size_t tail;      // written only by the audio thread
+    atomic_size_t dropped;
+    size_t        frequency;
+    uint64_t      clock;     // integer sample clock (clock ticks * Hz)
+};
+
+// Offline renderer into a caller's buffer or a WAV file's staging buffer
+GBL_DECLARE_STRUCT(EvmuBuzzerRender_) {
+    uint8_t*      pBuffer;
+    size_t        capacity;
+    size_t        used;
+    size_t        samples;
+    size_t        frequency; // 0 while not rendering
+    uint64_t      clock;
+    FILE*         pFile;
+    GblByteArray* pStaging;
+    GblBool       truncated;
+    GblBool       failed;
+};
+
+// Square wave state of the buzzer output at a given T1L value
+GBL_DECLARE_STRUCT(EvmuBuzzerWave_) {
+    int     period;
+    int     invPulse;
+    int     phase;
+    GblBool playing;
+};
 
 GBL_DECLARE_STRUCT(EvmuBuzzer_) {
     uint8_t      pcmBuffer[EVMU_BUZZER_PCM_BUFFER_SIZE];
     EvmuRam_*    pRam;
+    EvmuClock_*  pClock;
     GblBool      enabled;
     GblBool      active;
     uint16_t     tonePeriod;
     uint8_t      toneInvPulseLength;
     size_t       pcmSamples;
     size_t       pcmFrequency;
+    EvmuBuzzerStream_ stream;
+    EvmuBuzzerRender_ render;
 };
 
 void EvmuBuzzer__memorySink_        (EvmuBuzzer_* pSelf_, EvmuAddress address, EvmuWord value);
 void EvmuBuzzer__timer1Mode1Reload_ (EvmuBuzzer_* pSelf_);
+void EvmuBuzzer__pcmAdvance_        (EvmuBuzzer_* pSelf_, int t1l, int cycles);
 
 GBL_DECLS_END
 
@@ -5,6 +5,7 @@
 #include "evmu_device_.h"
 #include "evmu_ram_.h"
 #include "evmu_clock_.h"
+#include "../types/evmu_ibehavior_.h"
 
 #define EVMU_CLOCK_OSC_QUARTZ_STABILIZATION_TIME
 #if 0
@@ -446,12 +447,31 @@ static GBL_RESULT EvmuClock_destructor_(GblBox* pSelf) {
 }
 
 
+static EVMU_RESULT EvmuClock_state_(EvmuClock* pSelf, EvmuStateBuffer* pBuffer) {
+    EvmuClock_*  pSelf_ = EVMU_CLOCK_(pSelf);
+    const size_t start  = EvmuIBehavior__beginSection_(pBuffer, EVMU_CLOCK__STATE_TAG_, EVMU_CLOCK__STATE_VERSION_);
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->signals);
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+static EVMU_RESULT EvmuClock_IBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuClock_state_(EVMU_CLOCK(pSelf), pBuffer);
+}
+
+static EVMU_RESULT EvmuClock_IBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuClock_state_(EVMU_CLOCK(pSelf), pBuffer);
+}
+
 static GBL_RESULT EvmuClockClass_init_(GblClass* pClass, const void* pData) {
     GBL_UNUSED(pData);
     GBL_CTX_BEGIN(NULL);
 
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnReset          = EvmuClock_reset_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnUpdate         = EvmuClock_update_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState      = EvmuClock_IBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState      = EvmuClock_IBehavior_loadState_;
     EVMU_PERIPHERAL_CLASS(pClass)->pFnMemoryEvent   = EvmuClock_memoryEvent_;
     GBL_OBJECT_CLASS(pClass)->pFnConstructor        = EvmuClock_constructor_;
     GBL_BOX_CLASS(pClass)->pFnDestructor            = EvmuClock_destructor_;
@@ -8,6 +8,9 @@
 #define EVMU_CLOCK_(instance)     (GBL_PRIVATE(EvmuClock, instance))
 #define EVMU_CLOCK_PUBLIC_(priv)  (GBL_PUBLIC(EvmuClock, priv))
 
+#define EVMU_CLOCK__STATE_TAG_     EVMU_IBEHAVIOR__STATE_TAG_('C', 'L', 'K', ' ')
+#define EVMU_CLOCK__STATE_VERSION_ 1
+
 #define GBL_SELF_TYPE EvmuClock_
 
 GBL_DECLS_BEGIN
@@ -9,8 +9,10 @@
 #include "evmu_pic_.h"
 #include "evmu_gamepad_.h"
 #include "evmu_timers_.h"
+#include "evmu_sio_.h"
 #include "evmu_flash_.h"
 #include "../types/evmu_peripheral_.h"
+#include "../types/evmu_ibehavior_.h"
 #include <gimbal/meta/signals/gimbal_marshal.h>
 
 EVMU_EXPORT EvmuPc EvmuCpu_pc(const EvmuCpu* pSelf) {
@@ -81,6 +83,10 @@ EVMU_EXPORT size_t EvmuCpu_cycles(const EvmuCpu* pSelf) {
 }
 
 
+EVMU_EXPORT uint64_t EvmuCpu_instructions(const EvmuCpu* pSelf) {
+    return EVMU_CPU_(pSelf)->instructions;
+}
+
 EVMU_EXPORT EVMU_RESULT EvmuCpu_execute(EvmuCpu* pSelf, const EvmuDecodedInstruction* pInstr) {
     GBL_CTX_BEGIN(NULL);
     GBL_VCALL(EvmuCpu, pFnExecute, pSelf, pInstr);
@@ -134,6 +140,7 @@ static EVMU_RESULT EvmuCpu_runNext_(EvmuCpu* pSelf) {
 
     //Execute instructions
     GBL_VCALL(EvmuCpu, pFnExecute, pSelf, &pSelf_->curInstr.decoded);
+    ++pSelf_->instructions;
 
     //Check if we entered the firmware
     if(EvmuRom_biosActive(pRom)) {
@@ -572,10 +579,12 @@ static EVMU_RESULT EvmuCpu_IBehavior_update_(EvmuIBehavior* pIBehav, EvmuTicks t
     GBL_CTX_BEGIN(NULL);
 
     EvmuCpu*     pSelf    = EVMU_CPU(pIBehav);
+    EvmuCpu_*    pSelf_   = EVMU_CPU_(pSelf);
     EvmuDevice*  pDevice  = EvmuPeripheral_device(EVMU_PERIPHERAL(pIBehav));
     EvmuDevice_* pDevice_ = EVMU_DEVICE_(pDevice);
     //do timing in time domain, so when clock frequency changes, it's automatically handled
-    double time = 0.0;
+    // Instructions don't end on update boundaries, so start out behind by however far the last one overran
+    double time = pSelf_->overshoot;
     double deltaTime = (double)ticks / 1000000000.0;
 
     EvmuIBehavior_update(EVMU_IBEHAVIOR(pDevice->pGamepad), ticks);
@@ -583,6 +592,7 @@ static EVMU_RESULT EvmuCpu_IBehavior_update_(EvmuIBehavior* pIBehav, EvmuTicks t
     while(time < deltaTime) {
         EvmuPic_update(EVMU_PIC_PUBLIC_(pDevice_->pPic));
         EvmuTimers_update(EVMU_TIMERS_PUBLIC_(pDevice_->pTimers));
+        EvmuSio_update(EVMU_SIO_PUBLIC_(pDevice_->pSio));
         if(!(pDevice_->pRam->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_PCON)] & EVMU_SFR_PCON_HALT_MASK))
             EvmuCpu_runNext(pSelf);
 
@@ -592,6 +602,8 @@ static EVMU_RESULT EvmuCpu_IBehavior_update_(EvmuIBehavior* pIBehav, EvmuTicks t
 
     }
 
+    pSelf_->overshoot = time - deltaTime;
+
     GBL_CTX_END();
 }
 
@@ -605,10 +617,41 @@ static GBL_RESULT EvmuCpu_IBehavior_reset_(EvmuIBehavior* pSelf) {
     memset(&EVMU_CPU_(pSelf)->curInstr.encoded, 0, sizeof(EvmuInstruction));
     memset(&EVMU_CPU_(pSelf)->curInstr.decoded, 0, sizeof(EvmuInstruction));
     EVMU_CPU_(pSelf)->curInstr.pFormat = EvmuIsa_format(EVMU_OPCODE_NOP);
+    EVMU_CPU_(pSelf)->overshoot        = 0.0;
 
     GBL_CTX_END();
 }
 
+static EVMU_RESULT EvmuCpu_state_(EvmuCpu* pSelf, EvmuStateBuffer* pBuffer) {
+    EvmuCpu_*    pSelf_ = EVMU_CPU_(pSelf);
+    const size_t start  = EvmuIBehavior__beginSection_(pBuffer, EVMU_CPU__STATE_TAG_, EVMU_CPU__STATE_VERSION_);
+    uint8_t      flags  = pSelf->halted | (pSelf->haltAfterNext << 1) | (pSelf->pcChanged << 2);
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->pc);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->instructions);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->overshoot);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->curInstr.encoded);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->curInstr.decoded);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, flags);
+
+    if(pBuffer->loading) {
+        pSelf_->curInstr.pFormat = EvmuIsa_format(pSelf_->curInstr.encoded.bytes[EVMU_INSTRUCTION_BYTE_OPCODE]);
+        pSelf->halted            = flags & 0x1;
+        pSelf->haltAfterNext     = (flags >> 1) & 0x1;
+        pSelf->pcChanged         = (flags >> 2) & 0x1;
+    }
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+static EVMU_RESULT EvmuCpu_IBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuCpu_state_(EVMU_CPU(pSelf), pBuffer);
+}
+
+static EVMU_RESULT EvmuCpu_IBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuCpu_state_(EVMU_CPU(pSelf), pBuffer);
+}
+
 static GBL_RESULT EvmuCpu_GblObject_setProperty_(GblObject* pObject, const GblProperty* pProp, GblVariant* pValue) {
     GBL_CTX_BEGIN(NULL);
 
@@ -680,6 +723,8 @@ static GBL_RESULT EvmuCpuClass_init_(GblClass* pClass, const void* pData) {
     GBL_OBJECT_CLASS(pClass)    ->pFnSetProperty = EvmuCpu_GblObject_setProperty_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnUpdate      = EvmuCpu_IBehavior_update_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnReset       = EvmuCpu_IBehavior_reset_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState   = EvmuCpu_IBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState   = EvmuCpu_IBehavior_loadState_;
     EVMU_CPU_CLASS(pClass)      ->pFnFetch       = EvmuCpu_fetch_;
     EVMU_CPU_CLASS(pClass)      ->pFnDecode      = EvmuCpu_decode_;
     EVMU_CPU_CLASS(pClass)      ->pFnExecute     = EvmuCpu_execute_;
@@ -6,6 +6,9 @@
 #define EVMU_CPU_(instance)     (GBL_PRIVATE(EvmuCpu, instance))
 #define EVMU_CPU_PUBLIC_(priv)  (GBL_PUBLIC(EvmuCpu, priv))
 
+#define EVMU_CPU__STATE_TAG_     EVMU_IBEHAVIOR__STATE_TAG_('C', 'P', 'U', ' ')
+#define EVMU_CPU__STATE_VERSION_ 1
+
 #define GBL_SELF_TYPE EvmuCpu_
 
 GBL_DECLS_BEGIN
@@ -34,6 +37,8 @@ typedef struct EvmuCpu_ {
     EvmuRam_*       pRam;
 
     uint16_t        pc;
+    uint64_t        instructions;
+    double          overshoot;  // secs the last update ran past its end, owed by the next
 
     struct {
         EvmuInstruction                 encoded;
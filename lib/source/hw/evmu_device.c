@@ -16,16 +16,94 @@
 #include "evmu_buzzer_.h"
 #include "evmu_gamepad_.h"
 #include "evmu_timers_.h"
+#include "evmu_sio_.h"
 #include "evmu_rom_.h"
 #include "evmu_pic_.h"
 #include "evmu_flash_.h"
 #include "evmu_wram_.h"
+#include "evmu_rewind_.h"
+#include "evmu_movie_.h"
+#include "evmu_hash_.h"
 #include "../fs/evmu_fat_.h"
+#include "../types/evmu_ibehavior_.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
 
 EVMU_EXPORT EvmuDevice* EvmuDevice_create(void) {
     return GBL_NEW(EvmuDevice);
 }
 
+EVMU_EXPORT EvmuDevice* EvmuDevice_createWithFlags(EVMU_DEVICE_INIT_FLAGS flags) {
+    return GBL_NEW(EvmuDevice,
+                   "initFlags", flags);
+}
+
+/* Everything but storage goes through an external state, so a clone picks up the same fields
+ * a save state does. Flash and ROM are shared afterwards, so that loading doesn't have to copy
+ * them first, and stay shared until either side writes to them. */
+static EVMU_RESULT EvmuDevice_cloneState_(EvmuDevice* pDst, const EvmuDevice* pSrc) {
+    uint8_t* pState    = NULL;
+    size_t   stateSize = 0;
+
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuDevice_* pDst_ = EVMU_DEVICE_(pDst);
+    EvmuDevice_* pSrc_ = EVMU_DEVICE_(pSrc);
+
+    EvmuIBehavior__saveExternal_(EVMU_IBEHAVIOR(pSrc), NULL, 0, &stateSize);
+
+    GBL_CTX_VERIFY((pState = malloc(stateSize)),
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate state to clone: [%zu bytes]",
+                   stateSize);
+
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior__saveExternal_(EVMU_IBEHAVIOR(pSrc), pState, stateSize, &stateSize));
+    // A clone that fails to load is destroyed, so there's nothing to roll back
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior__loadTrusted_(EVMU_IBEHAVIOR(pDst), pState, stateSize));
+
+    GBL_CTX_VERIFY_CALL(EvmuFlash__share_(pDst_->pFlash, pSrc_->pFlash));
+    EvmuRom__share_(pDst_->pRom, pSrc_->pRom);
+
+    memcpy(pDst_->pWram->pStorage->pData,
+           pSrc_->pWram->pStorage->pData,
+           pSrc_->pWram->pStorage->size);
+
+    // How the device was asked to initialize isn't part of its state
+    pDst_->initFlags = pSrc_->initFlags;
+
+    GBL_CTX_END_BLOCK();
+
+    free(pState);
+    return GBL_CTX_RESULT();
+}
+
+EVMU_EXPORT EvmuDevice* EvmuDevice_clone(const EvmuDevice* pSelf) {
+    EvmuDevice* pClone = NULL;
+
+    GBL_CTX_BEGIN(NULL);
+    GBL_CTX_VERIFY_POINTER(pSelf);
+
+    // Formatting and resetting would only be overwritten by the copied state
+    pClone = EvmuDevice_createWithFlags(EVMU_DEVICE_INIT_LIGHTWEIGHT);
+
+    GBL_CTX_VERIFY(pClone,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to create device to clone into!");
+
+    GBL_CTX_VERIFY_CALL(EvmuDevice_cloneState_(pClone, pSelf));
+
+    GBL_CTX_END_BLOCK();
+
+    if(GBL_RESULT_ERROR(GBL_CTX_RESULT()) && pClone) {
+        GBL_UNREF(pClone);
+        pClone = NULL;
+    }
+
+    return pClone;
+}
+
 EVMU_EXPORT EvmuDevice* EvmuDevice_ref(const EvmuDevice* pSelf) {
     return EVMU_DEVICE(GBL_REF(pSelf));
 }
@@ -43,6 +121,9 @@ static GBL_RESULT EvmuDevice_constructor_(GblObject* pSelf) {
     // Call parent constructor
     GBL_VCALL_DEFAULT(GblObject, pFnConstructor, pSelf);
 
+    pSelf_->speed      = 1.0;
+    pSelf_->turboSlice = EVMU_DEVICE__TURBO_SLICE_;
+
     // Create peripherals
     pDevice->pRam     = GBL_NEW(EvmuRam,
                                 "parent", pSelf);
@@ -68,6 +149,9 @@ static GBL_RESULT EvmuDevice_constructor_(GblObject* pSelf) {
     pDevice->pTimers  = GBL_NEW(EvmuTimers,
                                 "parent", pSelf);
 
+    pDevice->pSio     = GBL_NEW(EvmuSio,
+                                "parent", pSelf);
+
     pDevice->pRom     = GBL_NEW(EvmuRom,
                                 "parent", pSelf);
 
@@ -89,6 +173,7 @@ static GBL_RESULT EvmuDevice_constructor_(GblObject* pSelf) {
     pSelf_->pBuzzer  = EVMU_BUZZER_(pDevice->pBuzzer);
     pSelf_->pGamepad = EVMU_GAMEPAD_(pDevice->pGamepad);
     pSelf_->pTimers  = EVMU_TIMERS_(pDevice->pTimers);
+    pSelf_->pSio     = EVMU_SIO_(pDevice->pSio);
     pSelf_->pRom     = EVMU_ROM_(pDevice->pRom);
     pSelf_->pPic     = EVMU_PIC_(pDevice->pPic);
     pSelf_->pFlash   = EVMU_FLASH_(pDevice->pFlash);
@@ -104,19 +189,209 @@ static GBL_RESULT EvmuDevice_constructor_(GblObject* pSelf) {
     pSelf_->pLcd->pRam       = pSelf_->pRam;
     pSelf_->pBattery->pRam   = pSelf_->pRam;
     pSelf_->pBuzzer->pRam    = pSelf_->pRam;
+    pSelf_->pBuzzer->pClock  = pSelf_->pClock;
     pSelf_->pGamepad->pRam   = pSelf_->pRam;
     pSelf_->pTimers->pRam    = pSelf_->pRam;
     pSelf_->pTimers->pBuzzer = pSelf_->pBuzzer;
+    pSelf_->pSio->pRam       = pSelf_->pRam;
     pSelf_->pRom->pRam       = pSelf_->pRam;
     pSelf_->pPic->pRam       = pSelf_->pRam;
     pSelf_->pFat->pRam       = pSelf_->pRam;
     pSelf_->pWram->pRam      = pSelf_->pRam;
 
-    //!\todo move this to EvmuFat
-    GBL_CTX_CALL(EvmuFat_format(pDevice->pFat, NULL));
-    EvmuFat_log(pDevice->pFat);
+    // Index peripherals for constant-time lookups, in creation order
+    EvmuPeripheral* pPeripherals[] = {
+        EVMU_PERIPHERAL(pDevice->pRam),
+        EVMU_PERIPHERAL(pDevice->pCpu),
+        EVMU_PERIPHERAL(pDevice->pClock),
+        EVMU_PERIPHERAL(pDevice->pLcd),
+        EVMU_PERIPHERAL(pDevice->pBattery),
+        EVMU_PERIPHERAL(pDevice->pBuzzer),
+        EVMU_PERIPHERAL(pDevice->pGamepad),
+        EVMU_PERIPHERAL(pDevice->pTimers),
+        EVMU_PERIPHERAL(pDevice->pSio),
+        EVMU_PERIPHERAL(pDevice->pRom),
+        EVMU_PERIPHERAL(pDevice->pPic),
+        EVMU_PERIPHERAL(pDevice->pFileMgr),
+        EVMU_PERIPHERAL(pDevice->pWram)
+    };
+
+    for(size_t p = 0; p < GBL_COUNT_OF(pPeripherals); ++p)
+        GBL_CTX_VERIFY_CALL(EvmuDevice__registerPeripheral_(pSelf_, pPeripherals[p]));
+
+    GBL_CTX_END();
+}
+
+// Moves ROM, flash, and WRAM storage into one contiguous block, hottest first
+static EVMU_RESULT EvmuDevice_adoptArena_(EvmuDevice_* pSelf_) {
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuStorage_** ppStorages[] = {
+        &pSelf_->pRom->pStorage,
+        &pSelf_->pFlash->pStorage,
+        &pSelf_->pWram->pStorage
+    };
+
+    size_t capacity = 0;
+    for(size_t s = 0; s < GBL_COUNT_OF(ppStorages); ++s)
+        capacity += EvmuArena__footprint_((*ppStorages[s])->size);
+
+    EvmuArena_* pArena = EvmuArena__create_(capacity);
+
+    GBL_CTX_VERIFY(pArena,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate device arena: [%zu bytes]",
+                   capacity);
+
+    for(size_t s = 0; s < GBL_COUNT_OF(ppStorages); ++s) {
+        EvmuStorage_* pOld = *ppStorages[s];
+        EvmuStorage_* pNew = EvmuArena__storage_(pArena, pOld->size);
 
-    GBL_CTX_VERIFY_CALL(EvmuIBehavior_reset(EVMU_IBEHAVIOR(pSelf)));
+        memcpy(pNew->pData, pOld->pData, pOld->size);
+
+        if(pSelf_->pRam->pExt == pOld->pData)
+            pSelf_->pRam->pExt = pNew->pData;
+
+        *ppStorages[s] = pNew;
+        EvmuStorage__unref_(pOld);
+    }
+
+    // Storages now own the block, which is freed along with the last of them
+    EvmuArena__release_(pArena);
+
+    GBL_CTX_END();
+}
+
+static GBL_RESULT EvmuDevice_GblObject_constructed_(GblObject* pSelf) {
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_VCALL_DEFAULT(GblObject, pFnConstructed, pSelf);
+
+    EvmuDevice_* pSelf_ = EVMU_DEVICE_(pSelf);
+
+    if(pSelf_->initFlags & EVMU_DEVICE_INIT_ARENA)
+        GBL_CTX_VERIFY_CALL(EvmuDevice_adoptArena_(pSelf_));
+
+    // Anything not explicitly deferred is performed right away
+    pSelf_->pendingInit = EVMU_DEVICE_INIT_DEFER_FORMAT | EVMU_DEVICE_INIT_DEFER_RESET;
+
+    GBL_CTX_VERIFY_CALL(EvmuDevice__finishInit_(pSelf_,
+                                                ~pSelf_->initFlags));
+    GBL_CTX_END();
+}
+
+EVMU_RESULT EvmuDevice__finishInit_(EvmuDevice_* pSelf_, EVMU_DEVICE_INIT_FLAGS mask) {
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuDevice* pSelf = EVMU_DEVICE_PUBLIC_(pSelf_);
+
+    if(pSelf_->pendingInit & mask & EVMU_DEVICE_INIT_DEFER_FORMAT) {
+        pSelf_->pendingInit &= ~EVMU_DEVICE_INIT_DEFER_FORMAT;
+
+        // Deferred formatting must not clobber an image loaded in the meantime
+        if(!(pSelf_->initFlags & EVMU_DEVICE_INIT_DEFER_FORMAT) ||
+           !EvmuFat_isFormatted(pSelf->pFat))
+        {
+            //!\todo move this to EvmuFat
+            GBL_CTX_CALL(EvmuFat_format(pSelf->pFat, NULL));
+
+            if(!(pSelf_->initFlags & EVMU_DEVICE_INIT_QUIET))
+                EvmuFat_log(pSelf->pFat);
+        }
+    }
+
+    if(pSelf_->pendingInit & mask & EVMU_DEVICE_INIT_DEFER_RESET)
+        GBL_CTX_VERIFY_CALL(EvmuIBehavior_reset(EVMU_IBEHAVIOR(pSelf)));
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_DEVICE_INIT_FLAGS EvmuDevice_initFlags(const EvmuDevice* pSelf) {
+    return EVMU_DEVICE_(pSelf)->initFlags;
+}
+
+EVMU_EXPORT EVMU_DEVICE_INIT_FLAGS EvmuDevice_pendingInit(const EvmuDevice* pSelf) {
+    return EVMU_DEVICE_(pSelf)->pendingInit;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_finishInit(EvmuDevice* pSelf) {
+    return EvmuDevice__finishInit_(EVMU_DEVICE_(pSelf), EVMU_DEVICE_INIT_LIGHTWEIGHT);
+}
+
+static GBL_RESULT EvmuDevice_GblObject_setProperty_(GblObject* pObject, const GblProperty* pProp, GblVariant* pValue) {
+    GBL_CTX_BEGIN(NULL);
+
+    switch(pProp->id) {
+    case EvmuDevice_Property_Id_initFlags:
+        EVMU_DEVICE_(pObject)->initFlags = GblVariant_toFlags(pValue);
+        break;
+    default:
+        GBL_CTX_RECORD_SET(GBL_RESULT_ERROR_INVALID_PROPERTY,
+                           "Attempt to write unknown EvmuDevice property: [%s]",
+                           GblProperty_nameString(pProp));
+        break;
+    }
+
+    GBL_CTX_END();
+}
+
+static GBL_RESULT EvmuDevice_GblObject_property_(const GblObject* pObject, const GblProperty* pProp, GblVariant* pValue) {
+    GBL_CTX_BEGIN(NULL);
+
+    const EvmuDevice* pSelf = EVMU_DEVICE(pObject);
+
+    switch(pProp->id) {
+    case EvmuDevice_Property_Id_memory:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pRam));
+        break;
+    case EvmuDevice_Property_Id_cpu:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pCpu));
+        break;
+    case EvmuDevice_Property_Id_clock:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pClock));
+        break;
+    case EvmuDevice_Property_Id_pic:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pPic));
+        break;
+    case EvmuDevice_Property_Id_rom:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pRom));
+        break;
+    case EvmuDevice_Property_Id_flash:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pFlash));
+        break;
+    case EvmuDevice_Property_Id_wram:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pWram));
+        break;
+    case EvmuDevice_Property_Id_lcd:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pLcd));
+        break;
+    case EvmuDevice_Property_Id_buzzer:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pBuzzer));
+        break;
+    case EvmuDevice_Property_Id_battery:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pBattery));
+        break;
+    case EvmuDevice_Property_Id_gamepad:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pGamepad));
+        break;
+    case EvmuDevice_Property_Id_timers:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pTimers));
+        break;
+    case EvmuDevice_Property_Id_sio:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pSio));
+        break;
+    case EvmuDevice_Property_Id_fat:
+        GblVariant_setObjectCopy(pValue, GBL_OBJECT(pSelf->pFat));
+        break;
+    case EvmuDevice_Property_Id_initFlags:
+        GblVariant_setFlags(pValue, EvmuDevice_initFlags(pSelf), GBL_FLAGS_TYPE);
+        break;
+    default:
+        GBL_CTX_RECORD_SET(GBL_RESULT_ERROR_INVALID_PROPERTY,
+                           "Attempt to read unknown EvmuDevice property: [%s]",
+                           GblProperty_nameString(pProp));
+        break;
+    }
 
     GBL_CTX_END();
 }
@@ -134,11 +409,16 @@ static GBL_RESULT EvmuDevice_destructor_(GblBox* pSelf) {
     GBL_UNREF(pDevice->pBuzzer);
     GBL_UNREF(pDevice->pGamepad);
     GBL_UNREF(pDevice->pTimers);
+    GBL_UNREF(pDevice->pSio);
     GBL_UNREF(pDevice->pRom);
     GBL_UNREF(pDevice->pPic);
     GBL_UNREF(pDevice->pFlash);
     GBL_UNREF(pDevice->pWram);
 
+    EvmuRewind__destroy_(EVMU_DEVICE_(pDevice)->pRewind);
+    EvmuMovie__destroy_(EVMU_DEVICE_(pDevice)->pMovie);
+    EvmuHashCache__destroy_(EVMU_DEVICE_(pDevice)->pHash);
+
     GBL_VCALL_DEFAULT(GblObject, base.pFnDestructor, pSelf);
     GBL_CTX_END();
 }
@@ -146,69 +426,367 @@ static GBL_RESULT EvmuDevice_destructor_(GblBox* pSelf) {
 static GBL_RESULT EvmuDevice_reset_(EvmuIBehavior* pIBehavior) {
     GBL_CTX_BEGIN(NULL);
     GBL_VCALL_DEFAULT(EvmuIBehavior, pFnReset, pIBehavior);
+    EVMU_DEVICE_(pIBehavior)->pendingInit &= ~EVMU_DEVICE_INIT_DEFER_RESET;
+
+    if(EVMU_DEVICE_(pIBehavior)->pRewind)
+        EvmuRewind__restart_(EVMU_DEVICE_(pIBehavior)->pRewind);
+
+    // The input stream can't represent the jump
+    if(EVMU_DEVICE_(pIBehavior)->pMovie)
+        EVMU_DEVICE_(pIBehavior)->pMovie->recording = GBL_FALSE;
     //EvmuPic_raiseIrq(EVMU_DEVICE(pIBehavior)->pPic, EVMU_IRQ_RESET);
     GBL_CTX_END();
 }
 
+GBL_RESULT EvmuDevice__advance_(EvmuDevice* pSelf, EvmuTicks ticks) {
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuDevice_* pSelf_ = EVMU_DEVICE_(pSelf);
+
+    // First use of a lightweight device completes its construction
+    if(pSelf_->pendingInit)
+        GBL_CTX_VERIFY_CALL(EvmuDevice__finishInit_(pSelf_, EVMU_DEVICE_INIT_LIGHTWEIGHT));
+
+    // A playing .LCD animation takes over the display, so don't run the CPU beneath it
+    if(EvmuLcd_animationState(pSelf->pLcd) == EVMU_LCD_ANIMATION_STATE_PLAYING) {
+        // The LCD counts microseconds, so carry what's left over rather than losing it every step
+        const EvmuTicks lcdTicks = pSelf_->lcdRemainder + ticks;
+
+        pSelf_->lcdRemainder = lcdTicks % 1000;
+        EvmuIBehavior_update(EVMU_IBEHAVIOR(pSelf->pLcd), lcdTicks / 1000);
+    } else
+        EvmuIBehavior_update(EVMU_IBEHAVIOR(pSelf->pCpu), ticks);
+
+    pSelf_->emulatedTicks += ticks;
+
+    if(pSelf_->pRewind)
+        EvmuRewind__record_(pSelf_->pRewind, ticks);
+
+    if(pSelf_->pMovie && pSelf_->pMovie->recording)
+        EvmuMovie__record_(pSelf_->pMovie, ticks, EvmuGamepad__buttons_(pSelf->pGamepad));
+
+    GBL_CTX_END();
+}
+
+// Pending deferred work is saved too, since it would otherwise clobber the loaded state
+static EVMU_RESULT EvmuDevice_state_(EvmuDevice* pSelf, EvmuStateBuffer* pBuffer) {
+    EvmuDevice_* pSelf_ = EVMU_DEVICE_(pSelf);
+    const size_t start  = EvmuIBehavior__beginSection_(pBuffer, EVMU_DEVICE__STATE_TAG_, EVMU_DEVICE__STATE_VERSION_);
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->remainingTicks);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->pendingInit);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->speed);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->speedRemainder);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->emulatedTicks);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->lcdRemainder);
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+// Followed by each peripheral's own section, in the order they were constructed
+static GBL_RESULT EvmuDevice_saveState_(const EvmuIBehavior* pIBehavior, EvmuStateBuffer* pBuffer) {
+    GBL_CTX_BEGIN(NULL);
+    GBL_CTX_VERIFY_CALL(EvmuDevice_state_(EVMU_DEVICE(pIBehavior), pBuffer));
+    GBL_VCALL_DEFAULT(EvmuIBehavior, pFnSaveState, pIBehavior, pBuffer);
+    GBL_CTX_END();
+}
+
+static GBL_RESULT EvmuDevice_loadState_(EvmuIBehavior* pIBehavior, EvmuStateBuffer* pBuffer) {
+    GBL_CTX_BEGIN(NULL);
+    GBL_CTX_VERIFY_CALL(EvmuDevice_state_(EVMU_DEVICE(pIBehavior), pBuffer));
+    GBL_VCALL_DEFAULT(EvmuIBehavior, pFnLoadState, pIBehavior, pBuffer);
+
+    // Rolling back a rejected load returns the device to where it already was
+    if(pBuffer->restoring)
+        GBL_CTX_DONE();
+
+    // Recorded history leads up to a state the device is no longer in
+    if(EVMU_DEVICE_(pIBehavior)->pRewind)
+        EvmuRewind__restart_(EVMU_DEVICE_(pIBehavior)->pRewind);
+
+    // The input stream can't represent the jump
+    if(EVMU_DEVICE_(pIBehavior)->pMovie)
+        EVMU_DEVICE_(pIBehavior)->pMovie->recording = GBL_FALSE;
+
+    GBL_CTX_END();
+}
+
 static GBL_RESULT EvmuDevice_update_(EvmuIBehavior* pIBehavior, EvmuTicks ticks) {
     GBL_CTX_BEGIN(NULL);
 
     EvmuDevice*  pSelf  = EVMU_DEVICE(pIBehavior);
+    EvmuDevice_* pSelf_ = EVMU_DEVICE_(pSelf);
 
     // fuck the base implementation, do it manually
     //GBL_VCALL_DEFAULT(EvmuIBehavior, pFnUpdate, pSelf, ticks);
 
+    double speed = pSelf_->speed;
+
     if(pSelf->pGamepad->slowMotion)
-        ticks /= 10.0f;
+        speed /= 10.0;
     if(pSelf->pGamepad->fastForward)
-        ticks *= 10.0f;
+        speed *= 10.0;
+
+    // Carry the fractional tick rather than truncating it away every update
+    const double scaled   = (double)ticks * speed + pSelf_->speedRemainder;
+    const double emulated = floor(scaled);
+
+    pSelf_->speedRemainder = scaled - emulated;
 
-    EvmuIBehavior_update(EVMU_IBEHAVIOR(pSelf->pCpu), ticks);
+    GBL_CTX_VERIFY_CALL(EvmuDevice__advance_(pSelf, (EvmuTicks)emulated));
 
     GBL_CTX_END();
 }
 
-EVMU_EXPORT size_t EvmuDevice_peripheralCount(const EvmuDevice* pSelf) {
-    size_t count = 0;
-    for(GblObject* pIter = GblObject_childFirst(GBL_OBJECT(pSelf));
-        pIter;
-        pIter = GblObject_siblingNext(pIter))
-    {
-        if(GBL_TYPECHECK(EvmuPeripheral, pIter)) ++count;
+static uint64_t EvmuDevice_nsecs_(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+EVMU_EXPORT double EvmuDevice_speed(const EvmuDevice* pSelf) {
+    return EVMU_DEVICE_(pSelf)->speed;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_setSpeed(EvmuDevice* pSelf, double ratio) {
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_ARG(isfinite(ratio) && ratio > 0.0);
+
+    EVMU_DEVICE_(pSelf)->speed = ratio;
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EvmuTicks EvmuDevice_emulatedTicks(const EvmuDevice* pSelf) {
+    return EVMU_DEVICE_(pSelf)->emulatedTicks;
+}
+
+EVMU_EXPORT double EvmuDevice_turboRatio(const EvmuDevice* pSelf) {
+    return EVMU_DEVICE_(pSelf)->turboRatio;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_runTurbo(EvmuDevice* pSelf, EvmuTicks budget, double* pRatio) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuDevice_*   pSelf_   = EVMU_DEVICE_(pSelf);
+    const uint64_t start    = EvmuDevice_nsecs_();
+    uint64_t       elapsed  = 0;
+    EvmuTicks      emulated = 0;
+
+    // Slices are sized from the rate of the last one, so that the budget is overrun by a fraction at most
+    const uint64_t sliceBudget = budget / EVMU_DEVICE__TURBO_SLICES_? budget / EVMU_DEVICE__TURBO_SLICES_ : 1;
+
+    while(elapsed < budget) {
+        const EvmuTicks slice      = pSelf_->turboSlice;
+        const uint64_t  sliceStart = EvmuDevice_nsecs_();
+
+        GBL_CTX_VERIFY_CALL(EvmuDevice__advance_(pSelf, slice));
+
+        const uint64_t now       = EvmuDevice_nsecs_();
+        const uint64_t sliceTime = now - sliceStart;
+
+        emulated += slice;
+        elapsed   = now - start;
+
+        const uint64_t remaining = elapsed < budget? budget - elapsed : 0;
+
+        if(!remaining) break;
+
+        double next = sliceTime? (double)slice *
+                                 (double)(remaining < sliceBudget? remaining : sliceBudget) /
+                                 (double)sliceTime
+                               : (double)slice * 2.0;
+
+        // Let a single slow or fast slice only move the length so far
+        if(next > (double)slice * 2.0) next = (double)slice * 2.0;
+        if(next < (double)slice * 0.5) next = (double)slice * 0.5;
+        if(next < EVMU_DEVICE__TURBO_SLICE_MIN_) next = EVMU_DEVICE__TURBO_SLICE_MIN_;
+
+        pSelf_->turboSlice = (EvmuTicks)next;
     }
-    return count;
+
+    pSelf_->turboRatio = elapsed? (double)emulated / (double)elapsed : 0.0;
+
+    if(pRatio) *pRatio = pSelf_->turboRatio;
+
+    GBL_CTX_END();
 }
 
-EVMU_EXPORT EvmuPeripheral* EvmuDevice_peripheral(const EvmuDevice* pSelf, size_t index) {
-    EvmuPeripheral* pPeripheral = NULL;
-    size_t count = 0;
+// FNV-1a, never 0 so that it can't be mistaken for an empty slot
+static uintptr_t EvmuDevice_nameKey_(const char* pName) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    while(*pName) {
+        hash ^= (uint8_t)*pName++;
+        hash *= 0x100000001b3ull;
+    }
+
+    return (uintptr_t)hash? (uintptr_t)hash : 1;
+}
+
+GBL_INLINE size_t EvmuDevice_slotNext_(size_t slot) {
+    return (slot + 1) & (EVMU_DEVICE__REGISTRY_SLOTS_ - 1);
+}
+
+// Slot holding \p type, the empty slot it would be inserted into, or NULL if the table is full
+static EvmuDeviceSlot_* EvmuDevice_typeSlot_(EvmuDeviceSlot_* pSlots, GblType type) {
+    const uintptr_t key = (uintptr_t)type;
+    size_t          s   = (key ^ (key >> 17)) & (EVMU_DEVICE__REGISTRY_SLOTS_ - 1);
+
+    // Peripherals register every ancestor type, so this table can fill up
+    for(size_t probes = 0; probes < EVMU_DEVICE__REGISTRY_SLOTS_; ++probes) {
+        if(!pSlots[s].key || pSlots[s].key == key)
+            return &pSlots[s];
+
+        s = EvmuDevice_slotNext_(s);
+    }
+
+    return NULL;
+}
+
+// Slot holding \p pName, or the empty slot it would be inserted into
+static EvmuDeviceSlot_* EvmuDevice_nameSlot_(EvmuDeviceSlot_* pSlots, const char* pName) {
+    const uintptr_t key = EvmuDevice_nameKey_(pName);
+    size_t          s   = key & (EVMU_DEVICE__REGISTRY_SLOTS_ - 1);
+
+    // Never loops forever, as there are twice as many slots as peripherals
+    while(pSlots[s].key &&
+          (pSlots[s].key != key ||
+           strcmp(GblObject_name(GBL_OBJECT(pSlots[s].pPeripheral)), pName) != 0))
+        s = EvmuDevice_slotNext_(s);
+
+    return &pSlots[s];
+}
 
-    for(GblObject* pIter = GblObject_childFirst(GBL_OBJECT(pSelf));
-        pIter;
-        pIter = GblObject_siblingNext(pIter))
+static void EvmuDevice_indexPeripheral_(EvmuDevice_* pSelf_, EvmuPeripheral* pPeripheral) {
+    const char* pName = GblObject_name(GBL_OBJECT(pPeripheral));
+
+    if(pName) {
+        EvmuDeviceSlot_* pSlot = EvmuDevice_nameSlot_(pSelf_->nameSlots, pName);
+
+        if(!pSlot->key) {
+            pSlot->key         = EvmuDevice_nameKey_(pName);
+            pSlot->pPeripheral = pPeripheral;
+        }
+    }
+
+    // Each type up to EvmuPeripheral maps to the first peripheral of or deriving from it
+    for(GblType type = GBL_TYPEOF(pPeripheral);
+        type != GBL_INVALID_TYPE && type != EVMU_PERIPHERAL_TYPE;
+        type = GblType_parent(type))
     {
-        if(GBL_TYPECHECK(EvmuPeripheral, pIter)) {
-            if(count++ == index) {
-                pPeripheral = EVMU_PERIPHERAL(pIter);
-                break;
-            }
+        EvmuDeviceSlot_* pSlot = EvmuDevice_typeSlot_(pSelf_->typeSlots, type);
+
+        if(pSlot && !pSlot->key) {
+            pSlot->key         = (uintptr_t)type;
+            pSlot->pPeripheral = pPeripheral;
         }
     }
+}
 
-    return pPeripheral;
+EVMU_RESULT EvmuDevice__registerPeripheral_(EvmuDevice_* pSelf_, EvmuPeripheral* pPeripheral) {
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_CTX_VERIFY(pSelf_->peripheralCount < EVMU_DEVICE__PERIPHERALS_MAX_,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Peripheral registry is full: [%zu peripherals]",
+                   pSelf_->peripheralCount);
+
+    pSelf_->pPeripherals[pSelf_->peripheralCount++] = pPeripheral;
+    EvmuDevice_indexPeripheral_(pSelf_, pPeripheral);
+
+    GBL_CTX_END();
+}
+
+void EvmuDevice__unregisterPeripheral_(EvmuDevice_* pSelf_, EvmuPeripheral* pPeripheral) {
+    size_t count = 0;
+
+    for(size_t p = 0; p < pSelf_->peripheralCount; ++p)
+        if(pSelf_->pPeripherals[p] != pPeripheral)
+            pSelf_->pPeripherals[count++] = pSelf_->pPeripherals[p];
+
+    pSelf_->peripheralCount = count;
+
+    // Open addressing can't simply clear a slot, so re-index what's left
+    memset(pSelf_->nameSlots, 0, sizeof(pSelf_->nameSlots));
+    memset(pSelf_->typeSlots, 0, sizeof(pSelf_->typeSlots));
+
+    for(size_t p = 0; p < pSelf_->peripheralCount; ++p)
+        EvmuDevice_indexPeripheral_(pSelf_, pSelf_->pPeripherals[p]);
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_addPeripheral(EvmuDevice* pSelf, EvmuPeripheral* pPeripheral) {
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_POINTER(pPeripheral);
+    GBL_CTX_VERIFY_ARG(!GblObject_parent(GBL_OBJECT(pPeripheral)));
+
+    GBL_CTX_VERIFY(EVMU_DEVICE_(pSelf)->peripheralCount < EVMU_DEVICE__PERIPHERALS_MAX_,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "EvmuDevice_addPeripheral(): device has too many peripherals!");
+
+    GblObject_addChild(GBL_OBJECT(pSelf), GBL_OBJECT(pPeripheral));
+
+    GBL_CTX_VERIFY_CALL(EvmuDevice__registerPeripheral_(EVMU_DEVICE_(pSelf), pPeripheral));
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_removePeripheral(EvmuDevice* pSelf, EvmuPeripheral* pPeripheral) {
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_POINTER(pPeripheral);
+
+    const GblBool removed = GblObject_removeChild(GBL_OBJECT(pSelf), GBL_OBJECT(pPeripheral));
+
+    GBL_CTX_VERIFY(removed,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "EvmuDevice_removePeripheral(): attempt to remove non-child peripheral!");
+
+    EvmuDevice__unregisterPeripheral_(EVMU_DEVICE_(pSelf), pPeripheral);
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT size_t EvmuDevice_peripheralCount(const EvmuDevice* pSelf) {
+    return EVMU_DEVICE_(pSelf)->peripheralCount;
+}
+
+EVMU_EXPORT EvmuPeripheral* EvmuDevice_peripheral(const EvmuDevice* pSelf, size_t index) {
+    EvmuDevice_* pSelf_ = EVMU_DEVICE_(pSelf);
+
+    return index < pSelf_->peripheralCount? pSelf_->pPeripherals[index] : NULL;
 }
 
 EVMU_EXPORT EvmuPeripheral* EvmuDevice_findPeripheral(const EvmuDevice* pSelf, const char* pName) {
-    return EVMU_PERIPHERAL(GblObject_findChildByName(GBL_OBJECT(pSelf), pName));
+    if(!pName) return NULL;
+
+    EvmuPeripheral* pPeripheral = EvmuDevice_nameSlot_(EVMU_DEVICE_(pSelf)->nameSlots, pName)->pPeripheral;
+
+    // Fall back to children which weren't added through the registry
+    return pPeripheral? pPeripheral :
+                        EVMU_PERIPHERAL(GblObject_findChildByName(GBL_OBJECT(pSelf), pName));
+}
+
+EVMU_EXPORT EvmuPeripheral* EvmuDevice_findPeripheralByType(const EvmuDevice* pSelf, GblType type) {
+    EvmuDeviceSlot_* pSlot = EvmuDevice_typeSlot_(EVMU_DEVICE_(pSelf)->typeSlots, type);
+
+    return pSlot? pSlot->pPeripheral : NULL;
 }
 
 static GBL_RESULT EvmuDeviceClass_init_(GblClass* pClass, const void* pData) {
     GBL_UNUSED(pData);
     GBL_CTX_BEGIN(NULL);
 
+    if(!GblType_classRefCount(EVMU_DEVICE_TYPE))
+        GBL_PROPERTIES_REGISTER(EvmuDevice);
+
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnReset       = EvmuDevice_reset_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnUpdate      = EvmuDevice_update_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState   = EvmuDevice_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState   = EvmuDevice_loadState_;
     GBL_OBJECT_CLASS(pClass)    ->pFnConstructor = EvmuDevice_constructor_;
+    GBL_OBJECT_CLASS(pClass)    ->pFnConstructed = EvmuDevice_GblObject_constructed_;
+    GBL_OBJECT_CLASS(pClass)    ->pFnProperty    = EvmuDevice_GblObject_property_;
+    GBL_OBJECT_CLASS(pClass)    ->pFnSetProperty = EvmuDevice_GblObject_setProperty_;
     GBL_BOX_CLASS(pClass)       ->pFnDestructor  = EvmuDevice_destructor_;
 
     GBL_CTX_END();
@@ -6,6 +6,15 @@
 #define EVMU_DEVICE_(instance)              (GBL_PRIVATE(EvmuDevice, instance))
 #define EVMU_DEVICE_PUBLIC_(priv)           (GBL_PUBLIC(EvmuDevice, priv))
 
+#define EVMU_DEVICE__STATE_TAG_             EVMU_IBEHAVIOR__STATE_TAG_('D', 'E', 'V', ' ')
+#define EVMU_DEVICE__STATE_VERSION_         2
+
+#define EVMU_DEVICE__PERIPHERALS_MAX_       32  // peripheral registry capacity
+#define EVMU_DEVICE__REGISTRY_SLOTS_        64  // slots per registry lookup table, a power of two
+#define EVMU_DEVICE__TURBO_SLICE_           1000000 // initial emulated ticks per turbo slice
+#define EVMU_DEVICE__TURBO_SLICE_MIN_       10000   // smallest emulated ticks per turbo slice
+#define EVMU_DEVICE__TURBO_SLICES_          8       // slices a turbo budget is divided into, bounding overrun
+
 #define GBL_SELF_TYPE EvmuDevice_
 
 GBL_DECLS_BEGIN
@@ -18,15 +27,35 @@ GBL_FORWARD_DECLARE_STRUCT(EvmuBattery_);
 GBL_FORWARD_DECLARE_STRUCT(EvmuBuzzer_);
 GBL_FORWARD_DECLARE_STRUCT(EvmuGamepad_);
 GBL_FORWARD_DECLARE_STRUCT(EvmuTimers_);
+GBL_FORWARD_DECLARE_STRUCT(EvmuSio_);
 GBL_FORWARD_DECLARE_STRUCT(EvmuRom_);
 GBL_FORWARD_DECLARE_STRUCT(EvmuPic_);
 GBL_FORWARD_DECLARE_STRUCT(EvmuFlash_);
 GBL_FORWARD_DECLARE_STRUCT(EvmuFat_);
 GBL_FORWARD_DECLARE_STRUCT(EvmuWram_);
+GBL_FORWARD_DECLARE_STRUCT(EvmuRewind_);
+GBL_FORWARD_DECLARE_STRUCT(EvmuMovie_);
+GBL_FORWARD_DECLARE_STRUCT(EvmuHashCache_);
+
+// Open-addressed lookup table entry within the peripheral registry
+GBL_DECLARE_STRUCT(EvmuDeviceSlot_) {
+    uintptr_t       key;            // name hash or GblType, 0 when empty
+    EvmuPeripheral* pPeripheral;
+};
 
 typedef struct EvmuDevice_ {
     EvmuTicks       remainingTicks;
 
+    EVMU_DEVICE_INIT_FLAGS initFlags;   // flags given at construction
+    EVMU_DEVICE_INIT_FLAGS pendingInit; // deferred work not yet performed
+
+    double          speed;          // emulated time per unit of host time
+    double          speedRemainder; // fraction of a tick owed to the next update
+    EvmuTicks       emulatedTicks;  // emulated time elapsed since construction
+    EvmuTicks       lcdRemainder;   // nanoseconds short of a microsecond owed to a playing animation
+    EvmuTicks       turboSlice;     // adaptive slice length for EvmuDevice_runTurbo()
+    double          turboRatio;     // speed achieved by the last EvmuDevice_runTurbo()
+
     EvmuCpu_*       pCpu;
     EvmuRam_*       pRam;
     EvmuClock_*     pClock;
@@ -35,11 +64,22 @@ typedef struct EvmuDevice_ {
     EvmuBuzzer_*    pBuzzer;
     EvmuGamepad_*   pGamepad;
     EvmuTimers_*    pTimers;
+    EvmuSio_*       pSio;
     EvmuRom_*       pRom;
     EvmuPic_*       pPic;
     EvmuFlash_*     pFlash;
     EvmuFat_*       pFat;
     EvmuWram_*      pWram;
+
+    EvmuRewind_*    pRewind;        // rewind history, or NULL when not recording
+    EvmuMovie_*     pMovie;         // last movie recorded, or NULL
+    EvmuHashCache_* pHash;          // region hashes for EvmuDevice_stateHash(), or NULL until first hashed
+
+    // Peripheral registry, in the order they were added
+    EvmuPeripheral* pPeripherals[EVMU_DEVICE__PERIPHERALS_MAX_];
+    size_t          peripheralCount;
+    EvmuDeviceSlot_ nameSlots[EVMU_DEVICE__REGISTRY_SLOTS_];
+    EvmuDeviceSlot_ typeSlots[EVMU_DEVICE__REGISTRY_SLOTS_];
 /*
 
     */
@@ -63,6 +103,16 @@ typedef struct EvmuDevice_ {
 
 } EvmuDevice_;
 
+// Performs whichever deferred work in \p mask is still pending
+EVMU_RESULT EvmuDevice__finishInit_(GBL_SELF, EVMU_DEVICE_INIT_FLAGS mask);
+// Runs the given device for exactly \p ticks of emulated time, recording them into its rewind history
+EVMU_RESULT EvmuDevice__advance_   (EvmuDevice* pSelf, EvmuTicks ticks);
+
+// Adds an already-parented peripheral to the registry's lookup tables
+EVMU_RESULT EvmuDevice__registerPeripheral_  (GBL_SELF, EvmuPeripheral* pPeripheral);
+// Removes a peripheral from the registry, rebuilding its lookup tables
+void        EvmuDevice__unregisterPeripheral_(GBL_SELF, EvmuPeripheral* pPeripheral);
+
 #define DEV_(dev) dev->pPrivate
 
 #define DEV_MEMBER_(dev, member) DEV_(dev)->member
@@ -3,6 +3,9 @@
 #include <evmu/hw/evmu_device.h>
 #include <evmu/hw/evmu_address_space.h>
 #include "evmu_flash_.h"
+#include "evmu_journal_.h"
+#include "evmu_ram_.h"
+#include "../types/evmu_ibehavior_.h"
 
 EVMU_EXPORT EvmuAddress EvmuFlash_programAddress(EVMU_FLASH_PROGRAM_STATE state) {
     static const EvmuAddress prgAddressLut[] = {
@@ -94,6 +97,30 @@ EVMU_EXPORT EVMU_RESULT EvmuFlash_writeBytes(EvmuFlash*   pSelf,
                                   pBytes);
 }
 
+EVMU_EXPORT EVMU_RESULT EvmuFlash_readRaw(const EvmuFlash* pSelf,
+                                          EvmuAddress      address,
+                                          void*            pBuffer,
+                                          size_t           bytes)
+{
+    return EvmuStorage__read_(EVMU_FLASH_(pSelf)->pStorage, address, bytes, pBuffer);
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuFlash_writeRaw(EvmuFlash*  pSelf,
+                                           EvmuAddress address,
+                                           const void* pBuffer,
+                                           size_t      bytes)
+{
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuFlash_* pSelf_ = EVMU_FLASH_(pSelf);
+
+    // Raw or not, clones and change tracking mustn't miss the write
+    GBL_CTX_VERIFY_CALL(EvmuFlash__detach_(pSelf_, address, bytes));
+    GBL_CTX_VERIFY_CALL(EvmuStorage__write_(pSelf_->pStorage, address, bytes, pBuffer));
+
+    GBL_CTX_END();
+}
+
 static EVMU_RESULT EvmuFlash_IMemory_readBytes_(const EvmuIMemory* pSelf,
                                                 EvmuAddress        address,
                                                 void*              pBuffer,
@@ -103,7 +130,7 @@ static EVMU_RESULT EvmuFlash_IMemory_readBytes_(const EvmuIMemory* pSelf,
     EvmuFlash_*  pSelf_  = EVMU_FLASH_(pSelf);
 
     if(!GBL_RESULT_SUCCESS(
-        GblByteArray_read(pSelf_->pStorage, address, *pBytes, pBuffer)
+        EvmuStorage__read_(pSelf_->pStorage, address, *pBytes, pBuffer)
     )) {
         *pBytes = 0;
         GBL_CTX_VERIFY_LAST_RECORD();
@@ -123,9 +150,12 @@ static EVMU_RESULT EvmuFlash_IMemory_writeBytes_(EvmuIMemory* pSelf,
     // Cache private data
     EvmuFlash_*  pSelf_   = EVMU_FLASH_(pSelf);
 
+    // Stop sharing storage with clones before modifying it
+    GBL_CTX_VERIFY_CALL(EvmuFlash__detach_(pSelf_, address, *pBytes));
+
     // Attempt to write to flash byte array
     if(!GBL_RESULT_SUCCESS(
-            GblByteArray_write(pSelf_->pStorage, address, *pBytes, pBuffer)
+            EvmuStorage__write_(pSelf_->pStorage, address, *pBytes, pBuffer)
     )) {
         // Return 0 if the write failed, proxy last error
         *pBytes = 0;
@@ -138,10 +168,94 @@ static EVMU_RESULT EvmuFlash_IMemory_writeBytes_(EvmuIMemory* pSelf,
     GBL_CTX_END();
 }
 
+EVMU_EXPORT GblBool EvmuFlash_blockDirty(const EvmuFlash* pSelf, size_t block) {
+    return block < EVMU_FLASH_BLOCKS &&
+           (EVMU_FLASH_(pSelf)->dirty[block / 64] >> (block % 64) & 1);
+}
+
+EVMU_EXPORT size_t EvmuFlash_dirtyBlocks(const EvmuFlash* pSelf) {
+    size_t count = 0;
+
+    for(size_t b = 0; b < EVMU_FLASH_BLOCKS; ++b)
+        count += EvmuFlash_blockDirty(pSelf, b);
+
+    return count;
+}
+
+EVMU_EXPORT void EvmuFlash_markClean(EvmuFlash* pSelf) {
+    memset(EVMU_FLASH_(pSelf)->dirty, 0, sizeof(EVMU_FLASH_(pSelf)->dirty));
+}
+
+EVMU_RESULT EvmuFlash__share_(EvmuFlash_* pSelf_, EvmuFlash_* pSrc_) {
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuStorage_* pCopy = NULL;
+
+    // Sharing a write-back mapping would cost pSrc its image on its next write, so it's copied up front
+    if(pSrc_->pStorage->writeBack) {
+        GBL_CTX_VERIFY((pCopy = EvmuStorage__create_(pSrc_->pStorage->size)),
+                       GBL_RESULT_ERROR_INTERNAL,
+                       "Failed to allocate flash storage to clone a mapped image into!");
+
+        memcpy(pCopy->pData, pSrc_->pStorage->pData, pCopy->size);
+    }
+
+    // EXT may be executing straight out of the old storage
+    EvmuDevice* pDevice = EvmuPeripheral_device(EVMU_PERIPHERAL(EVMU_FLASH_PUBLIC_(pSelf_)));
+    EvmuRam_*   pRam_   = EVMU_RAM_(pDevice->pRam);
+
+    if(!pCopy) pCopy = EvmuStorage__ref_(pSrc_->pStorage);
+
+    if(pRam_->pExt == pSelf_->pStorage->pData)
+        pRam_->pExt = pCopy->pData;
+
+    EvmuStorage__unref_(pSelf_->pStorage);
+    pSelf_->pStorage = pCopy;
+    ++pSelf_->generation;
+
+    // Nothing is known about how the new contents differ from our last snapshot
+    memset(pSelf_->dirty, 0xff, sizeof(pSelf_->dirty));
+    memset(pSelf_->stale, 0xff, sizeof(pSelf_->stale));
+    memset(pSelf_->unsynced, 0xff, sizeof(pSelf_->unsynced));
+    memset(pSelf_->unhashed, 0xff, sizeof(pSelf_->unhashed));
+
+    GBL_CTX_END();
+}
+
+EVMU_RESULT EvmuFlash__copyOnWrite_(EvmuFlash_* pSelf_) {
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuStorage_* pShared = pSelf_->pStorage;
+    EvmuStorage_* pOwned  = EvmuStorage__create_(pShared->size);
+
+    GBL_CTX_VERIFY(pOwned,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate private flash storage!");
+
+    memcpy(pOwned->pData, pShared->pData, pShared->size);
+
+    // EXT may be executing straight out of the old storage
+    EvmuDevice* pDevice = EvmuPeripheral_device(EVMU_PERIPHERAL(EVMU_FLASH_PUBLIC_(pSelf_)));
+    EvmuRam_*   pRam_   = EVMU_RAM_(pDevice->pRam);
+
+    if(pRam_->pExt == pShared->pData)
+        pRam_->pExt = pOwned->pData;
+
+    pSelf_->pStorage = pOwned;
+    EvmuStorage__unref_(pShared);
+
+    GBL_CTX_END();
+}
+
 static GBL_RESULT EvmuFlash_GblBox_destructor_(GblBox* pBox) {
     GBL_CTX_BEGIN(NULL);
 
-    GblByteArray_unref(EVMU_FLASH_(pBox)->pStorage);
+    // Whatever hasn't been synced yet gets one last chance to reach the journal or image
+    EvmuFlash_closeJournal(EVMU_FLASH(pBox));
+    EvmuFlash_syncImage(EVMU_FLASH(pBox), GBL_TRUE);
+    EvmuJournal__destroy_(EVMU_FLASH_(pBox)->pJournal);
+
+    EvmuStorage__unref_(EVMU_FLASH_(pBox)->pStorage);
     GBL_VCALL_DEFAULT(EvmuPeripheral, base.base.pFnDestructor, pBox);
 
     GBL_CTX_END();
@@ -153,11 +267,66 @@ static GBL_RESULT EvmuFlash_init_(GblInstance* pInstance) {
     EvmuFlash* pSelf   = EVMU_FLASH(pInstance);
     EvmuFlash_* pSelf_ = EVMU_FLASH_(pSelf);
 
-    pSelf_->pStorage   = GblByteArray_create(
+    pSelf_->pStorage   = EvmuStorage__create_(
                             EVMU_IMEMORY_GET_CLASS(pSelf)->capacity
                          );
 
-    memset(pSelf_->pStorage->pData, 0, pSelf_->pStorage->size);
+    GBL_CTX_VERIFY(pSelf_->pStorage,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate flash storage!");
+
+    GBL_CTX_END();
+}
+
+// Storage goes block by block, preceded by a mask of the blocks present
+static EVMU_RESULT EvmuFlash_state_(EvmuFlash* pSelf, EvmuStateBuffer* pBuffer) {
+    EvmuFlash_*  pSelf_ = EVMU_FLASH_(pSelf);
+    const size_t start  = EvmuIBehavior__beginSection_(pBuffer, EVMU_FLASH__STATE_TAG_, EVMU_FLASH__STATE_VERSION_);
+    uint64_t     blocks[EVMU_FLASH__DIRTY_WORDS_];
+
+    GBL_ASSERT(pSelf_->pStorage->size == EVMU_FLASH_SIZE);
+
+    if(pBuffer->delta)
+        memcpy(blocks, pSelf_->dirty, sizeof(blocks));
+    else
+        memset(blocks, pBuffer->external? 0 : 0xff, sizeof(blocks));
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->prgState);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->prgBytes);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, blocks);
+
+    for(size_t b = 0; b < EVMU_FLASH_BLOCKS; ++b)
+        if(blocks[b / 64] >> (b % 64) & 1)
+            EvmuIBehavior__field_(pBuffer,
+                                  &pSelf_->pStorage->pData[b * EVMU_FLASH_BLOCK_SIZE],
+                                  EVMU_FLASH_BLOCK_SIZE);
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf->dataChanged);
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+static EVMU_RESULT EvmuFlash_IBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuFlash_state_(EVMU_FLASH(pSelf), pBuffer);
+}
+
+static EVMU_RESULT EvmuFlash_IBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    GBL_CTX_BEGIN(NULL);
+
+    // Storage may be shared with a clone, which mustn't see the loaded contents
+    GBL_CTX_VERIFY_CALL(EvmuFlash__detach_(EVMU_FLASH_(pSelf), 0, 0));
+    GBL_CTX_VERIFY_CALL(EvmuFlash_state_(EVMU_FLASH(pSelf), pBuffer));
+
+    // Flash now matches the state, which becomes the base for the next delta, unless
+    // this undid a rejected load, after which no block is known to match any base
+    if(pBuffer->restoring)
+        memset(EVMU_FLASH_(pSelf)->dirty, 0xff, sizeof(EVMU_FLASH_(pSelf)->dirty));
+    else
+        EvmuFlash_markClean(EVMU_FLASH(pSelf));
+
+    memset(EVMU_FLASH_(pSelf)->stale, 0xff, sizeof(EVMU_FLASH_(pSelf)->stale));
+    memset(EVMU_FLASH_(pSelf)->unsynced, 0xff, sizeof(EVMU_FLASH_(pSelf)->unsynced));
+    memset(EVMU_FLASH_(pSelf)->unhashed, 0xff, sizeof(EVMU_FLASH_(pSelf)->unhashed));
 
     GBL_CTX_END();
 }
@@ -165,10 +334,12 @@ static GBL_RESULT EvmuFlash_init_(GblInstance* pInstance) {
 static GBL_RESULT EvmuFlashClass_init_(GblClass* pClass, const void* pUd) {
     GBL_CTX_BEGIN(NULL);
 
-    GBL_BOX_CLASS(pClass)     ->pFnDestructor = EvmuFlash_GblBox_destructor_;
-    EVMU_IMEMORY_CLASS(pClass)->pFnRead       = EvmuFlash_IMemory_readBytes_;
-    EVMU_IMEMORY_CLASS(pClass)->pFnWrite      = EvmuFlash_IMemory_writeBytes_;
-    EVMU_IMEMORY_CLASS(pClass)->capacity      = EVMU_FLASH_SIZE;
+    GBL_BOX_CLASS(pClass)       ->pFnDestructor = EvmuFlash_GblBox_destructor_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState  = EvmuFlash_IBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState  = EvmuFlash_IBehavior_loadState_;
+    EVMU_IMEMORY_CLASS(pClass)  ->pFnRead       = EvmuFlash_IMemory_readBytes_;
+    EVMU_IMEMORY_CLASS(pClass)  ->pFnWrite      = EvmuFlash_IMemory_writeBytes_;
+    EVMU_IMEMORY_CLASS(pClass)  ->capacity      = EVMU_FLASH_SIZE;
 
     GBL_CTX_END();
 }
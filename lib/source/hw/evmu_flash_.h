@@ -2,20 +2,65 @@
 #define EVMU_FLASH__H
 
 #include <evmu/hw/evmu_flash.h>
-#include <gimbal/utils/gimbal_byte_array.h>
+#include "evmu_storage_.h"
 
 #define EVMU_FLASH_(instance)    (GBL_PRIVATE(EvmuFlash, instance))
 #define EVMU_FLASH_PUBLIC_(priv) (GBL_PUBLIC(EvmuFlash, priv))
 
+#define EVMU_FLASH__STATE_TAG_     EVMU_IBEHAVIOR__STATE_TAG_('F', 'L', 'S', 'H')
+#define EVMU_FLASH__STATE_VERSION_ 2
+
+#define EVMU_FLASH__DIRTY_WORDS_   (EVMU_FLASH_BLOCKS / 64)
+
 GBL_DECLS_BEGIN
 
+GBL_FORWARD_DECLARE_STRUCT(EvmuJournal_);
+
 //Flash controller for VMU (note actual flash blocks are stored within device)
 GBL_DECLARE_STRUCT(EvmuFlash_) {
     EVMU_FLASH_PROGRAM_STATE prgState;
     uint8_t                  prgBytes;
-    GblByteArray*            pStorage;
+    EvmuStorage_*           pStorage;
+    uint64_t                 generation; // bumped whenever storage may have been modified
+    uint64_t                 dirty[EVMU_FLASH__DIRTY_WORDS_]; // blocks modified since last marked clean
+    uint64_t                 stale[EVMU_FLASH__DIRTY_WORDS_]; // blocks modified since EvmuDevice_stateHash() last hashed them
+    uint64_t                 unsynced[EVMU_FLASH__DIRTY_WORDS_]; // blocks modified since last synced to the journal or mapped image
+    uint64_t                 unhashed[EVMU_FLASH__DIRTY_WORDS_]; // blocks modified since the lockstep harness last hashed them
+    EvmuJournal_*            pJournal; // write-ahead journal persisting storage, or NULL
 };
 
+// Drops own storage in favor of sharing pSrc's storage copy-on-write, or copying it outright
+// when it's a write-back image mapping, which only pSrc may keep writing through, rebasing EXT onto it
+EVMU_RESULT EvmuFlash__share_       (EvmuFlash_* pSelf, EvmuFlash_* pSrc);
+// Gives a sharing flash its own private copy of storage
+EVMU_RESULT EvmuFlash__copyOnWrite_ (EvmuFlash_* pSelf);
+
+// Flags every block overlapping the given byte range as dirty, stale, unsynced, and unhashed
+EVMU_INLINE void EvmuFlash__touch_(EvmuFlash_* pSelf, size_t address, size_t bytes) GBL_NOEXCEPT {
+    if(!bytes || address >= EVMU_FLASH_SIZE)
+        return;
+
+    if(bytes > EVMU_FLASH_SIZE - address)
+        bytes = EVMU_FLASH_SIZE - address;
+
+    for(size_t b  = address / EVMU_FLASH_BLOCK_SIZE;
+               b <= (address + bytes - 1) / EVMU_FLASH_BLOCK_SIZE;
+             ++b)
+    {
+        pSelf->dirty[b / 64] |= UINT64_C(1) << (b % 64);
+        pSelf->stale[b / 64] |= UINT64_C(1) << (b % 64);
+        pSelf->unsynced[b / 64] |= UINT64_C(1) << (b % 64);
+        pSelf->unhashed[b / 64] |= UINT64_C(1) << (b % 64);
+    }
+}
+
+// Must be called before anything mutates storage, with the range about to be modified
+EVMU_INLINE EVMU_RESULT EvmuFlash__detach_(EvmuFlash_* pSelf, size_t address, size_t bytes) GBL_NOEXCEPT {
+    ++pSelf->generation;
+    EvmuFlash__touch_(pSelf, address, bytes);
+    return EvmuStorage__shared_(pSelf->pStorage)? EvmuFlash__copyOnWrite_(pSelf) : GBL_RESULT_SUCCESS;
+}
+
 GBL_DECLS_END
 
 #endif // EVMU_FLASH__H
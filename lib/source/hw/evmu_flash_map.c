@@ -0,0 +1,181 @@
+#include <evmu/hw/evmu_flash.h>
+#include <evmu/hw/evmu_device.h>
+#include "evmu_flash_.h"
+#include "evmu_ram_.h"
+#include <string.h>
+
+#ifdef EVMU_HAVE_POSIX_FILES
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#endif
+
+// Moves flash onto new storage, leaving the old storage to any clone still sharing it
+static void EvmuFlash_adopt_(EvmuFlash_* pSelf_, EvmuStorage_* pStorage) {
+    EvmuDevice* pDevice = EvmuPeripheral_device(EVMU_PERIPHERAL(EVMU_FLASH_PUBLIC_(pSelf_)));
+    EvmuRam_*   pRam_   = EVMU_RAM_(pDevice->pRam);
+
+    // EXT may be executing straight out of the old storage
+    if(pRam_->pExt == pSelf_->pStorage->pData)
+        pRam_->pExt = pStorage->pData;
+
+    EvmuStorage__unref_(pSelf_->pStorage);
+    pSelf_->pStorage = pStorage;
+    ++pSelf_->generation;
+}
+
+#ifdef EVMU_HAVE_POSIX_FILES
+EVMU_RESULT EvmuStorage__sync_(EvmuStorage_* pSelf, size_t offset, size_t bytes, GblBool wait) {
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_CTX_VERIFY(offset + bytes <= pSelf->size,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Out-of-range storage sync: [offset: %zu, bytes: %zu, size: %zu]",
+                   offset, bytes, pSelf->size);
+
+    if(!pSelf->writeBack || !bytes)
+        GBL_CTX_DONE();
+
+    // Mappings start on a page boundary, so only the start of the range needs rounding
+    const size_t page  = sysconf(_SC_PAGESIZE);
+    const size_t start = offset / page * page;
+
+    GBL_CTX_VERIFY(msync(&pSelf->pData[start], offset + bytes - start, wait? MS_SYNC : MS_ASYNC) == 0,
+                   GBL_RESULT_ERROR_FILE_WRITE,
+                   "Failed to sync storage mapping: [offset: %zu, bytes: %zu]",
+                   offset, bytes);
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuFlash_mapImage(EvmuFlash* pSelf, const char* pPath, GblBool writeBack) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuFlash_*   pSelf_  = EVMU_FLASH_(pSelf);
+    EvmuStorage_* pMapped = NULL;
+    int           fd      = -1;
+    struct stat   info;
+
+    GBL_CTX_VERIFY_POINTER(pPath);
+
+    GBL_CTX_VERIFY(!EvmuFlash_journaling(pSelf),
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "Cannot map a flash image while journaling!");
+
+    GBL_CTX_VERIFY((fd = open(pPath, writeBack? O_RDWR : O_RDONLY)) >= 0 &&
+                   fstat(fd, &info) == 0,
+                   GBL_RESULT_ERROR_FILE_OPEN,
+                   "Failed to open flash image: [%s]",
+                   pPath);
+
+    GBL_CTX_VERIFY(info.st_size == EVMU_FLASH_SIZE,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Flash image is the wrong size: [%s: %zu bytes]",
+                   pPath, (size_t)info.st_size);
+
+    GBL_CTX_VERIFY((pMapped = EvmuStorage__map_(fd, 0, EVMU_FLASH_SIZE, writeBack)),
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to map flash image: [%s]",
+                   pPath);
+
+    // Any previous image gets everything written to it before it's let go
+    GBL_CTX_VERIFY_CALL(EvmuFlash_syncImage(pSelf, GBL_TRUE));
+
+    EvmuFlash_adopt_(pSelf_, pMapped);
+    pMapped = NULL;
+
+    // Contents are brand new, but already match the image
+    memset(pSelf_->dirty, 0xff, sizeof(pSelf_->dirty));
+    memset(pSelf_->stale, 0xff, sizeof(pSelf_->stale));
+    memset(pSelf_->unsynced, 0, sizeof(pSelf_->unsynced));
+    memset(pSelf_->unhashed, 0xff, sizeof(pSelf_->unhashed));
+    pSelf->dataChanged = GBL_TRUE;
+
+    GBL_CTX_END_BLOCK();
+
+    EvmuStorage__unref_(pMapped);
+
+    // Mappings outlive the descriptor they were made from
+    if(fd >= 0) close(fd);
+
+    return GBL_CTX_RESULT();
+}
+
+#else
+
+EVMU_RESULT EvmuStorage__sync_(EvmuStorage_* pSelf, size_t offset, size_t bytes, GblBool wait) {
+    GBL_UNUSED(pSelf, offset, bytes, wait);
+    return GBL_RESULT_UNSUPPORTED;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuFlash_mapImage(EvmuFlash* pSelf, const char* pPath, GblBool writeBack) {
+    GBL_CTX_BEGIN(pSelf);
+    GBL_UNUSED(pPath, writeBack);
+
+    GBL_CTX_RECORD_SET(GBL_RESULT_UNSUPPORTED,
+                       "Flash images can only be mapped on POSIX hosts!");
+
+    GBL_CTX_END();
+}
+
+#endif
+
+EVMU_EXPORT EVMU_RESULT EvmuFlash_syncImage(EvmuFlash* pSelf, GblBool wait) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuFlash_*   pSelf_   = EVMU_FLASH_(pSelf);
+    EvmuStorage_* pStorage = pSelf_->pStorage;
+
+    // Private and heap storage have nowhere to write back to
+    if(!pStorage->writeBack)
+        GBL_CTX_DONE();
+
+    // Runs of adjacent modified blocks are flushed together
+    for(size_t b = 0; b < EVMU_FLASH_BLOCKS; ) {
+        if(!(pSelf_->unsynced[b / 64] >> (b % 64) & 1)) {
+            ++b;
+            continue;
+        }
+
+        const size_t first = b;
+
+        while(b < EVMU_FLASH_BLOCKS && pSelf_->unsynced[b / 64] >> (b % 64) & 1)
+            ++b;
+
+        GBL_CTX_VERIFY_CALL(EvmuStorage__sync_(pStorage,
+                                               first * EVMU_FLASH_BLOCK_SIZE,
+                                               (b - first) * EVMU_FLASH_BLOCK_SIZE,
+                                               wait));
+    }
+
+    memset(pSelf_->unsynced, 0, sizeof(pSelf_->unsynced));
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuFlash_unmapImage(EvmuFlash* pSelf) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuFlash_*   pSelf_ = EVMU_FLASH_(pSelf);
+    EvmuStorage_* pOwned = NULL;
+
+    if(!EvmuFlash_mapped(pSelf))
+        GBL_CTX_DONE();
+
+    GBL_CTX_VERIFY_CALL(EvmuFlash_syncImage(pSelf, GBL_TRUE));
+
+    GBL_CTX_VERIFY((pOwned = EvmuStorage__create_(pSelf_->pStorage->size)),
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate private flash storage!");
+
+    // Contents stay exactly the same, so nothing needs to be marked
+    memcpy(pOwned->pData, pSelf_->pStorage->pData, pOwned->size);
+    EvmuFlash_adopt_(pSelf_, pOwned);
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT GblBool EvmuFlash_mapped(const EvmuFlash* pSelf) {
+    return EVMU_FLASH_(pSelf)->pStorage->mapped;
+}
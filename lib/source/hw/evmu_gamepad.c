@@ -4,6 +4,7 @@
 #include "evmu_gamepad_.h"
 #include "evmu_ram_.h"
 #include "../types/evmu_peripheral_.h"
+#include "../types/evmu_ibehavior_.h"
 #include <gimbal/meta/signals/gimbal_marshal.h>
 
 
@@ -26,6 +27,36 @@ EvmuWord EvmuGamepad__port3Value_(const EvmuGamepad_* pSelf_) {
             (!pSelf->sleep << EVMU_SFR_P3_SLEEP_POS));
 }
 
+uint16_t EvmuGamepad__buttons_(const EvmuGamepad* pSelf) {
+    return pSelf->up                 |
+           (pSelf->down        << 1)  |
+           (pSelf->left        << 2)  |
+           (pSelf->right       << 3)  |
+           (pSelf->a           << 4)  |
+           (pSelf->b           << 5)  |
+           (pSelf->mode        << 6)  |
+           (pSelf->sleep       << 7)  |
+           (pSelf->turboA      << 8)  |
+           (pSelf->turboB      << 9)  |
+           (pSelf->fastForward << 10) |
+           (pSelf->slowMotion  << 11);
+}
+
+void EvmuGamepad__setButtons_(EvmuGamepad* pSelf, uint16_t buttons) {
+    pSelf->up          = buttons & 0x1;
+    pSelf->down        = (buttons >> 1)  & 0x1;
+    pSelf->left        = (buttons >> 2)  & 0x1;
+    pSelf->right       = (buttons >> 3)  & 0x1;
+    pSelf->a           = (buttons >> 4)  & 0x1;
+    pSelf->b           = (buttons >> 5)  & 0x1;
+    pSelf->mode        = (buttons >> 6)  & 0x1;
+    pSelf->sleep       = (buttons >> 7)  & 0x1;
+    pSelf->turboA      = (buttons >> 8)  & 0x1;
+    pSelf->turboB      = (buttons >> 9)  & 0x1;
+    pSelf->fastForward = (buttons >> 10) & 0x1;
+    pSelf->slowMotion  = (buttons >> 11) & 0x1;
+}
+
 static EVMU_RESULT EvmuGamepad_pollButtons_(EvmuGamepad* pSelf) {
     GBL_CTX_BEGIN(NULL);
 
@@ -61,7 +92,8 @@ static EVMU_RESULT EvmuGamepad_EvmuIBehavior_update_(EvmuIBehavior* pIBehav, Evm
     // Only update button states if P3DDR has any pins configured as input
     if(EvmuGamepad_isConfigured(pSelf)) {
         // Fire signal to any attached slots which are implementing input back-ends
-        GBL_CTX_VERIFY_CALL(GblSignal_emit(GBL_INSTANCE(pSelf), "updatingButtons"));
+        if(!EVMU_GAMEPAD_(pSelf)->locked)
+            GBL_CTX_VERIFY_CALL(GblSignal_emit(GBL_INSTANCE(pSelf), "updatingButtons"));
         // Call virtual method for subclass to process state
         GBL_VCALL(EvmuGamepad, pFnPollButtons, pSelf);
     }
@@ -99,6 +131,26 @@ static GBL_RESULT EvmuGamepad_GblObject_constructed_(GblObject* pSelf) {
     GBL_CTX_END();
 }
 
+static EVMU_RESULT EvmuGamepad_state_(EvmuGamepad* pSelf, EvmuStateBuffer* pBuffer) {
+    const size_t start   = EvmuIBehavior__beginSection_(pBuffer, EVMU_GAMEPAD__STATE_TAG_, EVMU_GAMEPAD__STATE_VERSION_);
+    uint16_t     buttons = EvmuGamepad__buttons_(pSelf);
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, buttons);
+
+    if(pBuffer->loading)
+        EvmuGamepad__setButtons_(pSelf, buttons);
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+static EVMU_RESULT EvmuGamepad_IBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuGamepad_state_(EVMU_GAMEPAD(pSelf), pBuffer);
+}
+
+static EVMU_RESULT EvmuGamepad_IBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuGamepad_state_(EVMU_GAMEPAD(pSelf), pBuffer);
+}
+
 static GBL_RESULT EvmuGamepadClass_init_(GblClass* pClass, const void* pUd) {
     GBL_UNUSED(pUd);
 
@@ -116,6 +168,8 @@ static GBL_RESULT EvmuGamepadClass_init_(GblClass* pClass, const void* pUd) {
     GBL_OBJECT_CLASS(pClass)    ->pFnConstructed = EvmuGamepad_GblObject_constructed_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnUpdate      = EvmuGamepad_EvmuIBehavior_update_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnReset       = EvmuGamepad_EvmuIBehavior_reset_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState   = EvmuGamepad_IBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState   = EvmuGamepad_IBehavior_loadState_;
     EVMU_GAMEPAD_CLASS(pClass)  ->pFnPollButtons = EvmuGamepad_pollButtons_;
 
     GBL_CTX_END();
@@ -6,15 +6,22 @@
 #define EVMU_GAMEPAD_(instance)     (GBL_PRIVATE(EvmuGamepad, instance))
 #define EVMU_GAMEPAD_PUBLIC_(priv)  (GBL_PUBLIC(EvmuGamepad, priv))
 
+#define EVMU_GAMEPAD__STATE_TAG_     EVMU_IBEHAVIOR__STATE_TAG_('P', 'A', 'D', ' ')
+#define EVMU_GAMEPAD__STATE_VERSION_ 1
+
 GBL_DECLS_BEGIN
 
 GBL_FORWARD_DECLARE_STRUCT(EvmuRam_);
 
 GBL_DECLARE_STRUCT(EvmuGamepad_) {
     EvmuRam_* pRam;
+    GblBool   locked;   // buttons are being driven by the device rather than the frontend
 };
 
 EvmuWord EvmuGamepad__port3Value_(const EvmuGamepad_* pSelf_);
+// Packs every button into one bit each, in the order they're declared
+uint16_t EvmuGamepad__buttons_    (const EvmuGamepad* pSelf);
+void     EvmuGamepad__setButtons_ (EvmuGamepad* pSelf, uint16_t buttons);
 
 GBL_DECLS_END
 
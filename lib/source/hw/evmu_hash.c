@@ -0,0 +1,138 @@
+#include <evmu/hw/evmu_device.h>
+#include "evmu_device_.h"
+#include "evmu_flash_.h"
+#include "evmu_wram_.h"
+#include "evmu_hash_.h"
+#include "../types/evmu_ibehavior_.h"
+#include <stdlib.h>
+#include <string.h>
+
+GBL_INLINE uint64_t EvmuHash_rotate_(uint64_t value, unsigned bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+GBL_INLINE uint64_t EvmuHash_round_(uint64_t acc, uint64_t word) {
+    acc = (acc ^ word) * EVMU_HASH__PRIME_;
+    return acc ^ (acc >> 29);
+}
+
+// SplitMix64 finalizer, so that every input bit affects every output bit
+GBL_INLINE uint64_t EvmuHash_avalanche_(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ull;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+EvmuStateHash EvmuHash__bytes_(uint64_t seed, const void* pData, size_t bytes) {
+    const uint8_t* pBytes = pData;
+    const uint64_t length = bytes;
+    uint64_t       lanes[EVMU_HASH__LANES_];
+    uint64_t       words[EVMU_HASH__LANES_];
+
+    for(size_t l = 0; l < EVMU_HASH__LANES_; ++l)
+        lanes[l] = seed + (l + 1) * EVMU_HASH__PRIME_;
+
+    // Lanes don't depend on each other, so the compiler is free to interleave or vectorize them
+    for(; bytes >= sizeof(words); bytes -= sizeof(words), pBytes += sizeof(words)) {
+        memcpy(words, pBytes, sizeof(words));
+
+        for(size_t l = 0; l < EVMU_HASH__LANES_; ++l)
+            lanes[l] = EvmuHash_round_(lanes[l], words[l]);
+    }
+
+    // Zero-padded, with the length mixed in below to tell the padding apart from real zeroes
+    if(bytes) {
+        memset(words, 0, sizeof(words));
+        memcpy(words, pBytes, bytes);
+
+        for(size_t l = 0; l < EVMU_HASH__LANES_; ++l)
+            lanes[l] = EvmuHash_round_(lanes[l], words[l]);
+    }
+
+    EvmuStateHash hash;
+
+    hash.lo = EvmuHash_avalanche_(lanes[0]                       ^ EvmuHash_rotate_(lanes[1], 16) ^
+                                  EvmuHash_rotate_(lanes[2], 32) ^ EvmuHash_rotate_(lanes[3], 48) ^ length);
+    hash.hi = EvmuHash_avalanche_(lanes[3]                       ^ EvmuHash_rotate_(lanes[2], 16) ^
+                                  EvmuHash_rotate_(lanes[1], 32) ^ EvmuHash_rotate_(lanes[0], 48) ^ hash.lo);
+
+    return hash;
+}
+
+void EvmuHashCache__destroy_(EvmuHashCache_* pSelf) {
+    if(pSelf) free(pSelf->pScratch);
+    free(pSelf);
+}
+
+// Rehashes the flash blocks written since the last call, folding them into the running hash
+static void EvmuHash_flash_(EvmuHashCache_* pSelf, EvmuFlash_* pFlash_) {
+    const uint8_t* pData = pFlash_->pStorage->pData;
+
+    for(size_t b = 0; b < EVMU_FLASH_BLOCKS; ++b) {
+        if(!(pFlash_->stale[b / 64] >> (b % 64) & 1))
+            continue;
+
+        const EvmuStateHash hash = EvmuHash__bytes_(b,
+                                                    &pData[b * EVMU_FLASH_BLOCK_SIZE],
+                                                    EVMU_FLASH_BLOCK_SIZE);
+
+        pSelf->flash.lo  ^= pSelf->blocks[b].lo ^ hash.lo;
+        pSelf->flash.hi  ^= pSelf->blocks[b].hi ^ hash.hi;
+        pSelf->blocks[b]  = hash;
+    }
+
+    memset(pFlash_->stale, 0, sizeof(pFlash_->stale));
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_stateHash(const EvmuDevice* pSelf, EvmuStateHash* pHash) {
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_POINTER(pHash);
+
+    // Only the cache is modified, never the state being hashed
+    EvmuDevice_*    pSelf_ = EVMU_DEVICE_((EvmuDevice*)pSelf);
+    EvmuHashCache_* pCache = pSelf_->pHash;
+    size_t          size   = 0;
+
+    if(!pCache) {
+        GBL_CTX_VERIFY((pCache = calloc(1, sizeof(EvmuHashCache_))),
+                       GBL_RESULT_ERROR_INTERNAL,
+                       "Failed to allocate state hash cache!");
+
+        pSelf_->pHash = pCache;
+        memset(pSelf_->pFlash->stale, 0xff, sizeof(pSelf_->pFlash->stale));
+    }
+
+    // Everything but storage contents, small enough to simply rehash every time
+    EvmuIBehavior__saveExternal_(EVMU_IBEHAVIOR(pSelf), NULL, 0, &size);
+
+    if(size > pCache->scratchCapacity) {
+        uint8_t* pScratch = realloc(pCache->pScratch, size);
+
+        GBL_CTX_VERIFY(pScratch,
+                       GBL_RESULT_ERROR_INTERNAL,
+                       "Failed to allocate state hash scratch: [%zu bytes]",
+                       size);
+
+        pCache->pScratch        = pScratch;
+        pCache->scratchCapacity = size;
+    }
+
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior__saveExternal_(EVMU_IBEHAVIOR(pSelf),
+                                                     pCache->pScratch,
+                                                     pCache->scratchCapacity,
+                                                     &size));
+
+    EvmuHash_flash_(pCache, pSelf_->pFlash);
+
+    const EvmuStateHash regions[] = {
+        EvmuHash__bytes_(0, pCache->pScratch, size),
+        EvmuHash__bytes_(1, pSelf_->pWram->pStorage->pData, pSelf_->pWram->pStorage->size),
+        pCache->flash
+    };
+
+    *pHash = EvmuHash__bytes_(EVMU_HASH__PRIME_, regions, sizeof(regions));
+
+    GBL_CTX_END();
+}
@@ -0,0 +1,28 @@
+#ifndef EVMU_HASH__H
+#define EVMU_HASH__H
+
+#include <evmu/hw/evmu_device.h>
+
+#define EVMU_HASH__LANES_       4                       // independent accumulators per step
+#define EVMU_HASH__PRIME_       0x9e3779b97f4a7c15ull
+
+GBL_DECLS_BEGIN
+
+/* Hashes of the regions of a device which are too large to rehash on every call,
+ * along with scratch space for the rest of its state. Each flash block is hashed
+ * separately, with only those written since the last call being rehashed.
+ */
+GBL_DECLARE_STRUCT(EvmuHashCache_) {
+    EvmuStateHash flash;                        // XOR of every block hash
+    EvmuStateHash blocks[EVMU_FLASH_BLOCKS];
+    uint8_t*      pScratch;                     // external save state being hashed
+    size_t        scratchCapacity;
+};
+
+// Non-cryptographic 128-bit hash, consuming EVMU_HASH__LANES_ words at a time
+EvmuStateHash EvmuHash__bytes_       (uint64_t seed, const void* pData, size_t bytes);
+void          EvmuHashCache__destroy_(EvmuHashCache_* pSelf);
+
+GBL_DECLS_END
+
+#endif // EVMU_HASH__H
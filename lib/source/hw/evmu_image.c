@@ -0,0 +1,258 @@
+#include <evmu/hw/evmu_device.h>
+#include "evmu_device_.h"
+#include "evmu_ram_.h"
+#include "evmu_rom_.h"
+#include "evmu_flash_.h"
+#include "evmu_wram_.h"
+#include "evmu_image_.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef EVMU_HAVE_POSIX_FILES
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#endif
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_saveImage(const EvmuDevice* pSelf, const char* pPath) {
+    GBL_CTX_BEGIN(pSelf);
+
+    uint8_t* pState    = NULL;
+    FILE*    pFile     = NULL;
+    size_t   stateSize = 0;
+
+    GBL_CTX_VERIFY_POINTER(pPath);
+
+    const EvmuDevice_*  pSelf_ = EVMU_DEVICE_(pSelf);
+    const EvmuStorage_* pStorages[EVMU_IMAGE__REGION_COUNT_] = {
+        [EVMU_IMAGE__REGION_ROM_]   = pSelf_->pRom->pStorage,
+        [EVMU_IMAGE__REGION_FLASH_] = pSelf_->pFlash->pStorage,
+        [EVMU_IMAGE__REGION_WRAM_]  = pSelf_->pWram->pStorage
+    };
+
+    EvmuIBehavior__saveExternal_(EVMU_IBEHAVIOR(pSelf), NULL, 0, &stateSize);
+
+    GBL_CTX_VERIFY((pState = malloc(stateSize)),
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate state for image: [%zu bytes]",
+                   stateSize);
+
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior__saveExternal_(EVMU_IBEHAVIOR(pSelf), pState, stateSize, NULL));
+
+    EvmuImageHeader_ header = {
+        .magic     = EVMU_IMAGE__MAGIC_,
+        .version   = EVMU_IMAGE__VERSION_,
+        .endian    = EVMU_IBEHAVIOR__STATE_ENDIAN_,
+        .alignment = EVMU_IMAGE__ALIGNMENT_,
+        .state     = { sizeof(header), stateSize }
+    };
+
+    uint64_t offset = EVMU_IMAGE__ALIGN_(sizeof(header) + stateSize);
+
+    for(size_t r = 0; r < EVMU_IMAGE__REGION_COUNT_; ++r) {
+        header.regions[r].offset = offset;
+        header.regions[r].size   = pStorages[r]->size;
+        offset = EVMU_IMAGE__ALIGN_(offset + pStorages[r]->size);
+    }
+
+    GBL_CTX_VERIFY((pFile = fopen(pPath, "wb")),
+                   GBL_RESULT_ERROR_FILE_OPEN,
+                   "Failed to open state image for writing: [%s]",
+                   pPath);
+
+    GBL_CTX_VERIFY(fwrite(&header, sizeof(header), 1, pFile) == 1 &&
+                   fwrite(pState, 1, stateSize, pFile) == stateSize,
+                   GBL_RESULT_ERROR_FILE_WRITE,
+                   "Failed to write state image header: [%s]",
+                   pPath);
+
+    // Seeking past the end leaves the padding as holes on filesystems that support them
+    for(size_t r = 0; r < EVMU_IMAGE__REGION_COUNT_; ++r)
+        GBL_CTX_VERIFY(fseek(pFile, (long)header.regions[r].offset, SEEK_SET) == 0 &&
+                       fwrite(pStorages[r]->pData, 1, pStorages[r]->size, pFile) == pStorages[r]->size,
+                       GBL_RESULT_ERROR_FILE_WRITE,
+                       "Failed to write state image region: [%zu bytes at %zu]",
+                       pStorages[r]->size, (size_t)header.regions[r].offset);
+
+    GBL_CTX_VERIFY(fflush(pFile) == 0,
+                   GBL_RESULT_ERROR_FILE_WRITE,
+                   "Failed to flush state image: [%s]",
+                   pPath);
+
+    GBL_CTX_END_BLOCK();
+
+    if(pFile) fclose(pFile);
+    free(pState);
+
+    return GBL_CTX_RESULT();
+}
+
+#ifdef EVMU_HAVE_POSIX_FILES
+EvmuStorage_* EvmuStorage__map_(int fd, uint64_t offset, size_t size, GblBool writeBack) {
+    EvmuStorage_* pSelf = malloc(sizeof(EvmuStorage_));
+
+    if(!pSelf)
+        return NULL;
+
+    // Pages are only read in once touched, and private writes never leave memory
+    void* pData = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                       writeBack? MAP_SHARED : MAP_PRIVATE, fd, (off_t)offset);
+
+    if(pData == MAP_FAILED) {
+        free(pSelf);
+        return NULL;
+    }
+
+    pSelf->pData     = pData;
+    pSelf->size      = size;
+    pSelf->pArena    = NULL;
+    pSelf->mapped    = GBL_TRUE;
+    pSelf->writeBack = writeBack;
+    atomic_init(&pSelf->refCount, 1);
+
+    return pSelf;
+}
+
+void EvmuStorage__unmap_(EvmuStorage_* pSelf) {
+    munmap(pSelf->pData, pSelf->size);
+}
+
+static GblBool EvmuImage_regionValid_(const EvmuImageRegion_* pRegion, uint64_t fileSize) {
+    return pRegion->offset <= fileSize && pRegion->size <= fileSize - pRegion->offset;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_loadImage(EvmuDevice* pSelf, const char* pPath) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuDevice_*     pSelf_    = EVMU_DEVICE_(pSelf);
+    EvmuStorage_*    pMapped[EVMU_IMAGE__REGION_COUNT_] = { NULL };
+    void*            pState    = MAP_FAILED;
+    size_t           stateMap  = 0;
+    int              fd        = -1;
+    EvmuImageHeader_ header;
+    struct stat      info;
+
+    GBL_CTX_VERIFY_POINTER(pPath);
+
+    EvmuStorage_** ppStorages[EVMU_IMAGE__REGION_COUNT_] = {
+        [EVMU_IMAGE__REGION_ROM_]   = &pSelf_->pRom->pStorage,
+        [EVMU_IMAGE__REGION_FLASH_] = &pSelf_->pFlash->pStorage,
+        [EVMU_IMAGE__REGION_WRAM_]  = &pSelf_->pWram->pStorage
+    };
+
+    GBL_CTX_VERIFY((fd = open(pPath, O_RDONLY)) >= 0,
+                   GBL_RESULT_ERROR_FILE_OPEN,
+                   "Failed to open state image: [%s]",
+                   pPath);
+
+    GBL_CTX_VERIFY(fstat(fd, &info) == 0 &&
+                   pread(fd, &header, sizeof(header), 0) == sizeof(header),
+                   GBL_RESULT_ERROR_FILE_READ,
+                   "Failed to read state image header: [%s]",
+                   pPath);
+
+    GBL_CTX_VERIFY(header.magic == EVMU_IMAGE__MAGIC_,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Not a state image: [%s]",
+                   pPath);
+
+    GBL_CTX_VERIFY(header.version == EVMU_IMAGE__VERSION_ &&
+                   header.endian  == EVMU_IBEHAVIOR__STATE_ENDIAN_,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Unsupported state image: [version %u, byte order 0x%x]",
+                   header.version, header.endian);
+
+    GBL_CTX_VERIFY(header.alignment && header.alignment % (uint32_t)sysconf(_SC_PAGESIZE) == 0,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "State image regions aren't aligned to host pages: [%u bytes]",
+                   header.alignment);
+
+    GBL_CTX_VERIFY(header.state.offset == sizeof(header) &&
+                   EvmuImage_regionValid_(&header.state, info.st_size),
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Truncated state image: [%s]",
+                   pPath);
+
+    // Regions are mapped copy-on-write, so nothing is read until the emulator touches it
+    for(size_t r = 0; r < EVMU_IMAGE__REGION_COUNT_; ++r) {
+        const EvmuImageRegion_* pRegion = &header.regions[r];
+
+        GBL_CTX_VERIFY(EvmuImage_regionValid_(pRegion, info.st_size) &&
+                       pRegion->offset % header.alignment == 0 &&
+                       pRegion->size == (*ppStorages[r])->size,
+                       GBL_RESULT_ERROR_OUT_OF_RANGE,
+                       "Invalid state image region: [%zu bytes at %zu]",
+                       (size_t)pRegion->size, (size_t)pRegion->offset);
+
+        GBL_CTX_VERIFY((pMapped[r] = EvmuStorage__map_(fd, pRegion->offset, pRegion->size, GBL_FALSE)),
+                       GBL_RESULT_ERROR_INTERNAL,
+                       "Failed to map state image region: [%zu bytes at %zu]",
+                       (size_t)pRegion->size, (size_t)pRegion->offset);
+    }
+
+    stateMap = header.state.offset + header.state.size;
+    pState   = mmap(NULL, stateMap, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    GBL_CTX_VERIFY(pState != MAP_FAILED,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to map state image: [%s]",
+                   pPath);
+
+    /* Everything else is small enough to simply load, and doing so before touching
+     * storage means a rejected state is rolled back with the device's own storage
+     * still in place. The state is external, so it leaves contents alone. */
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior_loadState(EVMU_IBEHAVIOR(pSelf),
+                                                (const uint8_t*)pState + header.state.offset,
+                                                header.state.size));
+
+    // Nothing can fail from here on. Old storage may still be shared with a clone, which keeps its own reference
+    for(size_t r = 0; r < EVMU_IMAGE__REGION_COUNT_; ++r) {
+        EvmuStorage_* pOld = *ppStorages[r];
+
+        if(pSelf_->pRam->pExt == pOld->pData)
+            pSelf_->pRam->pExt = pMapped[r]->pData;
+
+        *ppStorages[r] = pMapped[r];
+        pMapped[r]     = NULL;
+        EvmuStorage__unref_(pOld);
+    }
+
+    ++pSelf_->pFlash->generation;
+
+    GBL_CTX_END_BLOCK();
+
+    for(size_t r = 0; r < EVMU_IMAGE__REGION_COUNT_; ++r)
+        EvmuStorage__unref_(pMapped[r]);
+
+    if(pState != MAP_FAILED) munmap(pState, stateMap);
+
+    // Mappings outlive the descriptor they were made from
+    if(fd >= 0) close(fd);
+
+    return GBL_CTX_RESULT();
+}
+
+#else
+
+EvmuStorage_* EvmuStorage__map_(int fd, uint64_t offset, size_t size, GblBool writeBack) {
+    GBL_UNUSED(fd, offset, size, writeBack);
+    return NULL;
+}
+
+// Nothing is ever mapped
+void EvmuStorage__unmap_(EvmuStorage_* pSelf) {
+    GBL_UNUSED(pSelf);
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_loadImage(EvmuDevice* pSelf, const char* pPath) {
+    GBL_CTX_BEGIN(pSelf);
+    GBL_UNUSED(pPath);
+
+    GBL_CTX_RECORD_SET(GBL_RESULT_UNSUPPORTED,
+                       "State images can only be loaded on POSIX hosts!");
+
+    GBL_CTX_END();
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef EVMU_IMAGE__H
+#define EVMU_IMAGE__H
+
+#include <evmu/hw/evmu_device.h>
+#include "../types/evmu_ibehavior_.h"
+
+#define EVMU_IMAGE__MAGIC_      EVMU_IBEHAVIOR__STATE_TAG_('E', 'V', 'M', 'I')
+#define EVMU_IMAGE__VERSION_    1
+#define EVMU_IMAGE__ALIGNMENT_  65536   // largest page size of any supported host
+
+#define EVMU_IMAGE__ALIGN_(size) \
+    (((size) + EVMU_IMAGE__ALIGNMENT_ - 1) & ~(uint64_t)(EVMU_IMAGE__ALIGNMENT_ - 1))
+
+GBL_DECLS_BEGIN
+
+typedef enum EVMU_IMAGE__REGION_ {
+    EVMU_IMAGE__REGION_ROM_,
+    EVMU_IMAGE__REGION_FLASH_,
+    EVMU_IMAGE__REGION_WRAM_,
+    EVMU_IMAGE__REGION_COUNT_
+} EVMU_IMAGE__REGION_;
+
+GBL_DECLARE_STRUCT(EvmuImageRegion_) {
+    uint64_t offset;    // from the start of the file
+    uint64_t size;
+};
+
+/* Leads off every state image, followed directly by an external save state, holding
+ * everything but the contents of ROM, flash, and WRAM. Those follow as raw regions,
+ * each starting on an aligned offset so that it can be mapped straight into memory.
+ */
+GBL_DECLARE_STRUCT(EvmuImageHeader_) {
+    uint32_t         magic;
+    uint16_t         version;
+    uint16_t         endian;    // EVMU_IBEHAVIOR__STATE_ENDIAN_ in the saving host's byte order
+    uint32_t         alignment; // EVMU_IMAGE__ALIGNMENT_ of the saving host
+    uint32_t         reserved;
+    EvmuImageRegion_ state;
+    EvmuImageRegion_ regions[EVMU_IMAGE__REGION_COUNT_];
+};
+
+GBL_DECLS_END
+
+#endif // EVMU_IMAGE__H
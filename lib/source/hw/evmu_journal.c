@@ -0,0 +1,523 @@
+#include <evmu/hw/evmu_flash.h>
+#include <gimbal/algorithms/gimbal_hash.h>
+#include "evmu_flash_.h"
+#include "evmu_journal_.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#ifdef EVMU_HAVE_POSIX_FILES
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/stat.h>
+// Not every POSIX host declares fdatasync(), for which fsync() is a slower but equally safe stand-in
+#   ifndef EVMU_HAVE_FDATASYNC
+#       define fdatasync fsync
+#   endif
+#endif
+
+#define EVMU_JOURNAL__BLOCK_RECORD_ (sizeof(EvmuJournalRecord_) + EVMU_FLASH_BLOCK_SIZE)
+
+static EVMU_RESULT EvmuJournal_join_(EvmuJournal_* pSelf) {
+    if(!pSelf->checkpointing)
+        return GBL_RESULT_SUCCESS;
+
+    thrd_join(pSelf->thread, NULL);
+    pSelf->checkpointing = GBL_FALSE;
+
+    return pSelf->checkpointResult;
+}
+
+#ifdef EVMU_HAVE_POSIX_FILES
+
+// Applies the contents of a block recovered from a journal
+typedef GblBool (*EvmuJournalApply_)(void* pUd, size_t block, const uint8_t* pData);
+
+static GblBool EvmuJournal_pread_(int fd, void* pData, size_t size, off_t offset) {
+    for(size_t done = 0; done < size; ) {
+        const ssize_t bytes = pread(fd, (uint8_t*)pData + done, size - done, offset + done);
+
+        if(bytes < 0 && errno == EINTR) continue;
+        if(bytes <= 0) return GBL_FALSE;
+
+        done += bytes;
+    }
+
+    return GBL_TRUE;
+}
+
+static GblBool EvmuJournal_pwrite_(int fd, const void* pData, size_t size, off_t offset) {
+    for(size_t done = 0; done < size; ) {
+        const ssize_t bytes = pwrite(fd, (const uint8_t*)pData + done, size - done, offset + done);
+
+        if(bytes < 0 && errno == EINTR) continue;
+        if(bytes <= 0) return GBL_FALSE;
+
+        done += bytes;
+    }
+
+    return GBL_TRUE;
+}
+
+// Makes renames, creations, and deletions within the directory holding \p pPath durable
+static GblBool EvmuJournal_syncDir_(const char* pPath) {
+    const char* pSlash = strrchr(pPath, '/');
+    char*       pDir   = pSlash? strndup(pPath, pSlash == pPath? 1 : (size_t)(pSlash - pPath)) : strdup(".");
+    GblBool     synced = GBL_FALSE;
+
+    if(pDir) {
+        const int fd = open(pDir, O_RDONLY | O_DIRECTORY);
+
+        if(fd >= 0) {
+            synced = fsync(fd) == 0;
+            close(fd);
+        }
+
+        free(pDir);
+    }
+
+    return synced;
+}
+
+static uint32_t EvmuJournal_crc_(EvmuJournalRecord_* pRecord, size_t size) {
+    const uint32_t crc = pRecord->crc;
+
+    pRecord->crc = 0;
+    const uint32_t computed = gblHashCrc(pRecord, size);
+    pRecord->crc = crc;
+
+    return computed;
+}
+
+// Writes a record into the batch buffer, returning its size
+static size_t EvmuJournal_record_(uint8_t* pOut, uint16_t block, uint16_t count, uint64_t sequence, const uint8_t* pData) {
+    const size_t        size   = pData? EVMU_JOURNAL__BLOCK_RECORD_ : sizeof(EvmuJournalRecord_);
+    EvmuJournalRecord_  record = {
+        .magic    = EVMU_JOURNAL__MAGIC_,
+        .block    = block,
+        .count    = count,
+        .sequence = sequence
+    };
+
+    memcpy(pOut, &record, sizeof(record));
+
+    if(pData)
+        memcpy(pOut + sizeof(record), pData, EVMU_FLASH_BLOCK_SIZE);
+
+    record.crc = EvmuJournal_crc_((EvmuJournalRecord_*)pOut, size);
+    memcpy(pOut, &record, sizeof(record));
+
+    return size;
+}
+
+/* Walks the batches in the journal, applying those which were committed in full and
+ * whose numbers follow \p *pSequence, and stopping at the first which wasn't, as
+ * that's where a crash tore the last append. Returns GBL_FALSE on I/O failure only.
+ */
+static GblBool EvmuJournal_replay_(int fd, EvmuJournalApply_ pFnApply, void* pUd, uint64_t* pSequence) {
+    struct stat info;
+    uint8_t*    pData   = NULL;
+    GblBool     success = GBL_FALSE;
+    size_t      offset  = 0;
+
+    if(fstat(fd, &info) != 0)
+        return GBL_FALSE;
+
+    const size_t fileSize = info.st_size;
+
+    if(!fileSize)
+        return GBL_TRUE;
+
+    if(!(pData = malloc(fileSize)) || !EvmuJournal_pread_(fd, pData, fileSize, 0))
+        goto done;
+
+    for(;;) {
+        EvmuJournalRecord_ record;
+        size_t             cursor = offset;
+        size_t             count  = 0;
+        uint64_t           batch  = 0;
+
+        for(;;) {
+            if(fileSize - cursor < sizeof(record))
+                goto applied;
+
+            memcpy(&record, &pData[cursor], sizeof(record));
+
+            const GblBool commit = record.block == EVMU_JOURNAL__COMMIT_;
+            const size_t  size   = commit? sizeof(record) : EVMU_JOURNAL__BLOCK_RECORD_;
+
+            if(record.magic != EVMU_JOURNAL__MAGIC_                                ||
+               (!commit && record.block >= EVMU_FLASH_BLOCKS)                      ||
+               fileSize - cursor < size                                            ||
+               (count? record.sequence != batch : record.sequence < *pSequence)    ||
+               record.crc != EvmuJournal_crc_((EvmuJournalRecord_*)&pData[cursor], size))
+                goto applied;
+
+            batch   = record.sequence;
+            cursor += size;
+
+            if(commit) {
+                if(record.count != count || !count)
+                    goto applied;
+                break;
+            }
+
+            ++count;
+        }
+
+        for(size_t r = 0; r < count; ++r) {
+            const size_t at = offset + r * EVMU_JOURNAL__BLOCK_RECORD_;
+
+            memcpy(&record, &pData[at], sizeof(record));
+
+            if(!pFnApply(pUd, record.block, &pData[at + sizeof(record)]))
+                goto done;
+        }
+
+        offset     = cursor;
+        *pSequence = batch + 1;
+    }
+
+applied:
+    success = GBL_TRUE;
+done:
+    free(pData);
+    return success;
+}
+
+static GblBool EvmuJournal_applyMemory_(void* pUd, size_t block, const uint8_t* pData) {
+    memcpy((uint8_t*)pUd + block * EVMU_FLASH_BLOCK_SIZE, pData, EVMU_FLASH_BLOCK_SIZE);
+    return GBL_TRUE;
+}
+
+static GblBool EvmuJournal_applyImage_(void* pUd, size_t block, const uint8_t* pData) {
+    const EvmuJournal_* pSelf = pUd;
+
+    return EvmuJournal_pwrite_(pSelf->imageFd, pData, EVMU_FLASH_BLOCK_SIZE, block * EVMU_FLASH_BLOCK_SIZE);
+}
+
+// Replays the retired journal into the image and deletes it, succeeding if there wasn't one
+static GblBool EvmuJournal_fold_(EvmuJournal_* pSelf) {
+    uint64_t  sequence = 0;
+    const int fd       = open(pSelf->pOldPath, O_RDONLY);
+
+    if(fd < 0)
+        return errno == ENOENT;
+
+    // Blocks are overwritten in place, so a crash partway through is repaired by folding again
+    const GblBool folded = EvmuJournal_replay_(fd, EvmuJournal_applyImage_, pSelf, &sequence) &&
+                           fsync(pSelf->imageFd) == 0;
+
+    close(fd);
+
+    return folded && unlink(pSelf->pOldPath) == 0 && EvmuJournal_syncDir_(pSelf->pOldPath);
+}
+
+static int EvmuJournal_checkpointMain_(void* pArg) {
+    EvmuJournal_* pSelf = pArg;
+
+    pSelf->checkpointResult = EvmuJournal_fold_(pSelf)?
+                                  GBL_RESULT_SUCCESS : GBL_RESULT_ERROR_FILE_WRITE;
+    return 0;
+}
+
+static char* EvmuJournal_path_(const char* pImagePath, const char* pSuffix) {
+    const size_t size  = strlen(pImagePath) + strlen(pSuffix) + 1;
+    char*        pPath = malloc(size);
+
+    if(pPath) snprintf(pPath, size, "%s%s", pImagePath, pSuffix);
+
+    return pPath;
+}
+
+static EvmuJournal_* EvmuJournal_create_(const char* pImagePath) {
+    EvmuJournal_* pSelf = calloc(1, sizeof(EvmuJournal_));
+
+    if(!pSelf)
+        return NULL;
+
+    pSelf->imageFd    = -1;
+    pSelf->fd         = -1;
+    pSelf->pPath      = EvmuJournal_path_(pImagePath, ".journal");
+    pSelf->pOldPath   = EvmuJournal_path_(pImagePath, ".journal.old");
+    pSelf->pBatch     = malloc(EVMU_FLASH_BLOCKS * EVMU_JOURNAL__BLOCK_RECORD_ + sizeof(EvmuJournalRecord_));
+
+    if(!pSelf->pPath || !pSelf->pOldPath || !pSelf->pBatch) {
+        EvmuJournal__destroy_(pSelf);
+        return NULL;
+    }
+
+    return pSelf;
+}
+
+void EvmuJournal__destroy_(EvmuJournal_* pSelf) {
+    if(!pSelf)
+        return;
+
+    EvmuJournal_join_(pSelf);
+
+    if(pSelf->fd >= 0)      close(pSelf->fd);
+    if(pSelf->imageFd >= 0) close(pSelf->imageFd);
+
+    free(pSelf->pPath);
+    free(pSelf->pOldPath);
+    free(pSelf->pBatch);
+    free(pSelf);
+}
+
+// Replays the retired journal followed by the active one on top of the image contents in \p pData
+static GblBool EvmuJournal_recover_(EvmuJournal_* pSelf, uint8_t* pData) {
+    const char* pPaths[] = { pSelf->pOldPath, pSelf->pPath };
+
+    for(size_t p = 0; p < GBL_COUNT_OF(pPaths); ++p) {
+        const int fd = open(pPaths[p], O_RDONLY);
+
+        if(fd < 0) {
+            if(errno == ENOENT) continue;
+            return GBL_FALSE;
+        }
+
+        const GblBool replayed = EvmuJournal_replay_(fd, EvmuJournal_applyMemory_, pData, &pSelf->sequence);
+
+        close(fd);
+
+        if(!replayed)
+            return GBL_FALSE;
+    }
+
+    return GBL_TRUE;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuFlash_openJournal(EvmuFlash* pSelf, const char* pPath) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuFlash_*   pSelf_   = EVMU_FLASH_(pSelf);
+    EvmuJournal_* pJournal = NULL;
+    struct stat   info;
+
+    GBL_CTX_VERIFY_POINTER(pPath);
+    GBL_CTX_VERIFY_CALL(EvmuFlash_closeJournal(pSelf));
+
+    GBL_CTX_VERIFY(!EvmuFlash_mapped(pSelf),
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "Cannot journal flash while it's backed by a mapped image!");
+
+    GBL_CTX_VERIFY((pJournal = EvmuJournal_create_(pPath)),
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate flash journal!");
+
+    GBL_CTX_VERIFY((pJournal->imageFd = open(pPath, O_RDWR | O_CREAT, 0644)) >= 0 &&
+                   fstat(pJournal->imageFd, &info) == 0,
+                   GBL_RESULT_ERROR_FILE_OPEN,
+                   "Failed to open flash image: [%s]",
+                   pPath);
+
+    GBL_CTX_VERIFY(!info.st_size || info.st_size == EVMU_FLASH_SIZE,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Flash image is the wrong size: [%s: %zu bytes]",
+                   pPath, (size_t)info.st_size);
+
+    GBL_CTX_VERIFY_CALL(EvmuFlash__detach_(pSelf_, 0, EVMU_FLASH_SIZE));
+
+    // A new image starts out as whatever's in flash already
+    if(info.st_size) {
+        GBL_CTX_VERIFY(EvmuJournal_pread_(pJournal->imageFd, pSelf_->pStorage->pData, EVMU_FLASH_SIZE, 0),
+                       GBL_RESULT_ERROR_FILE_READ,
+                       "Failed to read flash image: [%s]",
+                       pPath);
+
+        GBL_CTX_VERIFY(EvmuJournal_recover_(pJournal, pSelf_->pStorage->pData),
+                       GBL_RESULT_ERROR_FILE_READ,
+                       "Failed to recover flash journal: [%s]",
+                       pJournal->pPath);
+
+        pSelf->dataChanged = GBL_TRUE;
+    }
+
+    // Only once the image holds everything recovered can the journals start over empty
+    GBL_CTX_VERIFY(EvmuJournal_pwrite_(pJournal->imageFd, pSelf_->pStorage->pData, EVMU_FLASH_SIZE, 0) &&
+                   fsync(pJournal->imageFd) == 0,
+                   GBL_RESULT_ERROR_FILE_WRITE,
+                   "Failed to write flash image: [%s]",
+                   pPath);
+
+    GBL_CTX_VERIFY((unlink(pJournal->pOldPath) == 0 || errno == ENOENT) &&
+                   (pJournal->fd = open(pJournal->pPath, O_RDWR | O_CREAT | O_TRUNC, 0644)) >= 0 &&
+                   EvmuJournal_syncDir_(pJournal->pPath),
+                   GBL_RESULT_ERROR_FILE_OPEN,
+                   "Failed to start flash journal: [%s]",
+                   pJournal->pPath);
+
+    memset(pSelf_->unsynced, 0, sizeof(pSelf_->unsynced));
+
+    pSelf_->pJournal = pJournal;
+    pJournal         = NULL;
+
+    GBL_CTX_END_BLOCK();
+
+    EvmuJournal__destroy_(pJournal);
+
+    return GBL_CTX_RESULT();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuFlash_syncJournal(EvmuFlash* pSelf) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuFlash_*   pSelf_   = EVMU_FLASH_(pSelf);
+    EvmuJournal_* pJournal = pSelf_->pJournal;
+    size_t        size     = 0;
+    uint16_t      count    = 0;
+
+    GBL_CTX_VERIFY(pJournal,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "Flash isn't being journaled!");
+
+    for(size_t b = 0; b < EVMU_FLASH_BLOCKS; ++b) {
+        if(!(pSelf_->unsynced[b / 64] >> (b % 64) & 1))
+            continue;
+
+        size += EvmuJournal_record_(&pJournal->pBatch[size],
+                                    (uint16_t)b,
+                                    0,
+                                    pJournal->sequence,
+                                    &pSelf_->pStorage->pData[b * EVMU_FLASH_BLOCK_SIZE]);
+        ++count;
+    }
+
+    if(!count)
+        GBL_CTX_DONE();
+
+    size += EvmuJournal_record_(&pJournal->pBatch[size], EVMU_JOURNAL__COMMIT_, count, pJournal->sequence, NULL);
+
+    // Burned even on failure, so what's left of a torn batch can never pass for the one written over it
+    ++pJournal->sequence;
+
+    GBL_CTX_VERIFY(EvmuJournal_pwrite_(pJournal->fd, pJournal->pBatch, size, pJournal->size) &&
+                   fdatasync(pJournal->fd) == 0,
+                   GBL_RESULT_ERROR_FILE_WRITE,
+                   "Failed to append to flash journal: [%s]",
+                   pJournal->pPath);
+
+    pJournal->size += size;
+    memset(pSelf_->unsynced, 0, sizeof(pSelf_->unsynced));
+
+    if(pJournal->size >= EVMU_JOURNAL__CHECKPOINT_SIZE_)
+        GBL_CTX_VERIFY_CALL(EvmuFlash_checkpointJournal(pSelf));
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuFlash_checkpointJournal(EvmuFlash* pSelf) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuJournal_* pJournal = EVMU_FLASH_(pSelf)->pJournal;
+    int           fd       = -1;
+
+    GBL_CTX_VERIFY(pJournal,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "Flash isn't being journaled!");
+
+    // Only one journal can be retired at a time, so a failed fold has to be retried first
+    EvmuJournal_join_(pJournal);
+
+    GBL_CTX_VERIFY(EvmuJournal_fold_(pJournal),
+                   GBL_RESULT_ERROR_FILE_WRITE,
+                   "Failed to checkpoint flash journal: [%s]",
+                   pJournal->pOldPath);
+
+    if(!pJournal->size)
+        GBL_CTX_DONE();
+
+    // Renaming is atomic, so a crash leaves the batches in one journal or the other
+    GBL_CTX_VERIFY(rename(pJournal->pPath, pJournal->pOldPath) == 0 &&
+                   (fd = open(pJournal->pPath, O_RDWR | O_CREAT | O_TRUNC, 0644)) >= 0 &&
+                   EvmuJournal_syncDir_(pJournal->pPath),
+                   GBL_RESULT_ERROR_FILE_WRITE,
+                   "Failed to retire flash journal: [%s]",
+                   pJournal->pPath);
+
+    close(pJournal->fd);
+    pJournal->fd   = fd;
+    pJournal->size = 0;
+    fd             = -1;
+
+    // Folding only touches the image and the retired journal, never flash itself
+    if(thrd_create(&pJournal->thread, EvmuJournal_checkpointMain_, pJournal) == thrd_success)
+        pJournal->checkpointing = GBL_TRUE;
+    else
+        GBL_CTX_VERIFY(EvmuJournal_fold_(pJournal),
+                       GBL_RESULT_ERROR_FILE_WRITE,
+                       "Failed to checkpoint flash journal: [%s]",
+                       pJournal->pOldPath);
+
+    GBL_CTX_END_BLOCK();
+
+    if(fd >= 0) close(fd);
+
+    return GBL_CTX_RESULT();
+}
+
+#else
+
+// Journals are never created without POSIX files
+void EvmuJournal__destroy_(EvmuJournal_* pSelf) {
+    GBL_UNUSED(pSelf);
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuFlash_openJournal(EvmuFlash* pSelf, const char* pPath) {
+    GBL_CTX_BEGIN(pSelf);
+    GBL_UNUSED(pPath);
+
+    GBL_CTX_RECORD_SET(GBL_RESULT_UNSUPPORTED,
+                       "Flash can only be journaled on POSIX hosts!");
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuFlash_syncJournal(EvmuFlash* pSelf) {
+    GBL_CTX_BEGIN(pSelf);
+
+    GBL_CTX_RECORD_SET(GBL_RESULT_UNSUPPORTED,
+                       "Flash can only be journaled on POSIX hosts!");
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuFlash_checkpointJournal(EvmuFlash* pSelf) {
+    GBL_CTX_BEGIN(pSelf);
+
+    GBL_CTX_RECORD_SET(GBL_RESULT_UNSUPPORTED,
+                       "Flash can only be journaled on POSIX hosts!");
+
+    GBL_CTX_END();
+}
+
+#endif
+
+EVMU_EXPORT EVMU_RESULT EvmuFlash_closeJournal(EvmuFlash* pSelf) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuFlash_* pSelf_ = EVMU_FLASH_(pSelf);
+
+    if(!pSelf_->pJournal)
+        GBL_CTX_DONE();
+
+    GBL_CTX_VERIFY_CALL(EvmuFlash_syncJournal(pSelf));
+    GBL_CTX_VERIFY_CALL(EvmuJournal_join_(pSelf_->pJournal));
+
+    EvmuJournal__destroy_(pSelf_->pJournal);
+    pSelf_->pJournal = NULL;
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT GblBool EvmuFlash_journaling(const EvmuFlash* pSelf) {
+    return EVMU_FLASH_(pSelf)->pJournal != NULL;
+}
+
+EVMU_EXPORT size_t EvmuFlash_journalSize(const EvmuFlash* pSelf) {
+    const EvmuJournal_* pJournal = EVMU_FLASH_(pSelf)->pJournal;
+
+    return pJournal? pJournal->size : 0;
+}
@@ -0,0 +1,52 @@
+#ifndef EVMU_JOURNAL__H
+#define EVMU_JOURNAL__H
+
+#include <evmu/hw/evmu_flash.h>
+#include "../types/evmu_thread_.h"
+#include "../types/evmu_ibehavior_.h"
+
+#define EVMU_JOURNAL__MAGIC_            EVMU_IBEHAVIOR__STATE_TAG_('E', 'V', 'M', 'J')
+#define EVMU_JOURNAL__COMMIT_           0xffff      // block of the record ending each batch
+#define EVMU_JOURNAL__CHECKPOINT_SIZE_  (1 << 20)   // journal bytes which trigger a checkpoint when synced
+
+GBL_DECLS_BEGIN
+
+/* Leads off every journal record, with block records followed by the contents of
+ * the block. A sync appends a batch of block records followed by a commit record
+ * holding their count, so a batch only counts once its commit has made it to disk.
+ * The CRC covers the record with its crc field zeroed, along with its contents.
+ */
+GBL_DECLARE_STRUCT(EvmuJournalRecord_) {
+    uint32_t magic;
+    uint16_t block;     // index of the block, or EVMU_JOURNAL__COMMIT_
+    uint16_t count;     // COMMIT: block records in the batch
+    uint64_t sequence;  // batch number, increasing across every journal of an image
+    uint32_t crc;
+    uint32_t reserved;
+};
+
+/* Write-ahead journal persisting flash to an image file. Syncs append modified
+ * blocks to the active journal. Checkpoints retire it by renaming it aside, then
+ * fold the retired journal into the image on a background thread, deleting it
+ * once the image is durable. Recovery replays the retired journal followed by
+ * the active one, so a crash at any point leaves every committed batch intact.
+ */
+GBL_DECLARE_STRUCT(EvmuJournal_) {
+    char*       pPath;          // active journal, beside the image
+    char*       pOldPath;       // retired journal, being folded into the image
+    int         imageFd;
+    int         fd;
+    uint64_t    sequence;       // number of the next batch
+    size_t      size;           // bytes of committed batches in the active journal
+    uint8_t*    pBatch;         // room for a batch holding every block
+    thrd_t      thread;         // folds the retired journal into the image
+    GblBool     checkpointing;
+    EVMU_RESULT checkpointResult;
+};
+
+// Waits for any checkpoint to finish, then closes and frees everything
+void EvmuJournal__destroy_(EvmuJournal_* pSelf);
+
+GBL_DECLS_END
+
+#endif // EVMU_JOURNAL__H
@@ -1,11 +1,26 @@
 #include "hw/evmu_lcd_.h"
 #include "hw/evmu_device_.h"
 #include "hw/evmu_ram_.h"
+#include "types/evmu_ibehavior_.h"
 #include <evmu/hw/evmu_address_space.h>
 #include <gimbal/meta/signals/gimbal_marshal.h>
+#include <gyro_vmu_lcd.h>
 
 #define EVMU_LCD_REFRESH_TICKS_83HZ_     12
 #define EVMU_LCD_REFRESH_TICKS_166HZ_    6
+#define EVMU_LCD_TICKS_PER_SEC_          1000000 // EvmuCpu drives the LCD in microseconds
+#define EVMU_LCD_DEVICE_TICKS_PER_SEC_   1000000000 // EvmuDevice is driven in nanoseconds
+#define EVMU_LCD_FRAME_HASH_ICONS_       EVMU_LCD_FRAME_SIZE // Hash slot following the frame bytes
+#define EVMU_LCD_ROW_BYTES_              (EVMU_LCD_PIXEL_WIDTH / 8)
+
+// Frame records are a LEB128 timestamp delta followed by an RLE-encoded XOR delta
+#define EVMU_LCD_RLE_LITERAL_            0x00 // 0x00-0x3f: (n+1) literal bytes follow
+#define EVMU_LCD_RLE_ZEROS_              0x40 // 0x40-0x7f: (n+1) zero bytes
+#define EVMU_LCD_RLE_REPEAT_             0x80 // 0x80-0xff: following byte is repeated (n+1) times
+#define EVMU_LCD_RLE_RUN_MAX_            64
+#define EVMU_LCD_RLE_REPEAT_MAX_         128
+#define EVMU_LCD_RECORD_MIN_             4
+#define EVMU_LCD_RECORD_MAX_             (10 + EVMU_LCD_FRAME_SIZE + EVMU_LCD_FRAME_SIZE / EVMU_LCD_RLE_RUN_MAX_ + 1)
 
 // 6 bytes per row (8 bits per byte) = 48 bits per row
 // rows are in groups of 2
@@ -60,6 +75,31 @@ GBL_INLINE size_t iconBit_(GblFlags icon) {
     return bit;
 }
 
+// byte offset of the given screen row within its XRAM bank
+GBL_INLINE size_t xramRowOffset_(size_t row) {
+    return ((row & 0xf) >> 1) * 16 + (row & 0x1) * EVMU_LCD_ROW_BYTES_;
+}
+
+// raw frame byte index for the given XRAM location, or GBL_NPOS if it isn't displayed
+GBL_INLINE size_t xramFrameIndex_(size_t bank, size_t offset) {
+    const size_t col = offset & 0xf;
+
+    if(bank > EVMU_XRAM_BANK_LCD_BOTTOM || col >= 2 * EVMU_LCD_ROW_BYTES_)
+        return GBL_NPOS;
+
+    const size_t row = bank * 16 + (offset >> 4) * 2 + col / EVMU_LCD_ROW_BYTES_;
+    return row * EVMU_LCD_ROW_BYTES_ + col % EVMU_LCD_ROW_BYTES_;
+}
+
+// splitmix64 finalizer over the byte position and its value
+GBL_INLINE uint64_t frameHashByte_(size_t position, uint8_t value) {
+    uint64_t key = ((uint64_t)position << 8) | value;
+
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+    return key ^ (key >> 31);
+}
+
 GBL_INLINE void xramBitFromRowCol_(int x, int y, unsigned* bank, int* addr, unsigned* bit) {
     *bank = y/16;
     unsigned row = y%16;
@@ -147,7 +187,8 @@ EVMU_EXPORT void EvmuLcd_setPixel(EvmuLcd* pSelf, size_t x, size_t y, GblBool on
     xramBitFromRowCol_(x, y, &bank, &addr, &bit);
     addr -= 0x180;
 
-    int prevVal = pSelf_->pRam->xram[bank][addr] & (0x1<<bit);
+    const EvmuWord prevByte = pSelf_->pRam->xram[bank][addr];
+    int prevVal = prevByte & (0x1<<bit);
 
     if(on != prevVal) {
         if(on) {
@@ -156,6 +197,7 @@ EVMU_EXPORT void EvmuLcd_setPixel(EvmuLcd* pSelf, size_t x, size_t y, GblBool on
             pSelf_->pRam->xram[bank][addr] &= ~(0x1<<bit);
         }
 
+        EvmuLcd__xramWrite_(pSelf_, bank, addr, prevByte, pSelf_->pRam->xram[bank][addr]);
         pSelf->screenChanged = GBL_TRUE;
     }
 }
@@ -267,11 +309,787 @@ EVMU_EXPORT void EvmuLcd_setIcons(EvmuLcd* pSelf, EVMU_LCD_ICONS icons) {
     }
 
     if(changed) {
+        EvmuLcd__xramWrite_(pSelf_, EVMU_XRAM_BANK_ICON, EVMU_XRAM_OFFSET(EVMU_ADDRESS_XRAM_ICN_FILE), 0, 0);
         pSelf->screenChanged = GBL_TRUE;
         GblSignal_emit(GBL_INSTANCE(pSelf), "iconsChange", icons);
     }
 }
 
+EVMU_EXPORT void EvmuLcd_frame(const EvmuLcd* pSelf, uint8_t* pFrame) {
+    EvmuLcd_* pSelf_ = EVMU_LCD_(pSelf);
+
+    for(size_t y = 0; y < EVMU_LCD_PIXEL_HEIGHT; ++y)
+        memcpy(&pFrame[y * EVMU_LCD_ROW_BYTES_],
+               &pSelf_->pRam->xram[y / 16][xramRowOffset_(y)],
+               EVMU_LCD_ROW_BYTES_);
+}
+
+EVMU_EXPORT void EvmuLcd_setFrame(EvmuLcd* pSelf, const uint8_t* pFrame) {
+    EvmuLcd_* pSelf_ = EVMU_LCD_(pSelf);
+
+    for(size_t y = 0; y < EVMU_LCD_PIXEL_HEIGHT; ++y)
+        memcpy(&pSelf_->pRam->xram[y / 16][xramRowOffset_(y)],
+               &pFrame[y * EVMU_LCD_ROW_BYTES_],
+               EVMU_LCD_ROW_BYTES_);
+
+    EvmuLcd__rehash_(pSelf_);
+    pSelf->screenChanged = GBL_TRUE;
+}
+
+void EvmuLcd__xramWrite_(EvmuLcd_* pSelf_, size_t bank, size_t offset, EvmuWord prevValue, EvmuWord value) {
+    if(bank == EVMU_XRAM_BANK_ICON) {
+        if(offset >= EVMU_XRAM_OFFSET(EVMU_ADDRESS_XRAM_ICN_FILE) &&
+           offset <= EVMU_XRAM_OFFSET(EVMU_ADDRESS_XRAM_ICN_FLASH))
+        {
+            const EVMU_LCD_ICONS icons = EvmuLcd_icons(EVMU_LCD_PUBLIC_(pSelf_));
+
+            if(icons != pSelf_->hashedIcons) {
+                pSelf_->frameHash  ^= frameHashByte_(EVMU_LCD_FRAME_HASH_ICONS_, pSelf_->hashedIcons) ^
+                                      frameHashByte_(EVMU_LCD_FRAME_HASH_ICONS_, icons);
+                pSelf_->hashedIcons = icons;
+            }
+        }
+    } else if(prevValue != value) {
+        const size_t index = xramFrameIndex_(bank, offset);
+
+        if(index != GBL_NPOS)
+            pSelf_->frameHash ^= frameHashByte_(index, prevValue) ^ frameHashByte_(index, value);
+    }
+}
+
+void EvmuLcd__rehash_(EvmuLcd_* pSelf_) {
+    EvmuLcd* pSelf = EVMU_LCD_PUBLIC_(pSelf_);
+    uint8_t  frame[EVMU_LCD_FRAME_SIZE];
+
+    EvmuLcd_frame(pSelf, frame);
+
+    pSelf_->hashedIcons = EvmuLcd_icons(pSelf);
+    pSelf_->frameHash   = EvmuLcd_hashFrame(frame, pSelf_->hashedIcons);
+}
+
+EVMU_EXPORT uint64_t EvmuLcd_hashFrame(const uint8_t* pFrame, EVMU_LCD_ICONS icons) {
+    uint64_t hash = frameHashByte_(EVMU_LCD_FRAME_HASH_ICONS_, icons);
+
+    for(size_t b = 0; b < EVMU_LCD_FRAME_SIZE; ++b)
+        hash ^= frameHashByte_(b, pFrame[b]);
+
+    return hash;
+}
+
+EVMU_EXPORT uint64_t EvmuLcd_frameHash(const EvmuLcd* pSelf) {
+    return EVMU_LCD_(pSelf)->frameHash;
+}
+
+EVMU_EXPORT GblBool EvmuLcd_runUntilHash(EvmuLcd*   pSelf,
+                                         uint64_t   hash,
+                                         EvmuTicks  timeout,
+                                         EvmuTicks* pElapsed)
+{
+    EvmuDevice*     pDevice = EvmuPeripheral_device(EVMU_PERIPHERAL(pSelf));
+    EvmuTicks       elapsed = 0;
+    GblBool         found   = EvmuLcd_frameHash(pSelf) == hash;
+
+    // Step one software screen refresh at a time, in device ticks
+    const EvmuTicks slice   = EvmuLcd_refreshRateTicks(pSelf) * EVMU_LCD_SCREEN_REFRESH_DIVISOR *
+                              (EVMU_LCD_DEVICE_TICKS_PER_SEC_ / EVMU_LCD_TICKS_PER_SEC_);
+
+    while(!found && elapsed < timeout) {
+        const EvmuTicks step = (timeout - elapsed < slice)? timeout - elapsed : slice;
+
+        if(GBL_RESULT_ERROR(EvmuIBehavior_update(EVMU_IBEHAVIOR(pDevice), step)))
+            break;
+
+        elapsed += step;
+        found    = EvmuLcd_frameHash(pSelf) == hash;
+    }
+
+    if(pElapsed) *pElapsed = elapsed;
+
+    return found;
+}
+
+// Sequential decoder state for walking the recording stream
+typedef struct EvmuLcdRecorderCursor_ {
+    size_t    offset;
+    size_t    frame;
+    EvmuTicks timestamp;
+    uint8_t   pixels[EVMU_LCD_FRAME_SIZE];
+} EvmuLcdRecorderCursor_;
+
+GBL_INLINE size_t recorderCapacity_(const EvmuLcdRecorder_* pRec) {
+    return pRec->pStream->size;
+}
+
+GBL_INLINE EvmuLcdKeyFrame_* recorderKeyFrame_(const EvmuLcdRecorder_* pRec, size_t group) {
+    const size_t count = pRec->pKeyFrames->size / sizeof(EvmuLcdKeyFrame_);
+    return &((EvmuLcdKeyFrame_*)pRec->pKeyFrames->pData)[(pRec->keyFrameTail + group) % count];
+}
+
+GBL_INLINE uint8_t recorderByte_(const EvmuLcdRecorder_* pRec, size_t* pOffset) {
+    const uint8_t value = pRec->pStream->pData[*pOffset];
+    *pOffset = (*pOffset + 1) % recorderCapacity_(pRec);
+    return value;
+}
+
+static size_t varintEncode_(uint64_t value, uint8_t* pDst) {
+    size_t size = 0;
+
+    do {
+        pDst[size] = value & 0x7f;
+        value >>= 7;
+        if(value) pDst[size] |= 0x80;
+    } while(pDst[size++] & 0x80);
+
+    return size;
+}
+
+static uint64_t varintDecode_(const EvmuLcdRecorder_* pRec, size_t* pOffset) {
+    uint64_t value = 0;
+    unsigned shift = 0;
+    uint8_t  byte;
+
+    do {
+        byte   = recorderByte_(pRec, pOffset);
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while(byte & 0x80);
+
+    return value;
+}
+
+static size_t rleEncode_(const uint8_t* pSrc, uint8_t* pDst) {
+    size_t in = 0, out = 0;
+
+    while(in < EVMU_LCD_FRAME_SIZE) {
+        const uint8_t* pIn  = &pSrc[in];
+        const size_t   left = EVMU_LCD_FRAME_SIZE - in;
+        size_t         run  = 1;
+
+        if(!pIn[0] && (left == 1 || !pIn[1])) {
+            while(run < left && run < EVMU_LCD_RLE_RUN_MAX_ && !pIn[run])
+                ++run;
+            pDst[out++] = EVMU_LCD_RLE_ZEROS_ | (run - 1);
+        } else if(left >= 3 && pIn[0] == pIn[1] && pIn[1] == pIn[2]) {
+            while(run < left && run < EVMU_LCD_RLE_REPEAT_MAX_ && pIn[run] == pIn[0])
+                ++run;
+            pDst[out++] = EVMU_LCD_RLE_REPEAT_ | (run - 1);
+            pDst[out++] = pIn[0];
+        } else {
+            // Literals swallow isolated zeroes, only stopping for runs worth encoding
+            run = 0;
+            while(run < left && run < EVMU_LCD_RLE_RUN_MAX_) {
+                const uint8_t* pCur    = &pIn[run];
+                const size_t   curLeft = left - run;
+                if(curLeft >= 2 && !pCur[0] && !pCur[1]) break;
+                if(curLeft >= 3 && pCur[0] == pCur[1] && pCur[1] == pCur[2]) break;
+                ++run;
+            }
+            pDst[out++] = EVMU_LCD_RLE_LITERAL_ | (run - 1);
+            memcpy(&pDst[out], pIn, run);
+            out += run;
+        }
+
+        in += run;
+    }
+
+    return out;
+}
+
+// XORs the decoded delta into pFrame
+static void rleDecode_(const EvmuLcdRecorder_* pRec, size_t* pOffset, uint8_t* pFrame) {
+    size_t out = 0;
+
+    while(out < EVMU_LCD_FRAME_SIZE) {
+        const uint8_t ctrl = recorderByte_(pRec, pOffset);
+
+        if(ctrl & EVMU_LCD_RLE_REPEAT_) {
+            const uint8_t value = recorderByte_(pRec, pOffset);
+            for(size_t r = 0; r <= (ctrl & 0x7f); ++r)
+                pFrame[out++] ^= value;
+        } else if(ctrl & EVMU_LCD_RLE_ZEROS_) {
+            out += (ctrl & 0x3f) + 1;
+        } else {
+            for(size_t r = 0; r <= ctrl; ++r)
+                pFrame[out++] ^= recorderByte_(pRec, pOffset);
+        }
+    }
+
+    GBL_ASSERT(out == EVMU_LCD_FRAME_SIZE, "Corrupt LCD frame record!");
+}
+
+static void recorderDecode_(const EvmuLcdRecorder_* pRec, EvmuLcdRecorderCursor_* pCursor) {
+    const EvmuTicks delta = varintDecode_(pRec, &pCursor->offset);
+
+    if(!(pCursor->frame % EVMU_LCD_RECORDER_KEYFRAME_INTERVAL)) {
+        pCursor->timestamp = recorderKeyFrame_(pRec, pCursor->frame / EVMU_LCD_RECORDER_KEYFRAME_INTERVAL)->timestamp;
+        memset(pCursor->pixels, 0, sizeof(pCursor->pixels));
+    } else {
+        pCursor->timestamp += delta;
+    }
+
+    rleDecode_(pRec, &pCursor->offset, pCursor->pixels);
+    ++pCursor->frame;
+}
+
+static void recorderSeek_(const EvmuLcdRecorder_* pRec, EvmuLcdRecorderCursor_* pCursor, size_t frame) {
+    pCursor->frame  = frame - frame % EVMU_LCD_RECORDER_KEYFRAME_INTERVAL;
+    pCursor->offset = recorderKeyFrame_(pRec, frame / EVMU_LCD_RECORDER_KEYFRAME_INTERVAL)->offset;
+
+    while(pCursor->frame <= frame)
+        recorderDecode_(pRec, pCursor);
+}
+
+static void EvmuLcd_recordFrame_(EvmuLcd* pSelf) {
+    EvmuLcdRecorder_* pRec = &EVMU_LCD_(pSelf)->recorder;
+    uint8_t           frame[EVMU_LCD_FRAME_SIZE];
+    uint8_t           delta[EVMU_LCD_FRAME_SIZE];
+    uint8_t           record[EVMU_LCD_RECORD_MAX_];
+
+    EvmuLcd_frame(pSelf, frame);
+
+    // Unchanged frames are folded into the next one's timestamp delta
+    if(pRec->frameCount && !memcmp(frame, pRec->prevFrame, sizeof(frame)))
+        return;
+
+    const GblBool keyFrame = !(pRec->frameCount % EVMU_LCD_RECORDER_KEYFRAME_INTERVAL);
+
+    for(size_t b = 0; b < EVMU_LCD_FRAME_SIZE; ++b)
+        delta[b] = keyFrame? frame[b] : frame[b] ^ pRec->prevFrame[b];
+
+    size_t size = varintEncode_(pRec->elapsed - pRec->prevTimestamp, record);
+    size += rleEncode_(delta, &record[size]);
+
+    const size_t capacity = recorderCapacity_(pRec);
+
+    // Evict the oldest keyframe group until the new record fits
+    while(pRec->bytes + size > capacity) {
+        GBL_ASSERT(pRec->keyFrameCount > 1, "LCD recording buffer too small for a single keyframe group!");
+
+        const size_t next = recorderKeyFrame_(pRec, 1)->offset;
+        pRec->bytes       -= (next + capacity - pRec->tail) % capacity;
+        pRec->tail         = next;
+        pRec->keyFrameTail = (pRec->keyFrameTail + 1) % (pRec->pKeyFrames->size / sizeof(EvmuLcdKeyFrame_));
+        pRec->frameCount  -= EVMU_LCD_RECORDER_KEYFRAME_INTERVAL;
+        --pRec->keyFrameCount;
+    }
+
+    if(keyFrame) {
+        EvmuLcdKeyFrame_* pKey = recorderKeyFrame_(pRec, pRec->keyFrameCount++);
+        pKey->timestamp = pRec->elapsed;
+        pKey->offset    = pRec->head;
+    }
+
+    const size_t firstChunk = (capacity - pRec->head < size)? capacity - pRec->head : size;
+    memcpy(&pRec->pStream->pData[pRec->head], record, firstChunk);
+    memcpy(pRec->pStream->pData, &record[firstChunk], size - firstChunk);
+
+    pRec->head          = (pRec->head + size) % capacity;
+    pRec->bytes        += size;
+    pRec->prevTimestamp = pRec->elapsed;
+    ++pRec->frameCount;
+    memcpy(pRec->prevFrame, frame, sizeof(frame));
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuLcd_startRecording(EvmuLcd* pSelf, size_t capacity) {
+    EvmuLcdRecorder_* pRec = &EVMU_LCD_(pSelf)->recorder;
+
+    GBL_CTX_BEGIN(NULL);
+
+    if(!capacity) capacity = EVMU_LCD_RECORDER_DEFAULT_CAPACITY;
+
+    GBL_CTX_VERIFY(capacity >= EVMU_LCD_RECORDER_MIN_CAPACITY,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "LCD recording buffer too small: [%zu/%zu bytes]",
+                   capacity,
+                   (size_t)EVMU_LCD_RECORDER_MIN_CAPACITY);
+
+    EvmuLcd_clearRecording(pSelf);
+
+    pRec->pStream    = GblByteArray_create(capacity);
+    pRec->pKeyFrames = GblByteArray_create(sizeof(EvmuLcdKeyFrame_) *
+                                           (capacity / (EVMU_LCD_RECORDER_KEYFRAME_INTERVAL *
+                                                        EVMU_LCD_RECORD_MIN_) + 2));
+
+    GBL_CTX_VERIFY(pRec->pStream && pRec->pKeyFrames,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate LCD recording buffer!");
+
+    pRec->active = GBL_TRUE;
+
+    // Always begin with whatever is currently on-screen
+    EvmuLcd_recordFrame_(pSelf);
+
+    GBL_CTX_END_BLOCK();
+
+    if(GBL_RESULT_ERROR(GBL_CTX_RESULT()))
+        EvmuLcd_clearRecording(pSelf);
+
+    return GBL_CTX_RESULT();
+}
+
+EVMU_EXPORT void EvmuLcd_stopRecording(EvmuLcd* pSelf) {
+    EVMU_LCD_(pSelf)->recorder.active = GBL_FALSE;
+}
+
+EVMU_EXPORT void EvmuLcd_clearRecording(EvmuLcd* pSelf) {
+    EvmuLcdRecorder_* pRec = &EVMU_LCD_(pSelf)->recorder;
+
+    if(pRec->pStream)    GblByteArray_unref(pRec->pStream);
+    if(pRec->pKeyFrames) GblByteArray_unref(pRec->pKeyFrames);
+
+    memset(pRec, 0, sizeof(EvmuLcdRecorder_));
+}
+
+EVMU_EXPORT GblBool EvmuLcd_recording(const EvmuLcd* pSelf) {
+    return EVMU_LCD_(pSelf)->recorder.active;
+}
+
+EVMU_EXPORT size_t EvmuLcd_recordedFrames(const EvmuLcd* pSelf) {
+    return EVMU_LCD_(pSelf)->recorder.frameCount;
+}
+
+EVMU_EXPORT size_t EvmuLcd_recordedBytes(const EvmuLcd* pSelf) {
+    return EVMU_LCD_(pSelf)->recorder.bytes;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuLcd_recordedFrame(const EvmuLcd* pSelf,
+                                              size_t         index,
+                                              uint8_t*       pFrame,
+                                              EvmuTicks*     pTimestamp)
+{
+    const EvmuLcdRecorder_* pRec = &EVMU_LCD_(pSelf)->recorder;
+    EvmuLcdRecorderCursor_  cursor;
+
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_CTX_VERIFY_POINTER(pFrame);
+    GBL_CTX_VERIFY(index < pRec->frameCount,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Recorded LCD frame out of range: [%zu/%zu]",
+                   index,
+                   pRec->frameCount);
+
+    recorderSeek_(pRec, &cursor, index);
+
+    memcpy(pFrame, cursor.pixels, EVMU_LCD_FRAME_SIZE);
+    if(pTimestamp) *pTimestamp = cursor.timestamp;
+
+    GBL_CTX_END();
+}
+
+GBL_INLINE uint64_t lcdFileDelays_(EvmuTicks ticks) {
+    return (ticks * 12 + EVMU_LCD_TICKS_PER_SEC_ / 2) / EVMU_LCD_TICKS_PER_SEC_;
+}
+
+/* Writes either every frame info or every frame's pixel data, splitting or
+ * dropping frames so that each frame's 1/12th second delay adds up to the
+ * total recorded time. */
+static EVMU_RESULT EvmuLcd_exportPass_(const EvmuLcdRecorder_* pRec,
+                                       FILE*                   pFile,
+                                       GblBool                 frameData,
+                                       size_t*                 pCount)
+{
+    EvmuLcdRecorderCursor_ cursor;
+    uint8_t                prevPixels[EVMU_LCD_FRAME_SIZE];
+    uint8_t                fileData[VMU_LCD_FRAME_DATA_SIZE];
+    uint64_t               prevStamp = 0;
+
+    GBL_CTX_BEGIN(NULL);
+
+    *pCount = 0;
+    recorderSeek_(pRec, &cursor, 0);
+
+    const EvmuTicks start = cursor.timestamp;
+    memcpy(prevPixels, cursor.pixels, sizeof(prevPixels));
+
+    for(size_t f = 1; f <= pRec->frameCount; ++f) {
+        uint64_t stamp;
+
+        if(f < pRec->frameCount) {
+            recorderDecode_(pRec, &cursor);
+            stamp = lcdFileDelays_(cursor.timestamp - start);
+        } else {
+            stamp = lcdFileDelays_(pRec->elapsed - start);
+            if(stamp <= prevStamp) stamp = prevStamp + 1;
+        }
+
+        if(frameData && stamp > prevStamp) {
+            for(size_t p = 0; p < VMU_LCD_FRAME_DATA_SIZE; ++p) {
+                const size_t x = p % EVMU_LCD_PIXEL_WIDTH;
+                const size_t y = p / EVMU_LCD_PIXEL_WIDTH;
+                fileData[p] = ((prevPixels[y * EVMU_LCD_ROW_BYTES_ + x / 8] >> (7 - x % 8)) & 0x1)?
+                                  VMU_LCD_FILE_PIXEL_ON : VMU_LCD_FILE_PIXEL_OFF;
+            }
+        }
+
+        for(uint64_t delay = stamp - prevStamp; delay; ) {
+            const uint8_t frameDelay = (delay > UINT8_MAX)? UINT8_MAX : delay;
+
+            if(frameData) {
+                GBL_CTX_VERIFY(fwrite(fileData, sizeof(fileData), 1, pFile) == 1,
+                               GBL_RESULT_ERROR_FILE_WRITE);
+            } else {
+                const LCDFrameInfo info = { .delay = frameDelay };
+                GBL_CTX_VERIFY(fwrite(&info, sizeof(LCDFrameInfo), 1, pFile) == 1,
+                               GBL_RESULT_ERROR_FILE_WRITE);
+            }
+
+            delay -= frameDelay;
+            ++(*pCount);
+        }
+
+        if(stamp > prevStamp) prevStamp = stamp;
+        memcpy(prevPixels, cursor.pixels, sizeof(prevPixels));
+    }
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuLcd_exportRecording(const EvmuLcd* pSelf, const char* pPath) {
+    const EvmuLcdRecorder_* pRec      = &EVMU_LCD_(pSelf)->recorder;
+    FILE*                   pFile     = NULL;
+    size_t                  infoCount = 0;
+    size_t                  dataCount = 0;
+
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_CTX_VERIFY_POINTER(pPath);
+    GBL_CTX_VERIFY(pRec->frameCount,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "No LCD frames have been recorded!");
+
+    EVMU_LOG_INFO("Exporting LCD recording: [%s]", pPath);
+    EVMU_LOG_PUSH();
+
+    GBL_CTX_VERIFY((pFile = fopen(pPath, "wb")),
+                   GBL_RESULT_ERROR_FILE_OPEN);
+
+    LCDFileHeader header = {
+        .version     = 1,
+        .width       = EVMU_LCD_PIXEL_WIDTH,
+        .height      = EVMU_LCD_PIXEL_HEIGHT,
+        .bitDepth    = 1,
+        .repeatCount = 0
+    };
+    memcpy(header.signature, VMU_LCD_SIGNATURE, VMU_LCD_SIGNATURE_SIZE);
+
+    // Header is rewritten once the final frame count is known
+    GBL_CTX_VERIFY(fwrite(&header, sizeof(header), 1, pFile) == 1,
+                   GBL_RESULT_ERROR_FILE_WRITE);
+
+    GBL_CTX_VERIFY_CALL(EvmuLcd_exportPass_(pRec, pFile, GBL_FALSE, &infoCount));
+
+    GBL_CTX_VERIFY(infoCount <= UINT16_MAX,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Too many frames for an .LCD file: [%zu/%u]",
+                   infoCount,
+                   UINT16_MAX);
+
+    GBL_CTX_VERIFY_CALL(EvmuLcd_exportPass_(pRec, pFile, GBL_TRUE, &dataCount));
+    GBL_ASSERT(infoCount == dataCount);
+
+    LCDCopyright copyright = { 0 };
+    strncpy(copyright.copyright, "ElysianVMU LCD Recorder", VMU_LCD_COPYRIGHT_SIZE);
+
+    GBL_CTX_VERIFY(fwrite(&copyright, sizeof(copyright), 1, pFile) == 1,
+                   GBL_RESULT_ERROR_FILE_WRITE);
+
+    header.frameCount = infoCount;
+    GBL_CTX_VERIFY(!fseek(pFile, 0, SEEK_SET) &&
+                   fwrite(&header, sizeof(header), 1, pFile) == 1,
+                   GBL_RESULT_ERROR_FILE_WRITE);
+
+    EVMU_LOG_VERBOSE("Wrote %zu frames from %zu recorded frames.", infoCount, pRec->frameCount);
+
+    GBL_CTX_END_BLOCK();
+
+    EVMU_LOG_POP(1);
+    if(pFile) fclose(pFile);
+
+    return GBL_CTX_RESULT();
+}
+
+GBL_INLINE const EvmuLcdAnimation_* animation_(const EvmuLcdPlayback_* pPlayback) {
+    return (const EvmuLcdAnimation_*)pPlayback->pAnimation->pData;
+}
+
+GBL_INLINE const uint8_t* animationFrame_(const EvmuLcdAnimation_* pAnimation, size_t frame) {
+    return &pAnimation->data[pAnimation->frameCount + frame * EVMU_LCD_FRAME_SIZE];
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuLcd_loadAnimation(EvmuLcd* pSelf, const char* pPath) {
+    EvmuLcdPlayback_*  pPlayback  = &EVMU_LCD_(pSelf)->playback;
+    GblByteArray*      pArena     = NULL;
+    FILE*              pFile      = NULL;
+    LCDFileHeader      header;
+    LCDFrameInfo       info;
+    LCDCopyright       copyright;
+    uint8_t            fileData[VMU_LCD_FRAME_DATA_SIZE];
+    char               signature[VMU_LCD_SIGNATURE_SIZE + 1] = { 0 };
+    char               copyrightStr[VMU_LCD_COPYRIGHT_SIZE + 1] = { 0 };
+
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_CTX_VERIFY_POINTER(pPath);
+
+    EVMU_LOG_INFO("Loading .LCD animation file: [%s]", pPath);
+    EVMU_LOG_PUSH();
+
+    GBL_CTX_VERIFY((pFile = fopen(pPath, "rb")),
+                   GBL_RESULT_ERROR_FILE_OPEN);
+
+    long fileEnd = -1;
+
+    GBL_CTX_VERIFY(fseek(pFile, 0, SEEK_END) == 0 &&
+                   (fileEnd = ftell(pFile)) >= 0 &&
+                   fseek(pFile, 0, SEEK_SET) == 0,
+                   GBL_RESULT_ERROR_FILE_READ,
+                   "Unable to determine .LCD file size: [%s]",
+                   pPath);
+
+    const size_t fileLen = fileEnd;
+
+    GBL_CTX_VERIFY(fread(&header, sizeof(header), 1, pFile) == 1,
+                   GBL_RESULT_ERROR_FILE_READ,
+                   "Unable to read .LCD header: [%zu bytes]",
+                   fileLen);
+
+    memcpy(signature, header.signature, VMU_LCD_SIGNATURE_SIZE);
+
+    GBL_CTX_VERIFY(!strcmp(signature, VMU_LCD_SIGNATURE),
+                   EVMU_RESULT_ERROR_INVALID_FILE,
+                   "Unknown file signature: [%s]",
+                   signature);
+
+    GBL_CTX_VERIFY(header.bitDepth == 1,
+                   EVMU_RESULT_ERROR_INVALID_FILE,
+                   "Unsupported bit depth: [%u]",
+                   header.bitDepth);
+
+    GBL_CTX_VERIFY(header.width  == EVMU_LCD_PIXEL_WIDTH &&
+                   header.height == EVMU_LCD_PIXEL_HEIGHT,
+                   EVMU_RESULT_ERROR_INVALID_FILE,
+                   "Unsupported resolution: <%u, %u>",
+                   header.width,
+                   header.height);
+
+    const size_t expectedSize = sizeof(LCDFileHeader)                          +
+                                header.frameCount * sizeof(LCDFrameInfo)       +
+                                header.frameCount * VMU_LCD_FRAME_DATA_SIZE    +
+                                sizeof(LCDCopyright);
+
+    GBL_CTX_VERIFY(header.frameCount && fileLen == expectedSize,
+                   EVMU_RESULT_ERROR_INVALID_FILE,
+                   "File size [%zu] does not match expected file size [%zu]!",
+                   fileLen,
+                   expectedSize);
+
+    // Single allocation for the whole animation
+    GBL_CTX_VERIFY((pArena = GblByteArray_create(sizeof(EvmuLcdAnimation_) +
+                                                 header.frameCount * (1 + EVMU_LCD_FRAME_SIZE))),
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate animation buffer!");
+
+    EvmuLcdAnimation_* pAnimation = (EvmuLcdAnimation_*)pArena->pData;
+    pAnimation->frameCount  = header.frameCount;
+    pAnimation->repeatCount = header.repeatCount;
+
+    for(size_t f = 0; f < header.frameCount; ++f) {
+        GBL_CTX_VERIFY(fread(&info, sizeof(info), 1, pFile) == 1,
+                       GBL_RESULT_ERROR_FILE_READ,
+                       "Failed to read info for frame [%zu]",
+                       f);
+        // A zero delay would never advance, so treat it as the shortest possible one
+        pAnimation->data[f] = info.delay? info.delay : 1;
+    }
+
+    for(size_t f = 0; f < header.frameCount; ++f) {
+        uint8_t* pFrame = (uint8_t*)animationFrame_(pAnimation, f);
+
+        GBL_CTX_VERIFY(fread(fileData, sizeof(fileData), 1, pFile) == 1,
+                       GBL_RESULT_ERROR_FILE_READ,
+                       "Failed to read data for frame [%zu]",
+                       f);
+
+        memset(pFrame, 0, EVMU_LCD_FRAME_SIZE);
+        for(size_t p = 0; p < VMU_LCD_FRAME_DATA_SIZE; ++p) {
+            if(fileData[p] == VMU_LCD_FILE_PIXEL_ON) {
+                const size_t x = p % EVMU_LCD_PIXEL_WIDTH;
+                const size_t y = p / EVMU_LCD_PIXEL_WIDTH;
+                pFrame[y * EVMU_LCD_ROW_BYTES_ + x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+    }
+
+    GBL_CTX_VERIFY(fread(&copyright, sizeof(copyright), 1, pFile) == 1,
+                   GBL_RESULT_ERROR_FILE_READ,
+                   "Failed to read copyright!");
+
+    memcpy(copyrightStr, copyright.copyright, VMU_LCD_COPYRIGHT_SIZE);
+
+    EVMU_LOG_VERBOSE("%-20s: %40u", "Version Number", header.version);
+    EVMU_LOG_VERBOSE("%-20s: %40u", "Repeat Count",   header.repeatCount);
+    EVMU_LOG_VERBOSE("%-20s: %40u", "Frame Count",    header.frameCount);
+    EVMU_LOG_VERBOSE("%-20s: %40s", "Copyright",      copyrightStr);
+
+    EvmuLcd_unloadAnimation(pSelf);
+
+    pPlayback->pAnimation = pArena;
+    pPlayback->state      = EVMU_LCD_ANIMATION_STATE_STOPPED;
+    pArena                = NULL;
+
+    GBL_CTX_VERIFY_CALL(EvmuLcd_seekAnimation(pSelf, 0));
+
+    GBL_CTX_END_BLOCK();
+
+    EVMU_LOG_POP(1);
+    if(pArena) GblByteArray_unref(pArena);
+    if(pFile)  fclose(pFile);
+
+    return GBL_CTX_RESULT();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuLcd_shareAnimation(EvmuLcd* pSelf, const EvmuLcd* pSource) {
+    EvmuLcdPlayback_*       pPlayback = &EVMU_LCD_(pSelf)->playback;
+    const EvmuLcdPlayback_* pSrc      = NULL;
+
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_CTX_VERIFY_POINTER(pSource);
+
+    pSrc = &EVMU_LCD_(pSource)->playback;
+
+    GBL_CTX_VERIFY(pSrc->pAnimation,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "Source display has no animation loaded!");
+
+    if(pSrc != pPlayback) {
+        GblByteArray* pAnimation = GblByteArray_ref(pSrc->pAnimation);
+
+        EvmuLcd_unloadAnimation(pSelf);
+
+        pPlayback->pAnimation = pAnimation;
+        pPlayback->state      = EVMU_LCD_ANIMATION_STATE_STOPPED;
+
+        GBL_CTX_VERIFY_CALL(EvmuLcd_seekAnimation(pSelf, 0));
+    }
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT void EvmuLcd_unloadAnimation(EvmuLcd* pSelf) {
+    EvmuLcdPlayback_* pPlayback = &EVMU_LCD_(pSelf)->playback;
+
+    if(pPlayback->pAnimation)
+        GblByteArray_unref(pPlayback->pAnimation);
+
+    memset(pPlayback, 0, sizeof(EvmuLcdPlayback_));
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuLcd_playAnimation(EvmuLcd* pSelf) {
+    EvmuLcdPlayback_* pPlayback = &EVMU_LCD_(pSelf)->playback;
+
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_CTX_VERIFY(pPlayback->pAnimation,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "No animation loaded!");
+
+    if(pPlayback->state == EVMU_LCD_ANIMATION_STATE_COMPLETE) {
+        pPlayback->loops = 0;
+        GBL_CTX_VERIFY_CALL(EvmuLcd_seekAnimation(pSelf, 0));
+    }
+
+    EvmuLcd_setScreenEnabled(pSelf, GBL_TRUE);
+    EvmuLcd_setRefreshEnabled(pSelf, GBL_TRUE);
+    EvmuLcd_setIcons(pSelf, EVMU_LCD_ICONS_NONE);
+
+    pPlayback->state = EVMU_LCD_ANIMATION_STATE_PLAYING;
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT void EvmuLcd_pauseAnimation(EvmuLcd* pSelf) {
+    EvmuLcdPlayback_* pPlayback = &EVMU_LCD_(pSelf)->playback;
+
+    if(pPlayback->state == EVMU_LCD_ANIMATION_STATE_PLAYING)
+        pPlayback->state = EVMU_LCD_ANIMATION_STATE_STOPPED;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuLcd_seekAnimation(EvmuLcd* pSelf, size_t frame) {
+    EvmuLcdPlayback_* pPlayback = &EVMU_LCD_(pSelf)->playback;
+
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_CTX_VERIFY(pPlayback->pAnimation,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "No animation loaded!");
+
+    GBL_CTX_VERIFY(frame < animation_(pPlayback)->frameCount,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Animation frame out of range: [%zu/%zu]",
+                   frame,
+                   animation_(pPlayback)->frameCount);
+
+    pPlayback->frame   = frame;
+    pPlayback->elapsed = 0;
+
+    if(pPlayback->state == EVMU_LCD_ANIMATION_STATE_COMPLETE)
+        pPlayback->state = EVMU_LCD_ANIMATION_STATE_STOPPED;
+
+    EvmuLcd_setFrame(pSelf, animationFrame_(animation_(pPlayback), frame));
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_LCD_ANIMATION_STATE EvmuLcd_animationState(const EvmuLcd* pSelf) {
+    return EVMU_LCD_(pSelf)->playback.state;
+}
+
+EVMU_EXPORT size_t EvmuLcd_animationFrames(const EvmuLcd* pSelf) {
+    const EvmuLcdPlayback_* pPlayback = &EVMU_LCD_(pSelf)->playback;
+    return pPlayback->pAnimation? animation_(pPlayback)->frameCount : 0;
+}
+
+EVMU_EXPORT size_t EvmuLcd_animationFrame(const EvmuLcd* pSelf) {
+    return EVMU_LCD_(pSelf)->playback.frame;
+}
+
+static void EvmuLcd_updateAnimation_(EvmuLcd* pSelf, EvmuTicks ticks) {
+    EvmuLcdPlayback_* pPlayback = &EVMU_LCD_(pSelf)->playback;
+
+    if(pPlayback->state != EVMU_LCD_ANIMATION_STATE_PLAYING)
+        return;
+
+    const EvmuLcdAnimation_* pAnimation = animation_(pPlayback);
+    const size_t             prevFrame  = pPlayback->frame;
+
+    // Delays are in 1/12ths of a second, so accumulate 12x the ticks to stay exact
+    pPlayback->elapsed += ticks * 12;
+
+    while(pPlayback->state == EVMU_LCD_ANIMATION_STATE_PLAYING) {
+        const EvmuTicks delay = (EvmuTicks)pAnimation->data[pPlayback->frame] * EVMU_LCD_TICKS_PER_SEC_;
+
+        if(pPlayback->elapsed < delay) break;
+
+        pPlayback->elapsed -= delay;
+
+        if(++pPlayback->frame >= pAnimation->frameCount) {
+            if(pAnimation->repeatCount != VMU_LCD_REPEAT_INFINITE &&
+               ++pPlayback->loops >= pAnimation->repeatCount)
+            {
+                --pPlayback->frame;
+                pPlayback->state = EVMU_LCD_ANIMATION_STATE_COMPLETE;
+            } else {
+                pPlayback->frame = 0;
+            }
+        }
+    }
+
+    if(pPlayback->frame != prevFrame)
+        EvmuLcd_setFrame(pSelf, animationFrame_(pAnimation, pPlayback->frame));
+}
+
 EVMU_EXPORT GblBool EvmuLcd_screenEnabled(const EvmuLcd* pSelf) {
     EvmuLcd_* pSelf_ = EVMU_LCD_(pSelf);
     return (pSelf_->pRam->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_VCCR)]>>EVMU_SFR_VCCR_VCCR7_POS);
@@ -448,6 +1266,11 @@ static GBL_RESULT EvmuLcd_IBehavior_update_(EvmuIBehavior* pSelf, EvmuTicks tick
 
     pLcd_->refreshElapsed += ticks;
 
+    if(pLcd_->recorder.active)
+        pLcd_->recorder.elapsed += ticks;
+
+    EvmuLcd_updateAnimation_(pLcd, ticks);
+
     if(!EvmuLcd_refreshEnabled(pLcd))
         GBL_CTX_DONE();
 
@@ -461,8 +1284,12 @@ static GBL_RESULT EvmuLcd_IBehavior_update_(EvmuIBehavior* pSelf, EvmuTicks tick
         }
     }
 
-    if(screenChanged)
+    if(screenChanged) {
+        if(pLcd_->recorder.active)
+            EvmuLcd_recordFrame_(pLcd);
+
         GBL_VCALL(EvmuLcd, pFnRefreshScreen, pLcd);
+    }
 
     GBL_CTX_END();
 }
@@ -482,6 +1309,16 @@ static GBL_RESULT EvmuLcd_IBehavior_reset_(EvmuIBehavior* pSelf) {
     GBL_CTX_END();
 }
 
+static GBL_RESULT EvmuLcd_GblBox_destructor_(GblBox* pBox) {
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuLcd_clearRecording(EVMU_LCD(pBox));
+    EvmuLcd_unloadAnimation(EVMU_LCD(pBox));
+    GBL_VCALL_DEFAULT(EvmuPeripheral, base.base.pFnDestructor, pBox);
+
+    GBL_CTX_END();
+}
+
 static GBL_RESULT EvmuLcd_init_(GblInstance* pInstance) {
     GBL_CTX_BEGIN(NULL);
 
@@ -493,6 +1330,42 @@ static GBL_RESULT EvmuLcd_init_(GblInstance* pInstance) {
     GBL_CTX_END();
 }
 
+// Recording and .LCD animation playback aren't part of the emulated hardware, so they're left alone
+static EVMU_RESULT EvmuLcd_state_(EvmuLcd* pSelf, EvmuStateBuffer* pBuffer) {
+    EvmuLcd_*    pSelf_ = EVMU_LCD_(pSelf);
+    const size_t start  = EvmuIBehavior__beginSection_(pBuffer, EVMU_LCD__STATE_TAG_, EVMU_LCD__STATE_VERSION_);
+    uint8_t      flags  = pSelf->screenChanged          |
+                          (pSelf->ghostingEnabled << 1) |
+                          (pSelf->filterEnabled   << 2) |
+                          (pSelf->invertColors    << 3);
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->pixelBuffer);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->icons);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->refreshElapsed);
+    EvmuIBehavior__size_(pBuffer, &pSelf->screenRefreshDivisor);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, flags);
+
+    if(pBuffer->loading) {
+        pSelf->screenChanged   = flags & 0x1;
+        pSelf->ghostingEnabled = (flags >> 1) & 0x1;
+        pSelf->filterEnabled   = (flags >> 2) & 0x1;
+        pSelf->invertColors    = (flags >> 3) & 0x1;
+
+        // XRAM was loaded along with the rest of RAM
+        EvmuLcd__rehash_(pSelf_);
+    }
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+static EVMU_RESULT EvmuLcd_IBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuLcd_state_(EVMU_LCD(pSelf), pBuffer);
+}
+
+static EVMU_RESULT EvmuLcd_IBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuLcd_state_(EVMU_LCD(pSelf), pBuffer);
+}
+
 static GBL_RESULT EvmuLcdClass_init_(GblClass* pClass, const void* pUd) {
     GBL_UNUSED(pUd);
     GBL_CTX_BEGIN(NULL);
@@ -518,11 +1391,14 @@ static GBL_RESULT EvmuLcdClass_init_(GblClass* pClass, const void* pUd) {
                                        GBL_FLAGS_TYPE));
     }
 
+    GBL_BOX_CLASS(pClass)       ->pFnDestructor    = EvmuLcd_GblBox_destructor_;
     GBL_OBJECT_CLASS(pClass)    ->pFnConstructed   = EvmuLcd_GblObject_constructed_;
     GBL_OBJECT_CLASS(pClass)    ->pFnProperty      = EvmuLcd_GblObject_property_;
     GBL_OBJECT_CLASS(pClass)    ->pFnSetProperty   = EvmuLcd_GblObject_setProperty_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnUpdate        = EvmuLcd_IBehavior_update_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnReset         = EvmuLcd_IBehavior_reset_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState     = EvmuLcd_IBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState     = EvmuLcd_IBehavior_loadState_;
     EVMU_LCD_CLASS(pClass)      ->pFnRefreshScreen = EvmuLcd_refreshScreen_;
 
     GBL_CTX_END();
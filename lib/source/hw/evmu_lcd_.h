@@ -2,21 +2,69 @@
 #define EVMU_LCD__H
 
 #include <evmu/hw/evmu_lcd.h>
+#include <gimbal/utils/gimbal_byte_array.h>
 
 #define EVMU_LCD_(self)         (GBL_PRIVATE(EvmuLcd, self))
 #define EVMU_LCD_PUBLIC_(priv)  (GBL_PUBLIC(EvmuLcd, priv))
 
+#define EVMU_LCD__STATE_TAG_     EVMU_IBEHAVIOR__STATE_TAG_('L', 'C', 'D', ' ')
+#define EVMU_LCD__STATE_VERSION_ 1
+
 GBL_DECLS_BEGIN
 
 GBL_FORWARD_DECLARE_STRUCT(EvmuRam_);
 
+// Keyframe index entry, used to seek into the recording stream
+GBL_DECLARE_STRUCT(EvmuLcdKeyFrame_) {
+    EvmuTicks timestamp;
+    size_t    offset;
+};
+
+// Ring buffer of XOR-delta + RLE compressed frames
+GBL_DECLARE_STRUCT(EvmuLcdRecorder_) {
+    GblByteArray* pStream;
+    GblByteArray* pKeyFrames;
+    size_t        head;
+    size_t        tail;
+    size_t        bytes;
+    size_t        keyFrameTail;
+    size_t        keyFrameCount;
+    size_t        frameCount;
+    EvmuTicks     elapsed;
+    EvmuTicks     prevTimestamp;
+    uint8_t       prevFrame[EVMU_LCD_FRAME_SIZE];
+    GblBool       active;
+};
+
+// Shared arena holding a decoded .LCD file: frameCount delays, followed by frameCount raw frames
+GBL_DECLARE_STRUCT(EvmuLcdAnimation_) {
+    size_t  frameCount;
+    uint8_t repeatCount;
+    uint8_t data[];
+};
+
+GBL_DECLARE_STRUCT(EvmuLcdPlayback_) {
+    GblByteArray*            pAnimation;
+    size_t                   frame;
+    size_t                   loops;
+    EvmuTicks                elapsed;
+    EVMU_LCD_ANIMATION_STATE state;
+};
+
 GBL_DECLARE_STRUCT(EvmuLcd_) {
-    int             pixelBuffer[EVMU_LCD_PIXEL_HEIGHT][EVMU_LCD_PIXEL_WIDTH];
-    EVMU_LCD_ICONS  icons;
-    EvmuTicks       refreshElapsed;
-    EvmuRam_*       pRam;
+    int              pixelBuffer[EVMU_LCD_PIXEL_HEIGHT][EVMU_LCD_PIXEL_WIDTH];
+    EVMU_LCD_ICONS   icons;
+    EvmuTicks        refreshElapsed;
+    EvmuRam_*        pRam;
+    uint64_t         frameHash;
+    EVMU_LCD_ICONS   hashedIcons;
+    EvmuLcdRecorder_ recorder;
+    EvmuLcdPlayback_ playback;
 };
 
+void EvmuLcd__xramWrite_ (EvmuLcd_* pSelf_, size_t bank, size_t offset, EvmuWord prevValue, EvmuWord value);
+void EvmuLcd__rehash_    (EvmuLcd_* pSelf_);
+
 GBL_DECLS_END
 
 #endif // EVMU_LCD__H
@@ -0,0 +1,301 @@
+#include <evmu/hw/evmu_device.h>
+#include <evmu/hw/evmu_sio.h>
+#include "evmu_device_.h"
+#include "evmu_gamepad_.h"
+#include "evmu_movie_.h"
+#include <stdlib.h>
+#include <string.h>
+
+static size_t EvmuMovie_varintSize_(uint64_t value) {
+    size_t size = 1;
+
+    while(value >>= 7) ++size;
+
+    return size;
+}
+
+static size_t EvmuMovie_varintWrite_(uint8_t* pOut, uint64_t value) {
+    size_t size = 0;
+
+    while(value >= 0x80) {
+        pOut[size++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+
+    pOut[size++] = (uint8_t)value;
+
+    return size;
+}
+
+// Decodes the value at \p *ppIn, returning GBL_FALSE if it runs past \p pEnd or overflows
+static GblBool EvmuMovie_varintRead_(const uint8_t** ppIn, const uint8_t* pEnd, uint64_t* pValue) {
+    uint64_t value = 0;
+
+    for(unsigned shift = 0; *ppIn < pEnd && shift < 64; shift += 7) {
+        const uint8_t byte = *(*ppIn)++;
+
+        value |= (uint64_t)(byte & 0x7f) << shift;
+
+        if(!(byte & 0x80)) {
+            *pValue = value;
+            return GBL_TRUE;
+        }
+    }
+
+    return GBL_FALSE;
+}
+
+// Bytes needed to write out the pending run
+static size_t EvmuMovie_runSize_(const EvmuMovie_* pSelf) {
+    return pSelf->runCount? EvmuMovie_varintSize_(pSelf->runTicks << 1) +
+                            EvmuMovie_varintSize_(pSelf->runCount) : 0;
+}
+
+static size_t EvmuMovie_runWrite_(const EvmuMovie_* pSelf, uint8_t* pOut) {
+    if(!pSelf->runCount)
+        return 0;
+
+    const size_t size = EvmuMovie_varintWrite_(pOut, pSelf->runTicks << 1);
+
+    return size + EvmuMovie_varintWrite_(pOut + size, pSelf->runCount);
+}
+
+// Grows the stream to fit \p bytes more, ending the recording if it can't
+static GblBool EvmuMovie_reserve_(EvmuMovie_* pSelf, size_t bytes) {
+    if(pSelf->capacity - pSelf->size >= bytes)
+        return GBL_TRUE;
+
+    const size_t capacity = pSelf->capacity * 2 + bytes;
+    uint8_t*     pData    = realloc(pSelf->pData, capacity);
+
+    if(!pData) {
+        pSelf->failed    = GBL_TRUE;
+        pSelf->recording = GBL_FALSE;
+        return GBL_FALSE;
+    }
+
+    pSelf->pData    = pData;
+    pSelf->capacity = capacity;
+
+    return GBL_TRUE;
+}
+
+static GblBool EvmuMovie_flush_(EvmuMovie_* pSelf) {
+    if(!EvmuMovie_reserve_(pSelf, 2 * EVMU_MOVIE__VARINT_MAX_))
+        return GBL_FALSE;
+
+    pSelf->size     += EvmuMovie_runWrite_(pSelf, &pSelf->pData[pSelf->size]);
+    pSelf->runCount  = 0;
+
+    return GBL_TRUE;
+}
+
+EvmuMovie_* EvmuMovie__create_(EvmuDevice* pDevice) {
+    const size_t stateSize = EvmuIBehavior_stateSize(EVMU_IBEHAVIOR(pDevice));
+    EvmuMovie_*  pSelf     = calloc(1, sizeof(EvmuMovie_));
+
+    if(!pSelf)
+        return NULL;
+
+    pSelf->capacity = sizeof(EvmuMovieHeader_) + stateSize + EVMU_MOVIE__CAPACITY_MIN_;
+    pSelf->pData    = malloc(pSelf->capacity);
+
+    if(!pSelf->pData ||
+       !GBL_RESULT_SUCCESS(EvmuIBehavior_saveState(EVMU_IBEHAVIOR(pDevice),
+                                                   &pSelf->pData[sizeof(EvmuMovieHeader_)],
+                                                   stateSize,
+                                                   NULL)))
+    {
+        EvmuMovie__destroy_(pSelf);
+        return NULL;
+    }
+
+    const EvmuMovieHeader_ header = {
+        .magic     = EVMU_MOVIE__MAGIC_,
+        .version   = EVMU_MOVIE__VERSION_,
+        .endian    = EVMU_IBEHAVIOR__STATE_ENDIAN_,
+        .stateSize = stateSize
+    };
+
+    memcpy(pSelf->pData, &header, sizeof(header));
+
+    pSelf->size      = sizeof(header) + stateSize;
+    pSelf->buttons   = EvmuGamepad__buttons_(pDevice->pGamepad);
+    pSelf->recording = GBL_TRUE;
+
+    return pSelf;
+}
+
+void EvmuMovie__destroy_(EvmuMovie_* pSelf) {
+    if(pSelf) free(pSelf->pData);
+    free(pSelf);
+}
+
+void EvmuMovie__record_(EvmuMovie_* pSelf, EvmuTicks ticks, uint16_t buttons) {
+    if(buttons != pSelf->buttons) {
+        if(!EvmuMovie_flush_(pSelf) || !EvmuMovie_reserve_(pSelf, EVMU_MOVIE__VARINT_MAX_))
+            return;
+
+        pSelf->size   += EvmuMovie_varintWrite_(&pSelf->pData[pSelf->size], ((uint64_t)buttons << 1) | 1);
+        pSelf->buttons = buttons;
+    }
+
+    if(pSelf->runCount && pSelf->runTicks == ticks) {
+        ++pSelf->runCount;
+    } else {
+        if(!EvmuMovie_flush_(pSelf))
+            return;
+
+        pSelf->runTicks = ticks;
+        pSelf->runCount = 1;
+    }
+
+    pSelf->ticks += ticks;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_recordMovie(EvmuDevice* pSelf) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuDevice_* pSelf_ = EVMU_DEVICE_(pSelf);
+
+    // Input from the other end of a link isn't part of the movie
+    GBL_CTX_VERIFY(!EvmuSio_linked(pSelf->pSio),
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "Cannot record a movie on a device linked to another!");
+
+    EvmuMovie__destroy_(pSelf_->pMovie);
+    pSelf_->pMovie = EvmuMovie__create_(pSelf);
+
+    GBL_CTX_VERIFY(pSelf_->pMovie,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to save the state to start the movie from!");
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT GblBool EvmuDevice_movieRecording(const EvmuDevice* pSelf) {
+    const EvmuMovie_* pMovie = EVMU_DEVICE_(pSelf)->pMovie;
+
+    return pMovie && pMovie->recording;
+}
+
+EVMU_EXPORT void EvmuDevice_stopMovie(EvmuDevice* pSelf) {
+    EvmuDevice_* pSelf_ = EVMU_DEVICE_(pSelf);
+
+    EvmuMovie__destroy_(pSelf_->pMovie);
+    pSelf_->pMovie = NULL;
+}
+
+EVMU_EXPORT size_t EvmuDevice_movieSize(const EvmuDevice* pSelf) {
+    const EvmuMovie_* pMovie = EVMU_DEVICE_(pSelf)->pMovie;
+
+    return pMovie? pMovie->size + EvmuMovie_runSize_(pMovie) : 0;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_saveMovie(const EvmuDevice* pSelf,
+                                             void*             pData,
+                                             size_t            capacity,
+                                             size_t*           pSize)
+{
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_POINTER(pData);
+
+    const EvmuMovie_* pMovie = EVMU_DEVICE_(pSelf)->pMovie;
+
+    GBL_CTX_VERIFY(pMovie,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "No movie has been recorded!");
+
+    GBL_CTX_VERIFY(!pMovie->failed,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Movie recording was cut short, failed to grow its input stream!");
+
+    const size_t size = EvmuDevice_movieSize(pSelf);
+
+    if(pSize) *pSize = size;
+
+    GBL_CTX_VERIFY(capacity >= size,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Failed to save movie: [%zu of %zu bytes]",
+                   capacity, size);
+
+    EvmuMovieHeader_ header;
+    memcpy(&header, pMovie->pData, sizeof(header));
+
+    header.streamSize = size - sizeof(header) - header.stateSize;
+    header.ticks      = pMovie->ticks;
+
+    memcpy(pData, &header, sizeof(header));
+    memcpy((uint8_t*)pData + sizeof(header), &pMovie->pData[sizeof(header)], pMovie->size - sizeof(header));
+    EvmuMovie_runWrite_(pMovie, (uint8_t*)pData + pMovie->size);
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_playMovie(EvmuDevice* pSelf, const void* pData, size_t size) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuGamepad_*    pGamepad = EVMU_DEVICE_(pSelf)->pGamepad;
+    EvmuMovieHeader_ header;
+
+    GBL_CTX_VERIFY_POINTER(pData);
+
+    GBL_CTX_VERIFY(size >= sizeof(header),
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Not a movie!");
+
+    memcpy(&header, pData, sizeof(header));
+
+    GBL_CTX_VERIFY(header.magic == EVMU_MOVIE__MAGIC_,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Not a movie!");
+
+    GBL_CTX_VERIFY(header.version == EVMU_MOVIE__VERSION_ &&
+                   header.endian  == EVMU_IBEHAVIOR__STATE_ENDIAN_,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Unsupported movie: [version %u, byte order 0x%x]",
+                   header.version, header.endian);
+
+    GBL_CTX_VERIFY(header.stateSize <= size - sizeof(header) &&
+                   header.streamSize <= size - sizeof(header) - header.stateSize,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Truncated movie: [%zu bytes]",
+                   size);
+
+    GBL_CTX_VERIFY(!EvmuSio_linked(pSelf->pSio),
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "Cannot play a movie on a device linked to another!");
+
+    const uint8_t* pState  = (const uint8_t*)pData + sizeof(header);
+    const uint8_t* pStream = pState + header.stateSize;
+    const uint8_t* pEnd    = pStream + header.streamSize;
+
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior_loadState(EVMU_IBEHAVIOR(pSelf), pState, header.stateSize));
+
+    // Buttons come from the movie alone, with each advance made exactly as it was recorded
+    pGamepad->locked = GBL_TRUE;
+
+    while(pStream < pEnd) {
+        uint64_t value = 0, count = 0;
+
+        GBL_CTX_VERIFY(EvmuMovie_varintRead_(&pStream, pEnd, &value) &&
+                       ((value & 1) || EvmuMovie_varintRead_(&pStream, pEnd, &count)),
+                       GBL_RESULT_ERROR_INVALID_ARG,
+                       "Corrupt movie input stream: [byte %zu of %zu]",
+                       (size_t)(header.streamSize - (pEnd - pStream)),
+                       (size_t)header.streamSize);
+
+        if(value & 1) {
+            EvmuGamepad__setButtons_(pSelf->pGamepad, (uint16_t)(value >> 1));
+        } else {
+            for(uint64_t a = 0; a < count; ++a)
+                GBL_CTX_VERIFY_CALL(EvmuDevice__advance_(pSelf, value >> 1));
+        }
+    }
+
+    GBL_CTX_END_BLOCK();
+
+    pGamepad->locked = GBL_FALSE;
+
+    return GBL_CTX_RESULT();
+}
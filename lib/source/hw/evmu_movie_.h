@@ -0,0 +1,49 @@
+#ifndef EVMU_MOVIE__H
+#define EVMU_MOVIE__H
+
+#include <evmu/hw/evmu_device.h>
+#include "../types/evmu_ibehavior_.h"
+
+#define EVMU_MOVIE__MAGIC_          EVMU_IBEHAVIOR__STATE_TAG_('E', 'V', 'M', 'V')
+#define EVMU_MOVIE__VERSION_        1
+#define EVMU_MOVIE__VARINT_MAX_     10      // bytes of the longest encoded 64-bit value
+#define EVMU_MOVIE__CAPACITY_MIN_   4096    // initial bytes reserved for the input stream
+
+GBL_DECLS_BEGIN
+
+/* Leads off every movie, followed by the save state it starts from and then its input
+ * stream. The stream is a sequence of LEB128 values: one with the low bit set holds the
+ * buttons for the advances that follow it, while one with it clear holds the ticks of
+ * a run of identical advances, followed by another holding the number in the run.
+ */
+GBL_DECLARE_STRUCT(EvmuMovieHeader_) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t endian;        // EVMU_IBEHAVIOR__STATE_ENDIAN_ in the recording host's byte order
+    uint64_t stateSize;     // bytes of the starting save state
+    uint64_t streamSize;    // bytes of the input stream
+    uint64_t ticks;         // emulated time covered by the input stream
+};
+
+// Input recorded from a device, along with the state it started from
+GBL_DECLARE_STRUCT(EvmuMovie_) {
+    uint8_t*  pData;        // header, starting state and the input stream so far
+    size_t    size;
+    size_t    capacity;
+    EvmuTicks ticks;        // emulated time recorded so far, including the pending run
+    EvmuTicks runTicks;     // ticks of each advance in the pending run
+    uint64_t  runCount;     // advances in the pending run, not yet written to the stream
+    uint16_t  buttons;      // buttons held as of the end of the stream
+    GblBool   recording;
+    GblBool   failed;       // the stream couldn't grow, so the recording was cut short
+};
+
+// Starts a movie from the current state of the given device, returning NULL on failure
+EvmuMovie_* EvmuMovie__create_  (EvmuDevice* pDevice);
+void        EvmuMovie__destroy_ (EvmuMovie_* pSelf);
+// Records an advance the device just made, with the buttons it was polled with
+void        EvmuMovie__record_  (EvmuMovie_* pSelf, EvmuTicks ticks, uint16_t buttons);
+
+GBL_DECLS_END
+
+#endif // EVMU_MOVIE__H
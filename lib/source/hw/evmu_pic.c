@@ -3,6 +3,7 @@
 #include "evmu_ram_.h"
 #include "evmu_device_.h"
 #include "../types/evmu_peripheral_.h"
+#include "../types/evmu_ibehavior_.h"
 
 const static EvmuAddress isrAddrLut_[EVMU_IRQ_COUNT] = {
     EVMU_ISR_ADDR_RESET,
@@ -228,6 +229,41 @@ static GBL_RESULT EvmuPic_GblObject_constructed_(GblObject* pObject) {
     GBL_CTX_END();
 }
 
+static EVMU_RESULT EvmuPic_state_(EvmuPic* pSelf, EvmuStateBuffer* pBuffer) {
+    EvmuPic_*    pSelf_ = EVMU_PIC_(pSelf);
+    const size_t start  = EvmuIBehavior__beginSection_(pBuffer, EVMU_PIC__STATE_TAG_, EVMU_PIC__STATE_VERSION_);
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->intReq);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->intStack);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->processThisInstr);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->prevIntPriority);
+
+    // Priorities index intStack, and each level services at most one IRQ at a time
+    if(pBuffer->loading && GBL_RESULT_SUCCESS(pBuffer->result)) {
+        GblBool valid = (uint32_t)pSelf_->intReq >> EVMU_IRQ_COUNT == 0 &&
+                        pSelf_->processThisInstr <= 1 &&
+                        pSelf_->prevIntPriority < EVMU_IRQ_PRIORITY_COUNT;
+
+        for(size_t p = 0; p < EVMU_IRQ_PRIORITY_COUNT; ++p)
+            if((pSelf_->intStack[p] & (pSelf_->intStack[p] - 1)) ||
+               (uint32_t)pSelf_->intStack[p] >> EVMU_IRQ_COUNT)
+                valid = GBL_FALSE;
+
+        if(!valid)
+            pBuffer->result = GBL_RESULT_ERROR_INVALID_ARG;
+    }
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+static EVMU_RESULT EvmuPic_IBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuPic_state_(EVMU_PIC(pSelf), pBuffer);
+}
+
+static EVMU_RESULT EvmuPic_IBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuPic_state_(EVMU_PIC(pSelf), pBuffer);
+}
+
 static GBL_RESULT EvmuPicClass_init_(GblClass* pClass, const void* pUd) {
     GBL_UNUSED(pUd);
     GBL_CTX_BEGIN(NULL);
@@ -235,6 +271,8 @@ static GBL_RESULT EvmuPicClass_init_(GblClass* pClass, const void* pUd) {
     GBL_OBJECT_CLASS(pClass)    ->pFnConstructed = EvmuPic_GblObject_constructed_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnReset       = EvmuPic_IBehavior_reset_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnUpdate      = EvmuPic_IBehavior_update_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState   = EvmuPic_IBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState   = EvmuPic_IBehavior_loadState_;
 
     GBL_CTX_END();
 }
@@ -12,6 +12,9 @@
 #define EVMU_PIC_(instance)     (GBL_PRIVATE(EvmuPic, instance))
 #define EVMU_PIC_PUBLIC_(priv)  (GBL_PUBLIC(EvmuPic, priv))
 
+#define EVMU_PIC__STATE_TAG_     EVMU_IBEHAVIOR__STATE_TAG_('P', 'I', 'C', ' ')
+#define EVMU_PIC__STATE_VERSION_ 1
+
 GBL_DECLS_BEGIN
 
 GBL_FORWARD_DECLARE_STRUCT(EvmuRam_);
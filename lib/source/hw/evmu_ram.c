@@ -3,9 +3,11 @@
 #include "evmu_ram_.h"
 #include "evmu_device_.h"
 #include "evmu_buzzer_.h"
+#include "evmu_lcd_.h"
 #include "evmu_timers_.h"
 #include "evmu_gamepad_.h"
 #include "evmu_rom_.h"
+#include "../types/evmu_ibehavior_.h"
 #include <gimbal/utils/gimbal_date_time.h>
 
 EVMU_EXPORT EvmuAddress EvmuRam_indirectAddress(const EvmuRam* pSelf, size_t mode) {
@@ -283,8 +285,18 @@ EVMU_EXPORT EVMU_RESULT EvmuRam_writeData(EvmuRam* pSelf, EvmuAddress addr, Evmu
     }
 
     //do actual memory write
+    const EvmuWord prevVal = pSelf_->pIntMap[addr/EVMU_RAM__INT_SEGMENT_SIZE_][addr%EVMU_RAM__INT_SEGMENT_SIZE_];
     pSelf_->pIntMap[addr/EVMU_RAM__INT_SEGMENT_SIZE_][addr%EVMU_RAM__INT_SEGMENT_SIZE_] = val;
 
+    //keep the LCD's frame hash in sync with XRAM
+    if(addr >= EVMU_ADDRESS_SEGMENT_XRAM_BASE && addr <= EVMU_ADDRESS_SEGMENT_XRAM_END)
+        EvmuLcd__xramWrite_(pDev_->pLcd,
+                            (pSelf_->pIntMap[EVMU_RAM__INT_SEGMENT_XRAM_] - pSelf_->xram[0]) /
+                                EVMU_ADDRESS_SEGMENT_XRAM_SIZE,
+                            EVMU_XRAM_OFFSET(addr),
+                            prevVal,
+                            val);
+
     EvmuBuzzer__memorySink_(EVMU_BUZZER_(pDevice->pBuzzer), addr, val);
 
     GBL_CTX_END();
@@ -357,10 +369,12 @@ EVMU_EXPORT EVMU_RESULT EvmuRam_writeProgram(EvmuRam* pSelf,
         GBL_CTX_VERIFY(addr < EVMU_FLASH_SIZE,
                        GBL_RESULT_ERROR_OUT_OF_RANGE,
                        "[EXT]: Invalid flash write address. [%x]", addr);
+        GBL_CTX_VERIFY_CALL(EvmuFlash__detach_(pSelf_->pFlash, addr, 1));
     } else {
         GBL_CTX_VERIFY(addr < EVMU_ROM_SIZE,
                        GBL_RESULT_ERROR_OUT_OF_RANGE,
                        "[EXT]: Invalid ROM write address. [%x]", addr);
+        GBL_CTX_VERIFY_CALL(EvmuRom__detach_(pSelf_->pRom));
     }
 
     pSelf_->pExt[addr] = value;
@@ -476,6 +490,7 @@ static GBL_RESULT EvmuRam_reset_(EvmuIBehavior* pSelf) {
     memset(pDevice_->pRam->ram, 0, EVMU_ADDRESS_SEGMENT_RAM_SIZE*EVMU_ADDRESS_SEGMENT_RAM_BANKS);
     memset(pDevice_->pRam->sfr, 0, EVMU_ADDRESS_SEGMENT_SFR_SIZE);
     memset(pDevice_->pRam->xram, 0, EVMU_ADDRESS_SEGMENT_XRAM_SIZE*EVMU_ADDRESS_SEGMENT_XRAM_BANKS);
+    EvmuLcd__rehash_(pDevice_->pLcd);
 
 
     pDevice_->pRam->pIntMap[EVMU_RAM__INT_SEGMENT_XRAM_]       = pDevice_->pRam->xram[EVMU_XRAM_BANK_LCD_TOP];
@@ -554,6 +569,146 @@ static GBL_RESULT EvmuRam_reset_(EvmuIBehavior* pSelf) {
     GBL_CTX_END();
 }
 
+EVMU_EXPORT size_t EvmuRam_regionSize(EVMU_RAM_REGION region) {
+    switch(region) {
+    case EVMU_RAM_REGION_RAM:  return EVMU_ADDRESS_SEGMENT_RAM_SIZE  * EVMU_ADDRESS_SEGMENT_RAM_BANKS;
+    case EVMU_RAM_REGION_SFR:  return EVMU_ADDRESS_SEGMENT_SFR_SIZE;
+    case EVMU_RAM_REGION_XRAM: return EVMU_ADDRESS_SEGMENT_XRAM_SIZE * EVMU_ADDRESS_SEGMENT_XRAM_BANKS;
+    default:                   return 0;
+    }
+}
+
+// Returns the banks backing the given region, or NULL if \p offset and \p bytes don't fit within it
+static EvmuWord* EvmuRam_region_(const EvmuRam_* pSelf_, EVMU_RAM_REGION region, size_t offset, size_t bytes) {
+    const size_t size = EvmuRam_regionSize(region);
+
+    if(!size || offset > size || bytes > size - offset)
+        return NULL;
+
+    switch(region) {
+    case EVMU_RAM_REGION_RAM:  return (EvmuWord*)pSelf_->ram;
+    case EVMU_RAM_REGION_SFR:  return (EvmuWord*)pSelf_->sfr;
+    default:                   return (EvmuWord*)pSelf_->xram;
+    }
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuRam_readRegionRaw(const EvmuRam*  pSelf,
+                                              EVMU_RAM_REGION region,
+                                              size_t          offset,
+                                              void*           pData,
+                                              size_t          bytes)
+{
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_POINTER(pData);
+
+    const EvmuWord* pRegion = EvmuRam_region_(EVMU_RAM_(pSelf), region, offset, bytes);
+
+    GBL_CTX_VERIFY(pRegion,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Out-of-range region read: [region: %u, offset: %zu, bytes: %zu]",
+                   region, offset, bytes);
+
+    memcpy(pData, &pRegion[offset], bytes);
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuRam_writeRegionRaw(EvmuRam*        pSelf,
+                                               EVMU_RAM_REGION region,
+                                               size_t          offset,
+                                               const void*     pData,
+                                               size_t          bytes)
+{
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_POINTER(pData);
+
+    EvmuRam_* pSelf_  = EVMU_RAM_(pSelf);
+    EvmuWord* pRegion = EvmuRam_region_(pSelf_, region, offset, bytes);
+
+    GBL_CTX_VERIFY(pRegion,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Out-of-range region write: [region: %u, offset: %zu, bytes: %zu]",
+                   region, offset, bytes);
+
+    memcpy(&pRegion[offset], pData, bytes);
+
+    // The LCD's frame hash is bookkeeping rather than a side-effect, so it's kept in sync regardless
+    if(region == EVMU_RAM_REGION_XRAM)
+        EvmuLcd__rehash_(EVMU_DEVICE_(EvmuPeripheral_device(EVMU_PERIPHERAL(pSelf)))->pLcd);
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuRam_readRegion(const EvmuRam*  pSelf,
+                                           EVMU_RAM_REGION region,
+                                           size_t          offset,
+                                           void*           pData,
+                                           size_t          bytes)
+{
+    // Only registers have read side-effects, with everything else read as-is
+    if(region != EVMU_RAM_REGION_SFR)
+        return EvmuRam_readRegionRaw(pSelf, region, offset, pData, bytes);
+
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_POINTER(pData);
+
+    GBL_CTX_VERIFY(EvmuRam_region_(EVMU_RAM_(pSelf), region, offset, bytes),
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Out-of-range region read: [region: %u, offset: %zu, bytes: %zu]",
+                   region, offset, bytes);
+
+    for(size_t b = 0; b < bytes; ++b)
+        ((uint8_t*)pData)[b] = EvmuRam_readData(pSelf, EVMU_ADDRESS_SEGMENT_SFR_BASE + offset + b);
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuRam_writeRegion(EvmuRam*        pSelf,
+                                            EVMU_RAM_REGION region,
+                                            size_t          offset,
+                                            const void*     pData,
+                                            size_t          bytes)
+{
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_POINTER(pData);
+
+    EvmuRam_*    pSelf_  = EVMU_RAM_(pSelf);
+    EvmuDevice*  pDevice = EvmuPeripheral_device(EVMU_PERIPHERAL(pSelf));
+    EvmuWord*    pRegion = EvmuRam_region_(pSelf_, region, offset, bytes);
+
+    GBL_CTX_VERIFY(pRegion,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Out-of-range region write: [region: %u, offset: %zu, bytes: %zu]",
+                   region, offset, bytes);
+
+    switch(region) {
+    // Every register has its own side-effects, which have to run one at a time
+    case EVMU_RAM_REGION_SFR:
+        for(size_t b = 0; b < bytes; ++b)
+            GBL_CTX_VERIFY_CALL(EvmuRam_writeData(pSelf,
+                                                  EVMU_ADDRESS_SEGMENT_SFR_BASE + offset + b,
+                                                  ((const uint8_t*)pData)[b]));
+        break;
+
+    case EVMU_RAM_REGION_XRAM:
+        if(memcmp(&pRegion[offset], pData, bytes) &&
+           !(pSelf_->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_VCCR)] & 0x40))
+            pDevice->pLcd->screenChanged = GBL_TRUE;
+
+        memcpy(&pRegion[offset], pData, bytes);
+        EvmuLcd__rehash_(EVMU_DEVICE_(pDevice)->pLcd);
+        break;
+
+    default:
+        memcpy(&pRegion[offset], pData, bytes);
+        break;
+    }
+
+    pSelf->dataChanged = GBL_TRUE;
+
+    GBL_CTX_END();
+}
+
 static EVMU_RESULT EvmuRam_IMemory_readBytes_(const EvmuIMemory* pSelf,
                                                  EvmuAddress        address,
                                                  void*              pBuffer,
@@ -589,11 +744,84 @@ static EVMU_RESULT EvmuRam_IMemory_writeBytes_(EvmuIMemory* pSelf,
     GBL_CTX_END();
 }
 
+// Resolves a saved bus map offset, or returns NULL if it isn't a bank \p segment can map
+static EvmuWord* EvmuRam_intMapEntry_(EvmuRam_* pSelf_, size_t segment, uint32_t offset) {
+    EvmuWord* pBanks[EVMU_ADDRESS_SEGMENT_XRAM_BANKS] = { NULL };
+    size_t    banks = 0;
+
+    switch(segment) {
+    case EVMU_RAM__INT_SEGMENT_GP1_:
+    case EVMU_RAM__INT_SEGMENT_GP2_:
+        for(; banks < EVMU_ADDRESS_SEGMENT_RAM_BANKS; ++banks)
+            pBanks[banks] = &pSelf_->ram[banks][segment == EVMU_RAM__INT_SEGMENT_GP2_?
+                                                EVMU_RAM__INT_SEGMENT_SIZE_ : 0];
+        break;
+    case EVMU_RAM__INT_SEGMENT_SFR_:
+        pBanks[banks++] = pSelf_->sfr;
+        break;
+    case EVMU_RAM__INT_SEGMENT_XRAM_:
+        for(; banks < EVMU_ADDRESS_SEGMENT_XRAM_BANKS; ++banks)
+            pBanks[banks] = pSelf_->xram[banks];
+        break;
+    }
+
+    for(size_t b = 0; b < banks; ++b)
+        if((size_t)((uint8_t*)pBanks[b] - (uint8_t*)pSelf_) == offset)
+            return pBanks[b];
+
+    return NULL;
+}
+
+static EVMU_RESULT EvmuRam_state_(EvmuRam* pSelf, EvmuStateBuffer* pBuffer) {
+    EvmuRam_*    pSelf_ = EVMU_RAM_(pSelf);
+    const size_t start  = EvmuIBehavior__beginSection_(pBuffer, EVMU_RAM__STATE_TAG_, EVMU_RAM__STATE_VERSION_);
+    uint32_t     intMap[EVMU_RAM__INT_SEGMENT_COUNT_];
+    // The bus maps point into the device, so they're saved relative to what they map
+    uint8_t      extFlash = pSelf_->pExt == pSelf_->pFlash->pStorage->pData;
+
+    for(size_t s = 0; s < EVMU_RAM__INT_SEGMENT_COUNT_; ++s)
+        intMap[s] = pSelf_->pIntMap[s]?
+                    (uint32_t)((uint8_t*)pSelf_->pIntMap[s] - (uint8_t*)pSelf_) : UINT32_MAX;
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->ram);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->sfr);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->xram);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, intMap);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, extFlash);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf->dataChanged);
+
+    if(pBuffer->loading && GBL_RESULT_SUCCESS(pBuffer->result)) {
+        // Anything other than one of the segment's own banks would let the bus reach past the device
+        for(size_t s = 0; s < EVMU_RAM__INT_SEGMENT_COUNT_; ++s) {
+            EvmuWord* pEntry = intMap[s] == UINT32_MAX? NULL : EvmuRam_intMapEntry_(pSelf_, s, intMap[s]);
+
+            if(pEntry || intMap[s] == UINT32_MAX)
+                pSelf_->pIntMap[s] = pEntry;
+            else
+                pBuffer->result = GBL_RESULT_ERROR_INVALID_ARG;
+        }
+
+        pSelf_->pExt = extFlash? pSelf_->pFlash->pStorage->pData : pSelf_->pRom->pStorage->pData;
+    }
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+static EVMU_RESULT EvmuRam_IBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuRam_state_(EVMU_RAM(pSelf), pBuffer);
+}
+
+static EVMU_RESULT EvmuRam_IBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuRam_state_(EVMU_RAM(pSelf), pBuffer);
+}
+
 static GBL_RESULT EvmuRamClass_init_(GblClass* pClass, const void* pData) {
     GBL_UNUSED(pData);
     GBL_CTX_BEGIN(NULL);
 
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnReset       = EvmuRam_reset_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState   = EvmuRam_IBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState   = EvmuRam_IBehavior_loadState_;
     GBL_OBJECT_CLASS(pClass)    ->pFnConstructor = EvmuRam_constructor_;
     GBL_BOX_CLASS(pClass)       ->pFnDestructor  = EvmuRam_destructor_;
     EVMU_IMEMORY_CLASS(pClass)  ->pFnRead        = EvmuRam_IMemory_readBytes_;
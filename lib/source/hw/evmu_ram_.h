@@ -16,6 +16,9 @@
 #define EVMU_RAM_(instance)      (GBL_PRIVATE(EvmuRam, instance))
 #define EVMU_RAM_PUBLIC_(priv)   (GBL_PUBLIC(EvmuRam, priv))
 
+#define EVMU_RAM__STATE_TAG_     EVMU_IBEHAVIOR__STATE_TAG_('R', 'A', 'M', ' ')
+#define EVMU_RAM__STATE_VERSION_ 1
+
 #define EVMU_RAM__INT_SEGMENT_SIZE_  128
 
 #define GBL_SELF_TYPE EvmuRam_
@@ -0,0 +1,427 @@
+#include <evmu/hw/evmu_device.h>
+#include <evmu/hw/evmu_sio.h>
+#include "evmu_device_.h"
+#include "evmu_gamepad_.h"
+#include "evmu_rewind_.h"
+#include "../types/evmu_ibehavior_.h"
+#include "../types/evmu_alloc_.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define EVMU_REWIND_ALIGN_(size) \
+    (((size) + EVMU_REWIND__ALIGNMENT_ - 1) & ~(size_t)(EVMU_REWIND__ALIGNMENT_ - 1))
+
+GBL_INLINE EvmuRewindRecord_* EvmuRewind_record_(const EvmuRewind_* pSelf, size_t offset) {
+    return (EvmuRewindRecord_*)&pSelf->pRing[offset];
+}
+
+GBL_INLINE GblBool EvmuRewind_empty_(const EvmuRewind_* pSelf) {
+    return !pSelf->wrapped && pSelf->head == pSelf->tail;
+}
+
+// Offset of the record following the one at \p offset, or tail if it's the last
+static size_t EvmuRewind_next_(const EvmuRewind_* pSelf, size_t offset) {
+    offset += sizeof(EvmuRewindRecord_) + EvmuRewind_record_(pSelf, offset)->size;
+
+    return pSelf->wrapped && offset == pSelf->wrapEnd? 0 : offset;
+}
+
+static void EvmuRewind_clear_(EvmuRewind_* pSelf) {
+    pSelf->head      = 0;
+    pSelf->tail      = 0;
+    pSelf->wrapped   = GBL_FALSE;
+    pSelf->stateSize = 0;
+    pSelf->advance   = SIZE_MAX;
+}
+
+// Drops the oldest snapshot along with the advances following it, which can't be replayed without it
+static void EvmuRewind_evict_(EvmuRewind_* pSelf) {
+    do {
+        pSelf->head = EvmuRewind_next_(pSelf, pSelf->head);
+
+        // The upper records have all been dropped, leaving only those at the front
+        if(pSelf->wrapped && !pSelf->head)
+            pSelf->wrapped = GBL_FALSE;
+
+    } while(!EvmuRewind_empty_(pSelf) &&
+            EvmuRewind_record_(pSelf, pSelf->head)->type != EVMU_REWIND__RECORD_SNAPSHOT_);
+
+    // Dropping the newest snapshot leaves nothing to replay from
+    if(EvmuRewind_empty_(pSelf))
+        EvmuRewind_clear_(pSelf);
+}
+
+// Evicts the oldest records until \p bytes are free in one piece, returning where they start
+static size_t EvmuRewind_reserve_(EvmuRewind_* pSelf, size_t bytes) {
+    for(;;) {
+        if(!pSelf->wrapped) {
+            if(pSelf->ringSize - pSelf->tail >= bytes)
+                return pSelf->tail;
+
+            if(pSelf->head >= bytes) {
+                pSelf->wrapEnd = pSelf->tail;
+                pSelf->tail    = 0;
+                pSelf->wrapped = GBL_TRUE;
+                return 0;
+            }
+        } else if(pSelf->head - pSelf->tail >= bytes) {
+            return pSelf->tail;
+        }
+
+        EvmuRewind_evict_(pSelf);
+    }
+}
+
+// Bytes needed to hold the changes between two snapshots
+static size_t EvmuRewind_deltaSize_(const uint64_t* pOld, const uint64_t* pNew, size_t words) {
+    size_t size = 0;
+
+    for(size_t w = 0; w < words; ) {
+        while(w < words && pOld[w] == pNew[w]) ++w;
+
+        if(w == words) break;
+
+        size += sizeof(EvmuRewindRun_);
+
+        while(w < words && pOld[w] != pNew[w]) {
+            size += sizeof(uint64_t);
+            ++w;
+        }
+    }
+
+    return size;
+}
+
+// Encodes the changes between two snapshots as runs of unchanged words and XORed changed ones
+static void EvmuRewind_deltaWrite_(const uint64_t* pOld, const uint64_t* pNew, size_t words, uint8_t* pOut) {
+    for(size_t w = 0; w < words; ) {
+        EvmuRewindRun_ run = { 0 };
+
+        while(w < words && pOld[w] == pNew[w]) {
+            ++run.skip;
+            ++w;
+        }
+
+        if(w == words) break;
+
+        uint64_t* pWords = (uint64_t*)(pOut + sizeof(EvmuRewindRun_));
+
+        while(w < words && pOld[w] != pNew[w]) {
+            pWords[run.words++] = pOld[w] ^ pNew[w];
+            ++w;
+        }
+
+        memcpy(pOut, &run, sizeof(run));
+        pOut += sizeof(run) + run.words * sizeof(uint64_t);
+    }
+}
+
+// Turns either snapshot of a delta into the other
+static void EvmuRewind_deltaApply_(uint64_t* pState, const uint8_t* pDelta, size_t size) {
+    const uint8_t* pEnd = pDelta + size;
+
+    while(pDelta < pEnd) {
+        EvmuRewindRun_ run;
+        memcpy(&run, pDelta, sizeof(run));
+
+        const uint64_t* pWords = (const uint64_t*)(pDelta + sizeof(run));
+
+        pState += run.skip;
+
+        for(uint32_t w = 0; w < run.words; ++w)
+            *pState++ ^= pWords[w];
+
+        pDelta += sizeof(run) + run.words * sizeof(uint64_t);
+    }
+}
+
+static void EvmuRewind_snapshot_(EvmuRewind_* pSelf) {
+    size_t size = 0;
+
+    if(!GBL_RESULT_SUCCESS(EvmuIBehavior_saveState(EVMU_IBEHAVIOR(pSelf->pDevice),
+                                                   pSelf->pScratch,
+                                                   pSelf->stateCapacity,
+                                                   &size)))
+    {
+        EvmuRewind_clear_(pSelf);
+        return;
+    }
+
+    const size_t words = (size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // Pad out the last word so that it compares equal
+    memset((uint8_t*)pSelf->pScratch + size, 0, words * sizeof(uint64_t) - size);
+
+    // A state of a different size can't be diffed against, so history starts over
+    if(pSelf->stateSize != size)
+        EvmuRewind_clear_(pSelf);
+
+    size_t       payload = pSelf->stateSize? EvmuRewind_deltaSize_(pSelf->pKey, pSelf->pScratch, words) : 0;
+    const size_t offset  = EvmuRewind_reserve_(pSelf, sizeof(EvmuRewindRecord_) + payload);
+
+    // Making room may have evicted the snapshot the delta was against
+    if(!pSelf->stateSize)
+        payload = 0;
+
+    EvmuRewindRecord_* pRecord = EvmuRewind_record_(pSelf, offset);
+
+    pRecord->type    = EVMU_REWIND__RECORD_SNAPSHOT_;
+    pRecord->ticks   = EvmuDevice_emulatedTicks(pSelf->pDevice);
+    pRecord->size    = payload;
+    pRecord->count   = 0;
+    pRecord->prev    = pSelf->stateSize? pSelf->newest : offset;
+    pRecord->buttons = 0;
+
+    if(payload)
+        EvmuRewind_deltaWrite_(pSelf->pKey, pSelf->pScratch, words, (uint8_t*)(pRecord + 1));
+
+    uint64_t* pKey  = pSelf->pKey;
+    pSelf->pKey     = pSelf->pScratch;
+    pSelf->pScratch = pKey;
+
+    pSelf->tail      = offset + sizeof(EvmuRewindRecord_) + payload;
+    pSelf->newest    = offset;
+    pSelf->advance   = SIZE_MAX;
+    pSelf->stateSize = size;
+    pSelf->keyTicks  = pRecord->ticks;
+}
+
+static void EvmuRewind_logAdvance_(EvmuRewind_* pSelf, EvmuTicks ticks, uint16_t buttons) {
+    if(pSelf->advance != SIZE_MAX) {
+        EvmuRewindRecord_* pRecord = EvmuRewind_record_(pSelf, pSelf->advance);
+
+        if(pRecord->ticks == ticks && pRecord->buttons == buttons && pRecord->count != UINT32_MAX) {
+            ++pRecord->count;
+            return;
+        }
+    }
+
+    const size_t offset = EvmuRewind_reserve_(pSelf, sizeof(EvmuRewindRecord_));
+
+    // Making room evicted the snapshot this advance followed
+    if(!pSelf->stateSize)
+        return;
+
+    EvmuRewindRecord_* pRecord = EvmuRewind_record_(pSelf, offset);
+
+    pRecord->type    = EVMU_REWIND__RECORD_ADVANCE_;
+    pRecord->ticks   = ticks;
+    pRecord->size    = 0;
+    pRecord->count   = 1;
+    pRecord->prev    = 0;
+    pRecord->buttons = buttons;
+
+    pSelf->tail    = offset + sizeof(EvmuRewindRecord_);
+    pSelf->advance = offset;
+}
+
+size_t EvmuRewind__footprint_(const EvmuDevice* pDevice) {
+    const size_t state = EVMU_REWIND_ALIGN_(EvmuIBehavior_stateSize(EVMU_IBEHAVIOR(pDevice)));
+
+    // Two whole snapshots, then a ring big enough for the worst-case delta of one word changed in every two
+    return EVMU_REWIND_ALIGN_(sizeof(EvmuRewind_)) +
+           2 * state +
+           EVMU_REWIND_ALIGN_(sizeof(EvmuRewindRecord_) + 2 * state);
+}
+
+EvmuRewind_* EvmuRewind__create_(EvmuDevice* pDevice, size_t budget, EvmuTicks interval) {
+    const size_t state = EVMU_REWIND_ALIGN_(EvmuIBehavior_stateSize(EVMU_IBEHAVIOR(pDevice)));
+    const size_t size  = budget & ~(size_t)(EVMU_REWIND__ALIGNMENT_ - 1);
+
+    GBL_ASSERT(budget >= EvmuRewind__footprint_(pDevice));
+
+    EvmuRewind_* pSelf = EvmuAlloc__aligned_(EVMU_REWIND__ALIGNMENT_, size);
+
+    if(pSelf) {
+        memset(pSelf, 0, sizeof(EvmuRewind_));
+
+        pSelf->pDevice       = pDevice;
+        pSelf->budget        = budget;
+        pSelf->interval      = interval;
+        pSelf->stateCapacity = state;
+        pSelf->pKey          = (uint64_t*)((uint8_t*)pSelf + EVMU_REWIND_ALIGN_(sizeof(EvmuRewind_)));
+        pSelf->pScratch      = (uint64_t*)((uint8_t*)pSelf->pKey + state);
+        pSelf->pRing         = (uint8_t*)pSelf->pScratch + state;
+        pSelf->ringSize      = size - (pSelf->pRing - (uint8_t*)pSelf);
+
+        EvmuRewind_clear_(pSelf);
+        EvmuRewind_snapshot_(pSelf);
+    }
+
+    return pSelf;
+}
+
+void EvmuRewind__destroy_(EvmuRewind_* pSelf) {
+    EvmuAlloc__alignedFree_(pSelf);
+}
+
+void EvmuRewind__restart_(EvmuRewind_* pSelf) {
+    // Rewinding loads its own snapshots, which are already part of the history
+    if(pSelf->replaying)
+        return;
+
+    EvmuRewind_clear_(pSelf);
+    EvmuRewind_snapshot_(pSelf);
+}
+
+void EvmuRewind__record_(EvmuRewind_* pSelf, EvmuTicks ticks) {
+    if(pSelf->replaying)
+        return;
+
+    // The gamepad has been polled by now, so its buttons are the ones the advance saw
+    if(pSelf->stateSize)
+        EvmuRewind_logAdvance_(pSelf, ticks, EvmuGamepad__buttons_(pSelf->pDevice->pGamepad));
+
+    if(!pSelf->stateSize ||
+       EvmuDevice_emulatedTicks(pSelf->pDevice) - pSelf->keyTicks >= pSelf->interval)
+        EvmuRewind_snapshot_(pSelf);
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_setRewind(EvmuDevice* pSelf, size_t budget, EvmuTicks interval) {
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_ARG(interval > 0);
+
+    EvmuDevice_* pSelf_ = EVMU_DEVICE_(pSelf);
+
+    EvmuRewind__destroy_(pSelf_->pRewind);
+    pSelf_->pRewind = NULL;
+
+    if(budget) {
+        const size_t footprint = EvmuRewind__footprint_(pSelf);
+
+        GBL_CTX_VERIFY(budget >= footprint,
+                       GBL_RESULT_ERROR_OUT_OF_RANGE,
+                       "Rewind budget too small: [%zu bytes, at least %zu needed]",
+                       budget, footprint);
+
+        pSelf_->pRewind = EvmuRewind__create_(pSelf, budget, interval);
+
+        GBL_CTX_VERIFY(pSelf_->pRewind,
+                       GBL_RESULT_ERROR_INTERNAL,
+                       "Failed to allocate rewind history!");
+    }
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT size_t EvmuDevice_rewindBudget(const EvmuDevice* pSelf) {
+    const EvmuRewind_* pRewind = EVMU_DEVICE_(pSelf)->pRewind;
+
+    return pRewind? pRewind->budget : 0;
+}
+
+EVMU_EXPORT EvmuTicks EvmuDevice_rewindLimit(const EvmuDevice* pSelf) {
+    const EvmuRewind_* pRewind = EVMU_DEVICE_(pSelf)->pRewind;
+
+    return pRewind && pRewind->stateSize?
+               EvmuRewind_record_(pRewind, pRewind->head)->ticks :
+               EvmuDevice_emulatedTicks(pSelf);
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuDevice_rewind(EvmuDevice* pSelf, EvmuTicks ticks) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuDevice_*  pSelf_   = EVMU_DEVICE_(pSelf);
+    EvmuRewind_*  pRewind  = pSelf_->pRewind;
+    EvmuGamepad_* pGamepad = pSelf_->pGamepad;
+
+    GBL_CTX_VERIFY(pRewind,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "Rewind history isn't being recorded!");
+
+    GBL_CTX_VERIFY(!EvmuSio_linked(pSelf->pSio),
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "Cannot rewind a device linked to another!");
+
+    GBL_CTX_VERIFY(ticks >= EvmuDevice_rewindLimit(pSelf) && ticks <= pSelf_->emulatedTicks,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Cannot rewind to [%llu ticks], history covers [%llu, %llu]",
+                   (unsigned long long)ticks,
+                   (unsigned long long)EvmuDevice_rewindLimit(pSelf),
+                   (unsigned long long)pSelf_->emulatedTicks);
+
+    const size_t words = (pRewind->stateSize + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    size_t       snap  = pRewind->newest;
+
+    memcpy(pRewind->pScratch, pRewind->pKey, words * sizeof(uint64_t));
+
+    // Walk back from the newest snapshot to the last one taken at or before the target
+    for(EvmuRewindRecord_* pRecord;
+        (pRecord = EvmuRewind_record_(pRewind, snap))->ticks > ticks;
+        snap = pRecord->prev)
+    {
+        GBL_ASSERT(snap != pRewind->head);
+        EvmuRewind_deltaApply_(pRewind->pScratch, (const uint8_t*)(pRecord + 1), pRecord->size);
+    }
+
+    pRewind->replaying = GBL_TRUE;
+    pGamepad->locked   = GBL_TRUE;
+
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior__loadTrusted_(EVMU_IBEHAVIOR(pSelf),
+                                                    pRewind->pScratch,
+                                                    pRewind->stateSize));
+
+    uint64_t* pKey    = pRewind->pKey;
+    pRewind->pKey     = pRewind->pScratch;
+    pRewind->pScratch = pKey;
+    pRewind->keyTicks = EvmuRewind_record_(pRewind, snap)->ticks;
+    pRewind->newest   = snap;
+    pRewind->advance  = SIZE_MAX;
+
+    // Replay whole advances up to the target, dropping everything recorded past it
+    size_t    keep    = EvmuRewind_next_(pRewind, snap);
+    EvmuTicks partial = 0;
+    uint16_t  buttons = EvmuGamepad__buttons_(pSelf->pGamepad);
+
+    for(size_t a = keep; a != pRewind->tail && pSelf_->emulatedTicks < ticks; a = keep) {
+        EvmuRewindRecord_* pRecord = EvmuRewind_record_(pRewind, a);
+        uint32_t           done    = 0;
+
+        GBL_ASSERT(pRecord->type == EVMU_REWIND__RECORD_ADVANCE_);
+
+        buttons = pRecord->buttons;
+
+        while(done < pRecord->count && pSelf_->emulatedTicks + pRecord->ticks <= ticks) {
+            EvmuGamepad__setButtons_(pSelf->pGamepad, buttons);
+            GBL_CTX_VERIFY_CALL(EvmuDevice__advance_(pSelf, pRecord->ticks));
+            ++done;
+        }
+
+        if(done < pRecord->count) {
+            partial        = ticks - pSelf_->emulatedTicks;
+            pRecord->count = done;
+
+            if(done) keep = EvmuRewind_next_(pRewind, a);
+            break;
+        }
+
+        keep = EvmuRewind_next_(pRewind, a);
+    }
+
+    if(keep != pRewind->tail) {
+        if(pRewind->wrapped && keep >= pRewind->head)
+            pRewind->wrapped = GBL_FALSE;
+
+        pRewind->tail = keep;
+    }
+
+    pRewind->replaying = GBL_FALSE;
+
+    // The remainder is a new advance, recorded like any other
+    if(partial) {
+        EvmuGamepad__setButtons_(pSelf->pGamepad, buttons);
+        GBL_CTX_VERIFY_CALL(EvmuDevice__advance_(pSelf, partial));
+    }
+
+    GBL_CTX_END_BLOCK();
+
+    pGamepad->locked = GBL_FALSE;
+
+    // History can't be trusted after a failed replay
+    if(pRewind && pRewind->replaying) {
+        pRewind->replaying = GBL_FALSE;
+        EvmuRewind__restart_(pRewind);
+    }
+
+    return GBL_CTX_RESULT();
+}
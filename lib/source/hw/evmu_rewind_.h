@@ -0,0 +1,69 @@
+#ifndef EVMU_REWIND__H
+#define EVMU_REWIND__H
+
+#include <evmu/hw/evmu_device.h>
+
+#define EVMU_REWIND__ALIGNMENT_ 64  // cache line
+
+GBL_DECLS_BEGIN
+
+typedef enum EVMU_REWIND__RECORD_ {
+    EVMU_REWIND__RECORD_SNAPSHOT_,  // snapshot taken, holding the delta back to the previous one
+    EVMU_REWIND__RECORD_ADVANCE_    // run of identical device advances
+} EVMU_REWIND__RECORD_;
+
+// Entry within the rewind ring, followed by size bytes of payload
+GBL_DECLARE_STRUCT(EvmuRewindRecord_) {
+    EvmuTicks ticks;    // SNAPSHOT: emulated time it was taken at, ADVANCE: ticks of each advance
+    uint32_t  size;
+    uint32_t  count;    // ADVANCE: number of consecutive advances
+    uint32_t  prev;     // SNAPSHOT: offset of the previous snapshot record
+    uint16_t  type;
+    uint16_t  buttons;  // ADVANCE: gamepad buttons held, as packed by EvmuGamepad__buttons_()
+};
+
+// Run of snapshot words left unchanged, followed by a run of changed words XORed together
+GBL_DECLARE_STRUCT(EvmuRewindRun_) {
+    uint32_t skip;
+    uint32_t words;
+};
+
+/* Rewind history of a device, living at the front of a single block sized to its budget.
+ * The newest snapshot is kept whole, with older ones recovered by walking backwards
+ * through the deltas stored in a ring of records, interleaved with the device advances
+ * made in between, which are replayed to reach points between snapshots. The oldest
+ * record in the ring is always a snapshot, so that everything after it can be replayed.
+ */
+GBL_DECLARE_STRUCT(EvmuRewind_) {
+    EvmuDevice* pDevice;
+    size_t      budget;
+    EvmuTicks   interval;       // emulated time between snapshots
+    size_t      stateCapacity;  // bytes reserved for each whole snapshot, a multiple of the alignment
+    size_t      stateSize;      // bytes of the newest snapshot, or 0 if there isn't one
+    uint64_t*   pKey;           // newest snapshot
+    uint64_t*   pScratch;
+    EvmuTicks   keyTicks;
+    uint8_t*    pRing;
+    size_t      ringSize;
+    size_t      head;           // oldest record
+    size_t      tail;           // where the next record goes
+    size_t      wrapEnd;        // end of the records before tail wrapped around to the front
+    GblBool     wrapped;
+    size_t      newest;         // newest snapshot record
+    size_t      advance;        // newest advance record, if nothing has been recorded after it
+    GblBool     replaying;
+};
+
+// Smallest budget which can hold history for the given device
+size_t       EvmuRewind__footprint_(const EvmuDevice* pDevice);
+// Allocates history for the given device within \p budget bytes, which must be at least its footprint
+EvmuRewind_* EvmuRewind__create_   (EvmuDevice* pDevice, size_t budget, EvmuTicks interval);
+void         EvmuRewind__destroy_  (EvmuRewind_* pSelf);
+// Drops all history, starting over from a snapshot of the device's current state
+void         EvmuRewind__restart_  (EvmuRewind_* pSelf);
+// Records an advance the device just made, taking a snapshot once the interval has elapsed
+void         EvmuRewind__record_   (EvmuRewind_* pSelf, EvmuTicks ticks);
+
+GBL_DECLS_END
+
+#endif // EVMU_REWIND__H
@@ -2,7 +2,9 @@
 #include "evmu_ram_.h"
 #include "evmu_device_.h"
 #include "../fs/evmu_fat_.h"
+#include "../types/evmu_ibehavior_.h"
 #include <gimbal/utils/gimbal_date_time.h>
+#include <gimbal/algorithms/gimbal_hash.h>
 
 EVMU_EXPORT GblBool EvmuRom_biosActive(const EvmuRom* pSelf) {
     EvmuRom_* pSelf_ = EVMU_ROM_(pSelf);
@@ -14,6 +16,10 @@ EVMU_EXPORT EVMU_BIOS_TYPE EvmuRom_biosType(const EvmuRom* pSelf) {
     return pSelf_->eBiosType;
 }
 
+EVMU_EXPORT GblHash EvmuRom_biosCrc(const EvmuRom* pSelf) {
+    return EVMU_ROM_(pSelf)->biosCrc;
+}
+
 EVMU_EXPORT EVMU_BIOS_MODE EvmuRom_biosMode(const EvmuRom* pSelf) {
     if(EvmuRom_biosType(pSelf) == EVMU_BIOS_TYPE_EMULATED)
         return EVMU_BIOS_MODE_UNKNOWN;
@@ -114,8 +120,10 @@ EVMU_EXPORT EVMU_RESULT EvmuRom_unloadBios(EvmuRom* pSelf) {
     EVMU_LOG_PUSH();
 
     EvmuRom_* pSelf_ = EVMU_ROM_(pSelf);
+    GBL_CTX_VERIFY_CALL(EvmuRom__detach_(pSelf_));
     memset(pSelf_->pStorage->pData, 0, pSelf_->pStorage->size);
     pSelf_->eBiosType = EVMU_BIOS_TYPE_EMULATED;
+    pSelf_->biosCrc   = 0;
 
     EVMU_LOG_POP(1);
     GBL_CTX_END();
@@ -141,6 +149,9 @@ static void biosWriteFlashRom_(EvmuRom_* pSelf_) {
 
     if(!pEntry ||  a >= pEntry->fileSize * EVMU_FAT_BLOCK_SIZE)
         EvmuRam_writeData(pDevice->pRam, 0x100, 0xff);
+    // Shared flash that couldn't be copied for writing fails the call rather than being written through
+    else if(!GBL_RESULT_SUCCESS(EvmuFlash__detach_(pDevice_->pFlash, a & ~0xff, 0x100)))
+        EvmuRam_writeData(pDevice->pRam, 0x100, 0xff);
     else {
         EvmuRam_writeData(pDevice->pRam, 0x100, 0x00);
         for(i=0; i<0x80; i++) {
@@ -207,6 +218,11 @@ EVMU_EXPORT EVMU_RESULT EvmuRom_loadBios_(EvmuRom* pSelf, const char* path) {
     }
 
     //Clear ROM
+    if(!GBL_RESULT_SUCCESS(EvmuRom__detach_(pSelf_))) {
+        fclose(file);
+        EVMU_LOG_POP(1);
+        return 0;
+    }
     memset(pSelf_->pStorage->pData, 0, pSelf_->pStorage->size);
 
     size_t bytesRead   = 0;
@@ -225,6 +241,7 @@ EVMU_EXPORT EVMU_RESULT EvmuRom_loadBios_(EvmuRom* pSelf, const char* path) {
     GBL_ASSERT(bytesTotal >= 0);
 
     const GblHash biosHash = gblHashCrc(pSelf_->pStorage->pData, pSelf_->pStorage->size);
+    pSelf_->biosCrc = biosHash;
     switch (biosHash) {
         case EVMU_BIOS_TYPE_AMERICAN_IMAGE_V1_05:
             EVMU_LOG_VERBOSE("Detected American V1.05 BIOS");
@@ -309,7 +326,7 @@ static EVMU_RESULT EvmuRom_IMemory_read_(const EvmuIMemory* pSelf,
     EvmuRom_*  pSelf_  = EVMU_ROM_(pSelf);
 
     if(!GBL_RESULT_SUCCESS(
-            GblByteArray_read(pSelf_->pStorage, address, *pBytes, pBuffer)
+            EvmuStorage__read_(pSelf_->pStorage, address, *pBytes, pBuffer)
             )) {
         *pBytes = 0;
         GBL_CTX_VERIFY_LAST_RECORD();
@@ -329,9 +346,12 @@ static EVMU_RESULT EvmuRom_IMemory_write_(EvmuIMemory* pSelf,
     // Cache private data
     EvmuRom_*  pSelf_   = EVMU_ROM_(pSelf);
 
+    // Stop sharing storage with clones before modifying it
+    GBL_CTX_VERIFY_CALL(EvmuRom__detach_(pSelf_));
+
     // Attempt to write to flash byte array
     if(!GBL_RESULT_SUCCESS(
-            GblByteArray_write(pSelf_->pStorage, address, *pBytes, pBuffer)
+            EvmuStorage__write_(pSelf_->pStorage, address, *pBytes, pBuffer)
             )) {
         // Return 0 if the write failed, proxy last error
         *pBytes = 0;
@@ -410,10 +430,41 @@ static GBL_RESULT EvmuRom_GblObject_constructed_(GblObject* pSelf) {
     GBL_CTX_END();
 }
 
+void EvmuRom__share_(EvmuRom_* pSelf_, EvmuRom_* pSrc_) {
+    // EXT may be executing straight out of the old storage
+    if(pSelf_->pRam->pExt == pSelf_->pStorage->pData)
+        pSelf_->pRam->pExt = pSrc_->pStorage->pData;
+
+    EvmuStorage__unref_(pSelf_->pStorage);
+    pSelf_->pStorage = EvmuStorage__ref_(pSrc_->pStorage);
+}
+
+EVMU_RESULT EvmuRom__copyOnWrite_(EvmuRom_* pSelf_) {
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuStorage_* pShared = pSelf_->pStorage;
+    EvmuStorage_* pOwned  = EvmuStorage__create_(pShared->size);
+
+    GBL_CTX_VERIFY(pOwned,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate private ROM storage!");
+
+    memcpy(pOwned->pData, pShared->pData, pShared->size);
+
+    // EXT may be executing straight out of the old storage
+    if(pSelf_->pRam->pExt == pShared->pData)
+        pSelf_->pRam->pExt = pOwned->pData;
+
+    pSelf_->pStorage = pOwned;
+    EvmuStorage__unref_(pShared);
+
+    GBL_CTX_END();
+}
+
 static GBL_RESULT EvmuRom_GblBox_destructor_(GblBox* pBox) {
     GBL_CTX_BEGIN(NULL);
 
-    GblByteArray_unref(EVMU_ROM_(pBox)->pStorage);
+    EvmuStorage__unref_(EVMU_ROM_(pBox)->pStorage);
     GBL_VCALL_DEFAULT(EvmuPeripheral, base.base.pFnDestructor, pBox);
 
     GBL_CTX_END();
@@ -425,11 +476,39 @@ static GBL_RESULT EvmuRom_init_(GblInstance* pInstance) {
     EvmuRom* pSelf   = EVMU_ROM(pInstance);
     EvmuRom_* pSelf_ = EVMU_ROM_(pSelf);
 
-    pSelf_->pStorage = GblByteArray_create(
+    pSelf_->pStorage = EvmuStorage__create_(
                            EVMU_IMEMORY_GET_CLASS(pSelf)->capacity
                        );
 
-    memset(pSelf_->pStorage->pData, 0, pSelf_->pStorage->size);
+    GBL_CTX_VERIFY(pSelf_->pStorage,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate ROM storage!");
+
+    GBL_CTX_END();
+}
+
+// The BIOS image is saved too, so that a state never resumes into a different BIOS
+static EVMU_RESULT EvmuRom_state_(EvmuRom* pSelf, EvmuStateBuffer* pBuffer) {
+    EvmuRom_*    pSelf_ = EVMU_ROM_(pSelf);
+    const size_t start  = EvmuIBehavior__beginSection_(pBuffer, EVMU_ROM__STATE_TAG_, EVMU_ROM__STATE_VERSION_);
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->eBiosType);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->biosCrc);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->bSetupSkipEnabled);
+    EvmuStorage__state_(pSelf_->pStorage, pBuffer);
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+static EVMU_RESULT EvmuRom_IBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuRom_state_(EVMU_ROM(pSelf), pBuffer);
+}
+
+static EVMU_RESULT EvmuRom_IBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_CTX_VERIFY_CALL(EvmuRom__detach_(EVMU_ROM_(pSelf)));
+    GBL_CTX_VERIFY_CALL(EvmuRom_state_(EVMU_ROM(pSelf), pBuffer));
 
     GBL_CTX_END();
 }
@@ -442,6 +521,8 @@ static GBL_RESULT EvmuRomClass_init_(GblClass* pClass, const void* pUd) {
     EVMU_IMEMORY_CLASS(pClass)  ->pFnRead        = EvmuRom_IMemory_read_;
     EVMU_IMEMORY_CLASS(pClass)  ->pFnWrite       = EvmuRom_IMemory_write_;
     EVMU_IMEMORY_CLASS(pClass)  ->capacity       = EVMU_ROM_SIZE;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState   = EvmuRom_IBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState   = EvmuRom_IBehavior_loadState_;
     GBL_OBJECT_CLASS(pClass)    ->pFnConstructed = EvmuRom_GblObject_constructed_;
     GBL_OBJECT_CLASS(pClass)    ->pFnProperty    = EvmuRom_GblObject_property_;
     GBL_OBJECT_CLASS(pClass)    ->pFnSetProperty = EvmuRom_GblObject_setProperty_;
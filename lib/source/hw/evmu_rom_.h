@@ -2,11 +2,14 @@
 #define EVMU_ROM__H
 
 #include <evmu/hw/evmu_rom.h>
-#include <gimbal/utils/gimbal_byte_array.h>
+#include "evmu_storage_.h"
 
 #define EVMU_ROM_(instance)     (GBL_PRIVATE(EvmuRom, instance))
 #define EVMU_ROM_PUBLIC_(priv)  (GBL_PUBLIC(EvmuRom, priv))
 
+#define EVMU_ROM__STATE_TAG_     EVMU_IBEHAVIOR__STATE_TAG_('R', 'O', 'M', ' ')
+#define EVMU_ROM__STATE_VERSION_ 2
+
 GBL_DECLS_BEGIN
 
 GBL_FORWARD_DECLARE_STRUCT(EvmuRam_);
@@ -14,11 +17,22 @@ GBL_FORWARD_DECLARE_STRUCT(EvmuRam_);
 typedef struct EvmuRom_ {
     EvmuRam_*      pRam;
 
-    GblByteArray*  pStorage;
+    EvmuStorage_* pStorage;
     EVMU_BIOS_TYPE eBiosType;
+    GblHash        biosCrc;  // CRC of the loaded BIOS image, or 0 when emulated
     GblBool        bSetupSkipEnabled;
 } EvmuRom_;
 
+// Drops own storage in favor of sharing pSrc's storage copy-on-write, rebasing EXT onto it
+void        EvmuRom__share_       (EvmuRom_* pSelf, EvmuRom_* pSrc);
+// Gives a sharing ROM its own private copy of storage
+EVMU_RESULT EvmuRom__copyOnWrite_ (EvmuRom_* pSelf);
+
+// Must be called before anything mutates storage
+EVMU_INLINE EVMU_RESULT EvmuRom__detach_(EvmuRom_* pSelf) GBL_NOEXCEPT {
+    return EvmuStorage__shared_(pSelf->pStorage)? EvmuRom__copyOnWrite_(pSelf) : GBL_RESULT_SUCCESS;
+}
+
 GBL_DECLS_END
 
 #endif // EVMU_ROM__H
@@ -0,0 +1,227 @@
+#include "evmu_device_.h"
+#include "evmu_sio_.h"
+#include "evmu_ram_.h"
+#include "../types/evmu_ibehavior_.h"
+#include <evmu/hw/evmu_sfr.h>
+#include <evmu/hw/evmu_address_space.h>
+
+EVMU_EXPORT EvmuCycles EvmuSio_transferCycles(const EvmuSio* pSelf) {
+    EvmuRam_* pRam = EVMU_SIO_(pSelf)->pRam;
+
+    // Internal transfer clock toggles every (256 - SBR) cycles
+    return EVMU_SIO_BITS * 2 * (256 - pRam->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_SBR)]);
+}
+
+EVMU_EXPORT GblBool EvmuSio_transmitting(const EvmuSio* pSelf) {
+    return EVMU_SIO_(pSelf)->txActive;
+}
+
+EVMU_EXPORT GblBool EvmuSio_linked(const EvmuSio* pSelf) {
+    return EVMU_SIO_(pSelf)->pTx != NULL;
+}
+
+// Queues a byte for the other device, returning GBL_FALSE if the link is backed up
+static GblBool EvmuSio_send_(EvmuSio_* pSelf_, EvmuWord value) {
+    EvmuSioQueue_* pQueue = pSelf_->pTx;
+    const size_t   tail   = atomic_load_explicit(&pQueue->tail, memory_order_relaxed);
+
+    if(tail - atomic_load_explicit(&pQueue->head, memory_order_acquire) == EVMU_SIO__QUEUE_SIZE_)
+        return GBL_FALSE;
+
+    EvmuSioPacket_* pPacket = &pQueue->packets[tail & (EVMU_SIO__QUEUE_SIZE_ - 1)];
+
+    // Never arrive within the current quantum, even when running behind the link
+    pPacket->time  = pSelf_->time + pSelf_->latency;
+    pPacket->value = value;
+
+    if(pPacket->time < pSelf_->horizon)
+        pPacket->time = pSelf_->horizon;
+
+    atomic_store_explicit(&pQueue->tail, tail + 1, memory_order_release);
+
+    return GBL_TRUE;
+}
+
+static void EvmuSio_updateTransmit_(EvmuSio* pSelf, EvmuCycles cycles) {
+    EvmuSio_*   pSelf_  = EVMU_SIO_(pSelf);
+    EvmuRam_*   pRam    = pSelf_->pRam;
+    EvmuDevice* pDevice = EvmuPeripheral_device(EVMU_PERIPHERAL(pSelf));
+    EvmuWord*   pScon   = &pRam->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_SCON0)];
+
+    // Clearing the transfer control bit aborts an ongoing transfer
+    if(!(*pScon & EVMU_SFR_SCON0_CTRL_MASK)) {
+        pSelf_->txActive = GBL_FALSE;
+        return;
+    }
+
+    if(!pSelf_->txActive) {
+        pSelf_->txActive = GBL_TRUE;
+        pSelf_->txCycles = EvmuSio_transferCycles(pSelf);
+        pSelf_->txValue  = pRam->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_SBUF0)];
+    }
+
+    if(pSelf_->txCycles > cycles) {
+        pSelf_->txCycles -= cycles;
+        return;
+    }
+
+    pSelf_->txActive = GBL_FALSE;
+
+    if(pSelf_->pTx && !EvmuSio_send_(pSelf_, pSelf_->txValue))
+        *pScon |= EVMU_SFR_SCON0_OV_MASK;
+
+    // Continuous transfers start over on the next update
+    if(!(*pScon & EVMU_SFR_SCON0_LEN_MASK))
+        *pScon &= ~EVMU_SFR_SCON0_CTRL_MASK;
+
+    *pScon |= EVMU_SFR_SCON0_END_MASK;
+
+    if(*pScon & EVMU_SFR_SCON0_IE_MASK)
+        EvmuPic_raiseIrq(pDevice->pPic, EVMU_IRQ_SIO0);
+}
+
+static void EvmuSio_updateReceive_(EvmuSio* pSelf) {
+    EvmuSio_*      pSelf_  = EVMU_SIO_(pSelf);
+    EvmuRam_*      pRam    = pSelf_->pRam;
+    EvmuDevice*    pDevice = EvmuPeripheral_device(EVMU_PERIPHERAL(pSelf));
+    EvmuSioQueue_* pQueue  = pSelf_->pRx;
+    EvmuWord*      pScon   = &pRam->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_SCON1)];
+
+    size_t head = atomic_load_explicit(&pQueue->head, memory_order_relaxed);
+
+    while(head != atomic_load_explicit(&pQueue->tail, memory_order_acquire)) {
+        const EvmuSioPacket_* pPacket = &pQueue->packets[head & (EVMU_SIO__QUEUE_SIZE_ - 1)];
+
+        // Bytes sent during the current quantum may not have been queued yet, so never look at them
+        if(pPacket->time > pSelf_->time || pPacket->time >= pSelf_->horizon)
+            break;
+
+        // Bytes arriving while SIO1 isn't running are lost, as on hardware
+        if(*pScon & EVMU_SFR_SCON1_CTRL_MASK) {
+            if(*pScon & EVMU_SFR_SCON1_END_MASK)
+                *pScon |= EVMU_SFR_SCON1_OV_MASK;
+
+            pRam->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_SBUF1)] = pPacket->value;
+
+            if(!(*pScon & EVMU_SFR_SCON1_LEN_MASK))
+                *pScon &= ~EVMU_SFR_SCON1_CTRL_MASK;
+
+            *pScon |= EVMU_SFR_SCON1_END_MASK;
+
+            if(*pScon & EVMU_SFR_SCON1_IE_MASK)
+                EvmuPic_raiseIrq(pDevice->pPic, EVMU_IRQ_SIO1);
+        }
+
+        atomic_store_explicit(&pQueue->head, ++head, memory_order_release);
+    }
+}
+
+EVMU_EXPORT void EvmuSio_update(EvmuSio* pSelf) {
+    EvmuSio_*   pSelf_  = EVMU_SIO_(pSelf);
+    EvmuDevice* pDevice = EvmuPeripheral_device(EVMU_PERIPHERAL(pSelf));
+
+    const EvmuCycles cy = EvmuCpu_cycles(pDevice->pCpu);
+
+    pSelf_->time += cy * EvmuClock_systemTicksPerCycle(pDevice->pClock);
+
+    EvmuSio_updateTransmit_(pSelf, cy);
+
+    if(pSelf_->pRx)
+        EvmuSio_updateReceive_(pSelf);
+}
+
+void EvmuSio__link_(EvmuSio_* pSelf_, EvmuSio_* pOther_, EvmuSioQueue_* pQueues, EvmuTicks latency) {
+    atomic_init(&pQueues[0].head, 0);
+    atomic_init(&pQueues[0].tail, 0);
+    atomic_init(&pQueues[1].head, 0);
+    atomic_init(&pQueues[1].tail, 0);
+
+    pSelf_->pTx = pOther_->pRx = &pQueues[0];
+    pSelf_->pRx = pOther_->pTx = &pQueues[1];
+
+    pSelf_->latency = pOther_->latency = latency;
+    pSelf_->horizon = pOther_->horizon = 0;
+
+    // Both ends count time from the moment they were linked
+    pSelf_->time = pOther_->time = 0;
+}
+
+void EvmuSio__unlink_(EvmuSio_* pSelf_) {
+    pSelf_->pTx = NULL;
+    pSelf_->pRx = NULL;
+}
+
+static GBL_RESULT EvmuSio_GblObject_constructed_(GblObject* pSelf) {
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_VCALL_DEFAULT(EvmuPeripheral, base.pFnConstructed, pSelf);
+    GblObject_setName(pSelf, EVMU_SIO_NAME);
+
+    GBL_CTX_END();
+}
+
+static GBL_RESULT EvmuSio_IBehavior_reset_(EvmuIBehavior* pSelf) {
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_VCALL_DEFAULT(EvmuIBehavior, pFnReset, pSelf);
+
+    EvmuSio_* pSelf_ = EVMU_SIO_(pSelf);
+
+    pSelf_->txActive = GBL_FALSE;
+    pSelf_->txCycles = 0;
+    pSelf_->txValue  = 0;
+
+    GBL_CTX_END();
+}
+
+// Links are between specific devices, so only the transfer in progress is saved
+static EVMU_RESULT EvmuSio_state_(EvmuSio* pSelf, EvmuStateBuffer* pBuffer) {
+    EvmuSio_*    pSelf_ = EVMU_SIO_(pSelf);
+    const size_t start  = EvmuIBehavior__beginSection_(pBuffer, EVMU_SIO__STATE_TAG_, EVMU_SIO__STATE_VERSION_);
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->txCycles);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->txValue);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->txActive);
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+static EVMU_RESULT EvmuSio_IBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuSio_state_(EVMU_SIO(pSelf), pBuffer);
+}
+
+static EVMU_RESULT EvmuSio_IBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuSio_state_(EVMU_SIO(pSelf), pBuffer);
+}
+
+static GBL_RESULT EvmuSioClass_init_(GblClass* pClass, const void* pUd) {
+    GBL_UNUSED(pUd);
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_OBJECT_CLASS(pClass)    ->pFnConstructed = EvmuSio_GblObject_constructed_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnReset       = EvmuSio_IBehavior_reset_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState   = EvmuSio_IBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState   = EvmuSio_IBehavior_loadState_;
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT GblType EvmuSio_type(void) {
+    static GblType type = GBL_INVALID_TYPE;
+
+    const static GblTypeInfo info = {
+        .classSize              = sizeof(EvmuSioClass),
+        .pFnClassInit           = EvmuSioClass_init_,
+        .instanceSize           = sizeof(EvmuSio),
+        .instancePrivateSize    = sizeof(EvmuSio_)
+    };
+
+    if(type == GBL_INVALID_TYPE) GBL_UNLIKELY {
+        type = GblType_register(GblQuark_internStatic("EvmuSio"),
+                                EVMU_PERIPHERAL_TYPE,
+                                &info,
+                                GBL_TYPE_FLAG_TYPEINFO_STATIC);
+    }
+
+    return type;
+}
@@ -0,0 +1,53 @@
+#ifndef EVMU_SIO__H
+#define EVMU_SIO__H
+
+#include <evmu/hw/evmu_sio.h>
+#include <stdatomic.h>
+#include <stdalign.h>
+
+#define EVMU_SIO_(instance)     (GBL_PRIVATE(EvmuSio, instance))
+#define EVMU_SIO_PUBLIC_(priv)  (GBL_PUBLIC(EvmuSio, priv))
+
+#define EVMU_SIO__STATE_TAG_     EVMU_IBEHAVIOR__STATE_TAG_('S', 'I', 'O', ' ')
+#define EVMU_SIO__STATE_VERSION_ 1
+
+#define EVMU_SIO__QUEUE_SIZE_   256 // bytes in flight per direction, a power of two
+
+GBL_DECLS_BEGIN
+
+GBL_FORWARD_DECLARE_STRUCT(EvmuRam_);
+
+// Byte sent over a link, received once the other device reaches its timestamp
+GBL_DECLARE_STRUCT(EvmuSioPacket_) {
+    EvmuTicks time;
+    EvmuWord  value;
+};
+
+// Bounded single-producer, single-consumer ring carrying bytes one way across a link
+GBL_DECLARE_STRUCT(EvmuSioQueue_) {
+    alignas(64) atomic_size_t head;     // next packet to receive, advanced by the receiver
+    alignas(64) atomic_size_t tail;     // next slot to send into, advanced by the sender
+    EvmuSioPacket_            packets[EVMU_SIO__QUEUE_SIZE_];
+};
+
+GBL_DECLARE_STRUCT(EvmuSio_) {
+    EvmuRam_*      pRam;
+    EvmuTicks      time;        // emulated time elapsed, as counted by the serial ports
+    EvmuCycles     txCycles;    // cycles left shifting out txValue
+    EvmuWord       txValue;     // SBUF0 latched when the transfer began
+    GblBool        txActive;
+    // Link state, owned by EvmuEmulator
+    EvmuSioQueue_* pTx;         // bytes sent to the other device
+    EvmuSioQueue_* pRx;         // bytes sent by the other device
+    EvmuTicks      latency;     // delay between sending a byte and the other device receiving it
+    EvmuTicks      horizon;     // bytes due at or beyond this time are left for the next quantum
+};
+
+// Connects two serial interfaces through a pair of queues, delivering bytes \p latency after they're sent
+void EvmuSio__link_   (EvmuSio_* pSelf, EvmuSio_* pOther, EvmuSioQueue_* pQueues, EvmuTicks latency);
+// Disconnects a serial interface from its queues, discarding anything in flight
+void EvmuSio__unlink_ (EvmuSio_* pSelf);
+
+GBL_DECLS_END
+
+#endif // EVMU_SIO__H
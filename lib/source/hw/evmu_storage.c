@@ -0,0 +1,142 @@
+#include "evmu_storage_.h"
+#include "../types/evmu_ibehavior_.h"
+#include "../types/evmu_alloc_.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define EVMU_STORAGE_ALIGN_(size) \
+    (((size) + EVMU_STORAGE_ALIGNMENT_ - 1) & ~(size_t)(EVMU_STORAGE_ALIGNMENT_ - 1))
+
+EvmuStorage_* EvmuStorage__create_(size_t size) {
+    EvmuStorage_* pSelf = malloc(sizeof(EvmuStorage_) + size);
+
+    if(pSelf) {
+        pSelf->pData     = (uint8_t*)(pSelf + 1);
+        pSelf->size      = size;
+        pSelf->pArena    = NULL;
+        pSelf->mapped    = GBL_FALSE;
+        pSelf->writeBack = GBL_FALSE;
+        atomic_init(&pSelf->refCount, 1);
+        memset(pSelf->pData, 0, size);
+    }
+
+    return pSelf;
+}
+
+EvmuStorage_* EvmuStorage__ref_(EvmuStorage_* pSelf) {
+    atomic_fetch_add_explicit(&pSelf->refCount, 1, memory_order_relaxed);
+    return pSelf;
+}
+
+size_t EvmuStorage__unref_(EvmuStorage_* pSelf) {
+    if(!pSelf) return 0;
+
+    const size_t count = atomic_fetch_sub_explicit(&pSelf->refCount, 1, memory_order_acq_rel) - 1;
+
+    if(!count) {
+        if(pSelf->mapped) EvmuStorage__unmap_(pSelf);
+
+        if(pSelf->pArena) EvmuArena__release_(pSelf->pArena);
+        else              free(pSelf);
+    }
+
+    return count;
+}
+
+EVMU_RESULT EvmuStorage__read_(const EvmuStorage_* pSelf, size_t offset, size_t bytes, void* pBuffer) {
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_CTX_VERIFY(offset + bytes <= pSelf->size,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Out-of-range storage read: [offset: %zu, bytes: %zu, size: %zu]",
+                   offset, bytes, pSelf->size);
+
+    memcpy(pBuffer, &pSelf->pData[offset], bytes);
+
+    GBL_CTX_END();
+}
+
+EVMU_RESULT EvmuStorage__write_(EvmuStorage_* pSelf, size_t offset, size_t bytes, const void* pBuffer) {
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_CTX_VERIFY(offset + bytes <= pSelf->size,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Out-of-range storage write: [offset: %zu, bytes: %zu, size: %zu]",
+                   offset, bytes, pSelf->size);
+
+    memcpy(&pSelf->pData[offset], pBuffer, bytes);
+
+    GBL_CTX_END();
+}
+
+EVMU_RESULT EvmuStorage__copy_(EvmuStorage_* pSelf, const EvmuStorage_* pOther) {
+    GBL_CTX_BEGIN(NULL);
+
+    GBL_CTX_VERIFY(pSelf->size == pOther->size,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Cannot copy between storages of different sizes: [%zu vs %zu]",
+                   pSelf->size, pOther->size);
+
+    memcpy(pSelf->pData, pOther->pData, pOther->size);
+
+    GBL_CTX_END();
+}
+
+void EvmuStorage__state_(EvmuStorage_* pSelf, EvmuStateBuffer* pBuffer) {
+    size_t size = pBuffer->external? 0 : pSelf->size;
+
+    EvmuIBehavior__size_(pBuffer, &size);
+
+    // Contents were transferred separately, so whatever's there already stays
+    if(!size)
+        return;
+
+    if(size != pSelf->size && GBL_RESULT_SUCCESS(pBuffer->result))
+        pBuffer->result = GBL_RESULT_ERROR_INVALID_ARG;
+
+    EvmuIBehavior__field_(pBuffer, pSelf->pData, pSelf->size);
+}
+
+size_t EvmuArena__footprint_(size_t size) {
+    return EVMU_STORAGE_ALIGN_(sizeof(EvmuStorage_)) + EVMU_STORAGE_ALIGN_(size);
+}
+
+EvmuArena_* EvmuArena__create_(size_t capacity) {
+    const size_t header = EVMU_STORAGE_ALIGN_(sizeof(EvmuArena_));
+    EvmuArena_*  pSelf  = EvmuAlloc__aligned_(EVMU_STORAGE_ALIGNMENT_,
+                                              header + EVMU_STORAGE_ALIGN_(capacity));
+
+    if(pSelf) {
+        atomic_init(&pSelf->refCount, 1);
+        pSelf->capacity = capacity;
+        pSelf->used     = 0;
+    }
+
+    return pSelf;
+}
+
+EvmuStorage_* EvmuArena__storage_(EvmuArena_* pSelf, size_t size) {
+    if(pSelf->used + EvmuArena__footprint_(size) > pSelf->capacity)
+        return NULL;
+
+    uint8_t*      pBlock   = (uint8_t*)pSelf + EVMU_STORAGE_ALIGN_(sizeof(EvmuArena_)) + pSelf->used;
+    EvmuStorage_* pStorage = (EvmuStorage_*)pBlock;
+
+    pStorage->pData     = pBlock + EVMU_STORAGE_ALIGN_(sizeof(EvmuStorage_));
+    pStorage->size      = size;
+    pStorage->pArena    = pSelf;
+    pStorage->mapped    = GBL_FALSE;
+    pStorage->writeBack = GBL_FALSE;
+    atomic_init(&pStorage->refCount, 1);
+    memset(pStorage->pData, 0, size);
+
+    pSelf->used += EvmuArena__footprint_(size);
+    atomic_fetch_add_explicit(&pSelf->refCount, 1, memory_order_relaxed);
+
+    return pStorage;
+}
+
+void EvmuArena__release_(EvmuArena_* pSelf) {
+    if(pSelf && atomic_fetch_sub_explicit(&pSelf->refCount, 1, memory_order_acq_rel) == 1)
+        EvmuAlloc__alignedFree_(pSelf);
+}
@@ -0,0 +1,65 @@
+#ifndef EVMU_STORAGE__H
+#define EVMU_STORAGE__H
+
+#include <evmu/types/evmu_typedefs.h>
+#include <evmu/types/evmu_ibehavior.h>
+#include <stdatomic.h>
+
+#define EVMU_STORAGE_ALIGNMENT_ 64  // cache line
+
+GBL_DECLS_BEGIN
+
+GBL_FORWARD_DECLARE_STRUCT(EvmuArena_);
+
+// Reference-counted flat byte buffer backing flash, ROM, and WRAM
+GBL_DECLARE_STRUCT(EvmuStorage_) {
+    uint8_t*      pData;
+    size_t        size;
+    atomic_size_t refCount;
+    EvmuArena_*   pArena;    // block this storage was carved from, or NULL if heap-allocated
+    GblBool       mapped;    // pData is a file mapping, unmapped on release
+    GblBool       writeBack; // mapping is shared, so writes reach the file
+};
+
+// Single cache-line-aligned block holding several storages back-to-back
+GBL_DECLARE_STRUCT(EvmuArena_) {
+    atomic_size_t refCount; // creator + each storage carved out of the block
+    size_t        capacity;
+    size_t        used;
+};
+
+EvmuStorage_* EvmuStorage__create_ (size_t size);
+// Maps \p size bytes of the file at \p offset, which must be page-aligned, either
+// writing modifications back to the file or keeping them private copy-on-write.
+// Lives with the state image code, and returns NULL on hosts without POSIX files
+EvmuStorage_* EvmuStorage__map_    (int fd, uint64_t offset, size_t size, GblBool writeBack);
+// Releases the mapping of a storage made by EvmuStorage__map_(), once unreferenced
+void          EvmuStorage__unmap_  (EvmuStorage_* pSelf);
+EvmuStorage_* EvmuStorage__ref_    (EvmuStorage_* pSelf);
+size_t        EvmuStorage__unref_  (EvmuStorage_* pSelf);
+// Whether anything else still references the storage, so it must be copied before it's written
+EVMU_INLINE GblBool EvmuStorage__shared_(EvmuStorage_* pSelf) GBL_NOEXCEPT {
+    return atomic_load_explicit(&pSelf->refCount, memory_order_acquire) > 1;
+}
+EVMU_RESULT   EvmuStorage__read_   (const EvmuStorage_* pSelf, size_t offset, size_t bytes, void* pBuffer);
+EVMU_RESULT   EvmuStorage__write_  (EvmuStorage_* pSelf, size_t offset, size_t bytes, const void* pBuffer);
+EVMU_RESULT   EvmuStorage__copy_   (EvmuStorage_* pSelf, const EvmuStorage_* pOther);
+// Flushes the pages overlapping the given range out to a write-back mapping's file,
+// returning once they're durable if \p wait or once they're scheduled if not.
+// Lives with the flash image code, and is unsupported on hosts without POSIX files
+EVMU_RESULT   EvmuStorage__sync_   (EvmuStorage_* pSelf, size_t offset, size_t bytes, GblBool wait);
+// Transfers the contents of storage to or from a save state, which must agree on its size,
+// or leave them out entirely for an external state
+void          EvmuStorage__state_  (EvmuStorage_* pSelf, EvmuStateBuffer* pBuffer);
+
+// Bytes of arena capacity consumed by a storage of the given size
+size_t        EvmuArena__footprint_ (size_t size);
+EvmuArena_*   EvmuArena__create_    (size_t capacity);
+// Carves a zeroed storage out of the arena, which stays alive until all of them are released
+EvmuStorage_* EvmuArena__storage_   (EvmuArena_* pSelf, size_t size);
+// Drops the creator's reference, freeing the block once no storages remain
+void          EvmuArena__release_   (EvmuArena_* pSelf);
+
+GBL_DECLS_END
+
+#endif // EVMU_STORAGE__H
@@ -2,6 +2,7 @@
 #include "evmu_ram_.h"
 #include "evmu_device_.h"
 #include "evmu_buzzer_.h"
+#include "../types/evmu_ibehavior_.h"
 
 static void EvmuTimers_updateBaseTimer_(EvmuTimers* pSelf) {
     EvmuTimers_* pSelf_  = EVMU_TIMERS_(pSelf);
@@ -126,6 +127,9 @@ static void EvmuTimers_updateTimer1_(EvmuTimers* pSelf) {
 
     const int cy = EvmuCpu_cycles(pDevice->pCpu);
 
+    //Generate PCM for the elapsed cycles from T1L's state before counting
+    EvmuBuzzer__pcmAdvance_(pSelf_->pBuzzer, pSelf_->timer1.base.tl, cy);
+
     //Interrupts enabled for T1H or overflow on T1H
     if(pRam->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_T1CNT)] & (EVMU_SFR_T1CNT_T1HRUN_MASK|EVMU_SFR_T1CNT_T1LRUN_MASK)) {
 
@@ -244,6 +248,25 @@ static GBL_RESULT EvmuTimers_IBehavior_reset_(EvmuIBehavior* pSelf) {
     GBL_CTX_END();
 }
 
+static EVMU_RESULT EvmuTimers_state_(EvmuTimers* pSelf, EvmuStateBuffer* pBuffer) {
+    EvmuTimers_* pSelf_ = EVMU_TIMERS_(pSelf);
+    const size_t start  = EvmuIBehavior__beginSection_(pBuffer, EVMU_TIMERS__STATE_TAG_, EVMU_TIMERS__STATE_VERSION_);
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->timer0);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->timer1);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf_->baseTimer);
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+static EVMU_RESULT EvmuTimers_IBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuTimers_state_(EVMU_TIMERS(pSelf), pBuffer);
+}
+
+static EVMU_RESULT EvmuTimers_IBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuTimers_state_(EVMU_TIMERS(pSelf), pBuffer);
+}
+
 static GBL_RESULT EvmuTimersClass_init_(GblClass* pClass, const void* pUd) {
     GBL_UNUSED(pUd);
     GBL_CTX_BEGIN(NULL);
@@ -251,6 +274,8 @@ static GBL_RESULT EvmuTimersClass_init_(GblClass* pClass, const void* pUd) {
     GBL_OBJECT_CLASS(pClass)    ->pFnConstructed = EvmuTimers_GblObject_constructed_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnUpdate      = EvmuTimers_IBehavior_update_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnReset       = EvmuTimers_IBehavior_reset_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState   = EvmuTimers_IBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState   = EvmuTimers_IBehavior_loadState_;
 
     GBL_CTX_END();
 }
@@ -6,6 +6,9 @@
 #define EVMU_TIMERS_(instance)      (GBL_PRIVATE(EvmuTimers, instance))
 #define EVMU_TIMERS_PUBLIC_(priv)   (GBL_PUBLIC(EvmuTimers, priv))
 
+#define EVMU_TIMERS__STATE_TAG_     EVMU_IBEHAVIOR__STATE_TAG_('T', 'M', 'R', ' ')
+#define EVMU_TIMERS__STATE_VERSION_ 1
+
 GBL_DECLS_BEGIN
 
 GBL_FORWARD_DECLARE_STRUCT(EvmuRam_);
@@ -1,6 +1,7 @@
 #include <evmu/hw/evmu_wram.h>
 #include "evmu_wram_.h"
 #include "evmu_ram_.h"
+#include "../types/evmu_ibehavior_.h"
 
 EVMU_EXPORT EvmuAddress EvmuWram_accessAddress(const EvmuWram* pSelf) {
     EvmuRam_* pRam_ = EVMU_WRAM_(pSelf)->pRam;
@@ -77,6 +78,22 @@ EVMU_EXPORT EVMU_RESULT EvmuWram_writeBytes(EvmuWram*   pSelf,
 }
 
 
+EVMU_EXPORT EVMU_RESULT EvmuWram_readRaw(const EvmuWram* pSelf,
+                                         EvmuAddress     address,
+                                         void*           pBuffer,
+                                         size_t          bytes)
+{
+    return EvmuStorage__read_(EVMU_WRAM_(pSelf)->pStorage, address, bytes, pBuffer);
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuWram_writeRaw(EvmuWram*   pSelf,
+                                          EvmuAddress address,
+                                          const void* pBuffer,
+                                          size_t      bytes)
+{
+    return EvmuStorage__write_(EVMU_WRAM_(pSelf)->pStorage, address, bytes, pBuffer);
+}
+
 static EVMU_RESULT EvmuWram_IBehavior_reset_(EvmuIBehavior* pBehav) {
     GBL_CTX_BEGIN(NULL);
     EvmuWram_* pSelf_ = EVMU_WRAM_(pBehav);
@@ -93,7 +110,7 @@ static EVMU_RESULT EvmuWram_IMemory_readBytes_(const EvmuIMemory* pSelf,
     EvmuWram_*  pSelf_  = EVMU_WRAM_(pSelf);
 
     if(!GBL_RESULT_SUCCESS(
-            GblByteArray_read(pSelf_->pStorage, address, *pBytes, pBuffer)
+            EvmuStorage__read_(pSelf_->pStorage, address, *pBytes, pBuffer)
             )) {
         *pBytes = 0;
         GBL_CTX_VERIFY_LAST_RECORD();
@@ -115,7 +132,7 @@ static EVMU_RESULT EvmuWram_IMemory_writeBytes_(EvmuIMemory* pSelf,
 
     // Attempt to write to flash byte array
     if(!GBL_RESULT_SUCCESS(
-            GblByteArray_write(pSelf_->pStorage, address, *pBytes, pBuffer)
+            EvmuStorage__write_(pSelf_->pStorage, address, *pBytes, pBuffer)
             )) {
         // Return 0 if the write failed, proxy last error
         *pBytes = 0;
@@ -131,7 +148,7 @@ static EVMU_RESULT EvmuWram_IMemory_writeBytes_(EvmuIMemory* pSelf,
 static GBL_RESULT EvmuWram_GblBox_destructor_(GblBox* pBox) {
     GBL_CTX_BEGIN(NULL);
 
-    GblByteArray_unref(EVMU_WRAM_(pBox)->pStorage);
+    EvmuStorage__unref_(EVMU_WRAM_(pBox)->pStorage);
     GBL_VCALL_DEFAULT(EvmuPeripheral, base.base.pFnDestructor, pBox);
 
     GBL_CTX_END();
@@ -143,20 +160,42 @@ static GBL_RESULT EvmuWram_init_(GblInstance* pInstance) {
     EvmuWram* pSelf   = EVMU_WRAM(pInstance);
     EvmuWram_* pSelf_ = EVMU_WRAM_(pSelf);
 
-    pSelf_->pStorage   = GblByteArray_create(
+    pSelf_->pStorage   = EvmuStorage__create_(
                              EVMU_IMEMORY_GET_CLASS(pSelf)->capacity
                          );
 
-    memset(pSelf_->pStorage->pData, 0, pSelf_->pStorage->size);
+    GBL_CTX_VERIFY(pSelf_->pStorage,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate WRAM storage!");
 
     GBL_CTX_END();
 }
 
+static EVMU_RESULT EvmuWram_state_(EvmuWram* pSelf, EvmuStateBuffer* pBuffer) {
+    EvmuWram_*   pSelf_ = EVMU_WRAM_(pSelf);
+    const size_t start  = EvmuIBehavior__beginSection_(pBuffer, EVMU_WRAM__STATE_TAG_, EVMU_WRAM__STATE_VERSION_);
+
+    EvmuStorage__state_(pSelf_->pStorage, pBuffer);
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, pSelf->dataChanged);
+
+    return EvmuIBehavior__endSection_(pBuffer, start);
+}
+
+static EVMU_RESULT EvmuWram_IBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuWram_state_(EVMU_WRAM(pSelf), pBuffer);
+}
+
+static EVMU_RESULT EvmuWram_IBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    return EvmuWram_state_(EVMU_WRAM(pSelf), pBuffer);
+}
+
 static GBL_RESULT EvmuWramClass_init_(GblClass* pClass, const void* pUd) {
     GBL_CTX_BEGIN(NULL);
 
     GBL_BOX_CLASS(pClass)       ->pFnDestructor = EvmuWram_GblBox_destructor_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnReset      = EvmuWram_IBehavior_reset_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState  = EvmuWram_IBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState  = EvmuWram_IBehavior_loadState_;
     EVMU_IMEMORY_CLASS(pClass)  ->pFnRead       = EvmuWram_IMemory_readBytes_;
     EVMU_IMEMORY_CLASS(pClass)  ->pFnWrite      = EvmuWram_IMemory_writeBytes_;
     EVMU_IMEMORY_CLASS(pClass)  ->capacity      = EVMU_WRAM_SIZE;
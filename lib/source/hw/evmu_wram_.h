@@ -2,18 +2,21 @@
 #define EVMU_WRAM__H
 
 #include <evmu/hw/evmu_wram.h>
-#include <gimbal/utils/gimbal_byte_array.h>
+#include "evmu_storage_.h"
 
 #define EVMU_WRAM_(instance)   (GBL_PRIVATE(EvmuWram, instance))
 #define EVMU_WRAM_PUBLIC(priv) (GBL_PUBLIC(EvmuWram, priv))
 
+#define EVMU_WRAM__STATE_TAG_     EVMU_IBEHAVIOR__STATE_TAG_('W', 'R', 'A', 'M')
+#define EVMU_WRAM__STATE_VERSION_ 1
+
 GBL_DECLS_BEGIN
 
 GBL_FORWARD_DECLARE_STRUCT(EvmuRam_);
 
 GBL_DECLARE_STRUCT(EvmuWram_) {
     EvmuRam_*     pRam;
-    GblByteArray* pStorage;
+    EvmuStorage_*pStorage;
 };
 
 GBL_DECLS_END
@@ -0,0 +1,33 @@
+#ifndef EVMU_ALLOC__H
+#define EVMU_ALLOC__H
+
+/* Aligned heap blocks, which have to go back through EvmuAlloc__alignedFree_().
+ * MSVC's CRT has no C11 aligned_alloc(), only _aligned_malloc(), whose blocks
+ * can't be released with plain free().
+ */
+#include <stdlib.h>
+#ifdef _MSC_VER
+#   include <malloc.h>
+#endif
+
+// Returns \p size bytes aligned to \p alignment, a power of two, or NULL
+static inline void* EvmuAlloc__aligned_(size_t alignment, size_t size) {
+    // C11 wants the size to be a whole number of alignments
+    size = (size + alignment - 1) & ~(alignment - 1);
+
+#ifdef _MSC_VER
+    return _aligned_malloc(size, alignment);
+#else
+    return aligned_alloc(alignment, size);
+#endif
+}
+
+static inline void EvmuAlloc__alignedFree_(void* pBlock) {
+#ifdef _MSC_VER
+    _aligned_free(pBlock);
+#else
+    free(pBlock);
+#endif
+}
+
+#endif // EVMU_ALLOC__H
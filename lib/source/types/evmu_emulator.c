@@ -1,6 +1,21 @@
 #include <evmu/types/evmu_emulator.h>
 #include <evmu/hw/evmu_device.h>
+#include <evmu/hw/evmu_clock.h>
 #include <gimbal/utils/gimbal_version.h>
+#include <gimbal/algorithms/gimbal_hash.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "evmu_emulator_.h"
+#include "evmu_ibehavior_.h"
+#include "evmu_alloc_.h"
+#include "../hw/evmu_device_.h"
+#include "../hw/evmu_ram_.h"
+#include "../hw/evmu_flash_.h"
+#include "../hw/evmu_rom_.h"
+#include "../hw/evmu_wram_.h"
+#include <evmu/hw/evmu_sfr.h>
+#include <evmu/hw/evmu_address_space.h>
 
 EVMU_EXPORT GblVersion EvmuEmulator_version(void) {
     return GBL_VERSION_MAKE(EVMU_VERSION_MAJOR, EVMU_VERSION_MINOR, EVMU_VERSION_PATCH);
@@ -33,63 +48,1196 @@ EVMU_EXPORT EVMU_RESULT EvmuEmulator_removeDevice(EvmuEmulator* pSelf, EvmuDevic
     GBL_CTX_VERIFY(removed,
                    GBL_RESULT_ERROR_INVALID_OPERATION,
                    "EvmuEmulator_removeDevice(): attempt to remove non-child device!");
+
+    if(EvmuEmulator_linkedDevice(pSelf, pDevice))
+        GBL_CTX_VERIFY_CALL(EvmuEmulator_unlinkDevice(pSelf, pDevice));
+
     GBL_CTX_END();
 }
 
+// Devices are whichever children are EvmuDevices, however they came to be parented to the emulator
+static EvmuDevice* EvmuEmulator_nextDevice_(GblObject* pIter) {
+    while(pIter && !GBL_TYPECHECK(EvmuDevice, pIter))
+        pIter = GblObject_siblingNext(pIter);
+
+    return pIter? EVMU_DEVICE(pIter) : NULL;
+}
+
+#define EVMU_EMULATOR_FOREACH_DEVICE_(pSelf, pDevice)                                            \
+    for(EvmuDevice* pDevice = EvmuEmulator_nextDevice_(GblObject_childFirst(GBL_OBJECT(pSelf))); \
+        pDevice;                                                                                 \
+        pDevice = EvmuEmulator_nextDevice_(GblObject_siblingNext(GBL_OBJECT(pDevice))))
+
 EVMU_EXPORT size_t EvmuEmulator_deviceCount(const EvmuEmulator* pSelf) {
     size_t count = 0;
-    for(GblObject* pIter = GblObject_childFirst(GBL_OBJECT(pSelf));
-        pIter;
-        pIter = GblObject_siblingNext(pIter))
-    {
-        if(GBL_TYPECHECK(EvmuDevice, pIter)) ++count;
-    }
+
+    EVMU_EMULATOR_FOREACH_DEVICE_(pSelf, pDevice)
+        ++count;
+
     return count;
 }
 
-GBL_DECLARE_STRUCT(EvmuEmulatorDeviceIterClosure_) {
-    size_t      count;
-    size_t      index;
-    EvmuDevice* pResult;
-};
+EVMU_EXPORT EvmuDevice* EvmuEmulator_device(const EvmuEmulator* pSelf, size_t index) {
+    EVMU_EMULATOR_FOREACH_DEVICE_(pSelf, pDevice)
+        if(!index--)
+            return pDevice;
 
-static GblBool EvmuEmulator_deviceIter_(const EvmuEmulator* pSelf, EvmuDevice* pDevice, void* pClosure) {
-    EvmuEmulatorDeviceIterClosure_* pIterClosure = pClosure;
+    return NULL;
+}
+
+EVMU_EXPORT GblBool EvmuEmulator_foreachDevice(const EvmuEmulator* pSelf, EvmuEmulatorIterFn pFnIt, void* pClosure) {
+    EVMU_EMULATOR_FOREACH_DEVICE_(pSelf, pDevice)
+        if(pFnIt(pSelf, pDevice, pClosure))
+            return GBL_TRUE;
 
-    if(pIterClosure->count++ == pIterClosure->index) {
-        pIterClosure->pResult = pDevice;
-        return GBL_TRUE;
+    return GBL_FALSE;
+}
+
+// Copies the current devices into a flat array the workers can index
+static EVMU_RESULT EvmuEmulator_snapshotDevices_(EvmuEmulator* pSelf) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuEmulator_* pSelf_ = EVMU_EMULATOR_(pSelf);
+    const size_t   count  = EvmuEmulator_deviceCount(pSelf);
+
+    if(count > pSelf_->deviceCapacity) {
+        EvmuDevice**        ppDevices = realloc(pSelf_->ppDevices, sizeof(EvmuDevice*) * count);
+        EvmuEmulatorSlice_* pSlices   = ppDevices?
+                                        realloc(pSelf_->pSlices, sizeof(EvmuEmulatorSlice_) * count) :
+                                        NULL;
+        if(ppDevices) pSelf_->ppDevices = ppDevices;
+        if(pSlices)   pSelf_->pSlices   = pSlices;
+
+        GBL_CTX_VERIFY(ppDevices && pSlices,
+                       GBL_RESULT_ERROR_INTERNAL,
+                       "Failed to allocate device schedule: [%zu devices]",
+                       count);
+
+        // New devices start at the shortest slice and adapt from there
+        memset(&pSelf_->pSlices[pSelf_->deviceCapacity],
+               0,
+               sizeof(EvmuEmulatorSlice_) * (count - pSelf_->deviceCapacity));
+
+        pSelf_->deviceCapacity = count;
+    }
+
+    // Each deque must be able to hold every device's task at once
+    for(size_t w = 0; w < pSelf_->workerCount; ++w) {
+        EvmuEmulatorDeque_* pDeque = &pSelf_->pWorkers[w].deque;
+
+        if(!pDeque->pTasks || pDeque->mask + 1 < count) {
+            size_t size = 1;
+            while(size < count) size <<= 1;
+
+            atomic_size_t* pTasks = realloc(pDeque->pTasks, sizeof(atomic_size_t) * size);
+
+            GBL_CTX_VERIFY(pTasks,
+                           GBL_RESULT_ERROR_INTERNAL,
+                           "Failed to allocate work-stealing deque: [%zu tasks]",
+                           size);
+
+            pDeque->pTasks = pTasks;
+            pDeque->mask   = size - 1;
+        }
+    }
+
+    pSelf_->deviceCount = 0;
+
+    EVMU_EMULATOR_FOREACH_DEVICE_(pSelf, pDevice)
+        pSelf_->ppDevices[pSelf_->deviceCount++] = pDevice;
+
+    GBL_CTX_END();
+}
+
+static uint64_t EvmuEmulator_nsecs_(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void EvmuEmulator_dequeReset_(EvmuEmulatorDeque_* pDeque) {
+    atomic_store_explicit(&pDeque->top,    0, memory_order_relaxed);
+    atomic_store_explicit(&pDeque->bottom, 0, memory_order_relaxed);
+}
+
+// Owner only
+static void EvmuEmulator_dequePush_(EvmuEmulatorDeque_* pDeque, size_t task) {
+    const long long b = atomic_load_explicit(&pDeque->bottom, memory_order_relaxed);
+
+    atomic_store_explicit(&pDeque->pTasks[b & pDeque->mask], task, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&pDeque->bottom, b + 1, memory_order_relaxed);
+}
+
+// Owner only
+static GblBool EvmuEmulator_dequeTake_(EvmuEmulatorDeque_* pDeque, size_t* pTask) {
+    const long long b     = atomic_load_explicit(&pDeque->bottom, memory_order_relaxed) - 1;
+    GblBool         found = GBL_FALSE;
+
+    atomic_store_explicit(&pDeque->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    long long t = atomic_load_explicit(&pDeque->top, memory_order_relaxed);
+
+    if(t <= b) {
+        *pTask = atomic_load_explicit(&pDeque->pTasks[b & pDeque->mask], memory_order_relaxed);
+        found  = GBL_TRUE;
+
+        // Last task left, so race any thieves for it
+        if(t == b) {
+            found = atomic_compare_exchange_strong_explicit(&pDeque->top, &t, t + 1,
+                                                            memory_order_seq_cst,
+                                                            memory_order_relaxed);
+            atomic_store_explicit(&pDeque->bottom, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&pDeque->bottom, b + 1, memory_order_relaxed);
+    }
+
+    return found;
+}
+
+// Any thread
+static GblBool EvmuEmulator_dequeSteal_(EvmuEmulatorDeque_* pDeque, size_t* pTask) {
+    long long t = atomic_load_explicit(&pDeque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    const long long b = atomic_load_explicit(&pDeque->bottom, memory_order_acquire);
+
+    if(t < b) {
+        *pTask = atomic_load_explicit(&pDeque->pTasks[t & pDeque->mask], memory_order_relaxed);
+
+        return atomic_compare_exchange_strong_explicit(&pDeque->top, &t, t + 1,
+                                                       memory_order_seq_cst,
+                                                       memory_order_relaxed);
     }
 
     return GBL_FALSE;
 }
 
-EVMU_EXPORT EvmuDevice* EvmuEmulator_device(const EvmuEmulator* pSelf, size_t index) {
-    EvmuEmulatorDeviceIterClosure_ closure = {
-        .index = index
-    };
+// Returns the link \p pDevice is part of, or NULL if it isn't linked
+static EvmuEmulatorLink_* EvmuEmulator_findLink_(const EvmuEmulator_* pSelf_, const EvmuDevice* pDevice) {
+    if(!EVMU_DEVICE_(pDevice)->pSio->pTx)
+        return NULL;
 
-    EvmuEmulator_foreachDevice(pSelf, EvmuEmulator_deviceIter_, &closure);
+    for(size_t l = 0; l < pSelf_->linkCount; ++l)
+        if(pSelf_->ppLinks[l]->pDevices[0] == pDevice || pSelf_->ppLinks[l]->pDevices[1] == pDevice)
+            return pSelf_->ppLinks[l];
 
-    return closure.pResult;
+    return NULL;
 }
 
-EVMU_EXPORT GblBool EvmuEmulator_foreachDevice(const EvmuEmulator* pSelf, EvmuEmulatorIterFn pFnIt, void* pClosure) {
-    EvmuDevice* pDevice = NULL;
-    size_t      count   = 0;
+/* Runs a linked device up to the end of the current quantum, unless it's already past it.
+ * Speed and fast-forward are ignored, since the quantum is in emulated time. */
+static GBL_RESULT EvmuEmulator_runQuantum_(EvmuDevice* pDevice, EvmuTicks target) {
+    const EvmuSio_* pSio_ = EVMU_DEVICE_(pDevice)->pSio;
 
-    for(GblObject* pIter = GblObject_childFirst(GBL_OBJECT(pSelf));
-        pIter;
-        pIter = GblObject_siblingNext(pIter))
-    {
-        if(GBL_TYPECHECK(EvmuDevice, pIter))
-            if(pFnIt(pSelf, EVMU_DEVICE(pIter), pClosure))
-                return GBL_TRUE;
+    return target > pSio_->time?
+           EvmuDevice__advance_(pDevice, target - pSio_->time) :
+           GBL_RESULT_SUCCESS;
+}
+
+static int EvmuEmulator_linkMain_(void* pArg) {
+    EvmuEmulatorLink_* pLink  = pArg;
+    uint_fast64_t      quanta = 0;
+
+    for(;;) {
+        mtx_lock(&pLink->lock);
+
+        while(!pLink->quit && !atomic_load_explicit(&pLink->active, memory_order_acquire))
+            cnd_wait(&pLink->wake, &pLink->lock);
+
+        const GblBool quit = pLink->quit;
+        mtx_unlock(&pLink->lock);
+
+        if(quit) break;
+
+        // Quanta are too short to sleep between, so spin until the frame is over
+        while(atomic_load_explicit(&pLink->active, memory_order_acquire)) {
+            if(atomic_load_explicit(&pLink->released, memory_order_acquire) == quanta) {
+                thrd_yield();
+                continue;
+            }
+
+            const GBL_RESULT result = EvmuEmulator_runQuantum_(pLink->pDevices[1], pLink->target);
+
+            if(GBL_RESULT_ERROR(result) && !GBL_RESULT_ERROR(pLink->result))
+                pLink->result = result;
+
+            atomic_store_explicit(&pLink->finished, ++quanta, memory_order_release);
+        }
+    }
+
+    return 0;
+}
+
+// Advances both devices of a link by \p ticks, one quantum at a time, with the second on the link's thread
+static GBL_RESULT EvmuEmulator_runLink_(EvmuEmulatorLink_* pLink, EvmuTicks ticks) {
+    EvmuSio_*       pSio1  = EVMU_DEVICE_(pLink->pDevices[0])->pSio;
+    EvmuSio_*       pSio2  = EVMU_DEVICE_(pLink->pDevices[1])->pSio;
+    const EvmuTicks end    = pLink->time + ticks;
+    uint_fast64_t   quanta = atomic_load_explicit(&pLink->released, memory_order_relaxed);
+    GBL_RESULT      result = GBL_RESULT_SUCCESS;
+
+    pLink->result = GBL_RESULT_SUCCESS;
+
+    // Without a thread of its own, the second device takes its turn right after the first
+    if(!EVMU_THREADS_ENABLED_) {
+        while(pLink->time < end && !GBL_RESULT_ERROR(result)) {
+            const EvmuTicks target = (end - pLink->time < pLink->quantum)?
+                                     end : pLink->time + pLink->quantum;
+
+            pSio1->horizon = pSio2->horizon = target;
+
+            result = EvmuEmulator_runQuantum_(pLink->pDevices[0], target);
+
+            if(!GBL_RESULT_ERROR(result))
+                result = EvmuEmulator_runQuantum_(pLink->pDevices[1], target);
+
+            pLink->time = target;
+        }
+
+        return result;
+    }
+
+    mtx_lock(&pLink->lock);
+    atomic_store_explicit(&pLink->active, GBL_TRUE, memory_order_release);
+    cnd_signal(&pLink->wake);
+    mtx_unlock(&pLink->lock);
+
+    while(pLink->time < end && !GBL_RESULT_ERROR(result) && !GBL_RESULT_ERROR(pLink->result)) {
+        const EvmuTicks target = (end - pLink->time < pLink->quantum)?
+                                 end : pLink->time + pLink->quantum;
+
+        // Bytes sent during this quantum can't be received until the next one
+        pSio1->horizon = pSio2->horizon = target;
+        pLink->target  = target;
+
+        atomic_store_explicit(&pLink->released, ++quanta, memory_order_release);
+
+        result = EvmuEmulator_runQuantum_(pLink->pDevices[0], target);
+
+        while(atomic_load_explicit(&pLink->finished, memory_order_acquire) != quanta)
+            thrd_yield();
+
+        pLink->time = target;
+    }
+
+    atomic_store_explicit(&pLink->active, GBL_FALSE, memory_order_release);
+
+    return GBL_RESULT_ERROR(result)? result : pLink->result;
+}
+
+static void EvmuEmulator_destroyLink_(EvmuEmulatorLink_* pLink) {
+    mtx_lock(&pLink->lock);
+    pLink->quit = GBL_TRUE;
+    cnd_signal(&pLink->wake);
+    mtx_unlock(&pLink->lock);
+
+    thrd_join(pLink->thread, NULL);
+
+    EvmuSio__unlink_(EVMU_DEVICE_(pLink->pDevices[0])->pSio);
+    EvmuSio__unlink_(EVMU_DEVICE_(pLink->pDevices[1])->pSio);
+
+    cnd_destroy(&pLink->wake);
+    mtx_destroy(&pLink->lock);
+    EvmuAlloc__alignedFree_(pLink);
+}
+
+// Runs a device update on behalf of a worker, accumulating its counters
+static GBL_RESULT EvmuEmulator_runDevice_(EvmuEmulatorWorker_* pWorker,
+                                          EvmuDevice*          pDevice,
+                                          EvmuTicks            ticks,
+                                          uint64_t*            pInstructions)
+{
+    EvmuEmulatorLink_* pLink = EvmuEmulator_findLink_(pWorker->pEmulator, pDevice);
+    EvmuDevice*        pPeer = pLink? pLink->pDevices[1] : NULL;
+
+    // The second device of a link is run alongside the first
+    if(pPeer == pDevice) {
+        *pInstructions = 0;
+        return GBL_RESULT_SUCCESS;
+    }
+
+    const uint64_t   instructions = EvmuCpu_instructions(pDevice->pCpu) +
+                                    (pPeer? EvmuCpu_instructions(pPeer->pCpu) : 0);
+    const uint64_t   start        = EvmuEmulator_nsecs_();
+    const GBL_RESULT result       = pLink? EvmuEmulator_runLink_(pLink, ticks) :
+                                           EvmuIBehavior_update(EVMU_IBEHAVIOR(pDevice), ticks);
+
+    *pInstructions = EvmuCpu_instructions(pDevice->pCpu) +
+                     (pPeer? EvmuCpu_instructions(pPeer->pCpu) : 0) - instructions;
+
+    pWorker->stats.busyNsecs    += EvmuEmulator_nsecs_() - start;
+    pWorker->stats.instructions += *pInstructions;
+    ++pWorker->stats.slices;
+
+    if(GBL_RESULT_ERROR(result) && !GBL_RESULT_ERROR(pWorker->result))
+        pWorker->result = result;
+
+    return result;
+}
+
+// Runs one frame for the worker's contiguous slice of the device snapshot
+static void EvmuEmulator_runPartition_(EvmuEmulator_* pSelf_, EvmuEmulatorWorker_* pWorker) {
+    const size_t begin = pWorker->index       * pSelf_->deviceCount / pSelf_->workerCount;
+    const size_t end   = (pWorker->index + 1) * pSelf_->deviceCount / pSelf_->workerCount;
+    uint64_t     instructions;
+
+    for(size_t d = begin; d < end; ++d)
+        EvmuEmulator_runDevice_(pWorker, pSelf_->ppDevices[d], pSelf_->frameTicks, &instructions);
+}
+
+static GblBool EvmuEmulator_stealTask_(EvmuEmulator_* pSelf_, EvmuEmulatorWorker_* pWorker, size_t* pTask) {
+    const size_t victims = pSelf_->workerCount - 1;
+
+    if(!victims) return GBL_FALSE;
+
+    // xorshift32 picks where to start looking
+    uint32_t x = pWorker->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    pWorker->seed = x;
+
+    for(size_t v = 0; v < victims; ++v) {
+        const size_t victim = (pWorker->index + 1 + (x + v) % victims) % pSelf_->workerCount;
+
+        if(EvmuEmulator_dequeSteal_(&pSelf_->pWorkers[victim].deque, pTask)) {
+            ++pWorker->stats.steals;
+            return GBL_TRUE;
+        }
     }
 
     return GBL_FALSE;
 }
 
+// Runs the next time slice of a device, then requeues it or retires it for the frame
+static void EvmuEmulator_runSlice_(EvmuEmulator_* pSelf_, EvmuEmulatorWorker_* pWorker, size_t d) {
+    EvmuEmulatorSlice_* pSlice   = &pSelf_->pSlices[d];
+    const EvmuTicks     minTicks = (pSelf_->frameTicks < EVMU_EMULATOR_SLICE_MIN_TICKS)?
+                                   pSelf_->frameTicks : EVMU_EMULATOR_SLICE_MIN_TICKS;
+
+    if(pSlice->sliceTicks < minTicks)
+        pSlice->sliceTicks = minTicks;
+
+    const EvmuTicks ticks = (pSlice->remaining < pSlice->sliceTicks)?
+                            pSlice->remaining : pSlice->sliceTicks;
+    uint64_t        instructions;
+
+    const GBL_RESULT result = EvmuEmulator_runDevice_(pWorker,
+                                                      pSelf_->ppDevices[d],
+                                                      ticks,
+                                                      &instructions);
+
+    // Retarget at a fixed instruction budget using the measured instruction rate, smoothed
+    const EvmuTicks target = instructions?
+                             ticks * EVMU_EMULATOR_SLICE_INSTRUCTIONS / instructions :
+                             pSelf_->frameTicks;
+
+    pSlice->sliceTicks = (pSlice->sliceTicks + target) / 2;
+
+    if(pSlice->sliceTicks < minTicks)           pSlice->sliceTicks = minTicks;
+    if(pSlice->sliceTicks > pSelf_->frameTicks) pSlice->sliceTicks = pSelf_->frameTicks;
+
+    pSlice->remaining = GBL_RESULT_ERROR(result)? 0 : pSlice->remaining - ticks;
+
+    if(pSlice->remaining)
+        EvmuEmulator_dequePush_(&pWorker->deque, d);
+    else
+        atomic_fetch_sub_explicit(&pSelf_->activeDevices, 1, memory_order_release);
+}
+
+static void EvmuEmulator_runStealing_(EvmuEmulator_* pSelf_, EvmuEmulatorWorker_* pWorker) {
+    while(atomic_load_explicit(&pSelf_->activeDevices, memory_order_acquire)) {
+        size_t d;
+
+        if(EvmuEmulator_dequeTake_(&pWorker->deque, &d) ||
+           EvmuEmulator_stealTask_(pSelf_, pWorker, &d))
+            EvmuEmulator_runSlice_(pSelf_, pWorker, d);
+        else
+            thrd_yield();
+    }
+}
+
+static void EvmuEmulator_runFrame_(EvmuEmulator_* pSelf_, EvmuEmulatorWorker_* pWorker) {
+    pWorker->result = GBL_RESULT_SUCCESS;
+
+    if(pSelf_->schedule == EVMU_EMULATOR_SCHEDULE_WORK_STEALING)
+        EvmuEmulator_runStealing_(pSelf_, pWorker);
+    else
+        EvmuEmulator_runPartition_(pSelf_, pWorker);
+}
+
+// Deals every device's frame out across the deques before the workers are released
+static void EvmuEmulator_queueFrame_(EvmuEmulator_* pSelf_) {
+    for(size_t w = 0; w < pSelf_->workerCount; ++w)
+        EvmuEmulator_dequeReset_(&pSelf_->pWorkers[w].deque);
+
+    for(size_t d = 0; d < pSelf_->deviceCount; ++d) {
+        pSelf_->pSlices[d].remaining = pSelf_->frameTicks;
+        EvmuEmulator_dequePush_(&pSelf_->pWorkers[d % pSelf_->workerCount].deque, d);
+    }
+
+    atomic_store_explicit(&pSelf_->activeDevices,
+                          pSelf_->frameTicks? pSelf_->deviceCount : 0,
+                          memory_order_relaxed);
+}
+
+static int EvmuEmulator_workerMain_(void* pArg) {
+    EvmuEmulatorWorker_* pWorker = pArg;
+    EvmuEmulator_*       pSelf_  = pWorker->pEmulator;
+
+    for(;;) {
+        mtx_lock(&pSelf_->lock);
+
+        while(!pSelf_->quit && pSelf_->epoch == pWorker->epoch)
+            cnd_wait(&pSelf_->frameStart, &pSelf_->lock);
+
+        if(pSelf_->quit) {
+            mtx_unlock(&pSelf_->lock);
+            break;
+        }
+
+        pWorker->epoch = pSelf_->epoch;
+        mtx_unlock(&pSelf_->lock);
+
+        EvmuEmulator_runFrame_(pSelf_, pWorker);
+
+        mtx_lock(&pSelf_->lock);
+        if(!--pSelf_->pending)
+            cnd_signal(&pSelf_->frameDone);
+        mtx_unlock(&pSelf_->lock);
+    }
+
+    return 0;
+}
+
+static void EvmuEmulator_stopWorkers_(EvmuEmulator_* pSelf_) {
+    mtx_lock(&pSelf_->lock);
+    pSelf_->quit = GBL_TRUE;
+    cnd_broadcast(&pSelf_->frameStart);
+    mtx_unlock(&pSelf_->lock);
+
+    for(size_t w = 1; w < pSelf_->workerCount; ++w)
+        thrd_join(pSelf_->pWorkers[w].thread, NULL);
+
+    for(size_t w = 0; w < pSelf_->workerCount; ++w)
+        free(pSelf_->pWorkers[w].deque.pTasks);
+
+    free(pSelf_->pWorkers);
+
+    pSelf_->pWorkers    = NULL;
+    pSelf_->workerCount = 0;
+    pSelf_->quit        = GBL_FALSE;
+}
+
+// Returns the number of workers actually started, which is always at least the calling thread
+static size_t EvmuEmulator_startWorkers_(EvmuEmulator_* pSelf_, size_t count) {
+    if(!(pSelf_->pWorkers = calloc(count, sizeof(EvmuEmulatorWorker_))))
+        return 0;
+
+    for(size_t w = 0; w < count; ++w) {
+        EvmuEmulatorWorker_* pWorker = &pSelf_->pWorkers[w];
+
+        pWorker->pEmulator  = pSelf_;
+        pWorker->index      = w;
+        pWorker->epoch      = pSelf_->epoch;
+        pWorker->seed       = (uint32_t)(w + 1) * 2654435761u;
+        pSelf_->workerCount = w + 1;
+
+        if(w && thrd_create(&pWorker->thread, EvmuEmulator_workerMain_, pWorker) != thrd_success) {
+            pSelf_->workerCount = w;
+            break;
+        }
+    }
+
+    return pSelf_->workerCount;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_setWorkerCount(EvmuEmulator* pSelf, size_t count) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuEmulator_* pSelf_ = EVMU_EMULATOR_(pSelf);
+
+    GBL_CTX_VERIFY(count && count <= EVMU_EMULATOR_WORKERS_MAX,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Invalid worker count: [%zu/%u]",
+                   count,
+                   EVMU_EMULATOR_WORKERS_MAX);
+
+    GBL_CTX_VERIFY(EVMU_THREADS_ENABLED_ || count == 1,
+                   GBL_RESULT_UNSUPPORTED,
+                   "Device scheduler was built without thread support: [%zu workers]",
+                   count);
+
+    if(count == pSelf_->workerCount) GBL_CTX_DONE();
+
+    EvmuEmulator_stopWorkers_(pSelf_);
+
+    const size_t started = EvmuEmulator_startWorkers_(pSelf_, count);
+
+    GBL_CTX_VERIFY(started == count,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Only started %zu of %zu workers!",
+                   started,
+                   count);
+
+    EVMU_LOG_VERBOSE("Resized device scheduler: [%zu workers]", count);
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT size_t EvmuEmulator_workerCount(const EvmuEmulator* pSelf) {
+    return EVMU_EMULATOR_(pSelf)->workerCount;
+}
+
+EVMU_EXPORT void EvmuEmulator_setSchedule(EvmuEmulator* pSelf, EVMU_EMULATOR_SCHEDULE schedule) {
+    EVMU_EMULATOR_(pSelf)->schedule = schedule;
+}
+
+EVMU_EXPORT EVMU_EMULATOR_SCHEDULE EvmuEmulator_schedule(const EvmuEmulator* pSelf) {
+    return EVMU_EMULATOR_(pSelf)->schedule;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_workerStats(const EvmuEmulator*      pSelf,
+                                                 size_t                   index,
+                                                 EvmuEmulatorWorkerStats* pStats)
+{
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuEmulator_* pSelf_ = EVMU_EMULATOR_(pSelf);
+
+    GBL_CTX_VERIFY_POINTER(pStats);
+    GBL_CTX_VERIFY(index < pSelf_->workerCount,
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Invalid worker index: [%zu/%zu]",
+                   index,
+                   pSelf_->workerCount);
+
+    *pStats = pSelf_->pWorkers[index].stats;
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT float EvmuEmulator_workerUtilization(const EvmuEmulator* pSelf, size_t index) {
+    EvmuEmulatorWorkerStats stats;
+
+    if(GBL_RESULT_ERROR(EvmuEmulator_workerStats(pSelf, index, &stats)) || !stats.totalNsecs)
+        return 0.0f;
+
+    return (float)((double)stats.busyNsecs / (double)stats.totalNsecs);
+}
+
+EVMU_EXPORT void EvmuEmulator_resetWorkerStats(EvmuEmulator* pSelf) {
+    EvmuEmulator_* pSelf_ = EVMU_EMULATOR_(pSelf);
+
+    for(size_t w = 0; w < pSelf_->workerCount; ++w)
+        memset(&pSelf_->pWorkers[w].stats, 0, sizeof(EvmuEmulatorWorkerStats));
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_runDevices(EvmuEmulator* pSelf,
+                                                EvmuTicks     frameTicks,
+                                                size_t        frames)
+{
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuEmulator_* pSelf_ = EVMU_EMULATOR_(pSelf);
+
+    GBL_CTX_VERIFY(pSelf_->workerCount,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "Device scheduler has no workers!");
+
+    GBL_CTX_VERIFY_CALL(EvmuEmulator_snapshotDevices_(pSelf));
+
+    pSelf_->frameTicks = frameTicks;
+
+    for(size_t f = 0; f < frames; ++f) {
+        const GblBool  parallel = pSelf_->workerCount > 1;
+        const uint64_t start    = EvmuEmulator_nsecs_();
+
+        if(pSelf_->schedule == EVMU_EMULATOR_SCHEDULE_WORK_STEALING)
+            EvmuEmulator_queueFrame_(pSelf_);
+
+        // Release the pool for the next frame epoch
+        if(parallel) {
+            mtx_lock(&pSelf_->lock);
+            pSelf_->pending = pSelf_->workerCount - 1;
+            ++pSelf_->epoch;
+            cnd_broadcast(&pSelf_->frameStart);
+            mtx_unlock(&pSelf_->lock);
+        }
+
+        EvmuEmulator_runFrame_(pSelf_, &pSelf_->pWorkers[0]);
+
+        // Frame barrier
+        if(parallel) {
+            mtx_lock(&pSelf_->lock);
+            while(pSelf_->pending)
+                cnd_wait(&pSelf_->frameDone, &pSelf_->lock);
+            mtx_unlock(&pSelf_->lock);
+        }
+
+        const uint64_t elapsed = EvmuEmulator_nsecs_() - start;
+
+        for(size_t w = 0; w < pSelf_->workerCount; ++w)
+            pSelf_->pWorkers[w].stats.totalNsecs += elapsed;
+
+        for(size_t w = 0; w < pSelf_->workerCount; ++w)
+            GBL_CTX_VERIFY_CALL(pSelf_->pWorkers[w].result);
+    }
+
+    GBL_CTX_END();
+}
+
+// Multiply-xorshift step of the lockstep hash
+GBL_INLINE uint64_t EvmuEmulator_mix_(uint64_t hash) {
+    hash *= 0x9e3779b97f4a7c15ull;
+    return hash ^ (hash >> 32);
+}
+
+// Fast non-cryptographic hash, consuming a word at a time
+static uint64_t EvmuEmulator_hash_(uint64_t hash, const void* pData, size_t bytes) {
+    const uint8_t* pBytes = pData;
+    uint64_t       word;
+
+    for(; bytes >= sizeof(word); bytes -= sizeof(word), pBytes += sizeof(word)) {
+        memcpy(&word, pBytes, sizeof(word));
+        hash = EvmuEmulator_mix_(hash ^ word);
+    }
+
+    while(bytes--)
+        hash = EvmuEmulator_mix_(hash ^ *pBytes++);
+
+    return hash;
+}
+
+// Program counter, with bit 16 set when executing from flash
+static uint32_t EvmuEmulator_lanePc_(const EvmuEmulatorLane_* pLane) {
+    const EvmuDevice_* pDevice_ = EVMU_DEVICE_(pLane->pDevice);
+    const EvmuRam_*    pRam_    = pDevice_->pRam;
+
+    return pDevice_->pCpu->pc | (pRam_->pExt == pRam_->pFlash->pStorage->pData) << 16;
+}
+
+// Rehashes only the flash blocks written since the last time
+static void EvmuEmulator_laneFlash_(EvmuEmulatorLane_* pLane) {
+    EvmuFlash_*    pFlash_ = EVMU_DEVICE_(pLane->pDevice)->pFlash;
+    const uint8_t* pData   = pFlash_->pStorage->pData;
+
+    for(size_t b = 0; b < EVMU_EMULATOR__LOCKSTEP_BLOCKS_; ++b) {
+        if(!(pFlash_->unhashed[b / 64] >> (b % 64) & 1))
+            continue;
+
+        const uint64_t hash = EvmuEmulator_hash_(b + 1,
+                                                 &pData[b * EVMU_EMULATOR__LOCKSTEP_BLOCK_],
+                                                 EVMU_EMULATOR__LOCKSTEP_BLOCK_);
+
+        pLane->flashHash      ^= pLane->blockHashes[b] ^ hash;
+        pLane->blockHashes[b]  = hash;
+    }
+
+    memset(pFlash_->unhashed, 0, sizeof(pFlash_->unhashed));
+}
+
+// Cheap enough to compare after every step, since flash is rehashed incrementally
+static uint64_t EvmuEmulator_laneHash_(EvmuEmulatorLane_* pLane) {
+    EvmuEmulator_laneFlash_(pLane);
+
+    return EvmuEmulator_mix_(EvmuEmulator_lanePc_(pLane) ^ pLane->flashHash);
+}
+
+// Everything else is written all over by the CPU and peripherals alike, so it's only hashed at sync points
+static uint64_t EvmuEmulator_laneMemoryHash_(const EvmuEmulatorLane_* pLane) {
+    const EvmuRam_*     pRam_ = EVMU_DEVICE_(pLane->pDevice)->pRam;
+    const EvmuStorage_* pWram = EVMU_DEVICE_(pLane->pDevice)->pWram->pStorage;
+    uint64_t            hash  = 0;
+
+    hash = EvmuEmulator_hash_(hash, pRam_->ram,   sizeof(pRam_->ram));
+    hash = EvmuEmulator_hash_(hash, pRam_->sfr,   sizeof(pRam_->sfr));
+    hash = EvmuEmulator_hash_(hash, pRam_->xram,  sizeof(pRam_->xram));
+    hash = EvmuEmulator_hash_(hash, pWram->pData, pWram->size);
+
+    return hash;
+}
+
+// Records the first byte differing between two copies of a region, returning whether there was one
+static GblBool EvmuEmulator_diffRegion_(EvmuEmulatorLockstep* pLockstep,
+                                        EVMU_EMULATOR_REGION  region,
+                                        EvmuAddress           base,
+                                        size_t                bankSize,
+                                        const EvmuWord*       pExpected,
+                                        const EvmuWord*       pActual,
+                                        size_t                begin,
+                                        size_t                end)
+{
+    for(size_t b = begin; b < end; ++b) {
+        if(pExpected[b] != pActual[b]) {
+            pLockstep->region   = region;
+            pLockstep->bank     = b / bankSize;
+            pLockstep->address  = base + b % bankSize;
+            pLockstep->expected = pExpected[b];
+            pLockstep->actual   = pActual[b];
+            return GBL_TRUE;
+        }
+    }
+
+    return GBL_FALSE;
+}
+
+// Locates the first difference between a diverging lane and the reference lane
+static void EvmuEmulator_diffLanes_(EvmuEmulatorLockstep*    pLockstep,
+                                    const EvmuEmulatorLane_* pReference,
+                                    const EvmuEmulatorLane_* pLane)
+{
+    const EvmuRam_* pExpected = EVMU_DEVICE_(pReference->pDevice)->pRam;
+    const EvmuRam_* pActual   = EVMU_DEVICE_(pLane->pDevice)->pRam;
+
+    pLockstep->region   = EVMU_EMULATOR_REGION_CPU;
+    pLockstep->bank     = 0;
+    pLockstep->address  = 0;
+    pLockstep->expected = EvmuEmulator_lanePc_(pReference);
+    pLockstep->actual   = EvmuEmulator_lanePc_(pLane);
+
+    if(pLockstep->expected != pLockstep->actual)
+        return;
+
+    if(EvmuEmulator_diffRegion_(pLockstep,
+                                EVMU_EMULATOR_REGION_RAM,
+                                EVMU_ADDRESS_SEGMENT_RAM_BASE,
+                                EVMU_ADDRESS_SEGMENT_RAM_SIZE,
+                                &pExpected->ram[0][0],
+                                &pActual->ram[0][0],
+                                0,
+                                sizeof(pExpected->ram))                         ||
+       EvmuEmulator_diffRegion_(pLockstep,
+                                EVMU_EMULATOR_REGION_SFR,
+                                EVMU_ADDRESS_SEGMENT_SFR_BASE,
+                                EVMU_ADDRESS_SEGMENT_SFR_SIZE,
+                                pExpected->sfr,
+                                pActual->sfr,
+                                0,
+                                sizeof(pExpected->sfr))                         ||
+       EvmuEmulator_diffRegion_(pLockstep,
+                                EVMU_EMULATOR_REGION_XRAM,
+                                EVMU_ADDRESS_SEGMENT_XRAM_BASE,
+                                EVMU_ADDRESS_SEGMENT_XRAM_SIZE,
+                                &pExpected->xram[0][0],
+                                &pActual->xram[0][0],
+                                0,
+                                sizeof(pExpected->xram))                        ||
+       EvmuEmulator_diffRegion_(pLockstep,
+                                EVMU_EMULATOR_REGION_WRAM,
+                                0,
+                                EVMU_WRAM_BANK_SIZE,
+                                EVMU_DEVICE_(pReference->pDevice)->pWram->pStorage->pData,
+                                EVMU_DEVICE_(pLane->pDevice)->pWram->pStorage->pData,
+                                0,
+                                EVMU_WRAM_SIZE))
+        return;
+
+    // Only walk the flash blocks whose hashes differ
+    for(size_t b = 0; b < EVMU_EMULATOR__LOCKSTEP_BLOCKS_; ++b) {
+        const size_t offset = b * EVMU_EMULATOR__LOCKSTEP_BLOCK_;
+
+        if(pReference->blockHashes[b] != pLane->blockHashes[b] &&
+           EvmuEmulator_diffRegion_(pLockstep,
+                                    EVMU_EMULATOR_REGION_FLASH,
+                                    0,
+                                    EVMU_FLASH_BANK_SIZE,
+                                    pExpected->pFlash->pStorage->pData,
+                                    pActual->pFlash->pStorage->pData,
+                                    offset,
+                                    offset + EVMU_EMULATOR__LOCKSTEP_BLOCK_))
+            return;
+    }
+
+    pLockstep->region   = EVMU_EMULATOR_REGION_NONE;
+    pLockstep->expected = 0;
+    pLockstep->actual   = 0;
+}
+
+// Rebuilds the lanes whenever the set of devices has changed since lockstep began
+static EVMU_RESULT EvmuEmulator_syncLanes_(EvmuEmulator* pSelf) {
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuEmulator_* pSelf_ = EVMU_EMULATOR_(pSelf);
+    size_t         count  = 0;
+    GblBool        stale  = GBL_FALSE;
+
+    EVMU_EMULATOR_FOREACH_DEVICE_(pSelf, pDevice) {
+        stale |= count >= pSelf_->laneCount || pSelf_->pLanes[count].pDevice != pDevice;
+        ++count;
+    }
+
+    if(stale || count != pSelf_->laneCount) {
+        // Lockstep refuses to run with fewer than two lanes, but keeps at least one allocated
+        EvmuEmulatorLane_* pLanes = realloc(pSelf_->pLanes,
+                                            sizeof(EvmuEmulatorLane_) * (count? count : 1));
+
+        GBL_CTX_VERIFY(pLanes,
+                       GBL_RESULT_ERROR_INTERNAL,
+                       "Failed to allocate lockstep lanes: [%zu devices]",
+                       count);
+
+        pSelf_->pLanes    = pLanes;
+        pSelf_->laneCount = 0;
+
+        memset(&pSelf_->lockstep, 0, sizeof(EvmuEmulatorLockstep));
+
+        // Force each lane's flash to be hashed in full on the first step
+        EVMU_EMULATOR_FOREACH_DEVICE_(pSelf, pDevice) {
+            EvmuFlash_* pFlash_ = EVMU_DEVICE_(pDevice)->pFlash;
+
+            memset(&pSelf_->pLanes[pSelf_->laneCount], 0, sizeof(EvmuEmulatorLane_));
+            pSelf_->pLanes[pSelf_->laneCount++].pDevice = pDevice;
+            memset(pFlash_->unhashed, 0xff, sizeof(pFlash_->unhashed));
+        }
+    }
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_runLockstep(EvmuEmulator*         pSelf,
+                                                 EvmuTicks             stepTicks,
+                                                 size_t                steps,
+                                                 EvmuEmulatorLockstep* pLockstep)
+{
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuEmulator_*        pSelf_ = EVMU_EMULATOR_(pSelf);
+    EvmuEmulatorLockstep* pState = &pSelf_->lockstep;
+
+    GBL_CTX_VERIFY_CALL(EvmuEmulator_syncLanes_(pSelf));
+
+    GBL_CTX_VERIFY(pSelf_->laneCount >= 2,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "Lockstep requires at least two devices: [%zu devices]",
+                   pSelf_->laneCount);
+
+    EvmuEmulatorLane_* pReference = &pSelf_->pLanes[0];
+
+    // Keep reporting the first divergence until lockstep is reset
+    for(size_t s = 0; s < steps && !pState->diverged; ++s) {
+        const EvmuTicks ticks = stepTicks? stepTicks :
+                                EvmuClock_systemTicksPerCycle(pReference->pDevice->pClock);
+
+        // Speed and fast-forward would make lanes diverge for reasons of their own
+        for(size_t d = 0; d < pSelf_->laneCount; ++d) {
+            GBL_CTX_VERIFY_CALL(EvmuDevice__advance_(pSelf_->pLanes[d].pDevice, ticks));
+        }
+
+        ++pState->steps;
+        pState->ticks += ticks;
+
+        const GblBool sync = pState->steps % pSelf_->lockstepSync == 0 || s + 1 == steps;
+        uint64_t      hash = EvmuEmulator_laneHash_(pReference);
+
+        if(sync) hash = EvmuEmulator_mix_(hash ^ EvmuEmulator_laneMemoryHash_(pReference));
+
+        pState->hash = EvmuEmulator_mix_(pState->hash ^ hash);
+
+        for(size_t d = 1; d < pSelf_->laneCount; ++d) {
+            uint64_t laneHash = EvmuEmulator_laneHash_(&pSelf_->pLanes[d]);
+
+            if(sync) laneHash = EvmuEmulator_mix_(laneHash ^ EvmuEmulator_laneMemoryHash_(&pSelf_->pLanes[d]));
+
+            if(laneHash != hash) {
+                pState->diverged = GBL_TRUE;
+                pState->device   = d;
+                EvmuEmulator_diffLanes_(pState, pReference, &pSelf_->pLanes[d]);
+                break;
+            }
+        }
+    }
+
+    GBL_CTX_END_BLOCK();
+
+    if(pLockstep)
+        *pLockstep = pSelf_->lockstep;
+
+    return GBL_CTX_RESULT();
+}
+
+EVMU_EXPORT void EvmuEmulator_resetLockstep(EvmuEmulator* pSelf) {
+    EvmuEmulator_* pSelf_ = EVMU_EMULATOR_(pSelf);
+
+    free(pSelf_->pLanes);
+    pSelf_->pLanes    = NULL;
+    pSelf_->laneCount = 0;
+    memset(&pSelf_->lockstep, 0, sizeof(EvmuEmulatorLockstep));
+}
+
+EVMU_EXPORT void EvmuEmulator_setLockstepSync(EvmuEmulator* pSelf, size_t steps) {
+    EVMU_EMULATOR_(pSelf)->lockstepSync = steps? steps : EVMU_EMULATOR_LOCKSTEP_SYNC;
+}
+
+EVMU_EXPORT size_t EvmuEmulator_lockstepSync(const EvmuEmulator* pSelf) {
+    return EVMU_EMULATOR_(pSelf)->lockstepSync;
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_linkDevices(EvmuEmulator* pSelf,
+                                                 EvmuDevice*   pDevice1,
+                                                 EvmuDevice*   pDevice2,
+                                                 EvmuTicks     quantum)
+{
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_POINTER(pDevice1);
+    GBL_CTX_VERIFY_POINTER(pDevice2);
+    GBL_CTX_VERIFY_ARG(pDevice1 != pDevice2);
+
+    EvmuEmulator_* pSelf_ = EVMU_EMULATOR_(pSelf);
+
+    GBL_CTX_VERIFY(GblObject_parent(GBL_OBJECT(pDevice1)) == GBL_OBJECT(pSelf) &&
+                   GblObject_parent(GBL_OBJECT(pDevice2)) == GBL_OBJECT(pSelf),
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "EvmuEmulator_linkDevices(): attempt to link unmanaged device!");
+
+    GBL_CTX_VERIFY(!EvmuEmulator_findLink_(pSelf_, pDevice1) &&
+                   !EvmuEmulator_findLink_(pSelf_, pDevice2),
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "EvmuEmulator_linkDevices(): attempt to link device which is already linked!");
+
+    EvmuEmulatorLink_** ppLinks = realloc(pSelf_->ppLinks,
+                                          sizeof(EvmuEmulatorLink_*) * (pSelf_->linkCount + 1));
+
+    GBL_CTX_VERIFY(ppLinks,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate link registry: [%zu links]",
+                   pSelf_->linkCount + 1);
+
+    pSelf_->ppLinks = ppLinks;
+
+    // Queues are cache-line aligned to keep each end's index from being falsely shared
+    EvmuEmulatorLink_* pLink = EvmuAlloc__aligned_(alignof(EvmuEmulatorLink_), sizeof(EvmuEmulatorLink_));
+
+    GBL_CTX_VERIFY(pLink,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate link!");
+
+    memset(pLink, 0, sizeof(EvmuEmulatorLink_));
+
+    pLink->pDevices[0] = pDevice1;
+    pLink->pDevices[1] = pDevice2;
+    pLink->quantum     = quantum? quantum : EVMU_EMULATOR_LINK_QUANTUM;
+
+    atomic_init(&pLink->active,   GBL_FALSE);
+    atomic_init(&pLink->released, 0);
+    atomic_init(&pLink->finished, 0);
+
+    if(mtx_init(&pLink->lock, mtx_plain) != thrd_success) {
+        EvmuAlloc__alignedFree_(pLink);
+        GBL_CTX_VERIFY(GBL_FALSE, GBL_RESULT_ERROR_INTERNAL, "Failed to initialize link lock!");
+    }
+
+    if(cnd_init(&pLink->wake) != thrd_success) {
+        mtx_destroy(&pLink->lock);
+        EvmuAlloc__alignedFree_(pLink);
+        GBL_CTX_VERIFY(GBL_FALSE, GBL_RESULT_ERROR_INTERNAL, "Failed to initialize link condition!");
+    }
+
+    if(EVMU_THREADS_ENABLED_ &&
+       thrd_create(&pLink->thread, EvmuEmulator_linkMain_, pLink) != thrd_success) {
+        cnd_destroy(&pLink->wake);
+        mtx_destroy(&pLink->lock);
+        EvmuAlloc__alignedFree_(pLink);
+        GBL_CTX_VERIFY(GBL_FALSE, GBL_RESULT_ERROR_INTERNAL, "Failed to start link thread!");
+    }
+
+    // Bytes take one quantum to arrive, so neither device can observe a byte before it's sent
+    EvmuSio__link_(EVMU_DEVICE_(pDevice1)->pSio,
+                   EVMU_DEVICE_(pDevice2)->pSio,
+                   pLink->queues,
+                   pLink->quantum);
+
+    pSelf_->ppLinks[pSelf_->linkCount++] = pLink;
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_unlinkDevice(EvmuEmulator* pSelf, EvmuDevice* pDevice) {
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_POINTER(pDevice);
+
+    EvmuEmulator_*     pSelf_ = EVMU_EMULATOR_(pSelf);
+    EvmuEmulatorLink_* pLink  = EvmuEmulator_findLink_(pSelf_, pDevice);
+
+    GBL_CTX_VERIFY(pLink,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "EvmuEmulator_unlinkDevice(): attempt to unlink device which isn't linked!");
+
+    for(size_t l = 0; l < pSelf_->linkCount; ++l) {
+        if(pSelf_->ppLinks[l] == pLink) {
+            pSelf_->ppLinks[l] = pSelf_->ppLinks[--pSelf_->linkCount];
+            break;
+        }
+    }
+
+    EvmuEmulator_destroyLink_(pLink);
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EvmuDevice* EvmuEmulator_linkedDevice(const EvmuEmulator* pSelf, const EvmuDevice* pDevice) {
+    EvmuEmulatorLink_* pLink = EvmuEmulator_findLink_(EVMU_EMULATOR_(pSelf), pDevice);
+
+    if(!pLink) return NULL;
+
+    return pLink->pDevices[pLink->pDevices[0] == pDevice];
+}
+
+// The BIOS idles in HALT between base timer interrupts once it's reached its main loop
+static GblBool EvmuEmulator_bootIdle_(const EvmuDevice* pDevice) {
+    return EvmuRom_biosActive(pDevice->pRom) &&
+           (EVMU_DEVICE_(pDevice)->pRam->sfr[EVMU_SFR_OFFSET(EVMU_ADDRESS_SFR_PCON)] & EVMU_SFR_PCON_HALT_MASK);
+}
+
+static EvmuEmulatorBoot_* EvmuEmulator_findBoot_(const EvmuEmulator_* pSelf_, GblHash biosCrc, GblHash cardCrc) {
+    for(size_t b = 0; b < pSelf_->bootCount; ++b)
+        if(pSelf_->pBoots[b].biosCrc == biosCrc && pSelf_->pBoots[b].cardCrc == cardCrc)
+            return &pSelf_->pBoots[b];
+
+    return NULL;
+}
+
+/* Runs a device from reset until its BIOS reaches the main loop, then caches
+ * its state, minus ROM, flash, and WRAM contents, so that loading it leaves
+ * another device's card in place. A BIOS which wrote to the card along the way
+ * left state that wouldn't hold for any other, so that boot isn't cached. */
+static EVMU_RESULT EvmuEmulator_boot_(EvmuEmulator_* pSelf_, EvmuDevice* pDevice, GblHash cardCrc) {
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuEmulatorBoot_ boot = {
+        .biosCrc = EvmuRom_biosCrc(pDevice->pRom),
+        .cardCrc = cardCrc
+    };
+
+    // Known images can jump straight past the date/time setup
+    if(EvmuRom_biosType(pDevice->pRom) != EVMU_BIOS_TYPE_UNKNOWN_IMAGE)
+        GBL_CTX_VERIFY_CALL(EvmuRom_skipBiosSetup(pDevice->pRom, GBL_TRUE));
+
+    GBL_CTX_VERIFY_CALL(EvmuDevice_finishInit(pDevice));
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior_reset(EVMU_IBEHAVIOR(pDevice)));
+
+    const uint64_t generation = EVMU_FLASH_(pDevice->pFlash)->generation;
+
+    for(EvmuTicks t = 0; !EvmuEmulator_bootIdle_(pDevice); t += EVMU_EMULATOR__BOOT_SLICE_) {
+        GBL_CTX_VERIFY(t < EVMU_EMULATOR__BOOT_TICKS_MAX_,
+                       GBL_RESULT_ERROR_INVALID_OPERATION,
+                       "BIOS never reached its main loop: [CRC 0x%X]",
+                       boot.biosCrc);
+
+        GBL_CTX_VERIFY_CALL(EvmuDevice__advance_(pDevice, EVMU_EMULATOR__BOOT_SLICE_));
+    }
+
+    if(EVMU_FLASH_(pDevice->pFlash)->generation != generation)
+        GBL_CTX_DONE();
+
+    EvmuEmulatorBoot_* pBoots = realloc(pSelf_->pBoots, sizeof(EvmuEmulatorBoot_) * (pSelf_->bootCount + 1));
+
+    GBL_CTX_VERIFY(pBoots,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate boot cache: [%zu entries]",
+                   pSelf_->bootCount + 1);
+
+    pSelf_->pBoots = pBoots;
+
+    EvmuIBehavior__saveExternal_(EVMU_IBEHAVIOR(pDevice), NULL, 0, &boot.stateSize);
+
+    boot.pState = malloc(boot.stateSize);
+
+    GBL_CTX_VERIFY(boot.pState,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate boot state: [%zu bytes]",
+                   boot.stateSize);
+
+    const EVMU_RESULT result = EvmuIBehavior__saveExternal_(EVMU_IBEHAVIOR(pDevice),
+                                                            boot.pState,
+                                                            boot.stateSize,
+                                                            NULL);
+
+    if(!GBL_RESULT_SUCCESS(result))
+        free(boot.pState);
+
+    GBL_CTX_VERIFY_CALL(result);
+
+    pSelf_->pBoots[pSelf_->bootCount++] = boot;
+
+    GBL_CTX_END();
+}
+
+EVMU_EXPORT EVMU_RESULT EvmuEmulator_bootDevice(EvmuEmulator* pSelf, EvmuDevice* pDevice) {
+    EvmuRom_* pRom_     = NULL;
+    GblBool   setupSkip = GBL_FALSE;
+
+    GBL_CTX_BEGIN(pSelf);
+    GBL_CTX_VERIFY_POINTER(pDevice);
+
+    // Booting turns on the setup skip, which is saved along with a cached boot, so put the caller's back after
+    pRom_     = EVMU_ROM_(pDevice->pRom);
+    setupSkip = pRom_->bSetupSkipEnabled;
+
+    GBL_CTX_VERIFY(EvmuRom_biosType(pDevice->pRom) != EVMU_BIOS_TYPE_EMULATED,
+                   GBL_RESULT_ERROR_INVALID_OPERATION,
+                   "Cannot boot a device without a BIOS image loaded!");
+
+    // Formatting may be pending, and the card must be as the BIOS will find it
+    GBL_CTX_VERIFY_CALL(EvmuDevice_finishInit(pDevice));
+
+    EvmuEmulator_*           pSelf_  = EVMU_EMULATOR_(pSelf);
+    const EvmuStorage_*      pCard   = EVMU_FLASH_(pDevice->pFlash)->pStorage;
+    const GblHash            cardCrc = gblHashCrc(pCard->pData, pCard->size);
+    const EvmuEmulatorBoot_* pBoot   = EvmuEmulator_findBoot_(pSelf_, EvmuRom_biosCrc(pDevice->pRom), cardCrc);
+
+    // What the BIOS does on startup can depend on what's on the card, so boots are only shared between identical ones
+    if(!pBoot) {
+        GBL_CTX_VERIFY_CALL(EvmuEmulator_boot_(pSelf_, pDevice, cardCrc));
+    } else {
+        GblDateTime dateTime;
+
+        GBL_CTX_VERIFY_CALL(EvmuIBehavior__loadTrusted_(EVMU_IBEHAVIOR(pDevice), pBoot->pState, pBoot->stateSize));
+
+        // The cached clock is from whenever the BIOS was first booted
+        GBL_CTX_VERIFY_CALL(EvmuRom_setDateTime(pDevice->pRom, GblDateTime_nowLocal(&dateTime)));
+    }
+
+    GBL_CTX_END_BLOCK();
+
+    if(pRom_)
+        pRom_->bSetupSkipEnabled = setupSkip;
+
+    return GBL_CTX_RESULT();
+}
+
+EVMU_EXPORT size_t EvmuEmulator_bootCacheCount(const EvmuEmulator* pSelf) {
+    return EVMU_EMULATOR_(pSelf)->bootCount;
+}
+
+EVMU_EXPORT void EvmuEmulator_clearBootCache(EvmuEmulator* pSelf) {
+    EvmuEmulator_* pSelf_ = EVMU_EMULATOR_(pSelf);
+
+    for(size_t b = 0; b < pSelf_->bootCount; ++b)
+        free(pSelf_->pBoots[b].pState);
+
+    free(pSelf_->pBoots);
+    pSelf_->pBoots    = NULL;
+    pSelf_->bootCount = 0;
+}
+
+static GBL_RESULT EvmuEmulator_IBehavior_update_(EvmuIBehavior* pIBehavior, EvmuTicks ticks) {
+    GBL_CTX_BEGIN(NULL);
+    GBL_CTX_VERIFY_CALL(EvmuEmulator_runDevices(EVMU_EMULATOR(pIBehavior), ticks, 1));
+
+    // Devices were just run by the scheduler, but any other behaviors still get updated in turn
+    for(GblObject* pObject = GblObject_childFirst(GBL_OBJECT(pIBehavior));
+        pObject != NULL;
+        pObject = GblObject_siblingNext(pObject))
+    {
+        if(GBL_TYPECHECK(EvmuIBehavior, pObject) && !GBL_TYPECHECK(EvmuDevice, pObject))
+            GBL_CTX_VERIFY_CALL(EvmuIBehavior_update(EVMU_IBEHAVIOR(pObject), ticks));
+    }
+
+    GBL_CTX_END();
+}
 
 static GBL_RESULT EvmuEmulator_GblModule_unload_(GblModule* pModule) {
     GBL_CTX_BEGIN(NULL);
@@ -103,6 +1251,25 @@ static GBL_RESULT EvmuEmulator_GblModule_load_(GblModule* pModule) {
 
 static GBL_RESULT EvmuEmulator_GblBox_destructor_(GblBox* pBox) {
     GBL_CTX_BEGIN(NULL);
+
+    EvmuEmulator_* pSelf_ = EVMU_EMULATOR_(pBox);
+
+    EvmuEmulator_stopWorkers_(pSelf_);
+
+    for(size_t l = 0; l < pSelf_->linkCount; ++l)
+        EvmuEmulator_destroyLink_(pSelf_->ppLinks[l]);
+
+    free(pSelf_->ppLinks);
+    free(pSelf_->pLanes);
+    free(pSelf_->ppDevices);
+    free(pSelf_->pSlices);
+
+    EvmuEmulator_clearBootCache(EVMU_EMULATOR(pBox));
+
+    cnd_destroy(&pSelf_->frameDone);
+    cnd_destroy(&pSelf_->frameStart);
+    mtx_destroy(&pSelf_->lock);
+
     GBL_VCALL_DEFAULT(GblModule, base.base.base.pFnDestructor, pBox);
     GBL_CTX_END();
 }
@@ -110,22 +1277,37 @@ static GBL_RESULT EvmuEmulator_GblBox_destructor_(GblBox* pBox) {
 static GBL_RESULT EvmuEmulator_init_(GblInstance* pInstance) {
     GBL_CTX_BEGIN(NULL);
 
-    GblModule* pModule    = GBL_MODULE(pInstance);
+    GblModule*     pModule = GBL_MODULE(pInstance);
+    EvmuEmulator_* pSelf_  = EVMU_EMULATOR_(pInstance);
 
     pModule->version      = EvmuEmulator_version();
     pModule->pPrefix      = GblStringRef_create("Evmu");
     pModule->pAuthor      = GblStringRef_create("Falco Girgis");
     pModule->pDescription = GblStringRef_create("ElysianVMU Emulation Core");
 
+    GBL_CTX_VERIFY(mtx_init(&pSelf_->lock, mtx_plain) == thrd_success &&
+                   cnd_init(&pSelf_->frameStart)      == thrd_success &&
+                   cnd_init(&pSelf_->frameDone)       == thrd_success,
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to initialize device scheduler!");
+
+    pSelf_->lockstepSync = EVMU_EMULATOR_LOCKSTEP_SYNC;
+
+    // Run serially on the calling thread until a pool is requested
+    GBL_CTX_VERIFY(EvmuEmulator_startWorkers_(pSelf_, 1),
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate device scheduler!");
+
     GBL_CTX_END();
 }
 
 static GBL_RESULT EvmuEmulatorClass_init_(GblClass* pClass, const void* pUd) {
     GBL_CTX_BEGIN(NULL);
 
-    GBL_BOX_CLASS(pClass)   ->pFnDestructor = EvmuEmulator_GblBox_destructor_;
-    GBL_MODULE_CLASS(pClass)->pFnLoad       = EvmuEmulator_GblModule_load_;
-    GBL_MODULE_CLASS(pClass)->pFnUnload     = EvmuEmulator_GblModule_unload_;
+    GBL_BOX_CLASS(pClass)       ->pFnDestructor = EvmuEmulator_GblBox_destructor_;
+    GBL_MODULE_CLASS(pClass)    ->pFnLoad       = EvmuEmulator_GblModule_load_;
+    GBL_MODULE_CLASS(pClass)    ->pFnUnload     = EvmuEmulator_GblModule_unload_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnUpdate     = EvmuEmulator_IBehavior_update_;
 
     GBL_CTX_END();
 }
@@ -140,12 +1322,13 @@ EVMU_EXPORT GblType EvmuEmulator_type(void) {
     };
 
     static const GblTypeInfo info = {
-        .pFnClassInit    = EvmuEmulatorClass_init_,
-        .classSize       = sizeof(EvmuEmulatorClass),
-        .pFnInstanceInit = EvmuEmulator_init_,
-        .instanceSize    = sizeof(EvmuEmulator),
-        .interfaceCount  = 1,
-        .pInterfaceImpls   = ifaceEntries
+        .pFnClassInit        = EvmuEmulatorClass_init_,
+        .classSize           = sizeof(EvmuEmulatorClass),
+        .pFnInstanceInit     = EvmuEmulator_init_,
+        .instanceSize        = sizeof(EvmuEmulator),
+        .instancePrivateSize = sizeof(EvmuEmulator_),
+        .interfaceCount      = 1,
+        .pInterfaceImpls     = ifaceEntries
     };
 
     if(type == GBL_INVALID_TYPE) {
@@ -1,133 +1,117 @@
-#ifndef EVMU_CONTEXT__H
-#define EVMU_CONTEXT__H
-
-#include <evmu/util/evmu_context.h>
-#include <gimbal/gimbal_container.h>
-#include "../hw/evmu_device_.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-
-typedef struct EvmuContext_ {
-    struct GblContext_      gblContext;
-    GblVector               devices;
-} EvmuContext_;
-
-
-GBL_INLINE EVMU_RESULT evmuContextDeviceAdd_(struct EvmuContext_* pCtx, EvmuDevice_* pDev) {
-    EVMU_API_BEGIN(pCtx);
-    EVMU_API_VERIFY_DEVICE(pDev);
-    EVMU_API_CALL(gblVectorPushBack(&pCtx->devices, pDev));
-    EVMU_API_END();
-}
-
-GBL_INLINE EVMU_RESULT evmuContextDeviceRemove_(struct EvmuContext_* pCtx, EvmuDevice_* pDev) {
-    EvmuSize size = 0;
-    EvmuBool found = EVMU_FALSE;
-    EVMU_API_BEGIN(pCtx);
-    EVMU_API_VERIFY_DEVICE(pDev);
-    EVMU_API_CALL(gblVectorSize(&pCtx->devices, &size));
-    for(GblSize d = 0; d < size; ++d) {
-        EvmuDevice hDevice = GBL_HANDLE_INVALID;
-        EVMU_API_CALL(gblVectorAt(&pCtx->devices, d, (void**)&hDevice));
-        if(hDevice == pDev) {
-            EVMU_API_CALL(gblVectorErase(&pCtx->devices, d, 1));
-            found = EVMU_TRUE;
-            break;
-        }
-    }
-    EVMU_API_VERIFY_EXPRESSION(found, "Device %p not found!", pDev);
-    EVMU_API_END();
-}
-
-
-
-
-
-#if 0
-
-#define FOREACH_PERIPHERAL(DEVICE, INDEX, POINTER)              \
-    EvmuPeripheral_* POINTER = NULL;                            \
-    for(uint32_t INDEX = 0;                                     \
-        INDEX < peripheralCount_(DEVICE);                       \
-        POINTER = evmuDevicePeripheral_(DEVICE, INDEX++))
-
-
-GBL_API_INLINE GblSize gblVectorSize_()
-
-GBL_API_VECTOR_SIZE(gblVec) \
-
-const GblStackFrame*, pFrame
-
-#define GBL_EXT_FN_DEFINE_(prefixName, ...) \
-    GBL_API gblExt##prefixName (GBL_MAP_LIST(GBL_DECL_VAR_PAIR, __VA_ARGS__)) { \
-        GBL_ASSERT(pFrame); \
-        return gblContext##prefixName (pFrame->hContext, GBL_MAP_LIST(GBL_DECL_VAR_PAIR_NAME, __VA_ARGS__)); \
-    }
-
-
-GBL_API__CALL_DECLARE(retPair, apiFunction, ...) \
-    GBL_MAYBE_UNUSED GBL_INLINE GBL_DECL_VAR_PAIR_TYPE(retPair) apiFunction##_ (const GblStackFrame* pFrame, GBL_MAP_LIST(GBL_DECL_VAR_PAIR, __VA_ARGS__)) { \
-
-}
-
-#define GBL_API_INLINE(MethodPrefix, ReturnType, ...) \
-    GBL_INLINE ReturnType GBL_API_INLINE_##MethodPrefix##_(GBL_API_FRAME_DECLARE, SrcLoc srcLoc, ##__VA_ARGS__) { \
-        ReturnType GBL_API_INLINE_RETURN_VALUE_NAME;
-
-#define GBL_API_INLINE_BEGIN(InitialRetValue) \
-        GBL_API_INLINE_RETVAL() = InitialRetValue; \
-        GBL_API_SOURCE_LOC_PUSH(srcLoc);
-
-
-#define GBL_API_INLINE_END()                \
-        goto GBL_API_END_LABEL;             \
-        GBL_API_END_LABEL: do ; while(0);   \
-    }
-
-#define GBL_API_INLINE_RETURN() \
-    GBL_API_SOURCE_POP();  \
-    return GBL_API_INLINE_RETVAL()
-
-
-GBL_MAYBE_UNUSED GBL_API_INLINE(MALLOC, void*, GblSize size, GblSize align, const char* pDebugStr) {
-    GBL_API_INLINE_BEGIN(GBL_NULL);
-    GBL_ASSERT(size % align == 0);
-    GBL_API_EXT(MALLOC, size, align, pDebugStr, &GBL_API_INLINE_RETVAL());
-    GBL_API_INLINE_END();
-    // modify/set return value based on result
-    GBL_API_INLINE_RETURN();
-}
-
-
-
-
-GBL_VECTOR_FOREACH_KV_PAIR(it, gblVec) \
-for( struct { GblSize i; void* pData; } it = { 0, NULL}; \
-    it.k < GBL_API_INLINE_CALL(gblVectorSize(gblVec, 0)); \
-
-
-
-    EVMU_API_CALL(gblVectorAt))
-
-#define GBL_VECTOR_FOREACH(gblVec, it) \
-    for(struct { })
-
-    do {
-        GblSize size = 0;
-        for(GblSize i = 0; i < size; ++i) {
-            GBL_API_CALL(gblVectorAt((gblVec), i, (void**)(it)));
-
-        }
-
-    } while(0)
-#endif
-
-
-#ifdef __cplusplus
-}
-#endif
-
-#endif // EVMU_CONTEXT__H
+#ifndef EVMU_EMULATOR__H
+#define EVMU_EMULATOR__H
+
+#include <evmu/types/evmu_emulator.h>
+#include <evmu/hw/evmu_flash.h>
+#include "evmu_thread_.h"
+#include <stdatomic.h>
+#include "../hw/evmu_sio_.h"
+
+#define EVMU_EMULATOR_(instance)    (GBL_PRIVATE(EvmuEmulator, instance))
+#define EVMU_EMULATOR_PUBLIC_(priv) (GBL_PUBLIC(EvmuEmulator, priv))
+
+#define EVMU_EMULATOR__LOCKSTEP_BLOCK_  EVMU_FLASH_BLOCK_SIZE // flash bytes per cached lockstep hash (one per unhashed bit)
+#define EVMU_EMULATOR__LOCKSTEP_BLOCKS_ (EVMU_FLASH_SIZE / EVMU_EMULATOR__LOCKSTEP_BLOCK_)
+#define EVMU_EMULATOR__BOOT_SLICE_      1000000         // emulated time between checks for the BIOS idling (1ms)
+#define EVMU_EMULATOR__BOOT_TICKS_MAX_  30000000000ull  // boots taking longer are assumed to be stuck (30s)
+
+#define GBL_SELF_TYPE EvmuEmulator_
+
+GBL_DECLS_BEGIN
+
+GBL_FORWARD_DECLARE_STRUCT(EvmuEmulator_);
+
+// Chase-Lev work-stealing deque of device indices (owner pushes/takes at bottom, thieves steal at top)
+GBL_DECLARE_STRUCT(EvmuEmulatorDeque_) {
+    atomic_size_t* pTasks;
+    size_t         mask;
+    atomic_llong   top;
+    atomic_llong   bottom;
+};
+
+// Time slicing state of a device within the current frame
+GBL_DECLARE_STRUCT(EvmuEmulatorSlice_) {
+    EvmuTicks remaining;        // ticks left to run this frame
+    EvmuTicks sliceTicks;       // adaptive slice length
+};
+
+// Worker thread within the device scheduler's pool (index 0 is the calling thread)
+GBL_DECLARE_STRUCT(EvmuEmulatorWorker_) {
+    EvmuEmulator_*          pEmulator;
+    thrd_t                  thread;
+    size_t                  index;
+    uint64_t                epoch;      // last frame epoch this worker ran
+    GBL_RESULT              result;     // first error of the current frame
+    uint32_t                seed;       // victim selection
+    EvmuEmulatorDeque_      deque;
+    EvmuEmulatorWorkerStats stats;
+};
+
+// Device being compared in lockstep, with its incrementally maintained flash hash
+GBL_DECLARE_STRUCT(EvmuEmulatorLane_) {
+    EvmuDevice* pDevice;
+    uint64_t    flashHash;          // XOR of every block hash
+    uint64_t    blockHashes[EVMU_EMULATOR__LOCKSTEP_BLOCKS_];
+};
+
+// Pair of devices whose serial ports are connected, the second of which runs on the link's own thread
+GBL_DECLARE_STRUCT(EvmuEmulatorLink_) {
+    EvmuSioQueue_        queues[2];     // queues[i] carries bytes sent by pDevices[i]
+    EvmuDevice*          pDevices[2];
+    EvmuTicks            quantum;
+    EvmuTicks            time;          // quantum boundary both devices have reached
+    EvmuTicks            target;        // boundary of the quantum released to the thread
+    thrd_t               thread;
+    mtx_t                lock;
+    cnd_t                wake;
+    atomic_bool          active;        // a frame is running, so the thread spins rather than sleeps
+    atomic_uint_fast64_t released;      // quanta released to the thread
+    atomic_uint_fast64_t finished;      // quanta finished by the thread
+    GBL_RESULT           result;        // first error of the thread's device
+    GblBool              quit;
+};
+
+// State of a device booted into the BIOS main loop, for starting others with the same BIOS and card from
+GBL_DECLARE_STRUCT(EvmuEmulatorBoot_) {
+    GblHash biosCrc;
+    GblHash cardCrc;    // CRC of the flash contents the BIOS booted with
+    void*   pState;     // external state, leaving ROM, flash, and WRAM contents as they are
+    size_t  stateSize;
+};
+
+GBL_DECLARE_STRUCT(EvmuEmulator_) {
+    EvmuEmulatorWorker_*   pWorkers;
+    size_t                 workerCount;
+    // Device snapshot for the current run, partitioned across workers
+    EvmuDevice**           ppDevices;
+    EvmuEmulatorSlice_*    pSlices;
+    size_t                 deviceCount;
+    size_t                 deviceCapacity;
+    EvmuTicks              frameTicks;
+    EVMU_EMULATOR_SCHEDULE schedule;
+    atomic_size_t          activeDevices; // devices with slices left this frame
+    // Frame barrier: epoch releases workers, pending counts them back in
+    mtx_t                  lock;
+    cnd_t                  frameStart;
+    cnd_t                  frameDone;
+    uint64_t               epoch;
+    size_t                 pending;
+    GblBool                quit;
+    // Devices with linked serial ports
+    EvmuEmulatorLink_**    ppLinks;
+    size_t                 linkCount;
+    // Lockstep harness, with one lane per device
+    EvmuEmulatorLane_*     pLanes;
+    size_t                 laneCount;
+    size_t                 lockstepSync;  // steps between comparisons of everything but the PC and flash
+    EvmuEmulatorLockstep   lockstep;
+    // Post-boot states, one per BIOS image
+    EvmuEmulatorBoot_*     pBoots;
+    size_t                 bootCount;
+};
+
+GBL_DECLS_END
+
+#undef GBL_SELF_TYPE
+
+#endif // EVMU_EMULATOR__H
@@ -1,6 +1,9 @@
 #include <gimbal/meta/instances/gimbal_instance.h>
 #include <evmu/types/evmu_ibehavior.h>
 #include <evmu/types/evmu_emulator.h>
+#include <stdlib.h>
+#include <string.h>
+#include "evmu_ibehavior_.h"
 
 static GBL_RESULT EvmuIBehavior_reset_(EvmuIBehavior* pSelf) {
     GBL_CTX_BEGIN(NULL);
@@ -28,11 +31,40 @@ static GBL_RESULT EvmuIBehavior_update_(EvmuIBehavior* pSelf, EvmuTicks ticks) {
     GBL_CTX_END();
 }
 
+// Children are saved and loaded in order, so the device's peripherals line up between the two
+static GBL_RESULT EvmuIBehavior_saveState_(const EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    GBL_CTX_BEGIN(NULL);
+    for(GblObject* pObject = GblObject_childFirst(GBL_OBJECT(pSelf));
+        pObject != NULL;
+        pObject = GblObject_siblingNext(GBL_OBJECT(pObject)))
+    {
+        if(GBL_TYPECHECK(EvmuIBehavior, pObject)) {
+            GBL_VCALL(EvmuIBehavior, pFnSaveState, EVMU_IBEHAVIOR(pObject), pBuffer);
+        }
+    }
+    GBL_CTX_END();
+}
+
+static GBL_RESULT EvmuIBehavior_loadState_(EvmuIBehavior* pSelf, EvmuStateBuffer* pBuffer) {
+    GBL_CTX_BEGIN(NULL);
+    for(GblObject* pObject = GblObject_childFirst(GBL_OBJECT(pSelf));
+        pObject != NULL;
+        pObject = GblObject_siblingNext(GBL_OBJECT(pObject)))
+    {
+        if(GBL_TYPECHECK(EvmuIBehavior, pObject)) {
+            GBL_VCALL(EvmuIBehavior, pFnLoadState, EVMU_IBEHAVIOR(pObject), pBuffer);
+        }
+    }
+    GBL_CTX_END();
+}
+
 static GBL_RESULT EvmuIBehaviorClass_init_(GblClass* pClass, const void* pData) {
     GBL_CTX_BEGIN(NULL);
 
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnReset = EvmuIBehavior_reset_;
     EVMU_IBEHAVIOR_CLASS(pClass)->pFnUpdate = EvmuIBehavior_update_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnSaveState = EvmuIBehavior_saveState_;
+    EVMU_IBEHAVIOR_CLASS(pClass)->pFnLoadState = EvmuIBehavior_loadState_;
 
     GBL_CTX_END();
 }
@@ -105,6 +137,257 @@ GBL_EXPORT GBL_RESULT EvmuIBehavior_update(EvmuIBehavior* pSelf, EvmuTicks ticks
     GBL_CTX_END();
 }
 
+void EvmuIBehavior__field_(EvmuStateBuffer* pBuffer, void* pField, size_t size) {
+    if(GBL_RESULT_ERROR(pBuffer->result))
+        return;
+
+    if(size > pBuffer->capacity - pBuffer->offset) {
+        pBuffer->result = GBL_RESULT_ERROR_OUT_OF_RANGE;
+        return;
+    }
+
+    if(pBuffer->loading)
+        memcpy(pField, &pBuffer->pData[pBuffer->offset], size);
+    else if(pBuffer->pData)
+        memcpy(&pBuffer->pData[pBuffer->offset], pField, size);
+
+    pBuffer->offset += size;
+}
+
+void EvmuIBehavior__size_(EvmuStateBuffer* pBuffer, size_t* pValue) {
+    uint64_t value = *pValue;
+
+    EvmuIBehavior__field_(pBuffer, &value, sizeof(value));
+
+    if(pBuffer->loading)
+        *pValue = (size_t)value;
+}
+
+size_t EvmuIBehavior__beginSection_(EvmuStateBuffer* pBuffer, uint32_t tag, uint16_t version) {
+    const size_t      start   = pBuffer->offset;
+    EvmuStateSection_ section = {
+        .tag     = tag,
+        .version = version
+    };
+
+    EVMU_IBEHAVIOR__FIELD_(pBuffer, section);
+
+    if(pBuffer->loading && GBL_RESULT_SUCCESS(pBuffer->result) &&
+       (section.tag != tag || section.version != version))
+        pBuffer->result = GBL_RESULT_ERROR_INVALID_ARG;
+
+    return start;
+}
+
+EVMU_RESULT EvmuIBehavior__endSection_(EvmuStateBuffer* pBuffer, size_t start) {
+    if(GBL_RESULT_ERROR(pBuffer->result))
+        return pBuffer->result;
+
+    const uint64_t size = pBuffer->offset - start - sizeof(EvmuStateSection_);
+
+    if(pBuffer->loading) {
+        EvmuStateSection_ section;
+        memcpy(&section, &pBuffer->pData[start], sizeof(section));
+
+        if(section.size != size)
+            pBuffer->result = GBL_RESULT_ERROR_INVALID_ARG;
+
+    } else if(pBuffer->pData) {
+        memcpy(&pBuffer->pData[start + offsetof(EvmuStateSection_, size)], &size, sizeof(size));
+    }
+
+    return pBuffer->result;
+}
+
+static GBL_RESULT EvmuIBehavior_save_(const EvmuIBehavior* pSelf,
+                                      void*                pData,
+                                      size_t               capacity,
+                                      size_t*              pSize,
+                                      GblBool              delta,
+                                      GblBool              external)
+{
+    GBL_CTX_BEGIN(NULL);
+    GBL_CTX_VERIFY_POINTER(pSelf);
+
+    EvmuStateBuffer  buffer = {
+        .pData    = pData,
+        .capacity = pData? capacity : SIZE_MAX,
+        .delta    = delta,
+        .external = external,
+        .result   = GBL_RESULT_SUCCESS
+    };
+    EvmuStateHeader_ header = {
+        .magic   = EVMU_IBEHAVIOR__STATE_MAGIC_,
+        .version = EVMU_IBEHAVIOR_STATE_VERSION,
+        .endian  = EVMU_IBEHAVIOR__STATE_ENDIAN_
+    };
+
+    EVMU_IBEHAVIOR__FIELD_(&buffer, header);
+
+    if(GBL_RESULT_SUCCESS(buffer.result)) {
+        GBL_VCALL(EvmuIBehavior, pFnSaveState, (EvmuIBehavior*)pSelf, &buffer);
+    }
+
+    if(pSize) *pSize = buffer.offset;
+
+    GBL_CTX_VERIFY(GBL_RESULT_SUCCESS(buffer.result),
+                   buffer.result,
+                   "Failed to save state: [%zu of %zu bytes]",
+                   buffer.offset, capacity);
+
+    if(pData) {
+        header.size = buffer.offset - sizeof(header);
+        memcpy(pData, &header, sizeof(header));
+    }
+
+    GBL_CTX_END();
+}
+
+GBL_EXPORT size_t EvmuIBehavior_stateSize(const EvmuIBehavior* pSelf) {
+    size_t size = 0;
+
+    EvmuIBehavior_save_(pSelf, NULL, 0, &size, GBL_FALSE, GBL_FALSE);
+
+    return size;
+}
+
+GBL_EXPORT GBL_RESULT EvmuIBehavior_saveState(const EvmuIBehavior* pSelf,
+                                              void*                pData,
+                                              size_t               capacity,
+                                              size_t*              pSize)
+{
+    return EvmuIBehavior_save_(pSelf, pData, capacity, pSize, GBL_FALSE, GBL_FALSE);
+}
+
+GBL_EXPORT size_t EvmuIBehavior_deltaSize(const EvmuIBehavior* pSelf) {
+    size_t size = 0;
+
+    EvmuIBehavior_save_(pSelf, NULL, 0, &size, GBL_TRUE, GBL_FALSE);
+
+    return size;
+}
+
+GBL_EXPORT GBL_RESULT EvmuIBehavior_saveDelta(const EvmuIBehavior* pSelf,
+                                              void*                pData,
+                                              size_t               capacity,
+                                              size_t*              pSize)
+{
+    return EvmuIBehavior_save_(pSelf, pData, capacity, pSize, GBL_TRUE, GBL_FALSE);
+}
+
+GBL_RESULT EvmuIBehavior__saveExternal_(const EvmuIBehavior* pSelf,
+                                        void*                pData,
+                                        size_t               capacity,
+                                        size_t*              pSize)
+{
+    return EvmuIBehavior_save_(pSelf, pData, capacity, pSize, GBL_FALSE, GBL_TRUE);
+}
+
+// Applies a state whose header has already been verified
+static GBL_RESULT EvmuIBehavior_load_(EvmuIBehavior* pSelf, const void* pData, size_t size, GblBool restoring) {
+    GBL_CTX_BEGIN(NULL);
+
+    EvmuStateBuffer buffer = {
+        .pData     = (uint8_t*)pData,
+        .capacity  = size,
+        .offset    = sizeof(EvmuStateHeader_),
+        .loading   = GBL_TRUE,
+        .restoring = restoring,
+        .result    = GBL_RESULT_SUCCESS
+    };
+
+    GBL_VCALL(EvmuIBehavior, pFnLoadState, pSelf, &buffer);
+
+    GBL_CTX_VERIFY(GBL_RESULT_SUCCESS(buffer.result) && buffer.offset == buffer.capacity,
+                   GBL_RESULT_SUCCESS(buffer.result)? GBL_RESULT_ERROR_INVALID_ARG : buffer.result,
+                   "Failed to load state: [%zu of %zu bytes]",
+                   buffer.offset, buffer.capacity);
+
+    GBL_CTX_END();
+}
+
+// Checks that \p pData starts with a header for a state this build can load, which fits in \p size
+static GBL_RESULT EvmuIBehavior_verify_(const void* pData, size_t size, EvmuStateHeader_* pHeader) {
+    GBL_CTX_BEGIN(NULL);
+    GBL_CTX_VERIFY_POINTER(pData);
+
+    EvmuStateHeader_ header;
+    EvmuStateBuffer  buffer = {
+        .pData    = (uint8_t*)pData,
+        .capacity = size,
+        .loading  = GBL_TRUE,
+        .result   = GBL_RESULT_SUCCESS
+    };
+
+    EVMU_IBEHAVIOR__FIELD_(&buffer, header);
+
+    GBL_CTX_VERIFY(GBL_RESULT_SUCCESS(buffer.result) &&
+                   header.magic == EVMU_IBEHAVIOR__STATE_MAGIC_,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Not a save state!");
+
+    GBL_CTX_VERIFY(header.version == EVMU_IBEHAVIOR_STATE_VERSION &&
+                   header.endian  == EVMU_IBEHAVIOR__STATE_ENDIAN_,
+                   GBL_RESULT_ERROR_INVALID_ARG,
+                   "Unsupported save state: [version %u, byte order 0x%x]",
+                   header.version, header.endian);
+
+    GBL_CTX_VERIFY(header.size <= size - sizeof(header),
+                   GBL_RESULT_ERROR_OUT_OF_RANGE,
+                   "Truncated save state: [%zu of %zu bytes]",
+                   size, (size_t)(header.size + sizeof(header)));
+
+    *pHeader = header;
+
+    GBL_CTX_END();
+}
+
+GBL_EXPORT GBL_RESULT EvmuIBehavior_loadState(EvmuIBehavior* pSelf, const void* pData, size_t size) {
+    uint8_t* pSnapshot    = NULL;
+    size_t   snapshotSize = 0;
+    GblBool  applying     = GBL_FALSE;
+
+    GBL_CTX_BEGIN(NULL);
+    GBL_CTX_VERIFY_POINTER(pSelf);
+
+    EvmuStateHeader_ header;
+
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior_verify_(pData, size, &header));
+
+    // Sections are applied as they're read, so keep the current state to roll back to if one is rejected
+    snapshotSize = EvmuIBehavior_stateSize(pSelf);
+
+    GBL_CTX_VERIFY((pSnapshot = malloc(snapshotSize)),
+                   GBL_RESULT_ERROR_INTERNAL,
+                   "Failed to allocate state to roll back to: [%zu bytes]",
+                   snapshotSize);
+
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior_saveState(pSelf, pSnapshot, snapshotSize, &snapshotSize));
+
+    applying = GBL_TRUE;
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior_load_(pSelf, pData, sizeof(header) + header.size, GBL_FALSE));
+
+    GBL_CTX_END_BLOCK();
+
+    if(applying && GBL_RESULT_ERROR(GBL_CTX_RESULT()))
+        EvmuIBehavior_load_(pSelf, pSnapshot, snapshotSize, GBL_TRUE);
+
+    free(pSnapshot);
+    return GBL_CTX_RESULT();
+}
+
+GBL_RESULT EvmuIBehavior__loadTrusted_(EvmuIBehavior* pSelf, const void* pData, size_t size) {
+    GBL_CTX_BEGIN(NULL);
+    GBL_CTX_VERIFY_POINTER(pSelf);
+
+    EvmuStateHeader_ header;
+
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior_verify_(pData, size, &header));
+    GBL_CTX_VERIFY_CALL(EvmuIBehavior_load_(pSelf, pData, sizeof(header) + header.size, GBL_FALSE));
+
+    GBL_CTX_END();
+}
+
 GBL_EXPORT GblType EvmuIBehavior_type(void) {
     static GblType type = GBL_INVALID_TYPE;
 
@@ -0,0 +1,54 @@
+#ifndef EVMU_IBEHAVIOR__H
+#define EVMU_IBEHAVIOR__H
+
+#include <evmu/types/evmu_ibehavior.h>
+
+#define EVMU_IBEHAVIOR__STATE_TAG_(a, b, c, d) \
+    ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+#define EVMU_IBEHAVIOR__STATE_MAGIC_    EVMU_IBEHAVIOR__STATE_TAG_('E', 'V', 'M', 'S')
+#define EVMU_IBEHAVIOR__STATE_ENDIAN_   0x0102  // reads back byte-swapped on a host of the other byte order
+
+// Transfers a field in whichever direction the buffer is going, letting an entity
+// save and load with the same function so that the two can't disagree on layout
+#define EVMU_IBEHAVIOR__FIELD_(pBuffer, field) \
+    (EvmuIBehavior__field_((pBuffer), (void*)&(field), sizeof(field)))
+
+GBL_DECLS_BEGIN
+
+// Leads off every save state
+GBL_DECLARE_STRUCT(EvmuStateHeader_) {
+    uint32_t magic;
+    uint16_t version;   // EVMU_IBEHAVIOR_STATE_VERSION
+    uint16_t endian;    // EVMU_IBEHAVIOR__STATE_ENDIAN_ in the saving host's byte order
+    uint64_t size;      // bytes following the header
+};
+
+// Leads off the fields of each entity within a save state
+GBL_DECLARE_STRUCT(EvmuStateSection_) {
+    uint32_t tag;       // identifies the entity the fields belong to
+    uint16_t version;   // version of the entity's own fields
+    uint16_t reserved;
+    uint64_t size;      // bytes following the section header
+};
+
+// Copies \p size bytes between \p pField and the buffer, recording an error when they don't fit
+void        EvmuIBehavior__field_       (EvmuStateBuffer* pBuffer, void* pField, size_t size);
+// Transfers a size_t as 64 bits, so that it doesn't depend on the host's word size
+void        EvmuIBehavior__size_        (EvmuStateBuffer* pBuffer, size_t* pValue);
+// Transfers a section header, verifying \p tag and \p version when loading, and returns its offset
+size_t      EvmuIBehavior__beginSection_(EvmuStateBuffer* pBuffer, uint32_t tag, uint16_t version);
+// Closes the section opened at \p start, returning the result of the buffer so far
+EVMU_RESULT EvmuIBehavior__endSection_  (EvmuStateBuffer* pBuffer, size_t start);
+// Saves a whole state, minus ROM, flash, and WRAM contents, passing NULL \p pData to only measure it
+GBL_RESULT  EvmuIBehavior__saveExternal_(const EvmuIBehavior* pSelf,
+                                         void*                pData,
+                                         size_t               capacity,
+                                         size_t*              pSize);
+/* Loads a state the library saved itself, such as a rewind snapshot or cached boot, without
+ * first saving a snapshot to roll back to, which leaves the load half-applied if it's rejected */
+GBL_RESULT  EvmuIBehavior__loadTrusted_ (EvmuIBehavior* pSelf, const void* pData, size_t size);
+
+GBL_DECLS_END
+
+#endif // EVMU_IBEHAVIOR__H
@@ -0,0 +1,40 @@
+#ifndef EVMU_THREAD__H
+#define EVMU_THREAD__H
+
+/* C11 threads where the toolchain has them (see EVMU_HAVE_THREADS_H in
+ * CMakeLists.txt). Elsewhere, every primitive is a no-op and threads never
+ * start, so callers fall back to doing their work on the calling thread.
+ */
+#ifdef EVMU_HAVE_THREADS_H
+#   include <threads.h>
+#   define EVMU_THREADS_ENABLED_   1
+#else
+#   define EVMU_THREADS_ENABLED_   0
+
+typedef int thrd_t;
+typedef int mtx_t;
+typedef int cnd_t;
+typedef int (*thrd_start_t)(void*);
+
+enum { thrd_success, thrd_error };
+enum { mtx_plain };
+
+static inline int  thrd_create(thrd_t* pThread, thrd_start_t pFn, void* pArg) {
+    (void)pThread; (void)pFn; (void)pArg;
+    return thrd_error;
+}
+
+static inline int  thrd_join(thrd_t thread, int* pResult) { (void)thread; (void)pResult; return thrd_success; }
+static inline void thrd_yield(void)                       {}
+static inline int  mtx_init(mtx_t* pMtx, int type)        { (void)pMtx; (void)type; return thrd_success; }
+static inline int  mtx_lock(mtx_t* pMtx)                  { (void)pMtx; return thrd_success; }
+static inline int  mtx_unlock(mtx_t* pMtx)                { (void)pMtx; return thrd_success; }
+static inline void mtx_destroy(mtx_t* pMtx)               { (void)pMtx; }
+static inline int  cnd_init(cnd_t* pCnd)                  { (void)pCnd; return thrd_success; }
+static inline int  cnd_wait(cnd_t* pCnd, mtx_t* pMtx)     { (void)pCnd; (void)pMtx; return thrd_success; }
+static inline int  cnd_signal(cnd_t* pCnd)                { (void)pCnd; return thrd_success; }
+static inline int  cnd_broadcast(cnd_t* pCnd)             { (void)pCnd; return thrd_success; }
+static inline void cnd_destroy(cnd_t* pCnd)               { (void)pCnd; }
+#endif
+
+#endif // EVMU_THREAD__H
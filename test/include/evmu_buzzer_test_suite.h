@@ -0,0 +1,20 @@
+#ifndef EVMU_BUZZER_TEST_SUITE_H
+#define EVMU_BUZZER_TEST_SUITE_H
+
+#include <gimbal/test/gimbal_test_suite.h>
+
+#define EVMU_BUZZER_TEST_SUITE_TYPE                (GBL_TYPEID(EvmuBuzzerTestSuite))
+#define EVMU_BUZZER_TEST_SUITE(instance)           (GBL_CAST(instance, EvmuBuzzerTestSuite))
+#define EVMU_BUZZER_TEST_SUITE_CLASS(klass)        (GBL_CLASS_CAST(klass, EvmuBuzzerTestSuite))
+#define EVMU_BUZZER_TEST_SUITE_GET_CLASS(instance) (GBL_CLASSOF(instance, EvmuBuzzerTestSuite))
+
+GBL_DECLS_BEGIN
+
+GBL_CLASS_DERIVE_EMPTY   (EvmuBuzzerTestSuite, GblTestSuite)
+GBL_INSTANCE_DERIVE_EMPTY(EvmuBuzzerTestSuite, GblTestSuite)
+
+GBL_EXPORT GblType EvmuBuzzerTestSuite_type(void) GBL_NOEXCEPT;
+
+GBL_DECLS_END
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef EVMU_LCD_TEST_SUITE_H
+#define EVMU_LCD_TEST_SUITE_H
+
+#include <gimbal/test/gimbal_test_suite.h>
+
+#define EVMU_LCD_TEST_SUITE_TYPE                (GBL_TYPEID(EvmuLcdTestSuite))
+#define EVMU_LCD_TEST_SUITE(instance)           (GBL_CAST(instance, EvmuLcdTestSuite))
+#define EVMU_LCD_TEST_SUITE_CLASS(klass)        (GBL_CLASS_CAST(klass, EvmuLcdTestSuite))
+#define EVMU_LCD_TEST_SUITE_GET_CLASS(instance) (GBL_CLASSOF(instance, EvmuLcdTestSuite))
+
+GBL_DECLS_BEGIN
+
+GBL_CLASS_DERIVE_EMPTY   (EvmuLcdTestSuite, GblTestSuite)
+GBL_INSTANCE_DERIVE_EMPTY(EvmuLcdTestSuite, GblTestSuite)
+
+GBL_EXPORT GblType EvmuLcdTestSuite_type(void) GBL_NOEXCEPT;
+
+GBL_DECLS_END
+
+#endif
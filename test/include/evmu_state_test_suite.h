@@ -0,0 +1,20 @@
+#ifndef EVMU_STATE_TEST_SUITE_H
+#define EVMU_STATE_TEST_SUITE_H
+
+#include <gimbal/test/gimbal_test_suite.h>
+
+#define EVMU_STATE_TEST_SUITE_TYPE                (GBL_TYPEID(EvmuStateTestSuite))
+#define EVMU_STATE_TEST_SUITE(instance)           (GBL_CAST(instance, EvmuStateTestSuite))
+#define EVMU_STATE_TEST_SUITE_CLASS(klass)        (GBL_CLASS_CAST(klass, EvmuStateTestSuite))
+#define EVMU_STATE_TEST_SUITE_GET_CLASS(instance) (GBL_CLASSOF(instance, EvmuStateTestSuite))
+
+GBL_DECLS_BEGIN
+
+GBL_CLASS_DERIVE_EMPTY   (EvmuStateTestSuite, GblTestSuite)
+GBL_INSTANCE_DERIVE_EMPTY(EvmuStateTestSuite, GblTestSuite)
+
+GBL_EXPORT GblType EvmuStateTestSuite_type(void) GBL_NOEXCEPT;
+
+GBL_DECLS_END
+
+#endif
@@ -0,0 +1,145 @@
+#include "evmu_batch_test_suite.h"
+#include <gimbal/test/gimbal_test_macros.h>
+#include <evmu/hw/evmu_device.h>
+#include <evmu/hw/evmu_batch.h>
+#include <evmu/hw/evmu_flash.h>
+#include <evmu/hw/evmu_sfr.h>
+#include <evmu/hw/evmu_address_space.h>
+
+#define EVMU_BATCH_TEST_SUITE_(instance)  (GBL_PRIVATE(EvmuBatchTestSuite, instance))
+
+#define EVMU_BATCH_TEST_LANES_          8
+#define EVMU_BATCH_TEST_INSTRUCTIONS_   200
+
+#define GBL_SELF_TYPE EvmuBatchTestSuite
+
+GBL_TEST_FIXTURE {
+    EvmuDevice* pBatched[EVMU_BATCH_TEST_LANES_];
+    EvmuDevice* pScalar[EVMU_BATCH_TEST_LANES_];
+};
+
+/* Mixes vectorizable ALU, load/store, stack and branch operations with a
+ * store to XRAM, which falls back to EvmuCpu, branching on per-lane data so
+ * lanes spread across several PCs before each settles into the idle loop. */
+static const uint8_t EvmuBatchTestSuite_program_[] = {
+    /* 00 */ 0x81, 0x05,        // ADDI #5
+    /* 02 */ 0x82, 0x10,        // ADD  0x10
+    /* 04 */ 0x12, 0x12,        // ST   0x12
+    /* 06 */ 0x13, 0x80,        // ST   0x180
+    /* 08 */ 0xe0,              // ROL
+    /* 09 */ 0xf2, 0x12,        // XOR  0x12
+    /* 0b */ 0xc2, 0x13,        // XCH  0x13
+    /* 0d */ 0x62, 0x10,        // INC  0x10
+    /* 0f */ 0x60, 0x10,        // PUSH 0x10
+    /* 11 */ 0x30,              // MUL
+    /* 12 */ 0x70, 0x14,        // POP  0x14
+    /* 14 */ 0x90, 0x02,        // BNZ  0x18
+    /* 16 */ 0xa1, 0x03,        // SUBI #3
+    /* 18 */ 0x78, 0x00, 0x02,  // BP   ACC, 0, 0x1d
+    /* 1b */ 0xd1, 0x40,        // ORI  #0x40
+    /* 1d */ 0x52, 0x11, 0xe0,  // DBNZ 0x11, 0x00
+    /* 20 */ 0x01, 0xfe         // BR   0x20
+};
+
+// Loads the program and seeds registers and RAM differently for each lane
+static GBL_RESULT EvmuBatchTestSuite_setup_(GblTestSuite* pSelf, EvmuDevice* pDevice, size_t lane) {
+    GBL_CTX_BEGIN(pSelf);
+
+    size_t bytes = sizeof(EvmuBatchTestSuite_program_);
+
+    GBL_TEST_CALL(EvmuFlash_writeBytes(pDevice->pFlash, 0, EvmuBatchTestSuite_program_, &bytes));
+    GBL_TEST_COMPARE(bytes, sizeof(EvmuBatchTestSuite_program_));
+
+    GBL_TEST_CALL(EvmuRam_setProgramSrc(pDevice->pRam, EVMU_PROGRAM_SRC_FLASH_BANK_0));
+    GBL_TEST_CALL(EvmuRam_writeData(pDevice->pRam, EVMU_ADDRESS_SFR_ACC, lane * 37));
+    GBL_TEST_CALL(EvmuRam_writeData(pDevice->pRam, EVMU_ADDRESS_SFR_B,   lane + 2));
+    GBL_TEST_CALL(EvmuRam_writeData(pDevice->pRam, EVMU_ADDRESS_SFR_C,   lane * 11));
+    GBL_TEST_CALL(EvmuRam_writeData(pDevice->pRam, 0x10, lane));
+    GBL_TEST_CALL(EvmuRam_writeData(pDevice->pRam, 0x11, lane + 3));
+    EvmuCpu_setPc(pDevice->pCpu, 0);
+
+    GBL_CTX_END();
+}
+
+GBL_TEST_INIT() {
+    for(size_t l = 0; l < EVMU_BATCH_TEST_LANES_; ++l) {
+        pFixture->pBatched[l] = GBL_OBJECT_NEW(EvmuDevice);
+        pFixture->pScalar[l]  = GBL_OBJECT_NEW(EvmuDevice);
+    }
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_FINAL() {
+    for(size_t l = 0; l < EVMU_BATCH_TEST_LANES_; ++l) {
+        GBL_UNREF(pFixture->pBatched[l]);
+        GBL_UNREF(pFixture->pScalar[l]);
+    }
+
+    GBL_TEST_CASE_END;
+}
+
+// Runs the program batched on one set of devices and one instruction at a time on the other, then compares them
+static GBL_RESULT EvmuBatchTestSuite_compare_(GblTestSuite* pSelf, GblBool validating) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuBatchTestSuite_* pFixture = EVMU_BATCH_TEST_SUITE_(pSelf);
+    EvmuBatch*           pBatch   = NULL;
+    EvmuBatchStats       stats;
+
+    for(size_t l = 0; l < EVMU_BATCH_TEST_LANES_; ++l) {
+        GBL_TEST_CALL(EvmuBatchTestSuite_setup_(pSelf, pFixture->pBatched[l], l));
+        GBL_TEST_CALL(EvmuBatchTestSuite_setup_(pSelf, pFixture->pScalar[l], l));
+    }
+
+    pBatch = EvmuBatch_create(pFixture->pBatched, EVMU_BATCH_TEST_LANES_);
+    GBL_TEST_VERIFY(pBatch);
+
+    EvmuBatch_setValidating(pBatch, validating);
+    GBL_TEST_COMPARE(EvmuBatch_validating(pBatch), validating);
+
+    GBL_TEST_CALL(EvmuBatch_run(pBatch, EVMU_BATCH_TEST_INSTRUCTIONS_));
+
+    EvmuBatch_stats(pBatch, &stats);
+    GBL_TEST_VERIFY(stats.vectorLanes);
+    GBL_TEST_VERIFY(stats.scalarLanes);
+    GBL_TEST_COMPARE(stats.validated, validating? stats.vectorLanes : 0);
+
+    GBL_TEST_CALL(EvmuBatch_sync(pBatch));
+
+    for(size_t l = 0; l < EVMU_BATCH_TEST_LANES_; ++l)
+        for(size_t i = 0; i < EVMU_BATCH_TEST_INSTRUCTIONS_; ++i)
+            GBL_TEST_CALL(EvmuCpu_runNext(pFixture->pScalar[l]->pCpu));
+
+    for(size_t l = 0; l < EVMU_BATCH_TEST_LANES_; ++l) {
+        EvmuDevice* pBatched = pFixture->pBatched[l];
+        EvmuDevice* pScalar  = pFixture->pScalar[l];
+
+        GBL_TEST_COMPARE(EvmuBatch_pc(pBatch, l), EvmuCpu_pc(pScalar->pCpu));
+        GBL_TEST_COMPARE(EvmuCpu_pc(pBatched->pCpu), EvmuCpu_pc(pScalar->pCpu));
+
+        // RAM, the SFRs and XRAM, as seen through the current banks
+        for(EvmuAddress a = 0; a <= EVMU_ADDRESS_SEGMENT_XRAM_END; ++a)
+            GBL_TEST_COMPARE(EvmuRam_viewData(pBatched->pRam, a), EvmuRam_viewData(pScalar->pRam, a));
+    }
+
+    // Every lane has finished its loop and is spinning on the same branch
+    GBL_TEST_COMPARE(EvmuBatch_divergence(pBatch), 1);
+
+    GBL_CTX_END_BLOCK();
+    EvmuBatch_destroy(pBatch);
+    return GBL_CTX_RESULT();
+}
+
+GBL_TEST_CASE(matchesScalar) {
+    GBL_TEST_CALL(EvmuBatchTestSuite_compare_(pSelf, GBL_FALSE));
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_CASE(validatedMatchesScalar) {
+    GBL_TEST_CALL(EvmuBatchTestSuite_compare_(pSelf, GBL_TRUE));
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_REGISTER(matchesScalar,
+                  validatedMatchesScalar);
@@ -0,0 +1,208 @@
+#include "evmu_buzzer_test_suite.h"
+#include <gimbal/test/gimbal_test_macros.h>
+#include <evmu/hw/evmu_device.h>
+#include <evmu/hw/evmu_buzzer.h>
+#include <evmu/hw/evmu_clock.h>
+#include <evmu/hw/evmu_sfr.h>
+#include <evmu/hw/evmu_address_space.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define EVMU_BUZZER_TEST_SUITE_(instance)  (GBL_PRIVATE(EvmuBuzzerTestSuite, instance))
+
+#define EVMU_BUZZER_TEST_FREQUENCY_    44100
+#define EVMU_BUZZER_TEST_DURATION_     250000000ull // ns
+#define EVMU_BUZZER_TEST_SLICE_        1000000ull   // ns
+#define EVMU_BUZZER_TEST_PERIOD_       200          // cycles
+#define EVMU_BUZZER_TEST_WAV_PATH_     "evmu_buzzer_test.wav"
+
+#define GBL_SELF_TYPE EvmuBuzzerTestSuite
+
+GBL_TEST_FIXTURE {
+    EvmuDevice* pDevice;
+    EvmuBuzzer* pBuzzer;
+};
+
+GBL_TEST_INIT() {
+    pFixture->pDevice = GBL_OBJECT_NEW(EvmuDevice);
+    pFixture->pBuzzer = pFixture->pDevice->pBuzzer;
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_FINAL() {
+    GBL_UNREF(pFixture->pDevice);
+    GBL_TEST_CASE_END;
+}
+
+// Samples a sink should have produced over \p ticks of emulated time
+static size_t EvmuBuzzerTestSuite_expected_(EvmuTicks ticks, size_t frequency) {
+    return (size_t)(ticks * frequency / 1000000000ull);
+}
+
+// Instructions overrun update boundaries, so allow the count to drift by a fraction of a percent
+static GblBool EvmuBuzzerTestSuite_matches_(size_t samples, size_t expected) {
+    const size_t tolerance = expected / 200 + 1;
+
+    return samples + tolerance >= expected && samples <= expected + tolerance;
+}
+
+GBL_TEST_CASE(streamRate) {
+    GBL_TEST_CALL(EvmuBuzzer_startPcmStream(pFixture->pBuzzer, EVMU_BUZZER_TEST_FREQUENCY_, 1 << 16));
+    GBL_TEST_VERIFY(EvmuBuzzer_pcmStreaming(pFixture->pBuzzer));
+    GBL_TEST_COMPARE(EvmuBuzzer_pcmStreamFrequency(pFixture->pBuzzer), EVMU_BUZZER_TEST_FREQUENCY_);
+
+    size_t  pulled = 0;
+    uint8_t buffer[512];
+
+    // Drain as the audio thread would, so the ring never fills up and drops anything
+    for(EvmuTicks t = 0; t < EVMU_BUZZER_TEST_DURATION_; t += EVMU_BUZZER_TEST_SLICE_) {
+        GBL_TEST_CALL(EvmuIBehavior_update(EVMU_IBEHAVIOR(pFixture->pDevice), EVMU_BUZZER_TEST_SLICE_));
+        pulled += EvmuBuzzer_pullPcm(pFixture->pBuzzer, buffer, sizeof(buffer));
+    }
+
+    const size_t expected = EvmuBuzzerTestSuite_expected_(EVMU_BUZZER_TEST_DURATION_, EVMU_BUZZER_TEST_FREQUENCY_);
+    const size_t produced = pulled + EvmuBuzzer_pcmStreamAvailable(pFixture->pBuzzer);
+
+    GBL_TEST_COMPARE(EvmuBuzzer_pcmStreamDropped(pFixture->pBuzzer), 0);
+    GBL_TEST_VERIFY(EvmuBuzzerTestSuite_matches_(produced, expected));
+
+    EvmuBuzzer_stopPcmStream(pFixture->pBuzzer);
+    GBL_TEST_VERIFY(!EvmuBuzzer_pcmStreaming(pFixture->pBuzzer));
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_CASE(streamRates) {
+    static const size_t rates[] = { 8000, 22050, 48000 };
+    uint8_t             buffer[512];
+
+    // A tenth of a second at each rate, checked against the rate itself rather than converted clock ticks
+    for(size_t r = 0; r < GBL_COUNT_OF(rates); ++r) {
+        size_t pulled = 0;
+
+        GBL_TEST_CALL(EvmuBuzzer_startPcmStream(pFixture->pBuzzer, rates[r], 1 << 16));
+
+        for(size_t s = 0; s < 100; ++s) {
+            GBL_TEST_CALL(EvmuIBehavior_update(EVMU_IBEHAVIOR(pFixture->pDevice), EVMU_BUZZER_TEST_SLICE_));
+            pulled += EvmuBuzzer_pullPcm(pFixture->pBuzzer, buffer, sizeof(buffer));
+        }
+
+        pulled += EvmuBuzzer_pcmStreamAvailable(pFixture->pBuzzer);
+
+        GBL_TEST_COMPARE(EvmuBuzzer_pcmStreamDropped(pFixture->pBuzzer), 0);
+        GBL_TEST_VERIFY(EvmuBuzzerTestSuite_matches_(pulled, rates[r] / 10));
+
+        EvmuBuzzer_stopPcmStream(pFixture->pBuzzer);
+    }
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_CASE(streamUnderrun) {
+    uint8_t buffer[64];
+
+    GBL_TEST_CALL(EvmuBuzzer_startPcmStream(pFixture->pBuzzer, EVMU_BUZZER_TEST_FREQUENCY_, 0));
+
+    // Nothing has been emulated yet, so the whole pull is padded with silence
+    GBL_TEST_COMPARE(EvmuBuzzer_pullPcm(pFixture->pBuzzer, buffer, sizeof(buffer)), 0);
+
+    for(size_t s = 0; s < sizeof(buffer); ++s)
+        GBL_TEST_COMPARE(buffer[s], EVMU_BUZZER_STREAM_SILENCE);
+
+    EvmuBuzzer_stopPcmStream(pFixture->pBuzzer);
+
+    GBL_TEST_CASE_END;
+}
+
+// Drives P1.7 from Timer 1 as an 8-bit PWM output, the way software starts a tone
+static void EvmuBuzzerTestSuite_startTone_(EvmuDevice* pDevice, uint8_t period, uint8_t invPulse) {
+    EvmuRam_writeData(pDevice->pRam, EVMU_ADDRESS_SFR_P1DDR, EVMU_SFR_P1DDR_P17DDR_MASK);
+    EvmuRam_writeData(pDevice->pRam, EVMU_ADDRESS_SFR_P1FCR, EVMU_SFR_P1FCR_P17FCR_MASK);
+    EvmuRam_writeData(pDevice->pRam, EVMU_ADDRESS_SFR_P1,    0);
+    EvmuRam_writeData(pDevice->pRam, EVMU_ADDRESS_SFR_T1LR,  256 - period);
+    EvmuRam_writeData(pDevice->pRam, EVMU_ADDRESS_SFR_T1LC,  256 - period + invPulse);
+    EvmuRam_writeData(pDevice->pRam, EVMU_ADDRESS_SFR_T1CNT, EVMU_SFR_T1CNT_T1LRUN_MASK);
+}
+
+GBL_TEST_CASE(renderToneLength) {
+    const size_t capacity = 2 * EvmuBuzzerTestSuite_expected_(EVMU_BUZZER_TEST_DURATION_,
+                                                              EVMU_BUZZER_TEST_FREQUENCY_);
+    uint8_t*     pBuffer  = malloc(capacity);
+
+    GBL_TEST_VERIFY(pBuffer);
+
+    EvmuBuzzerTestSuite_startTone_(pFixture->pDevice, EVMU_BUZZER_TEST_PERIOD_, EVMU_BUZZER_TEST_PERIOD_ / 2);
+
+    GBL_TEST_CALL(EvmuBuzzer_renderPcm(pFixture->pBuzzer, EVMU_BUZZER_TEST_FREQUENCY_, pBuffer, capacity));
+    GBL_TEST_VERIFY(EvmuBuzzer_rendering(pFixture->pBuzzer));
+
+    const EvmuTicks start = EvmuDevice_emulatedTicks(pFixture->pDevice);
+    GBL_TEST_CALL(EvmuBuzzer_renderFor(pFixture->pBuzzer, EVMU_BUZZER_TEST_DURATION_));
+    const EvmuTicks elapsed = EvmuDevice_emulatedTicks(pFixture->pDevice) - start;
+
+    GBL_TEST_CALL(EvmuBuzzer_finishRender(pFixture->pBuzzer));
+    GBL_TEST_VERIFY(!EvmuBuzzer_rendering(pFixture->pBuzzer));
+
+    const size_t samples = EvmuBuzzer_renderedSamples(pFixture->pBuzzer);
+
+    GBL_TEST_VERIFY(samples <= capacity);
+    GBL_TEST_VERIFY(EvmuBuzzerTestSuite_matches_(samples,
+                                                 EvmuBuzzerTestSuite_expected_(elapsed, EVMU_BUZZER_TEST_FREQUENCY_)));
+
+    // One rising edge per period of the tone, which is well below the sample rate
+    const double toneHz = 1.0 / (EVMU_BUZZER_TEST_PERIOD_ * EvmuClock_systemSecsPerCycle(pFixture->pDevice->pClock));
+    const size_t edges  = (size_t)(toneHz * elapsed / 1000000000.0);
+    size_t       rising = 0;
+
+    for(size_t s = 1; s < samples; ++s)
+        if(pBuffer[s] > pBuffer[s - 1]) ++rising;
+
+    GBL_TEST_VERIFY(rising + edges / 20 + 2 >= edges && rising <= edges + edges / 20 + 2);
+
+    free(pBuffer);
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_CASE(renderWavLength) {
+    uint8_t header[44];
+
+    EvmuBuzzerTestSuite_startTone_(pFixture->pDevice, EVMU_BUZZER_TEST_PERIOD_, EVMU_BUZZER_TEST_PERIOD_ / 2);
+
+    GBL_TEST_CALL(EvmuBuzzer_renderWav(pFixture->pBuzzer, EVMU_BUZZER_TEST_FREQUENCY_, EVMU_BUZZER_TEST_WAV_PATH_));
+
+    const EvmuTicks start = EvmuDevice_emulatedTicks(pFixture->pDevice);
+    GBL_TEST_CALL(EvmuBuzzer_renderFor(pFixture->pBuzzer, EVMU_BUZZER_TEST_DURATION_));
+    const EvmuTicks elapsed = EvmuDevice_emulatedTicks(pFixture->pDevice) - start;
+
+    GBL_TEST_CALL(EvmuBuzzer_finishRender(pFixture->pBuzzer));
+
+    const size_t samples = EvmuBuzzer_renderedSamples(pFixture->pBuzzer);
+
+    GBL_TEST_VERIFY(EvmuBuzzerTestSuite_matches_(samples,
+                                                 EvmuBuzzerTestSuite_expected_(elapsed, EVMU_BUZZER_TEST_FREQUENCY_)));
+
+    // The file holds the header followed by exactly that many 8-bit samples
+    FILE* pFile = fopen(EVMU_BUZZER_TEST_WAV_PATH_, "rb");
+    GBL_TEST_VERIFY(pFile);
+
+    const GblBool read = fread(header, sizeof(header), 1, pFile) == 1 &&
+                         fseek(pFile, 0, SEEK_END) == 0;
+    const long    size = ftell(pFile);
+
+    fclose(pFile);
+    remove(EVMU_BUZZER_TEST_WAV_PATH_);
+
+    GBL_TEST_VERIFY(read);
+    GBL_TEST_COMPARE((size_t)size, sizeof(header) + samples);
+    GBL_TEST_COMPARE((size_t)(header[40] | header[41] << 8 | header[42] << 16 | (uint32_t)header[43] << 24),
+                     samples);
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_REGISTER(streamRate,
+                  streamRates,
+                  streamUnderrun,
+                  renderToneLength,
+                  renderWavLength);
@@ -0,0 +1,66 @@
+#include "evmu_emulator_test_suite.h"
+#include <gimbal/test/gimbal_test_macros.h>
+#include <evmu/types/evmu_emulator.h>
+#include <evmu/hw/evmu_device.h>
+
+#define EVMU_EMULATOR_TEST_SUITE_(instance)  (GBL_PRIVATE(EvmuEmulatorTestSuite, instance))
+
+#define EVMU_EMULATOR_TEST_FRAME_   1000000ull  // ns
+
+#define GBL_SELF_TYPE EvmuEmulatorTestSuite
+
+GBL_TEST_FIXTURE {
+    EvmuEmulator* pEmulator;
+};
+
+GBL_TEST_INIT() {
+    pFixture->pEmulator = EvmuEmulator_create();
+    GBL_TEST_VERIFY(pFixture->pEmulator);
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_FINAL() {
+    EvmuEmulator_unref(pFixture->pEmulator);
+    GBL_TEST_CASE_END;
+}
+
+// Devices given the emulator as their parent are managed just like added ones
+GBL_TEST_CASE(parentedDevice) {
+    EvmuDevice* pParented = GBL_NEW(EvmuDevice,
+                                    "parent",    pFixture->pEmulator,
+                                    "initFlags", EVMU_DEVICE_INIT_QUIET);
+    EvmuDevice* pAdded    = EvmuDevice_createWithFlags(EVMU_DEVICE_INIT_QUIET);
+
+    GBL_TEST_CALL(EvmuEmulator_addDevice(pFixture->pEmulator, pAdded));
+
+    GBL_TEST_COMPARE(EvmuEmulator_deviceCount(pFixture->pEmulator), 2);
+    GBL_TEST_VERIFY(EvmuEmulator_device(pFixture->pEmulator, 0) == pParented);
+    GBL_TEST_VERIFY(EvmuEmulator_device(pFixture->pEmulator, 1) == pAdded);
+    GBL_TEST_VERIFY(!EvmuEmulator_device(pFixture->pEmulator, 2));
+
+    GBL_TEST_CALL(EvmuEmulator_runDevices(pFixture->pEmulator, EVMU_EMULATOR_TEST_FRAME_, 1));
+
+    GBL_TEST_VERIFY(EvmuDevice_emulatedTicks(pParented) >= EVMU_EMULATOR_TEST_FRAME_);
+    GBL_TEST_VERIFY(EvmuDevice_emulatedTicks(pAdded)    >= EVMU_EMULATOR_TEST_FRAME_);
+
+    GBL_TEST_CASE_END;
+}
+
+// A device reparented away without going through EvmuEmulator_removeDevice() stops being managed
+GBL_TEST_CASE(reparentedDevice) {
+    EvmuDevice* pDevice = EvmuEmulator_device(pFixture->pEmulator, 0);
+
+    GblObject_setParent(GBL_OBJECT(pDevice), NULL);
+
+    GBL_TEST_COMPARE(EvmuEmulator_deviceCount(pFixture->pEmulator), 1);
+    GBL_TEST_VERIFY(EvmuEmulator_device(pFixture->pEmulator, 0) != pDevice);
+
+    GBL_UNREF(pDevice);
+
+    GBL_TEST_CALL(EvmuEmulator_runDevices(pFixture->pEmulator, EVMU_EMULATOR_TEST_FRAME_, 1));
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_REGISTER(parentedDevice,
+                  reparentedDevice);
@@ -0,0 +1,263 @@
+#include "evmu_journal_test_suite.h"
+#include <gimbal/test/gimbal_test_macros.h>
+#include <evmu/hw/evmu_device.h>
+#include <evmu/hw/evmu_flash.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define EVMU_JOURNAL_TEST_SUITE_(instance)  (GBL_PRIVATE(EvmuJournalTestSuite, instance))
+
+#define EVMU_JOURNAL_TEST_IMAGE_PATH_   "evmu_journal_test.bin"
+#define EVMU_JOURNAL_TEST_PATH_         EVMU_JOURNAL_TEST_IMAGE_PATH_ ".journal"
+#define EVMU_JOURNAL_TEST_OLD_PATH_     EVMU_JOURNAL_TEST_IMAGE_PATH_ ".journal.old"
+#define EVMU_JOURNAL_TEST_BATCHES_      3
+#define EVMU_JOURNAL_TEST_BLOCKS_       4
+
+// Where the CRC sits within a journal record, since the record itself is private
+#define EVMU_JOURNAL_TEST_CRC_OFFSET_   16
+#define EVMU_JOURNAL_TEST_RECORD_SIZE_  24
+
+#define GBL_SELF_TYPE EvmuJournalTestSuite
+
+GBL_TEST_FIXTURE {
+    uint8_t* pImage;
+    size_t   imageSize;
+    uint8_t* pJournal;
+    size_t   journalSize;
+    size_t   batchEnds[EVMU_JOURNAL_TEST_BATCHES_ + 1]; // journal size after each sync
+};
+
+static const size_t EvmuJournalTestSuite_blocks_[EVMU_JOURNAL_TEST_BLOCKS_] = { 10, 20, 30, 40 };
+
+/* What each batch fills the blocks with, or 0 where it leaves them alone. The
+ * last batch overwrites a block from the one before it, so the order in which
+ * batches are replayed shows up in the result. */
+static const uint8_t EvmuJournalTestSuite_fills_[EVMU_JOURNAL_TEST_BATCHES_][EVMU_JOURNAL_TEST_BLOCKS_] = {
+    { 0x11, 0x00, 0x00, 0x00 },
+    { 0x00, 0x22, 0x22, 0x00 },
+    { 0x00, 0x00, 0x33, 0x33 }
+};
+
+// Returns what a block should hold once the first \p committed batches have been recovered
+static uint8_t EvmuJournalTestSuite_expected_(size_t block, size_t committed) {
+    uint8_t value = 0;
+
+    for(size_t b = 0; b < committed; ++b)
+        if(EvmuJournalTestSuite_fills_[b][block])
+            value = EvmuJournalTestSuite_fills_[b][block];
+
+    return value;
+}
+
+static GblBool EvmuJournalTestSuite_readFile_(const char* pPath, uint8_t** ppData, size_t* pSize) {
+    FILE*   pFile = fopen(pPath, "rb");
+    GblBool read  = GBL_FALSE;
+
+    *ppData = NULL;
+
+    if(!pFile)
+        return GBL_FALSE;
+
+    if(fseek(pFile, 0, SEEK_END) == 0) {
+        const long size = ftell(pFile);
+
+        if(size > 0 && fseek(pFile, 0, SEEK_SET) == 0 && (*ppData = malloc(size))) {
+            *pSize = size;
+            read   = fread(*ppData, size, 1, pFile) == 1;
+        }
+    }
+
+    fclose(pFile);
+
+    return read;
+}
+
+static GblBool EvmuJournalTestSuite_writeFile_(const char* pPath, const uint8_t* pData, size_t size) {
+    FILE* pFile = fopen(pPath, "wb");
+
+    if(!pFile)
+        return GBL_FALSE;
+
+    const GblBool written = !size || fwrite(pData, size, 1, pFile) == 1;
+
+    return fclose(pFile) == 0 && written;
+}
+
+static GblBool EvmuJournalTestSuite_exists_(const char* pPath) {
+    FILE* pFile = fopen(pPath, "rb");
+
+    if(pFile) fclose(pFile);
+
+    return pFile != NULL;
+}
+
+// Journals every batch to a fresh image, then keeps copies of the image and journal it left behind
+GBL_TEST_INIT() {
+    EvmuDevice* pDevice = GBL_OBJECT_NEW(EvmuDevice);
+    uint8_t     block[EVMU_FLASH_BLOCK_SIZE];
+
+    // An image that doesn't exist yet starts out as whatever's in flash
+    remove(EVMU_JOURNAL_TEST_IMAGE_PATH_);
+    memset(block, 0, sizeof(block));
+
+    for(size_t b = 0; b < EVMU_JOURNAL_TEST_BLOCKS_; ++b)
+        GBL_TEST_CALL(EvmuFlash_writeRaw(pDevice->pFlash,
+                                         EvmuJournalTestSuite_blocks_[b] * EVMU_FLASH_BLOCK_SIZE,
+                                         block,
+                                         sizeof(block)));
+
+    GBL_TEST_CALL(EvmuFlash_openJournal(pDevice->pFlash, EVMU_JOURNAL_TEST_IMAGE_PATH_));
+
+    for(size_t s = 0; s < EVMU_JOURNAL_TEST_BATCHES_; ++s) {
+        for(size_t b = 0; b < EVMU_JOURNAL_TEST_BLOCKS_; ++b) {
+            if(!EvmuJournalTestSuite_fills_[s][b])
+                continue;
+
+            memset(block, EvmuJournalTestSuite_fills_[s][b], sizeof(block));
+            GBL_TEST_CALL(EvmuFlash_writeRaw(pDevice->pFlash,
+                                             EvmuJournalTestSuite_blocks_[b] * EVMU_FLASH_BLOCK_SIZE,
+                                             block,
+                                             sizeof(block)));
+        }
+
+        GBL_TEST_CALL(EvmuFlash_syncJournal(pDevice->pFlash));
+        pFixture->batchEnds[s + 1] = EvmuFlash_journalSize(pDevice->pFlash);
+    }
+
+    GBL_TEST_CALL(EvmuFlash_closeJournal(pDevice->pFlash));
+    GBL_UNREF(pDevice);
+
+    GBL_TEST_VERIFY(EvmuJournalTestSuite_readFile_(EVMU_JOURNAL_TEST_IMAGE_PATH_,
+                                                   &pFixture->pImage,
+                                                   &pFixture->imageSize));
+    GBL_TEST_VERIFY(EvmuJournalTestSuite_readFile_(EVMU_JOURNAL_TEST_PATH_,
+                                                   &pFixture->pJournal,
+                                                   &pFixture->journalSize));
+
+    GBL_TEST_COMPARE(pFixture->journalSize, pFixture->batchEnds[EVMU_JOURNAL_TEST_BATCHES_]);
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_FINAL() {
+    free(pFixture->pImage);
+    free(pFixture->pJournal);
+
+    remove(EVMU_JOURNAL_TEST_IMAGE_PATH_);
+    remove(EVMU_JOURNAL_TEST_PATH_);
+    remove(EVMU_JOURNAL_TEST_OLD_PATH_);
+
+    GBL_TEST_CASE_END;
+}
+
+/* Lays the original image back down beside the given retired and active journals,
+ * as a crash would have left them, then opens it on a fresh device and checks that
+ * exactly the first \p committed batches were recovered. */
+static GBL_RESULT EvmuJournalTestSuite_recover_(GblTestSuite*  pSelf,
+                                                const uint8_t* pOld,
+                                                size_t         oldSize,
+                                                const uint8_t* pActive,
+                                                size_t         activeSize,
+                                                size_t         committed)
+{
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuJournalTestSuite_* pFixture = EVMU_JOURNAL_TEST_SUITE_(pSelf);
+    EvmuDevice*            pDevice  = NULL;
+    uint8_t                block[EVMU_FLASH_BLOCK_SIZE];
+    uint8_t                expected[EVMU_FLASH_BLOCK_SIZE];
+
+    remove(EVMU_JOURNAL_TEST_OLD_PATH_);
+
+    GBL_TEST_VERIFY(EvmuJournalTestSuite_writeFile_(EVMU_JOURNAL_TEST_IMAGE_PATH_,
+                                                    pFixture->pImage,
+                                                    pFixture->imageSize));
+    GBL_TEST_VERIFY(!pOld || EvmuJournalTestSuite_writeFile_(EVMU_JOURNAL_TEST_OLD_PATH_, pOld, oldSize));
+    GBL_TEST_VERIFY(EvmuJournalTestSuite_writeFile_(EVMU_JOURNAL_TEST_PATH_, pActive, activeSize));
+
+    pDevice = GBL_OBJECT_NEW(EvmuDevice);
+
+    GBL_TEST_CALL(EvmuFlash_openJournal(pDevice->pFlash, EVMU_JOURNAL_TEST_IMAGE_PATH_));
+
+    for(size_t b = 0; b < EVMU_JOURNAL_TEST_BLOCKS_; ++b) {
+        GBL_TEST_CALL(EvmuFlash_readRaw(pDevice->pFlash,
+                                        EvmuJournalTestSuite_blocks_[b] * EVMU_FLASH_BLOCK_SIZE,
+                                        block,
+                                        sizeof(block)));
+
+        memset(expected, EvmuJournalTestSuite_expected_(b, committed), sizeof(expected));
+        GBL_TEST_VERIFY(memcmp(block, expected, sizeof(block)) == 0);
+    }
+
+    // Whatever was recovered now lives in the image, with both journals starting over
+    GBL_TEST_VERIFY(!EvmuJournalTestSuite_exists_(EVMU_JOURNAL_TEST_OLD_PATH_));
+    GBL_TEST_COMPARE(EvmuFlash_journalSize(pDevice->pFlash), 0);
+
+    GBL_TEST_CALL(EvmuFlash_closeJournal(pDevice->pFlash));
+
+    GBL_CTX_END_BLOCK();
+    GBL_UNREF(pDevice);
+    return GBL_CTX_RESULT();
+}
+
+GBL_TEST_CASE(recoverCommitted) {
+    GBL_TEST_CALL(EvmuJournalTestSuite_recover_(pSelf,
+                                                NULL, 0,
+                                                pFixture->pJournal, pFixture->journalSize,
+                                                EVMU_JOURNAL_TEST_BATCHES_));
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_CASE(discardTornBatch) {
+    const size_t last = pFixture->batchEnds[EVMU_JOURNAL_TEST_BATCHES_ - 1];
+
+    // Torn partway through the first block of the last batch
+    GBL_TEST_CALL(EvmuJournalTestSuite_recover_(pSelf,
+                                                NULL, 0,
+                                                pFixture->pJournal, last + EVMU_JOURNAL_TEST_RECORD_SIZE_ + 100,
+                                                EVMU_JOURNAL_TEST_BATCHES_ - 1));
+
+    // Torn with every block written but not the whole commit record
+    GBL_TEST_CALL(EvmuJournalTestSuite_recover_(pSelf,
+                                                NULL, 0,
+                                                pFixture->pJournal, pFixture->journalSize - 1,
+                                                EVMU_JOURNAL_TEST_BATCHES_ - 1));
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_CASE(discardCorruptBatch) {
+    uint8_t* pJournal = malloc(pFixture->journalSize);
+
+    GBL_TEST_VERIFY(pJournal);
+
+    // A bad CRC in the second batch ends recovery there, taking the intact batch after it too
+    memcpy(pJournal, pFixture->pJournal, pFixture->journalSize);
+    pJournal[pFixture->batchEnds[1] + EVMU_JOURNAL_TEST_CRC_OFFSET_] ^= 0xff;
+
+    const GBL_RESULT result = EvmuJournalTestSuite_recover_(pSelf,
+                                                            NULL, 0,
+                                                            pJournal, pFixture->journalSize,
+                                                            1);
+    free(pJournal);
+
+    GBL_TEST_CALL(result);
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_CASE(replayRetiredFirst) {
+    const size_t split = pFixture->batchEnds[EVMU_JOURNAL_TEST_BATCHES_ - 1];
+
+    /* Crashed after the journal was retired but before it was folded, so the
+     * earlier batches sit in the retired journal and the last in the new one. */
+    GBL_TEST_CALL(EvmuJournalTestSuite_recover_(pSelf,
+                                                pFixture->pJournal, split,
+                                                pFixture->pJournal + split, pFixture->journalSize - split,
+                                                EVMU_JOURNAL_TEST_BATCHES_));
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_REGISTER(recoverCommitted,
+                  discardTornBatch,
+                  discardCorruptBatch,
+                  replayRetiredFirst);
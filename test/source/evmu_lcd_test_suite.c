@@ -0,0 +1,146 @@
+#include "evmu_lcd_test_suite.h"
+#include <gimbal/test/gimbal_test_macros.h>
+#include <evmu/hw/evmu_device.h>
+#include <evmu/hw/evmu_lcd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EVMU_LCD_TEST_SUITE_(instance)  (GBL_PRIVATE(EvmuLcdTestSuite, instance))
+
+#define EVMU_LCD_TEST_FRAMES_   400
+#define EVMU_LCD_TEST_ROW_      (EVMU_LCD_FRAME_SIZE / EVMU_LCD_PIXEL_HEIGHT)
+
+#define GBL_SELF_TYPE EvmuLcdTestSuite
+
+GBL_TEST_FIXTURE {
+    EvmuDevice* pDevice;
+    EvmuLcd*    pLcd;
+    uint8_t*    pFrames;    // every frame pushed to the display, starting with the initial one
+    EvmuTicks   ticks;      // ticks between refreshes
+};
+
+GBL_TEST_INIT() {
+    pFixture->pDevice = GBL_OBJECT_NEW(EvmuDevice);
+    pFixture->pLcd    = pFixture->pDevice->pLcd;
+    pFixture->pFrames = malloc((EVMU_LCD_TEST_FRAMES_ + 1) * EVMU_LCD_FRAME_SIZE);
+
+    GBL_TEST_VERIFY(pFixture->pFrames);
+
+    EvmuLcd_setScreenEnabled(pFixture->pLcd, GBL_TRUE);
+    EvmuLcd_setRefreshEnabled(pFixture->pLcd, GBL_TRUE);
+
+    pFixture->ticks = EvmuLcd_refreshRateTicks(pFixture->pLcd) * EVMU_LCD_SCREEN_REFRESH_DIVISOR;
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_FINAL() {
+    free(pFixture->pFrames);
+    GBL_UNREF(pFixture->pDevice);
+    GBL_TEST_CASE_END;
+}
+
+static uint32_t EvmuLcdTestSuite_random_(uint32_t* pState) {
+    *pState ^= *pState << 13;
+    *pState ^= *pState >> 17;
+    *pState ^= *pState << 5;
+    return *pState;
+}
+
+/* Builds a frame which exercises every kind of run the encoder emits: a band of
+ * solid fill, a band of noise, and a band carried over from the previous frame
+ * apart from a single byte, with a counter up front so no two frames match. */
+static void EvmuLcdTestSuite_generate_(uint8_t* pFrame, const uint8_t* pPrev, size_t index, uint32_t* pSeed) {
+    memcpy(pFrame, pPrev, EVMU_LCD_FRAME_SIZE);
+
+    memset(pFrame, index & 0xff, 8 * EVMU_LCD_TEST_ROW_);
+    pFrame[0] = (index >> 8) + 1;
+    pFrame[1] = index & 0xff;
+
+    for(size_t b = 8 * EVMU_LCD_TEST_ROW_; b < 24 * EVMU_LCD_TEST_ROW_; ++b)
+        pFrame[b] = EvmuLcdTestSuite_random_(pSeed);
+
+    pFrame[24 * EVMU_LCD_TEST_ROW_ + EvmuLcdTestSuite_random_(pSeed) % (8 * EVMU_LCD_TEST_ROW_)] ^= 0xff;
+}
+
+// Pushes frames through the display, then checks every retained one decodes back exactly
+static GBL_RESULT EvmuLcdTestSuite_roundTrip_(GblTestSuite* pSelf, size_t capacity, GblBool evicts) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuLcdTestSuite_* pFixture = EVMU_LCD_TEST_SUITE_(pSelf);
+    uint32_t           seed     = 0x2468ace1;
+    uint8_t            frame[EVMU_LCD_FRAME_SIZE];
+    EvmuTicks          timestamp;
+
+    EvmuLcd_frame(pFixture->pLcd, pFixture->pFrames);
+    GBL_TEST_CALL(EvmuLcd_startRecording(pFixture->pLcd, capacity));
+
+    for(size_t f = 1; f <= EVMU_LCD_TEST_FRAMES_; ++f) {
+        uint8_t* pFrame = &pFixture->pFrames[f * EVMU_LCD_FRAME_SIZE];
+
+        EvmuLcdTestSuite_generate_(pFrame, pFrame - EVMU_LCD_FRAME_SIZE, f, &seed);
+        EvmuLcd_setFrame(pFixture->pLcd, pFrame);
+        GBL_TEST_CALL(EvmuIBehavior_update(EVMU_IBEHAVIOR(pFixture->pLcd), pFixture->ticks));
+    }
+
+    EvmuLcd_stopRecording(pFixture->pLcd);
+
+    const size_t frames = EvmuLcd_recordedFrames(pFixture->pLcd);
+    const size_t first  = EVMU_LCD_TEST_FRAMES_ + 1 - frames;
+
+    GBL_TEST_VERIFY(frames > 0 && frames <= EVMU_LCD_TEST_FRAMES_ + 1);
+    GBL_TEST_COMPARE(first > 0, evicts);
+
+    // Eviction drops whole keyframe groups, so what remains starts on a keyframe
+    GBL_TEST_COMPARE(first % EVMU_LCD_RECORDER_KEYFRAME_INTERVAL, 0);
+
+    for(size_t f = 0; f < frames; ++f) {
+        GBL_TEST_CALL(EvmuLcd_recordedFrame(pFixture->pLcd, f, frame, &timestamp));
+        GBL_TEST_VERIFY(!memcmp(frame, &pFixture->pFrames[(first + f) * EVMU_LCD_FRAME_SIZE], sizeof(frame)));
+        GBL_TEST_COMPARE(timestamp, (first + f) * pFixture->ticks);
+    }
+
+    GBL_TEST_EXPECT_ERROR();
+    GBL_TEST_COMPARE(EvmuLcd_recordedFrame(pFixture->pLcd, frames, frame, NULL),
+                     GBL_RESULT_ERROR_OUT_OF_RANGE);
+    GBL_CTX_CLEAR_LAST_RECORD();
+
+    EvmuLcd_clearRecording(pFixture->pLcd);
+    GBL_TEST_COMPARE(EvmuLcd_recordedFrames(pFixture->pLcd), 0);
+
+    GBL_CTX_END();
+}
+
+GBL_TEST_CASE(recordRoundTrip) {
+    GBL_TEST_CALL(EvmuLcdTestSuite_roundTrip_(pSelf, 0, GBL_FALSE));
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_CASE(recordEviction) {
+    GBL_TEST_CALL(EvmuLcdTestSuite_roundTrip_(pSelf, EVMU_LCD_RECORDER_MIN_CAPACITY, GBL_TRUE));
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_CASE(recordSkipsUnchanged) {
+    uint8_t frame[EVMU_LCD_FRAME_SIZE];
+
+    GBL_TEST_CALL(EvmuLcd_startRecording(pFixture->pLcd, 0));
+
+    memset(frame, 0x5a, sizeof(frame));
+    EvmuLcd_setFrame(pFixture->pLcd, frame);
+    GBL_TEST_CALL(EvmuIBehavior_update(EVMU_IBEHAVIOR(pFixture->pLcd), pFixture->ticks));
+
+    const size_t frames = EvmuLcd_recordedFrames(pFixture->pLcd);
+
+    EvmuLcd_setFrame(pFixture->pLcd, frame);
+    GBL_TEST_CALL(EvmuIBehavior_update(EVMU_IBEHAVIOR(pFixture->pLcd), pFixture->ticks));
+    GBL_TEST_COMPARE(EvmuLcd_recordedFrames(pFixture->pLcd), frames);
+
+    EvmuLcd_clearRecording(pFixture->pLcd);
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_REGISTER(recordRoundTrip,
+                  recordEviction,
+                  recordSkipsUnchanged);
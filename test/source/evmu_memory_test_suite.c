@@ -5,6 +5,8 @@
 #include <evmu/hw/evmu_sfr.h>
 #include <evmu/hw/evmu_address_space.h>
 #include <evmu/hw/evmu_wram.h>
+#include <evmu/hw/evmu_flash.h>
+#include <evmu/hw/evmu_rom.h>
 
 #define EVMU_RAM_TEST_SUITE_(instance)  (GBL_PRIVATE(EvmuRamTestSuite, instance))
 
@@ -255,6 +257,78 @@ GBL_RESULT EvmuRamTestSuite_xramBankChange_(GblTestSuite* pSelf, GblContext* pCt
 }
 
 
+GBL_RESULT EvmuRamTestSuite_cloneIsolation_(GblTestSuite* pSelf, GblContext* pCtx) {
+    GBL_CTX_BEGIN(pCtx);
+
+    EvmuRamTestSuite_* pSelf_ = EVMU_RAM_TEST_SUITE_(pSelf);
+    EvmuDevice*        pClone = NULL;
+
+    GBL_CTX_VERIFY_CALL(EvmuFlash_writeByte(pSelf_->pDevice->pFlash, 0x100, 0x11));
+    GBL_CTX_VERIFY_CALL(EvmuRom_writeByte(pSelf_->pDevice->pRom, 0x100, 0x22));
+
+    pClone = EvmuDevice_clone(pSelf_->pDevice);
+    GBL_TEST_VERIFY(pClone);
+
+    GBL_TEST_COMPARE(EvmuFlash_readByte(pClone->pFlash, 0x100), 0x11);
+    GBL_TEST_COMPARE(EvmuRom_readByte(pClone->pRom, 0x100), 0x22);
+
+    // Writing to the clone leaves the original alone
+    GBL_CTX_VERIFY_CALL(EvmuFlash_writeByte(pClone->pFlash, 0x100, 0x33));
+    GBL_CTX_VERIFY_CALL(EvmuRom_writeByte(pClone->pRom, 0x100, 0x44));
+    GBL_TEST_COMPARE(EvmuFlash_readByte(pSelf_->pDevice->pFlash, 0x100), 0x11);
+    GBL_TEST_COMPARE(EvmuRom_readByte(pSelf_->pDevice->pRom, 0x100), 0x22);
+
+    // And the other way around
+    const EvmuWord flash = EvmuFlash_readByte(pClone->pFlash, 0x101);
+    const EvmuWord rom   = EvmuRom_readByte(pClone->pRom, 0x101);
+
+    GBL_CTX_VERIFY_CALL(EvmuFlash_writeByte(pSelf_->pDevice->pFlash, 0x101, flash ^ 0xff));
+    GBL_CTX_VERIFY_CALL(EvmuRom_writeByte(pSelf_->pDevice->pRom, 0x101, rom ^ 0xff));
+    GBL_TEST_COMPARE(EvmuFlash_readByte(pClone->pFlash, 0x101), flash);
+    GBL_TEST_COMPARE(EvmuRom_readByte(pClone->pRom, 0x101), rom);
+    GBL_TEST_COMPARE(EvmuFlash_readByte(pClone->pFlash, 0x100), 0x33);
+    GBL_TEST_COMPARE(EvmuRom_readByte(pClone->pRom, 0x100), 0x44);
+
+    GBL_CTX_END_BLOCK();
+    GBL_UNREF(pClone);
+    return GBL_CTX_RESULT();
+}
+
+GBL_RESULT EvmuRamTestSuite_cloneExtRebase_(GblTestSuite* pSelf, GblContext* pCtx) {
+    GBL_CTX_BEGIN(pCtx);
+
+    EvmuRamTestSuite_*     pSelf_ = EVMU_RAM_TEST_SUITE_(pSelf);
+    const EVMU_PROGRAM_SRC src    = EvmuRam_programSrc(pSelf_->pRam);
+    EvmuDevice*            pClone = NULL;
+
+    EvmuRam_setProgramSrc(pSelf_->pRam, EVMU_PROGRAM_SRC_FLASH_BANK_0);
+    GBL_CTX_VERIFY_CALL(EvmuRam_writeProgram(pSelf_->pRam, 0x2, 0x5));
+
+    pClone = EvmuDevice_clone(pSelf_->pDevice);
+    GBL_TEST_VERIFY(pClone);
+
+    GBL_TEST_COMPARE(EvmuRam_programSrc(pClone->pRam), EVMU_PROGRAM_SRC_FLASH_BANK_0);
+    GBL_TEST_COMPARE(EvmuRam_readProgram(pClone->pRam, 0x2), 0x5);
+
+    // EXT has to follow the clone's flash once a write gives it storage of its own
+    GBL_CTX_VERIFY_CALL(EvmuRam_writeProgram(pClone->pRam, 0x2, 0x6));
+    GBL_TEST_COMPARE(EvmuRam_readProgram(pClone->pRam, 0x2), 0x6);
+    GBL_TEST_COMPARE(EvmuFlash_readByte(pClone->pFlash, 0x2), 0x6);
+    GBL_TEST_COMPARE(EvmuRam_readProgram(pSelf_->pRam, 0x2), 0x5);
+
+    const EvmuWord value = EvmuRam_readProgram(pClone->pRam, 0x3);
+
+    GBL_CTX_VERIFY_CALL(EvmuRam_writeProgram(pSelf_->pRam, 0x3, value ^ 0xff));
+    GBL_TEST_COMPARE(EvmuRam_readProgram(pClone->pRam, 0x3), value);
+    GBL_TEST_COMPARE(EvmuFlash_readByte(pSelf_->pDevice->pFlash, 0x3), value ^ 0xff);
+
+    GBL_CTX_END_BLOCK();
+    GBL_UNREF(pClone);
+    EvmuRam_setProgramSrc(pSelf_->pRam, src);
+    return GBL_CTX_RESULT();
+}
+
+
 GBL_EXPORT GblType EvmuRamTestSuite_type(void) {
     static GblType type = GBL_INVALID_TYPE;
 
@@ -271,6 +345,8 @@ GBL_EXPORT GblType EvmuRamTestSuite_type(void) {
         { "wramWrite",             EvmuRamTestSuite_wramWrite_             },
         { "xramBankChangeInvalid", EvmuRamTestSuite_xramBankChangeInvalid_ },
         { "xramBankChange",        EvmuRamTestSuite_xramBankChange_        },
+        { "cloneIsolation",        EvmuRamTestSuite_cloneIsolation_        },
+        { "cloneExtRebase",        EvmuRamTestSuite_cloneExtRebase_        },
         { NULL,                    NULL                                       },
     };
 
@@ -0,0 +1,385 @@
+#include "evmu_state_test_suite.h"
+#include <gimbal/test/gimbal_test_macros.h>
+#include <evmu/hw/evmu_device.h>
+#include <evmu/hw/evmu_flash.h>
+#include <evmu/hw/evmu_address_space.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EVMU_STATE_TEST_SUITE_(instance)  (GBL_PRIVATE(EvmuStateTestSuite, instance))
+
+#define EVMU_STATE_TEST_TICKS_          2000000ull  // ns
+#define EVMU_STATE_TEST_SLICE_          1000000ull  // ns
+#define EVMU_STATE_TEST_BLOCK_          5
+#define EVMU_STATE_TEST_REWIND_BUDGET_  (4 << 20)
+
+// Where the fields of the save state header sit, since the header itself is private
+#define EVMU_STATE_TEST_VERSION_OFFSET_ 4
+#define EVMU_STATE_TEST_ENDIAN_OFFSET_  6
+#define EVMU_STATE_TEST_SIZE_OFFSET_    8
+#define EVMU_STATE_TEST_HEADER_SIZE_    16
+
+#define GBL_SELF_TYPE EvmuStateTestSuite
+
+GBL_TEST_FIXTURE {
+    EvmuDevice* pDevice;
+};
+
+// Counts in RAM, mirrors the count into XRAM, and copies the buttons into RAM, forever
+static const uint8_t EvmuStateTestSuite_program_[] = {
+    /* 00 */ 0x62, 0x10,        // INC  0x10
+    /* 02 */ 0x02, 0x10,        // LD   0x10
+    /* 04 */ 0x13, 0x80,        // ST   0x180
+    /* 06 */ 0x03, 0x4c,        // LD   P3
+    /* 08 */ 0x12, 0x11,        // ST   0x11
+    /* 0a */ 0x01, 0xf4         // BR   0x00
+};
+
+static GBL_RESULT EvmuStateTestSuite_setup_(GblTestSuite* pSelf, EvmuDevice* pDevice) {
+    GBL_CTX_BEGIN(pSelf);
+
+    size_t bytes = sizeof(EvmuStateTestSuite_program_);
+
+    GBL_TEST_CALL(EvmuFlash_writeBytes(pDevice->pFlash, 0, EvmuStateTestSuite_program_, &bytes));
+    GBL_TEST_CALL(EvmuRam_setProgramSrc(pDevice->pRam, EVMU_PROGRAM_SRC_FLASH_BANK_0));
+    EvmuCpu_setPc(pDevice->pCpu, 0);
+
+    GBL_CTX_END();
+}
+
+// Updates pDevice a slice at a time, pressing a different pattern of buttons from one to the next
+static GBL_RESULT EvmuStateTestSuite_run_(GblTestSuite* pSelf, EvmuDevice* pDevice, size_t first, size_t slices) {
+    GBL_CTX_BEGIN(pSelf);
+
+    for(size_t s = first; s < first + slices; ++s) {
+        pDevice->pGamepad->a  = (s / 3) & 1;
+        pDevice->pGamepad->up = (s / 5) & 1;
+
+        GBL_TEST_CALL(EvmuIBehavior_update(EVMU_IBEHAVIOR(pDevice), EVMU_STATE_TEST_SLICE_));
+    }
+
+    GBL_CTX_END();
+}
+
+GBL_TEST_INIT() {
+    pFixture->pDevice = GBL_OBJECT_NEW(EvmuDevice);
+
+    GBL_TEST_CALL(EvmuStateTestSuite_setup_(pSelf, pFixture->pDevice));
+    GBL_TEST_CALL(EvmuIBehavior_update(EVMU_IBEHAVIOR(pFixture->pDevice), EVMU_STATE_TEST_TICKS_));
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_FINAL() {
+    GBL_UNREF(pFixture->pDevice);
+    GBL_TEST_CASE_END;
+}
+
+// Allocates and fills a full or delta state of pBehavior
+static GBL_RESULT EvmuStateTestSuite_save_(GblTestSuite*  pSelf,
+                                           EvmuIBehavior* pBehavior,
+                                           GblBool        delta,
+                                           uint8_t**      ppData,
+                                           size_t*        pSize)
+{
+    GBL_CTX_BEGIN(pSelf);
+
+    *pSize  = delta? EvmuIBehavior_deltaSize(pBehavior) : EvmuIBehavior_stateSize(pBehavior);
+    *ppData = malloc(*pSize);
+
+    GBL_TEST_VERIFY(*pSize && *ppData);
+
+    if(delta)
+        GBL_TEST_CALL(EvmuIBehavior_saveDelta(pBehavior, *ppData, *pSize, pSize));
+    else
+        GBL_TEST_CALL(EvmuIBehavior_saveState(pBehavior, *ppData, *pSize, pSize));
+
+    GBL_CTX_END();
+}
+
+static GblBool EvmuStateTestSuite_hashesMatch_(const EvmuStateHash* pA, const EvmuStateHash* pB) {
+    return pA->lo == pB->lo && pA->hi == pB->hi;
+}
+
+// Changes RAM, flash within the delta's block, and everything the CPU touches by running it
+static GBL_RESULT EvmuStateTestSuite_mutate_(GblTestSuite* pSelf) {
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuStateTestSuite_* pFixture = EVMU_STATE_TEST_SUITE_(pSelf);
+    EvmuDevice*          pDevice  = pFixture->pDevice;
+
+    GBL_TEST_CALL(EvmuFlash_writeByte(pDevice->pFlash,
+                                      EVMU_STATE_TEST_BLOCK_ * EVMU_FLASH_BLOCK_SIZE,
+                                      ~EvmuFlash_readByte(pDevice->pFlash,
+                                                          EVMU_STATE_TEST_BLOCK_ * EVMU_FLASH_BLOCK_SIZE)));
+    GBL_TEST_CALL(EvmuRam_writeData(pDevice->pRam, 0x20, ~EvmuRam_readData(pDevice->pRam, 0x20)));
+    GBL_TEST_CALL(EvmuIBehavior_update(EVMU_IBEHAVIOR(pDevice), EVMU_STATE_TEST_TICKS_));
+
+    GBL_CTX_END();
+}
+
+GBL_TEST_CASE(fullRoundTrip) {
+    EvmuStateHash saved, mutated, loaded;
+    uint8_t*      pState = NULL;
+    size_t        size   = 0;
+
+    GBL_TEST_CALL(EvmuStateTestSuite_save_(pSelf, EVMU_IBEHAVIOR(pFixture->pDevice), GBL_FALSE, &pState, &size));
+    GBL_TEST_CALL(EvmuDevice_stateHash(pFixture->pDevice, &saved));
+
+    GBL_TEST_CALL(EvmuStateTestSuite_mutate_(pSelf));
+    GBL_TEST_CALL(EvmuDevice_stateHash(pFixture->pDevice, &mutated));
+    GBL_TEST_VERIFY(!EvmuStateTestSuite_hashesMatch_(&saved, &mutated));
+
+    GBL_TEST_CALL(EvmuIBehavior_loadState(EVMU_IBEHAVIOR(pFixture->pDevice), pState, size));
+    GBL_TEST_CALL(EvmuDevice_stateHash(pFixture->pDevice, &loaded));
+    GBL_TEST_VERIFY(EvmuStateTestSuite_hashesMatch_(&saved, &loaded));
+
+    free(pState);
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_CASE(deltaRoundTrip) {
+    EvmuStateHash saved, loaded;
+    uint8_t*      pState = NULL;
+    size_t        size   = 0;
+
+    // Only the one block written since marking clean goes into the delta
+    EvmuFlash_markClean(pFixture->pDevice->pFlash);
+    GBL_TEST_CALL(EvmuStateTestSuite_mutate_(pSelf));
+
+    GBL_TEST_CALL(EvmuStateTestSuite_save_(pSelf, EVMU_IBEHAVIOR(pFixture->pDevice), GBL_TRUE, &pState, &size));
+    GBL_TEST_VERIFY(size + EVMU_FLASH_SIZE - EVMU_FLASH_BLOCK_SIZE <=
+                    EvmuIBehavior_stateSize(EVMU_IBEHAVIOR(pFixture->pDevice)));
+    GBL_TEST_CALL(EvmuDevice_stateHash(pFixture->pDevice, &saved));
+
+    GBL_TEST_CALL(EvmuStateTestSuite_mutate_(pSelf));
+
+    GBL_TEST_CALL(EvmuIBehavior_loadState(EVMU_IBEHAVIOR(pFixture->pDevice), pState, size));
+    GBL_TEST_CALL(EvmuDevice_stateHash(pFixture->pDevice, &loaded));
+    GBL_TEST_VERIFY(EvmuStateTestSuite_hashesMatch_(&saved, &loaded));
+
+    free(pState);
+
+    GBL_TEST_CASE_END;
+}
+
+/* Saves each peripheral's section on its own, runs just the CPU so that the
+ * device's own fields stay put, then loads every section back, which must
+ * restore all of the device. */
+GBL_TEST_CASE(peripheralRoundTrip) {
+    EvmuStateHash saved, loaded;
+    uint8_t*      pStates[64] = { NULL };
+    size_t        sizes[64]   = { 0 };
+    size_t        count       = 0;
+
+    GBL_TEST_CALL(EvmuDevice_stateHash(pFixture->pDevice, &saved));
+
+    for(GblObject* pObject = GblObject_childFirst(GBL_OBJECT(pFixture->pDevice));
+        pObject != NULL;
+        pObject = GblObject_siblingNext(pObject))
+    {
+        if(!GBL_TYPECHECK(EvmuIBehavior, pObject))
+            continue;
+
+        GBL_TEST_VERIFY(count < sizeof(pStates) / sizeof(pStates[0]));
+        GBL_TEST_CALL(EvmuStateTestSuite_save_(pSelf, EVMU_IBEHAVIOR(pObject), GBL_FALSE,
+                                               &pStates[count], &sizes[count]));
+        ++count;
+    }
+
+    GBL_TEST_VERIFY(count);
+
+    GBL_TEST_CALL(EvmuRam_writeData(pFixture->pDevice->pRam, 0x20, ~EvmuRam_readData(pFixture->pDevice->pRam, 0x20)));
+    GBL_TEST_CALL(EvmuIBehavior_update(EVMU_IBEHAVIOR(pFixture->pDevice->pCpu), EVMU_STATE_TEST_TICKS_));
+
+    count = 0;
+
+    for(GblObject* pObject = GblObject_childFirst(GBL_OBJECT(pFixture->pDevice));
+        pObject != NULL;
+        pObject = GblObject_siblingNext(pObject))
+    {
+        if(!GBL_TYPECHECK(EvmuIBehavior, pObject))
+            continue;
+
+        GBL_TEST_CALL(EvmuIBehavior_loadState(EVMU_IBEHAVIOR(pObject), pStates[count], sizes[count]));
+        free(pStates[count++]);
+    }
+
+    GBL_TEST_CALL(EvmuDevice_stateHash(pFixture->pDevice, &loaded));
+    GBL_TEST_VERIFY(EvmuStateTestSuite_hashesMatch_(&saved, &loaded));
+
+    GBL_TEST_CASE_END;
+}
+
+// Loading must fail with \p result and leave the device exactly as it was
+static GBL_RESULT EvmuStateTestSuite_rejects_(GblTestSuite*  pSelf,
+                                              const uint8_t* pState,
+                                              size_t         size,
+                                              GBL_RESULT     result)
+{
+    GBL_CTX_BEGIN(pSelf);
+
+    EvmuStateTestSuite_* pFixture = EVMU_STATE_TEST_SUITE_(pSelf);
+    EvmuStateHash        before, after;
+
+    GBL_TEST_CALL(EvmuDevice_stateHash(pFixture->pDevice, &before));
+
+    GBL_TEST_EXPECT_ERROR();
+    GBL_TEST_COMPARE(EvmuIBehavior_loadState(EVMU_IBEHAVIOR(pFixture->pDevice), pState, size), result);
+    GBL_CTX_CLEAR_LAST_RECORD();
+
+    GBL_TEST_CALL(EvmuDevice_stateHash(pFixture->pDevice, &after));
+    GBL_TEST_VERIFY(EvmuStateTestSuite_hashesMatch_(&before, &after));
+
+    GBL_CTX_END();
+}
+
+GBL_TEST_CASE(rejectTruncated) {
+    uint8_t* pState = NULL;
+    size_t   size   = 0;
+    uint64_t body;
+
+    GBL_TEST_CALL(EvmuStateTestSuite_save_(pSelf, EVMU_IBEHAVIOR(pFixture->pDevice), GBL_FALSE, &pState, &size));
+    GBL_TEST_CALL(EvmuStateTestSuite_mutate_(pSelf));
+
+    GBL_TEST_CALL(EvmuStateTestSuite_rejects_(pSelf, pState, size - 1, GBL_RESULT_ERROR_OUT_OF_RANGE));
+    GBL_TEST_CALL(EvmuStateTestSuite_rejects_(pSelf, pState, EVMU_STATE_TEST_HEADER_SIZE_ - 1,
+                                              GBL_RESULT_ERROR_INVALID_ARG));
+
+    // A header claiming the shorter size gets partway through the sections, which must all be rolled back
+    body = size / 2 - EVMU_STATE_TEST_HEADER_SIZE_;
+    memcpy(&pState[EVMU_STATE_TEST_SIZE_OFFSET_], &body, sizeof(body));
+
+    GBL_TEST_CALL(EvmuStateTestSuite_rejects_(pSelf, pState, size / 2, GBL_RESULT_ERROR_OUT_OF_RANGE));
+
+    free(pState);
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_CASE(rejectForeignEndian) {
+    uint8_t* pState = NULL;
+    size_t   size   = 0;
+    uint8_t  swap;
+
+    GBL_TEST_CALL(EvmuStateTestSuite_save_(pSelf, EVMU_IBEHAVIOR(pFixture->pDevice), GBL_FALSE, &pState, &size));
+    GBL_TEST_CALL(EvmuStateTestSuite_mutate_(pSelf));
+
+    swap                                       = pState[EVMU_STATE_TEST_ENDIAN_OFFSET_];
+    pState[EVMU_STATE_TEST_ENDIAN_OFFSET_]     = pState[EVMU_STATE_TEST_ENDIAN_OFFSET_ + 1];
+    pState[EVMU_STATE_TEST_ENDIAN_OFFSET_ + 1] = swap;
+
+    GBL_TEST_CALL(EvmuStateTestSuite_rejects_(pSelf, pState, size, GBL_RESULT_ERROR_INVALID_ARG));
+
+    free(pState);
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_CASE(rejectVersionMismatch) {
+    uint8_t* pState  = NULL;
+    size_t   size    = 0;
+    uint16_t version = EVMU_IBEHAVIOR_STATE_VERSION + 1;
+
+    GBL_TEST_CALL(EvmuStateTestSuite_save_(pSelf, EVMU_IBEHAVIOR(pFixture->pDevice), GBL_FALSE, &pState, &size));
+    GBL_TEST_CALL(EvmuStateTestSuite_mutate_(pSelf));
+
+    memcpy(&pState[EVMU_STATE_TEST_VERSION_OFFSET_], &version, sizeof(version));
+
+    GBL_TEST_CALL(EvmuStateTestSuite_rejects_(pSelf, pState, size, GBL_RESULT_ERROR_INVALID_ARG));
+
+    free(pState);
+
+    GBL_TEST_CASE_END;
+}
+
+// Rewinding partway back must land on exactly the state a device run straight there is in
+GBL_TEST_CASE(rewindMatchesStraightRun) {
+    EvmuDevice*   pRewound  = GBL_OBJECT_NEW(EvmuDevice);
+    EvmuDevice*   pStraight = GBL_OBJECT_NEW(EvmuDevice);
+    EvmuStateHash rewound, straight;
+
+    GBL_TEST_CALL(EvmuStateTestSuite_setup_(pSelf, pRewound));
+    GBL_TEST_CALL(EvmuStateTestSuite_setup_(pSelf, pStraight));
+
+    GBL_TEST_CALL(EvmuDevice_setRewind(pRewound, EVMU_STATE_TEST_REWIND_BUDGET_, 4 * EVMU_STATE_TEST_SLICE_));
+
+    GBL_TEST_CALL(EvmuStateTestSuite_run_(pSelf, pRewound,  0, 40));
+    GBL_TEST_CALL(EvmuStateTestSuite_run_(pSelf, pStraight, 0, 25));
+
+    // Between snapshots, so replaying the recorded input is needed to get there
+    const EvmuTicks target = EvmuDevice_emulatedTicks(pStraight);
+    GBL_TEST_VERIFY(target >= EvmuDevice_rewindLimit(pRewound));
+
+    GBL_TEST_CALL(EvmuDevice_rewind(pRewound, target));
+    GBL_TEST_COMPARE(EvmuDevice_emulatedTicks(pRewound), target);
+
+    GBL_TEST_CALL(EvmuDevice_stateHash(pRewound,  &rewound));
+    GBL_TEST_CALL(EvmuDevice_stateHash(pStraight, &straight));
+    GBL_TEST_VERIFY(EvmuStateTestSuite_hashesMatch_(&rewound, &straight));
+
+    // And carries on from there as though it had never gone further
+    GBL_TEST_CALL(EvmuStateTestSuite_run_(pSelf, pRewound,  25, 15));
+    GBL_TEST_CALL(EvmuStateTestSuite_run_(pSelf, pStraight, 25, 15));
+
+    GBL_TEST_CALL(EvmuDevice_stateHash(pRewound,  &rewound));
+    GBL_TEST_CALL(EvmuDevice_stateHash(pStraight, &straight));
+    GBL_TEST_VERIFY(EvmuStateTestSuite_hashesMatch_(&rewound, &straight));
+
+    GBL_UNREF(pRewound);
+    GBL_UNREF(pStraight);
+
+    GBL_TEST_CASE_END;
+}
+
+// Playing a movie back on another device must end in exactly the state of one run straight through
+GBL_TEST_CASE(movieMatchesStraightRun) {
+    EvmuDevice*   pRecorded = GBL_OBJECT_NEW(EvmuDevice);
+    EvmuDevice*   pStraight = GBL_OBJECT_NEW(EvmuDevice);
+    EvmuDevice*   pPlayed   = GBL_OBJECT_NEW(EvmuDevice);
+    EvmuStateHash recorded, straight, played;
+    uint8_t*      pMovie    = NULL;
+    size_t        size      = 0;
+
+    GBL_TEST_CALL(EvmuStateTestSuite_setup_(pSelf, pRecorded));
+    GBL_TEST_CALL(EvmuStateTestSuite_setup_(pSelf, pStraight));
+
+    // Recording starts partway in, so the movie's own state is what gets the player there
+    GBL_TEST_CALL(EvmuStateTestSuite_run_(pSelf, pRecorded, 0, 10));
+    GBL_TEST_CALL(EvmuDevice_recordMovie(pRecorded));
+    GBL_TEST_CALL(EvmuStateTestSuite_run_(pSelf, pRecorded, 10, 30));
+    GBL_TEST_VERIFY(EvmuDevice_movieRecording(pRecorded));
+
+    GBL_TEST_CALL(EvmuStateTestSuite_run_(pSelf, pStraight, 0, 40));
+
+    size   = EvmuDevice_movieSize(pRecorded);
+    pMovie = malloc(size);
+    GBL_TEST_VERIFY(size && pMovie);
+    GBL_TEST_CALL(EvmuDevice_saveMovie(pRecorded, pMovie, size, &size));
+
+    GBL_TEST_CALL(EvmuDevice_playMovie(pPlayed, pMovie, size));
+    GBL_TEST_COMPARE(EvmuDevice_emulatedTicks(pPlayed), EvmuDevice_emulatedTicks(pStraight));
+
+    GBL_TEST_CALL(EvmuDevice_stateHash(pRecorded, &recorded));
+    GBL_TEST_CALL(EvmuDevice_stateHash(pStraight, &straight));
+    GBL_TEST_CALL(EvmuDevice_stateHash(pPlayed,   &played));
+    GBL_TEST_VERIFY(EvmuStateTestSuite_hashesMatch_(&recorded, &straight));
+    GBL_TEST_VERIFY(EvmuStateTestSuite_hashesMatch_(&played,   &straight));
+
+    free(pMovie);
+    GBL_UNREF(pRecorded);
+    GBL_UNREF(pStraight);
+    GBL_UNREF(pPlayed);
+
+    GBL_TEST_CASE_END;
+}
+
+GBL_TEST_REGISTER(fullRoundTrip,
+                  deltaRoundTrip,
+                  peripheralRoundTrip,
+                  rejectTruncated,
+                  rejectForeignEndian,
+                  rejectVersionMismatch,
+                  rewindMatchesStraightRun,
+                  movieMatchesStraightRun);
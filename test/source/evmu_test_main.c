@@ -2,6 +2,12 @@
 #include "evmu_memory_test_suite.h"
 #include "evmu_cpu_test_suite.h"
 #include "evmu_isa_test_suite.h"
+#include "evmu_lcd_test_suite.h"
+#include "evmu_buzzer_test_suite.h"
+#include "evmu_batch_test_suite.h"
+#include "evmu_state_test_suite.h"
+#include "evmu_journal_test_suite.h"
+#include "evmu_emulator_test_suite.h"
 #include <stdlib.h>
 
 #if defined(__DREAMCAST__) && !defined(NDEBUG)
@@ -21,6 +27,20 @@ int main(int argc, char* pArgv[]) {
                                  GBL_TEST_SUITE(GBL_OBJECT_NEW(EvmuCpuTestSuite)));
     GblTestScenario_enqueueSuite(pScenario,
                                  GBL_TEST_SUITE(GBL_OBJECT_NEW(EvmuIsaTestSuite)));
+    GblTestScenario_enqueueSuite(pScenario,
+                                 GBL_TEST_SUITE(GBL_OBJECT_NEW(EvmuLcdTestSuite)));
+    GblTestScenario_enqueueSuite(pScenario,
+                                 GBL_TEST_SUITE(GBL_OBJECT_NEW(EvmuBuzzerTestSuite)));
+    GblTestScenario_enqueueSuite(pScenario,
+                                 GBL_TEST_SUITE(GBL_OBJECT_NEW(EvmuBatchTestSuite)));
+    GblTestScenario_enqueueSuite(pScenario,
+                                 GBL_TEST_SUITE(GBL_OBJECT_NEW(EvmuStateTestSuite)));
+#ifdef EVMU_HAVE_POSIX_FILES
+    GblTestScenario_enqueueSuite(pScenario,
+                                 GBL_TEST_SUITE(GBL_OBJECT_NEW(EvmuJournalTestSuite)));
+#endif
+    GblTestScenario_enqueueSuite(pScenario,
+                                 GBL_TEST_SUITE(GBL_OBJECT_NEW(EvmuEmulatorTestSuite)));
 
     const GBL_RESULT result = GblTestScenario_run(pScenario, argc, pArgv);
 